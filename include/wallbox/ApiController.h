@@ -3,6 +3,9 @@
 
 #include "HttpApiServer.h"
 #include "WallboxController.h"
+#include "LatencyTracer.h"
+#include "Logger.h"
+#include "Metrics.h"
 #include <memory>
 
 namespace Wallbox
@@ -41,10 +44,28 @@ namespace Wallbox
             setupStatusEndpoints(server);
             setupChargingEndpoints(server);
             setupWallboxEndpoints(server);
+            setupEventEndpoints(server);
         }
 
     private:
         WallboxController &m_wallboxController;
+        std::shared_ptr<EventStream> m_events;
+        std::shared_ptr<VersionedResource> m_statusResource;
+        std::shared_ptr<VersionedResource> m_relayResource;
+
+        /**
+         * @brief Setup push channel (Server-Sent Events)
+         */
+        void setupEventEndpoints(HttpApiServer &server)
+        {
+            // GET /api/events - state, relay and CP changes as they happen
+            m_events = std::make_shared<EventStream>();
+            server.registerEventStream("/api/events", m_events);
+
+            std::shared_ptr<EventStream> events = m_events;
+            m_wallboxController.addEventListener([events](const std::string &event, const std::string &data)
+                                                 { events->publish(event, data); });
+        }
 
         /**
          * @brief Setup health check endpoints
@@ -53,29 +74,89 @@ namespace Wallbox
         {
             server.GET("/health", [](const HttpRequest &, HttpResponse &res)
                        {
-                JsonBuilder json;
-                json.add("status", "healthy")
-                    .add("service", "Wallbox Controller API")
-                    .add("version", "2.0.0");
-                res.setJson(json.build()); });
+                JsonWriter json(res.body);
+                json.beginObject()
+                    .field("status", "healthy")
+                    .field("service", "Wallbox Controller API")
+                    .field("version", "2.0.0")
+                    .endObject(); });
+
+            // GET /api/diagnostics - internal counters
+            server.GET("/api/diagnostics", [this](const HttpRequest &, HttpResponse &res)
+                       {
+                GpioWriteStats gpio = m_wallboxController.getGpioWriteStats();
+                CpFilterStats cp = m_wallboxController.getCpFilterStats();
+                CpLatencyStats latency = m_wallboxController.getCpLatencyStats();
+                ListenerStats listeners = m_wallboxController.getStateDispatchStats();
+                LoggerStats log = Logger::instance().getStats();
+                JsonWriter json(res.body);
+                json.beginObject()
+                    .key("gpio")
+                    .beginObject()
+                    .field("writes", gpio.writes)
+                    .field("writesSaved", gpio.writesSaved)
+                    .endObject()
+                    .key("cp")
+                    .beginObject()
+                    .field("samples", cp.samples)
+                    .field("transitions", cp.transitions)
+                    .field("suppressed", cp.suppressed())
+                    .endObject()
+                    .key("cpToOutputs")
+                    .beginObject()
+                    .field("count", latency.count)
+                    .field("lastUs", latency.lastNs / 1000)
+                    .field("meanUs", latency.meanNs() / 1000)
+                    .field("maxUs", latency.maxNs / 1000)
+                    .endObject()
+                    .key("stateListeners")
+                    .beginObject()
+                    .field("delivered", listeners.delivered)
+                    .field("dropped", listeners.dropped)
+                    .field("highWater", static_cast<uint64_t>(listeners.highWater))
+                    .endObject()
+                    .key("log")
+                    .beginObject()
+                    .field("written", log.written)
+                    .field("dropped", log.dropped)
+                    .field("writes", log.writes)
+                    .endObject()
+                    .endObject(); });
+
+            // GET /metrics - counters and latency histograms in the Prometheus text format
+            server.GET("/metrics", [](const HttpRequest &, HttpResponse &res)
+                       {
+                res.contentType = MetricsRegistry::CONTENT_TYPE;
+                MetricsRegistry::instance().render(res.body); });
+
+            // GET /api/trace - recent latency traces as Chrome trace-event JSON (?all=1 adds idle heartbeats)
+            server.GET("/api/trace", [](const HttpRequest &req, HttpResponse &res)
+                       { LatencyTracer::instance().writeChromeTrace(res.body, req.getParam("all") == "1"); });
         }
 
         /**
          * @brief Setup status query endpoints
+         *
+         * Both are served from the controller's status snapshot, versioned
+         * with ETag and long-poll support (?since=<version>); polling them
+         * does not touch the controller.
          */
         void setupStatusEndpoints(HttpApiServer &server)
         {
             // GET /api/status - Get current wallbox status
-            server.GET("/api/status", [this](const HttpRequest &, HttpResponse &res)
-                       { res.setJson(m_wallboxController.getStatusJson()); });
+            m_statusResource = std::make_shared<VersionedResource>();
+            server.registerVersionedResource("/api/status", m_statusResource);
 
             // GET /api/relay - Get relay status
-            server.GET("/api/relay", [this](const HttpRequest &, HttpResponse &res)
-                       {
-                JsonBuilder json;
-                json.add("relayEnabled", m_wallboxController.isRelayEnabled())
-                    .add("state", m_wallboxController.getStateString());
-                res.setJson(json.build()); });
+            m_relayResource = std::make_shared<VersionedResource>();
+            server.registerVersionedResource("/api/relay", m_relayResource);
+
+            std::shared_ptr<VersionedResource> status = m_statusResource;
+            std::shared_ptr<VersionedResource> relay = m_relayResource;
+            m_wallboxController.addSnapshotListener([status, relay](const StatusSnapshotPtr &snapshot)
+                                                    {
+                status->publish(snapshot->version, snapshot->statusJson);
+                relay->publish(snapshot->version, snapshot->relayJson); });
         }
 
         /**
@@ -87,11 +168,12 @@ namespace Wallbox
             server.POST("/api/charging/start", [this](const HttpRequest &, HttpResponse &res)
                         {
                 if (m_wallboxController.startCharging()) {
-                    JsonBuilder json;
-                    json.add("success", true)
-                        .add("message", "Charging started")
-                        .add("state", m_wallboxController.getStateString());
-                    res.setJson(json.build());
+                    JsonWriter json(res.body);
+                    json.beginObject()
+                        .field("success", true)
+                        .field("message", "Charging started")
+                        .field("state", m_wallboxController.getStateString())
+                        .endObject();
                 } else {
                     res.setError(400, "Failed to start charging");
                 } });
@@ -100,11 +182,12 @@ namespace Wallbox
             server.POST("/api/charging/stop", [this](const HttpRequest &, HttpResponse &res)
                         {
                 if (m_wallboxController.stopCharging()) {
-                    JsonBuilder json;
-                    json.add("success", true)
-                        .add("message", "Charging stopped")
-                        .add("state", m_wallboxController.getStateString());
-                    res.setJson(json.build());
+                    JsonWriter json(res.body);
+                    json.beginObject()
+                        .field("success", true)
+                        .field("message", "Charging stopped")
+                        .field("state", m_wallboxController.getStateString())
+                        .endObject();
                 } else {
                     res.setError(400, "Failed to stop charging");
                 } });
@@ -113,11 +196,12 @@ namespace Wallbox
             server.POST("/api/charging/pause", [this](const HttpRequest &, HttpResponse &res)
                         {
                 if (m_wallboxController.pauseCharging()) {
-                    JsonBuilder json;
-                    json.add("success", true)
-                        .add("message", "Charging paused")
-                        .add("state", m_wallboxController.getStateString());
-                    res.setJson(json.build());
+                    JsonWriter json(res.body);
+                    json.beginObject()
+                        .field("success", true)
+                        .field("message", "Charging paused")
+                        .field("state", m_wallboxController.getStateString())
+                        .endObject();
                 } else {
                     res.setError(400, "Failed to pause charging");
                 } });
@@ -126,11 +210,12 @@ namespace Wallbox
             server.POST("/api/charging/resume", [this](const HttpRequest &, HttpResponse &res)
                         {
                 if (m_wallboxController.resumeCharging()) {
-                    JsonBuilder json;
-                    json.add("success", true)
-                        .add("message", "Charging resumed")
-                        .add("state", m_wallboxController.getStateString());
-                    res.setJson(json.build());
+                    JsonWriter json(res.body);
+                    json.beginObject()
+                        .field("success", true)
+                        .field("message", "Charging resumed")
+                        .field("state", m_wallboxController.getStateString())
+                        .endObject();
                 } else {
                     res.setError(400, "Failed to resume charging");
                 } });
@@ -145,11 +230,12 @@ namespace Wallbox
             server.POST("/api/wallbox/enable", [this](const HttpRequest &, HttpResponse &res)
                         {
                 if (m_wallboxController.enableWallbox()) {
-                    JsonBuilder json;
-                    json.add("success", true)
-                        .add("message", "Wallbox enabled")
-                        .add("enabled", true);
-                    res.setJson(json.build());
+                    JsonWriter json(res.body);
+                    json.beginObject()
+                        .field("success", true)
+                        .field("message", "Wallbox enabled")
+                        .field("enabled", true)
+                        .endObject();
                 } else {
                     res.setError(400, "Failed to enable wallbox");
                 } });
@@ -158,11 +244,12 @@ namespace Wallbox
             server.POST("/api/wallbox/disable", [this](const HttpRequest &, HttpResponse &res)
                         {
                 if (m_wallboxController.disableWallbox()) {
-                    JsonBuilder json;
-                    json.add("success", true)
-                        .add("message", "Wallbox disabled")
-                        .add("enabled", false);
-                    res.setJson(json.build());
+                    JsonWriter json(res.body);
+                    json.beginObject()
+                        .field("success", true)
+                        .field("message", "Wallbox disabled")
+                        .field("enabled", false)
+                        .endObject();
                 } else {
                     res.setError(400, "Failed to disable wallbox");
                 } });
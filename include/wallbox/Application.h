@@ -7,13 +7,12 @@
 #include "ApiController.h"
 #include "GpioFactory.h"
 #include "UdpCommunicator.h"
+#include "Logger.h"
 #include <memory>
 #include <atomic>
+#include <thread>
 #include <csignal>
 #include <iostream>
-#include <fstream>
-#include <chrono>
-#include <iomanip>
 #include <sstream>
 #include <cstdlib>
 
@@ -43,14 +42,15 @@ namespace Wallbox
             : m_running(false), m_config(Configuration::getInstance()), m_interactiveMode(false), m_dualMode(false)
         {
             // Open log file
-            m_logFile.open("/tmp/wallbox_v3.log", std::ios::out | std::ios::app);
+            m_logSink = Logger::instance().openFile("/tmp/wallbox_v3.log");
         }
 
         ~Application()
         {
-            if (m_logFile.is_open())
+            stopController();
+            if (m_logSink)
             {
-                m_logFile.close();
+                Logger::instance().closeFile(m_logSink);
             }
         }
 
@@ -75,14 +75,28 @@ namespace Wallbox
             m_config.loadFromFile(configFile);
             m_config.loadFromEnvironment();
 
+            LogLevel level;
+            if (Logger::parseLevel(m_config.getLogLevel(), level))
+            {
+                Logger::setLevel(level);
+            }
+            else
+            {
+                std::cerr << "Unknown log level: " << m_config.getLogLevel() << std::endl;
+            }
+
             displayConfiguration();
 
             // Create dependencies using factories
-            auto gpio = GpioFactory::create(m_config.getGpioType());
+            auto gpio = GpioFactory::create(m_config.getGpioType(),
+                                            m_config.getGpioChip(),
+                                            m_config.getGpioLineBase(),
+                                            m_config.getGpioMemDevice());
             auto network = std::make_unique<UdpCommunicator>(
                 m_config.getUdpListenPort(),
                 m_config.getUdpSendPort(),
-                m_config.getUdpSendAddress());
+                m_config.getUdpSendAddress(),
+                m_config.getUdpConnectedSocket());
 
             // Create wallbox controller
             m_wallboxController = std::make_unique<WallboxController>(
@@ -101,7 +115,12 @@ namespace Wallbox
             {
                 std::cout << "Starting HTTP API server..." << std::endl;
                 // Create and setup API server
-                m_apiServer = std::make_unique<HttpApiServer>(m_config.getApiPort());
+                HttpServerConfig serverConfig;
+                serverConfig.workerThreads = static_cast<size_t>(m_config.getHttpWorkerThreads());
+                serverConfig.maxConnections = static_cast<size_t>(m_config.getHttpMaxConnections());
+                serverConfig.maxHeaderBytes = static_cast<size_t>(m_config.getHttpMaxHeaderBytes());
+                serverConfig.maxBodyBytes = static_cast<size_t>(m_config.getHttpMaxBodyBytes());
+                m_apiServer = std::make_unique<HttpApiServer>(m_config.getApiPort(), serverConfig);
                 m_apiController = std::make_unique<ApiController>(*m_wallboxController);
                 m_apiController->setupEndpoints(*m_apiServer);
 
@@ -123,13 +142,15 @@ namespace Wallbox
 
         /**
          * @brief Run the application main loop (API server mode)
+         *
+         * The controller event loop runs on this thread until requestShutdown();
+         * the HTTP API serves requests from its own threads.
          */
         void run()
         {
-            // Just keep running and let HTTP API handle requests
-            while (m_running)
+            if (m_running)
             {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                m_wallboxController->run();
             }
         }
 
@@ -139,6 +160,7 @@ namespace Wallbox
         void runInteractive()
         {
             logMessage("INFO", "Interactive mode started - commands: enable, disable, start, stop, pause, resume, status, help, quit");
+            startControllerThread();
 
             // Show help at startup
             showHelp();
@@ -165,6 +187,7 @@ namespace Wallbox
         void runDual()
         {
             logMessage("INFO", "Dual mode started - HTTP API + Interactive terminal");
+            startControllerThread();
 
             // Show help at startup
             showHelp();
@@ -354,6 +377,7 @@ namespace Wallbox
          */
         void shutdown()
         {
+            stopController();
             if (!m_running)
                 return;
 
@@ -379,6 +403,10 @@ namespace Wallbox
         void requestShutdown()
         {
             m_running = false;
+            if (m_wallboxController)
+            {
+                m_wallboxController->stop();
+            }
         }
 
         /**
@@ -424,23 +452,34 @@ namespace Wallbox
         std::unique_ptr<WallboxController> m_wallboxController;
         std::unique_ptr<HttpApiServer> m_apiServer;
         std::unique_ptr<ApiController> m_apiController;
-        std::ofstream m_logFile;
+        std::thread m_controllerThread; ///< Runs the controller loop while the terminal owns the main thread
+        LogSinks m_logSink; ///< Application log file, 0 if it could not be opened
 
         /**
-         * @brief Get timestamp string
+         * @brief Run the controller event loop in the background (interactive modes)
          */
-        std::string getTimestamp()
+        void startControllerThread()
         {
-            auto now = std::chrono::system_clock::now();
-            auto time_t = std::chrono::system_clock::to_time_t(now);
-            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                          now.time_since_epoch()) %
-                      1000;
+            if (m_running && !m_controllerThread.joinable())
+            {
+                m_controllerThread = std::thread([this]()
+                                                 { m_wallboxController->run(); });
+            }
+        }
 
-            std::stringstream ss;
-            ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
-            ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
-            return ss.str();
+        /**
+         * @brief Stop the controller event loop and wait for it to return
+         */
+        void stopController()
+        {
+            if (m_wallboxController)
+            {
+                m_wallboxController->stop();
+            }
+            if (m_controllerThread.joinable())
+            {
+                m_controllerThread.join();
+            }
         }
 
         /**
@@ -448,11 +487,7 @@ namespace Wallbox
          */
         void logMessage(const std::string &level, const std::string &message)
         {
-            if (m_logFile.is_open())
-            {
-                m_logFile << "[" << getTimestamp() << "] [" << level << "] " << message << std::endl;
-                m_logFile.flush();
-            }
+            LogLine(level, m_logSink) << message;
         }
 
         void displayConfiguration()
@@ -469,6 +504,8 @@ namespace Wallbox
             std::cout << "  UDP Send Port: " << m_config.getUdpSendPort() << std::endl;
             std::cout << "  UDP Send Address: " << m_config.getUdpSendAddress() << std::endl;
             std::cout << "  REST API Port: " << m_config.getApiPort() << std::endl;
+            std::cout << "  HTTP Workers: " << m_config.getHttpWorkerThreads()
+                      << " (max " << m_config.getHttpMaxConnections() << " connections)" << std::endl;
 
             if (m_config.isDevelopmentMode())
             {
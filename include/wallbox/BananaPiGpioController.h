@@ -2,7 +2,10 @@
 #define BANANA_PI_GPIO_CONTROLLER_H
 
 #include "IGpioController.h"
+#include "GpioEdgeWatcher.h"
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 namespace Wallbox
 {
@@ -13,13 +16,25 @@ namespace Wallbox
      * Uses direct sysfs GPIO access for Banana Pi hardware.
      * This implementation works on real Banana Pi boards.
      *
+     * Each pin's value file is opened once (in setPinMode(), or on first
+     * use) and kept open; reads and writes are a single pread()/pwrite()
+     * at offset 0 instead of an open/format/close per call.
+     *
+     * watchPin() sets the pin's sysfs "edge" attribute and waits for
+     * POLLPRI on the open value file; the event timestamp is taken when
+     * the watcher thread wakes.
+     *
      * Design Pattern: Strategy Pattern
      * SOLID Principle: Liskov Substitution Principle
      */
     class BananaPiGpioController : public IGpioController
     {
     public:
-        BananaPiGpioController();
+        /**
+         * @param gpioPath sysfs GPIO root; a directory with the same layout
+         *                 can be used for testing without hardware
+         */
+        explicit BananaPiGpioController(const std::string &gpioPath = GPIO_PATH);
         ~BananaPiGpioController() override;
 
         bool initialize() override;
@@ -30,14 +45,24 @@ namespace Wallbox
         PinValue digitalRead(int pin) const override;
         bool isInitialized() const override;
 
+        bool watchPin(int pin, PinEdge edge, PinEventCallback callback) override;
+        void unwatchPin(int pin) override;
+
     private:
         bool exportPin(int pin);
         bool unexportPin(int pin);
         bool setDirection(int pin, const std::string &direction);
+        bool setEdge(int pin, const std::string &edge);
         bool setValue(int pin, int value) const;
         int getValue(int pin) const;
+        int valueFd(int pin) const;
+        void closeValueFds();
 
         bool m_initialized;
+        std::string m_gpioPath;
+        mutable std::unordered_map<int, int> m_valueFds; ///< pin -> open value file
+        mutable std::mutex m_valueFdMutex;
+        GpioEdgeWatcher m_edgeWatcher;
         static constexpr const char *GPIO_PATH = "/sys/class/gpio";
     };
 
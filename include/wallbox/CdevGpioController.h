@@ -0,0 +1,104 @@
+#ifndef CDEV_GPIO_CONTROLLER_H
+#define CDEV_GPIO_CONTROLLER_H
+
+#include "IGpioController.h"
+#include "GpioEdgeWatcher.h"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct gpio_v2_line_config;
+
+namespace Wallbox
+{
+
+    /**
+     * @brief GPIO controller on the character device (/dev/gpiochipN)
+     *
+     * Uses the GPIO v2 uAPI ioctls directly (no libgpiod). setPinMode()
+     * only collects lines; the first read, write or watchPin() requests all
+     * collected lines in one multi-line request, so startup needs no export
+     * and no settling delays. A request is held until shutdown(): later mode
+     * and edge changes are applied to it in place (GPIO_V2_LINE_SET_CONFIG)
+     * and a pin configured after the first request gets a request of its
+     * own, so an output that is already driven never glitches. A read or
+     * write is one ioctl, and writeMany() updates several outputs (e.g. an
+     * LED pattern) in one ioctl per request.
+     *
+     * watchPin() enables edge detection on the line in its request; the
+     * kernel queues line events with their own timestamp, so edges carry
+     * the time of the interrupt rather than of the wakeup.
+     *
+     * Pins use the same global numbers as sysfs; lineBase (the chip's
+     * sysfs base) is subtracted to get the line offset on the chip.
+     *
+     * Design Pattern: Strategy Pattern
+     * SOLID Principle: Liskov Substitution Principle
+     */
+    class CdevGpioController : public IGpioController
+    {
+    public:
+        /**
+         * @param chipPath GPIO chip device, e.g. /dev/gpiochip0
+         * @param lineBase Global number of the chip's line 0
+         */
+        explicit CdevGpioController(const std::string &chipPath = DEFAULT_CHIP, int lineBase = 0);
+        ~CdevGpioController() override;
+
+        bool initialize() override;
+        void shutdown() override;
+
+        bool setPinMode(int pin, PinMode mode) override;
+        bool digitalWrite(int pin, PinValue value) override;
+        PinValue digitalRead(int pin) const override;
+        bool isInitialized() const override;
+
+        /**
+         * @brief Set several output pins with a single ioctl
+         * @return false if a pin is not configured as output or the ioctl fails
+         */
+        bool writeMany(const PinWrite *writes, size_t count) override;
+
+        bool watchPin(int pin, PinEdge edge, PinEventCallback callback) override;
+        void unwatchPin(int pin) override;
+
+        static constexpr const char *DEFAULT_CHIP = "/dev/gpiochip0";
+
+    private:
+        struct Line
+        {
+            int pin;
+            uint32_t offset;
+            PinMode mode;
+            bool high; ///< Level to drive (outputs), kept across reconfiguration
+            int edge;  ///< PinEdge bits reported for this input, 0 if not watched
+            PinEventCallback callback;
+            mutable int request;   ///< Index in m_requestFds, -1 until requested
+            mutable uint32_t bit;  ///< Position in that request
+        };
+
+        std::string m_chipPath;
+        int m_lineBase;
+        uint32_t m_chipLines;
+        int m_chipFd;
+        mutable std::vector<int> m_requestFds; ///< Held until shutdown()
+        mutable bool m_pendingLines;          ///< Lines configured but not yet requested
+        std::vector<Line> m_lines;
+        mutable std::mutex m_mutex;
+        std::mutex m_configMutex; ///< Serializes reconfiguration and edge watcher updates; never held by I/O
+        GpioEdgeWatcher m_edgeWatcher;
+
+        int findLine(int pin) const;
+        bool requestPending() const;
+        bool configureRequest(int request);
+        void buildConfig(int request, gpio_v2_line_config &config) const;
+        GpioEdgeWatcher::ReadyHandler edgeHandler(int request) const;
+        void updateWatcher(int request, int fd, GpioEdgeWatcher::ReadyHandler handler);
+        bool setValues(int fd, uint64_t bits, uint64_t mask);
+    };
+
+} // namespace Wallbox
+
+#endif // CDEV_GPIO_CONTROLLER_H
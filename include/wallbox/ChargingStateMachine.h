@@ -2,8 +2,11 @@
 #define CHARGING_STATE_MACHINE_H
 
 #include <string>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 namespace Wallbox
@@ -37,6 +40,27 @@ namespace Wallbox
      */
     using StateChangeCallback = std::function<void(ChargingState oldState, ChargingState newState, const std::string &reason)>;
 
+    /**
+     * @brief How a state change listener is called
+     */
+    enum class ListenerMode
+    {
+        SYNCHRONOUS, ///< Inside the transition, on the transitioning thread
+        ASYNCHRONOUS ///< On the listener's own thread, fed through a bounded ring
+    };
+
+    using ListenerId = uint64_t;
+
+    /**
+     * @brief Delivery counters of a listener (dropped and highWater stay 0 for synchronous ones)
+     */
+    struct ListenerStats
+    {
+        uint64_t delivered; ///< Events handed to the callback
+        uint64_t dropped;   ///< Events lost because the listener's ring was full
+        size_t highWater;   ///< Most events ever waiting in the ring
+    };
+
     /**
      * @brief State machine for managing charging process
      *
@@ -51,6 +75,19 @@ namespace Wallbox
      * - Single Responsibility: Only manages state transitions
      * - Open/Closed: New states can be added via inheritance
      * - Liskov Substitution: State behaviors are substitutable
+     *
+     * Not synchronized: the owner must use it from one thread at a time
+     * (WallboxController only touches it on its controller loop).
+     * Listener registration is the exception: listeners may be added and
+     * removed from any thread, also while a transition is dispatching.
+     *
+     * The listener list is copy-on-write: transitions dispatch from an
+     * immutable snapshot without locking, add/remove publish a new list.
+     * Synchronous listeners run inside the transition. Asynchronous
+     * listeners get each event pushed into their own bounded SPSC ring and
+     * run on their own thread, so a slow listener (logging, network) costs
+     * the transition one ring push instead of its run time. When a ring is
+     * full the event is dropped for that listener and counted.
      */
     class ChargingStateMachine
     {
@@ -76,9 +113,39 @@ namespace Wallbox
         bool reset();
 
         // Observer pattern
-        void addStateChangeListener(StateChangeCallback callback);
+        ListenerId addStateChangeListener(StateChangeCallback callback);
+
+        /**
+         * @brief Register a listener, optionally dispatched asynchronously
+         * @param queueCapacity Ring size for ASYNCHRONOUS (rounded up to a power of two)
+         * @return Id for removeStateChangeListener()
+         */
+        ListenerId addStateChangeListener(StateChangeCallback callback, ListenerMode mode,
+                                          size_t queueCapacity = DEFAULT_QUEUE_CAPACITY);
+
+        /**
+         * @brief Unregister a listener
+         *
+         * An asynchronous listener's thread is stopped and joined; events
+         * still in its ring are discarded. Must not be called from that
+         * listener's own callback.
+         * @return false if the id is unknown
+         */
+        bool removeStateChangeListener(ListenerId id);
         void clearStateChangeListeners();
 
+        /**
+         * @brief Delivery counters of a listener (all zero for unknown ids)
+         */
+        ListenerStats getListenerStats(ListenerId id) const;
+
+        /**
+         * @brief Delivery counters summed over all asynchronous listeners
+         */
+        ListenerStats getDispatchStats() const;
+
+        static constexpr size_t DEFAULT_QUEUE_CAPACITY = 64;
+
         // State predicates
         bool isCharging() const { return m_currentState == ChargingState::CHARGING; }
         bool isIdle() const { return m_currentState == ChargingState::IDLE; }
@@ -89,8 +156,15 @@ namespace Wallbox
         bool isOff() const { return m_currentState == ChargingState::OFF; }
 
     private:
+        struct Listener;
+        using ListenerList = std::vector<std::shared_ptr<Listener>>;
+
         ChargingState m_currentState;
-        std::vector<StateChangeCallback> m_listeners;
+        std::shared_ptr<const ListenerList> m_listeners; ///< Accessed with std::atomic_load/atomic_store
+        std::mutex m_listenerMutex;                      ///< Serializes list updates (not dispatch)
+        ListenerId m_nextListenerId;
+
+        std::shared_ptr<const ListenerList> listeners() const { return std::atomic_load(&m_listeners); }
 
         void notifyStateChange(ChargingState oldState, ChargingState newState, const std::string &reason);
         bool isValidTransition(ChargingState from, ChargingState to) const;
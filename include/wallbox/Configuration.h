@@ -59,16 +59,25 @@ namespace Wallbox
         // GPIO
         std::string getGpioType() const
         {
-            return m_mode == Mode::DEVELOPMENT ? "stub" : "bananapi";
+            return m_mode == Mode::DEVELOPMENT ? "stub" : m_gpioBackend;
         }
+        std::string getGpioChip() const { return m_gpioChip; }
+        int getGpioLineBase() const { return m_gpioLineBase; }
+        std::string getGpioMemDevice() const { return m_gpioMemDevice; }
 
         // Network
         int getUdpListenPort() const { return m_udpListenPort; }
         int getUdpSendPort() const { return m_udpSendPort; }
         std::string getUdpSendAddress() const { return m_udpSendAddress; }
+        bool getUdpConnectedSocket() const { return m_udpConnectedSocket; }
+        int getStatusHeartbeatMs() const { return m_statusHeartbeatMs; }
 
         // API
         int getApiPort() const { return m_apiPort; }
+        int getHttpWorkerThreads() const { return m_httpWorkerThreads; }
+        int getHttpMaxConnections() const { return m_httpMaxConnections; }
+        int getHttpMaxHeaderBytes() const { return m_httpMaxHeaderBytes; }
+        int getHttpMaxBodyBytes() const { return m_httpMaxBodyBytes; }
 
         // GPIO Pins - now configurable
         int getRelayPin() const { return m_relayPin; }
@@ -78,6 +87,20 @@ namespace Wallbox
         int getButtonPin() const { return m_buttonPin; }
         int getCpPin() const { return m_cpPin; }
 
+        // CP ADC sampling (empty device and replay file: read the CP pin digitally)
+        std::string getCpAdcDevice() const { return m_cpAdcDevice; }
+        std::string getCpAdcChannel() const { return m_cpAdcChannel; }
+        int getCpAdcSampleRate() const { return m_cpAdcSampleRate; }
+        int getCpAdcOffsetMv() const { return m_cpAdcOffsetMv; }
+        int getCpAdcGainX1000() const { return m_cpAdcGainX1000; }
+        std::string getCpAdcReplayFile() const { return m_cpAdcReplayFile; }
+
+        // CP state filter (N-of-M voting, hysteresis, minimum dwell)
+        int getCpFilterVotes() const { return m_cpFilterVotes; }
+        int getCpFilterWindow() const { return m_cpFilterWindow; }
+        int getCpFilterHysteresisMv() const { return m_cpFilterHysteresisMv; }
+        int getCpFilterMinDwellMs() const { return m_cpFilterMinDwellMs; }
+
         // Setters for runtime configuration
         void setRelayPin(int pin) { m_relayPin = pin; }
         void setLedGreenPin(int pin) { m_ledGreenPin = pin; }
@@ -94,6 +117,8 @@ namespace Wallbox
         // Logging
         std::string getLogFile() const { return m_logFile; }
         std::string getLogLevel() const { return m_logLevel; }
+        std::string getEventJournalFile() const { return m_eventJournalFile; } ///< Empty: no journal
+        int getEventJournalSizeKb() const { return m_eventJournalSizeKb; }
 
         // Legacy GPIO Pins struct for backward compatibility
         // Updated for BananaPi M5 sysfs GPIO numbers
@@ -163,18 +188,37 @@ namespace Wallbox
               m_udpListenPort(50010),
               m_udpSendPort(50011),
               m_udpSendAddress("127.0.0.1"),
+              m_udpConnectedSocket(false),
+              m_statusHeartbeatMs(1000),
               m_apiPort(8080),
+              m_httpWorkerThreads(4),
+              m_httpMaxConnections(64),
+              m_httpMaxHeaderBytes(8192),
+              m_httpMaxBodyBytes(65536),
+              m_gpioBackend("bananapi"),
+              m_gpioChip("/dev/gpiochip0"),
+              m_gpioLineBase(0),
+              m_gpioMemDevice("/dev/gpiomem"),
               m_relayPin(21), // v4.0 default: GPIO 21
               m_ledGreenPin(17),
               m_ledYellowPin(27),
               m_ledRedPin(22),
               m_buttonPin(23),
               m_cpPin(7), // CP signal pin (ADC capable)
+              m_cpAdcChannel("voltage0"),
+              m_cpAdcSampleRate(20000),
+              m_cpAdcOffsetMv(1650),
+              m_cpAdcGainX1000(7273),
+              m_cpFilterVotes(3),
+              m_cpFilterWindow(5),
+              m_cpFilterHysteresisMv(500),
+              m_cpFilterMinDwellMs(50),
               m_maxCurrentAmps(16),
               m_voltage(230),
               m_timeoutSeconds(300),
               m_logFile("/tmp/wallbox_v4.log"),
-              m_logLevel("info")
+              m_logLevel("info"),
+              m_eventJournalSizeKb(256)
         {
         }
 
@@ -192,9 +236,27 @@ namespace Wallbox
             m_udpListenPort = extractJsonInt(content, "udp_listen_port", m_udpListenPort);
             m_udpSendPort = extractJsonInt(content, "udp_send_port", m_udpSendPort);
             m_apiPort = extractJsonInt(content, "api_port", m_apiPort);
+            m_httpWorkerThreads = extractJsonInt(content, "http_worker_threads", m_httpWorkerThreads);
+            m_httpMaxConnections = extractJsonInt(content, "http_max_connections", m_httpMaxConnections);
+            m_httpMaxHeaderBytes = extractJsonInt(content, "http_max_header_bytes", m_httpMaxHeaderBytes);
+            m_httpMaxBodyBytes = extractJsonInt(content, "http_max_body_bytes", m_httpMaxBodyBytes);
             std::string addr = extractJsonValue(content, "udp_send_address");
             if (!addr.empty())
                 m_udpSendAddress = addr;
+            m_udpConnectedSocket = extractJsonBool(content, "udp_connected_socket", m_udpConnectedSocket);
+            m_statusHeartbeatMs = extractJsonInt(content, "status_heartbeat_ms", m_statusHeartbeatMs);
+
+            // Parse GPIO backend (production mode only; development always uses the stub)
+            std::string backend = extractJsonValue(content, "gpio_backend");
+            if (!backend.empty())
+                m_gpioBackend = backend;
+            std::string chip = extractJsonValue(content, "gpio_chip");
+            if (!chip.empty())
+                m_gpioChip = chip;
+            m_gpioLineBase = extractJsonInt(content, "gpio_line_base", m_gpioLineBase);
+            std::string memDevice = extractJsonValue(content, "gpio_mem_device");
+            if (!memDevice.empty())
+                m_gpioMemDevice = memDevice;
 
             // Parse GPIO pins
             m_relayPin = extractJsonInt(content, "relay_enable", m_relayPin);
@@ -204,6 +266,26 @@ namespace Wallbox
             m_buttonPin = extractJsonInt(content, "button", m_buttonPin);
             m_cpPin = extractJsonInt(content, "cp_pin", m_cpPin);
 
+            // Parse CP ADC settings
+            std::string adcDevice = extractJsonValue(content, "cp_adc_device");
+            if (!adcDevice.empty())
+                m_cpAdcDevice = adcDevice;
+            std::string adcChannel = extractJsonValue(content, "cp_adc_channel");
+            if (!adcChannel.empty())
+                m_cpAdcChannel = adcChannel;
+            m_cpAdcSampleRate = extractJsonInt(content, "cp_adc_sample_rate", m_cpAdcSampleRate);
+            m_cpAdcOffsetMv = extractJsonInt(content, "cp_adc_offset_mv", m_cpAdcOffsetMv);
+            m_cpAdcGainX1000 = extractJsonInt(content, "cp_adc_gain_x1000", m_cpAdcGainX1000);
+            std::string replayFile = extractJsonValue(content, "cp_adc_replay_file");
+            if (!replayFile.empty())
+                m_cpAdcReplayFile = replayFile;
+
+            // Parse CP state filter settings
+            m_cpFilterVotes = extractJsonInt(content, "cp_filter_votes", m_cpFilterVotes);
+            m_cpFilterWindow = extractJsonInt(content, "cp_filter_window", m_cpFilterWindow);
+            m_cpFilterHysteresisMv = extractJsonInt(content, "cp_filter_hysteresis_mv", m_cpFilterHysteresisMv);
+            m_cpFilterMinDwellMs = extractJsonInt(content, "cp_filter_min_dwell_ms", m_cpFilterMinDwellMs);
+
             // Parse charging parameters
             m_maxCurrentAmps = extractJsonInt(content, "max_current_amps", m_maxCurrentAmps);
             m_voltage = extractJsonInt(content, "voltage", m_voltage);
@@ -216,6 +298,10 @@ namespace Wallbox
             std::string logLevel = extractJsonValue(content, "level");
             if (!logLevel.empty())
                 m_logLevel = logLevel;
+            std::string eventFile = extractJsonValue(content, "event_file");
+            if (!eventFile.empty())
+                m_eventJournalFile = eventFile;
+            m_eventJournalSizeKb = extractJsonInt(content, "event_file_kb", m_eventJournalSizeKb);
         }
 
         std::string extractJsonValue(const std::string &json, const std::string &key)
@@ -240,6 +326,28 @@ namespace Wallbox
             return json.substr(pos + 1, end - pos - 1);
         }
 
+        bool extractJsonBool(const std::string &json, const std::string &key, bool defaultValue)
+        {
+            std::string searchKey = "\"" + key + "\"";
+            size_t pos = json.find(searchKey);
+            if (pos == std::string::npos)
+                return defaultValue;
+
+            pos = json.find(":", pos);
+            if (pos == std::string::npos)
+                return defaultValue;
+
+            pos = json.find_first_not_of(" \t\n", pos + 1);
+            if (pos == std::string::npos)
+                return defaultValue;
+
+            if (json.compare(pos, 4, "true") == 0)
+                return true;
+            if (json.compare(pos, 5, "false") == 0)
+                return false;
+            return defaultValue;
+        }
+
         int extractJsonInt(const std::string &json, const std::string &key, int defaultValue)
         {
             std::string searchKey = "\"" + key + "\"";
@@ -280,7 +388,19 @@ namespace Wallbox
         int m_udpListenPort;
         int m_udpSendPort;
         std::string m_udpSendAddress;
+        bool m_udpConnectedSocket;
+        int m_statusHeartbeatMs;
         int m_apiPort;
+        int m_httpWorkerThreads;
+        int m_httpMaxConnections;
+        int m_httpMaxHeaderBytes;
+        int m_httpMaxBodyBytes;
+
+        // GPIO backend
+        std::string m_gpioBackend;
+        std::string m_gpioChip;
+        int m_gpioLineBase;
+        std::string m_gpioMemDevice;
 
         // GPIO Pins
         int m_relayPin;
@@ -290,6 +410,20 @@ namespace Wallbox
         int m_buttonPin;
         int m_cpPin;
 
+        // CP ADC
+        std::string m_cpAdcDevice;
+        std::string m_cpAdcChannel;
+        int m_cpAdcSampleRate;
+        int m_cpAdcOffsetMv;
+        int m_cpAdcGainX1000;
+        std::string m_cpAdcReplayFile;
+
+        // CP state filter
+        int m_cpFilterVotes;
+        int m_cpFilterWindow;
+        int m_cpFilterHysteresisMv;
+        int m_cpFilterMinDwellMs;
+
         // Charging parameters
         int m_maxCurrentAmps;
         int m_voltage;
@@ -298,6 +432,8 @@ namespace Wallbox
         // Logging
         std::string m_logFile;
         std::string m_logLevel;
+        std::string m_eventJournalFile;
+        int m_eventJournalSizeKb;
     };
 
 } // namespace Wallbox
@@ -0,0 +1,107 @@
+#ifndef CP_STATE_FILTER_H
+#define CP_STATE_FILTER_H
+
+#include "ICpSignalReader.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace Wallbox
+{
+
+    /**
+     * @brief Tuning of the CP state filter
+     */
+    struct CpFilterConfig
+    {
+        unsigned votes;         ///< N: samples of the window that must agree on a new state
+        unsigned window;        ///< M: samples considered, at most CpStateFilter::MAX_WINDOW
+        int32_t hysteresisMv;   ///< How far a voltage must leave the current state's band
+        uint32_t minDwellMs;    ///< Minimum time a state is held before the next change
+
+        CpFilterConfig()
+            : votes(3), window(5), hysteresisMv(500), minDwellMs(50)
+        {
+        }
+
+        CpFilterConfig(unsigned votes, unsigned window, int32_t hysteresisMv, uint32_t minDwellMs)
+            : votes(votes), window(window), hysteresisMv(hysteresisMv), minDwellMs(minDwellMs)
+        {
+        }
+    };
+
+    /**
+     * @brief Debounces CP samples before they become state changes
+     *
+     * Three stages, applied per sample:
+     * - Hysteresis: a voltage within hysteresisMv of the current state's
+     *   band still counts as the current state.
+     * - N-of-M voting: a new state needs `votes` of the last `window`
+     *   samples.
+     * - Dwell: a state is held at least minDwellMs before the next change.
+     *   STATE_F is exempt, so errors are never delayed beyond the vote.
+     *
+     * Timestamps are CLOCK_MONOTONIC nanoseconds of the samples; a change
+     * is dated to the first sample that voted for it. Not thread-safe.
+     */
+    class CpStateFilter
+    {
+    public:
+        static constexpr unsigned MAX_WINDOW = 16;
+
+        /**
+         * @param config Tuning; votes and window are clamped to 1..MAX_WINDOW
+         */
+        explicit CpStateFilter(const CpFilterConfig &config = CpFilterConfig());
+
+        /**
+         * @brief Start over from a known state (all window samples agree)
+         */
+        void reset(CpState state, uint64_t timestampNs);
+
+        /**
+         * @brief Add a CP plateau voltage
+         * @return true if the filtered state changed
+         */
+        bool addVoltage(int32_t millivolts, uint64_t timestampNs);
+
+        /**
+         * @brief Add an already classified sample (no hysteresis applies)
+         * @return true if the filtered state changed
+         */
+        bool addState(CpState state, uint64_t timestampNs);
+
+        CpState state() const { return m_state; }
+
+        /**
+         * @brief Time of the first sample that voted for the current state
+         */
+        uint64_t changeTimestampNs() const { return m_changeNs; }
+
+        /**
+         * @brief true if every sample in the window agrees with state()
+         *
+         * While false, another sample may still change the state.
+         */
+        bool settled() const;
+
+        const CpFilterStats &stats() const { return m_stats; }
+        const CpFilterConfig &config() const { return m_config; }
+
+    private:
+        CpFilterConfig m_config;
+        CpState m_state;
+        uint64_t m_changeNs;
+        CpState m_window[MAX_WINDOW];
+        uint64_t m_windowNs[MAX_WINDOW];
+        unsigned m_next;
+        unsigned m_filled;
+        CpState m_lastRaw; ///< Last unfiltered state, for counting suppressed transitions
+        CpFilterStats m_stats;
+
+        CpState withHysteresis(int32_t millivolts, CpState raw) const;
+        bool vote(CpState state, CpState raw, uint64_t timestampNs);
+    };
+
+} // namespace Wallbox
+
+#endif // CP_STATE_FILTER_H
@@ -0,0 +1,68 @@
+#ifndef CP_WAVEFORM_ANALYZER_H
+#define CP_WAVEFORM_ANALYZER_H
+
+#include "ICpSignalReader.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace Wallbox
+{
+
+    /**
+     * @brief Plateau voltages and PWM duty cycle of one block of CP samples
+     */
+    struct CpMeasurement
+    {
+        int32_t highMv;        ///< Mean of the samples above the mid threshold
+        int32_t lowMv;         ///< Mean of the samples at or below it
+        uint16_t dutyPermille; ///< Share of high samples, 0-1000
+        bool oscillating;      ///< PWM present (high and low plateau differ)
+        uint32_t samples;
+    };
+
+    /**
+     * @brief Evaluates sampled Control Pilot waveforms (IEC 61851-1)
+     *
+     * The analysis runs two flat passes over the block: min/max, then a
+     * branch-free threshold count and plateau sums. Both loops are written
+     * so the compiler vectorizes them (-O3); a 1 kHz PWM block of a few
+     * hundred samples is analyzed in well under a microsecond.
+     */
+    class CpWaveformAnalyzer
+    {
+    public:
+        /**
+         * @brief Minimum high/low difference (mV) for a block to count as PWM
+         */
+        static constexpr int32_t MIN_PWM_SWING_MV = 2000;
+
+        /**
+         * @brief Measure plateaus and duty cycle
+         * @param millivolts CP voltage samples
+         * @param count Number of samples (0 yields an all-zero measurement)
+         */
+        static CpMeasurement analyze(const int32_t *millivolts, size_t count);
+
+        /**
+         * @brief CP state from the high plateau
+         *
+         * With PWM active the low plateau must be near -12 V (vehicle diode
+         * present); otherwise the block is reported as STATE_F.
+         */
+        static CpState classify(const CpMeasurement &measurement);
+
+        /**
+         * @brief CP state for a plateau voltage (IEC 61851-1 thresholds)
+         */
+        static CpState stateForVoltage(int32_t millivolts);
+
+        /**
+         * @brief Charging current the duty cycle offers (IEC 61851-1 Annex A)
+         * @return Current in mA, 0 if the duty cycle does not encode a current
+         */
+        static uint32_t maxCurrentMilliamps(uint16_t dutyPermille);
+    };
+
+} // namespace Wallbox
+
+#endif // CP_WAVEFORM_ANALYZER_H
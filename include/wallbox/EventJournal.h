@@ -0,0 +1,120 @@
+#ifndef EVENT_JOURNAL_H
+#define EVENT_JOURNAL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Wallbox
+{
+
+    enum class JournalEvent : uint8_t
+    {
+        STATE_TRANSITION = 1, ///< arg0 old, arg1 new ChargingState; data = reason
+        RELAY = 2,            ///< arg0 relay on, arg1 level changed
+        CP_CHANGE = 3,        ///< arg0 old, arg1 new CpState
+        UDP_RX = 4,           ///< arg0 datagram size; data = its first bytes
+        UDP_TX = 5            ///< arg0 datagram size; data = its first bytes
+    };
+
+    /**
+     * @brief One journal entry, 64 bytes in host byte order
+     */
+    struct JournalRecord
+    {
+        static constexpr size_t DATA_CAPACITY = 32;
+
+        uint64_t sequence;    ///< 1-based write number, 0 while the slot is being written
+        uint64_t timestampNs; ///< Wall clock (CLOCK_REALTIME)
+        JournalEvent type;
+        uint8_t reserved;
+        uint16_t length; ///< Bytes used in data
+        uint32_t arg0;
+        uint32_t arg1;
+        uint32_t thread; ///< Kernel thread id of the writer
+        uint8_t data[DATA_CAPACITY];
+    };
+
+    /**
+     * @brief File header, followed by capacity records
+     */
+    struct JournalHeader
+    {
+        static constexpr uint32_t VERSION = 1;
+
+        char magic[8]; ///< "WBJRNL\0\0"
+        uint32_t version;
+        uint32_t recordSize;
+        uint64_t capacity; ///< Records in the ring
+        uint64_t next;     ///< Sequences handed out so far
+        uint8_t reserved[32];
+    };
+
+    /**
+     * @brief Binary circular event journal in a memory-mapped file
+     *
+     * Writers claim a slot with one atomic increment and fill it in the
+     * shared mapping: no system call, no formatting, no lock. The page cache
+     * writes it back, so the file holds the last capacity events even after
+     * a crash and costs flash one page write per dirty page instead of one
+     * write per text line. Reopening a file with the same geometry
+     * continues its sequence; anything else reinitialises it.
+     *
+     * record() is a no-op while the journal is closed. Decode with
+     * wallbox_journal (or readFile()).
+     */
+    class EventJournal
+    {
+    public:
+        static constexpr size_t MIN_CAPACITY = 16;
+
+        static EventJournal &instance();
+
+        /**
+         * @brief Map path as a journal of at most maxBytes (header included)
+         */
+        bool open(const std::string &path, size_t maxBytes);
+
+        /**
+         * @brief Stop recording, sync and unmap (waits for writers in progress)
+         */
+        void close();
+
+        bool isOpen() const { return m_records.load(std::memory_order_acquire) != nullptr; }
+        size_t capacity() const { return m_capacity; }
+
+        /**
+         * @brief Append an event; data beyond DATA_CAPACITY bytes is cut
+         */
+        void record(JournalEvent type, uint32_t arg0, uint32_t arg1 = 0,
+                    const void *data = nullptr, size_t size = 0);
+
+        /**
+         * @brief Read a journal file, oldest record first
+         * @return false (with error set) if the file is not a journal
+         */
+        static bool readFile(const std::string &path, std::vector<JournalRecord> &records, std::string &error);
+
+        static const char *eventName(JournalEvent type);
+
+    private:
+        EventJournal();
+        ~EventJournal() = delete;
+        EventJournal(const EventJournal &) = delete;
+        EventJournal &operator=(const EventJournal &) = delete;
+
+        std::mutex m_mutex; ///< Serialises open()/close()
+        std::atomic<JournalRecord *> m_records;
+        std::atomic<int> m_writers; ///< record() calls in progress
+        JournalHeader *m_header;
+        void *m_mapping;
+        size_t m_mappingSize;
+        size_t m_capacity;
+    };
+
+} // namespace Wallbox
+
+#endif // EVENT_JOURNAL_H
@@ -0,0 +1,143 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include "MpscQueue.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Wallbox
+{
+
+    /**
+     * @brief Single-threaded epoll loop for fds, timers and posted tasks
+     *
+     * Everything the loop reacts to is a file descriptor: sockets and
+     * other fds registered with addFd(), timerfds created by addTimer(),
+     * and an eventfd that wakes the loop for post() and stop(). run()
+     * sleeps in epoll_wait() until one of them is ready, so an idle loop
+     * does not wake up at all.
+     *
+     * Posted tasks go through a lock-free MPSC queue; the eventfd is only
+     * written when the loop is not already due to drain it, so a burst of
+     * posts costs one wakeup.
+     *
+     * addFd(), removeFd() and addTimer() must be called before run() or
+     * from the loop thread; post(), armTimer() and stop() may be called
+     * from any thread, stop() also from a signal handler.
+     */
+    class EventLoop
+    {
+    public:
+        using FdHandler = std::function<void(uint32_t events)>;
+        using Task = std::function<void()>;
+
+        EventLoop();
+        ~EventLoop();
+
+        EventLoop(const EventLoop &) = delete;
+        EventLoop &operator=(const EventLoop &) = delete;
+
+        /**
+         * @brief Create the epoll instance and the wakeup eventfd
+         * @return false if either could not be created
+         */
+        bool open();
+
+        /**
+         * @brief Close the loop's own fds and forget all handlers
+         */
+        void close();
+
+        bool isOpen() const { return m_epollFd >= 0; }
+
+        /**
+         * @brief Call handler on the loop thread whenever fd is ready
+         * @param fd Descriptor to watch; not closed by the loop
+         * @param events epoll events (EPOLLIN, ...)
+         */
+        bool addFd(int fd, uint32_t events, FdHandler handler);
+        void removeFd(int fd);
+
+        /**
+         * @brief Create a disarmed timer
+         * @return Timer id for armTimer(), -1 on error
+         */
+        int addTimer(Task handler);
+
+        /**
+         * @brief (Re)start a timer
+         * @param timer Id from addTimer()
+         * @param intervalMs Period in ms; 0 disarms the timer
+         * @param periodic Repeat every intervalMs, else fire once
+         */
+        bool armTimer(int timer, uint32_t intervalMs, bool periodic = true);
+
+        /**
+         * @brief Run a task on the loop thread (in posting order)
+         */
+        void post(Task task);
+
+        /**
+         * @brief Run queued tasks on the calling thread if run() is not active
+         *
+         * Lets callers waiting for a posted task make progress while the
+         * loop is stopped (before run(), after stop()). Tasks still run one
+         * consumer at a time and in order.
+         * @return false if another thread is consuming tasks
+         */
+        bool runPending();
+
+        /**
+         * @brief Dispatch events until stop() is called
+         */
+        void run();
+
+        /**
+         * @brief Make run() return after the current dispatch
+         */
+        void stop();
+
+        bool isRunning() const { return m_running.load(); }
+
+        /**
+         * @brief true when called from the thread executing run() or runPending()
+         */
+        bool inLoopThread() const { return m_loopThread.load() == std::this_thread::get_id(); }
+
+        /**
+         * @brief Loop iterations, i.e. returns from epoll_wait()
+         */
+        uint64_t wakeups() const { return m_wakeups.load(std::memory_order_relaxed); }
+
+    private:
+        struct Watch
+        {
+            int fd;
+            std::shared_ptr<FdHandler> handler;
+        };
+
+        int m_epollFd;
+        int m_wakeFd;
+        std::vector<Watch> m_watches;
+        std::vector<int> m_timers;
+        MpscQueue<Task> m_tasks;
+        std::atomic<bool> m_wakePending; ///< eventfd already signalled for queued tasks
+        std::mutex m_consumerMutex;      ///< Held by the thread consuming m_tasks
+        std::atomic<bool> m_running;
+        std::atomic<bool> m_stopRequested;
+        std::atomic<std::thread::id> m_loopThread;
+        std::atomic<uint64_t> m_wakeups;
+
+        void wake();
+        void runTasks();
+        void dispatch(int fd, uint32_t events);
+    };
+
+} // namespace Wallbox
+
+#endif // EVENT_LOOP_H
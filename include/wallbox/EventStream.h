@@ -0,0 +1,78 @@
+#ifndef EVENT_STREAM_H
+#define EVENT_STREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Wallbox
+{
+
+    /**
+     * @brief One serialized SSE event, shared by all subscribers
+     */
+    struct EventFrame
+    {
+        uint64_t id;
+        std::string text;
+    };
+
+    /**
+     * @brief Server-Sent Events channel with replay buffer
+     *
+     * publish() may be called from any thread. Each event is formatted once
+     * into an immutable frame ("id:/event:/data:") that every subscriber
+     * connection shares, so the cost of an event does not grow with the
+     * number of open dashboards. The last replayCapacity frames are kept
+     * so a reconnecting client can resume from its Last-Event-ID.
+     *
+     * Delivery is done by HttpApiServer: the notifier installed by
+     * HttpApiServer::registerEventStream() wakes its event loop, which
+     * collects new frames with takePending() and fans them out.
+     */
+    class EventStream
+    {
+    public:
+        using Frame = std::shared_ptr<const EventFrame>;
+
+        explicit EventStream(size_t replayCapacity = 64);
+
+        /**
+         * @brief Publish an event to all subscribers
+         * @param event SSE event name (e.g. "state")
+         * @param data Payload, normally one line of JSON
+         * @return Id assigned to the event
+         */
+        uint64_t publish(const std::string &event, const std::string &data);
+
+        /**
+         * @brief Frames newer than lastEventId still held in the replay buffer
+         */
+        void replaySince(uint64_t lastEventId, std::vector<Frame> &frames) const;
+
+        /**
+         * @brief Move frames published since the last call into frames
+         */
+        void takePending(std::vector<Frame> &frames);
+
+        void setNotifier(std::function<void()> notifier);
+
+        uint64_t getLastEventId() const;
+
+    private:
+        size_t m_replayCapacity;
+        uint64_t m_nextId;
+        std::deque<Frame> m_replay;
+        std::vector<Frame> m_pending;
+        std::function<void()> m_notifier;
+        mutable std::mutex m_mutex;
+    };
+
+} // namespace Wallbox
+
+#endif // EVENT_STREAM_H
@@ -0,0 +1,84 @@
+#ifndef GPIO_EDGE_WATCHER_H
+#define GPIO_EDGE_WATCHER_H
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Wallbox
+{
+
+    /**
+     * @brief Thread that sleeps in poll() on GPIO event fds
+     *
+     * Shared by the GPIO backends that support IGpioController::watchPin():
+     * each backend registers the fds that signal edges (sysfs value files
+     * with POLLPRI, character device line requests with POLLIN) together
+     * with a handler that reads the event. The thread only wakes for
+     * edges or for reconfiguration (signalled through an eventfd).
+     *
+     * watch()/unwatch() restart the thread, so they must not be called
+     * from a handler.
+     */
+    class GpioEdgeWatcher
+    {
+    public:
+        using ReadyHandler = std::function<void()>;
+
+        GpioEdgeWatcher();
+        ~GpioEdgeWatcher();
+
+        GpioEdgeWatcher(const GpioEdgeWatcher &) = delete;
+        GpioEdgeWatcher &operator=(const GpioEdgeWatcher &) = delete;
+
+        /**
+         * @brief Watch an fd, replacing any entry registered under the same key
+         * @param key Caller-chosen id (e.g. the pin number)
+         * @param fd File descriptor to poll; not closed by the watcher
+         * @param events poll() events that signal an edge
+         * @param handler Called on the watcher thread when the fd is ready
+         * @return false if the watcher thread could not be started
+         */
+        bool watch(int key, int fd, short events, ReadyHandler handler);
+
+        /**
+         * @brief Stop watching the fd registered under key
+         */
+        void unwatch(int key);
+
+        /**
+         * @brief Stop watching all fds and stop the thread
+         */
+        void clear();
+
+        bool isWatching(int key) const;
+
+        /**
+         * @brief CLOCK_MONOTONIC in nanoseconds, the time base of PinEvent
+         */
+        static uint64_t monotonicNowNs();
+
+    private:
+        struct Entry
+        {
+            int key;
+            int fd;
+            short events;
+            ReadyHandler handler;
+        };
+
+        std::vector<Entry> m_entries;
+        mutable std::mutex m_mutex; ///< Serializes reconfiguration; not held by the thread
+        std::thread m_thread;
+        int m_wakeFd;
+
+        bool startThread();
+        void stopThread();
+        void run(std::vector<Entry> entries);
+    };
+
+} // namespace Wallbox
+
+#endif // GPIO_EDGE_WATCHER_H
@@ -4,6 +4,8 @@
 #include "IGpioController.h"
 #include "StubGpioController.h"
 #include "BananaPiGpioController.h"
+#include "CdevGpioController.h"
+#include "MmioGpioController.h"
 #include <memory>
 #include <string>
 #include <iostream>
@@ -28,10 +30,26 @@ namespace Wallbox
     public:
         /**
          * @brief Create GPIO controller based on type
-         * @param type Controller type ("stub", "bananapi", "real")
+         * @param type Controller type ("stub", "bananapi", "real", "cdev", "mmio")
          * @return Unique pointer to GPIO controller
          */
         static std::unique_ptr<IGpioController> create(const std::string &type)
+        {
+            return create(type, CdevGpioController::DEFAULT_CHIP, 0);
+        }
+
+        /**
+         * @brief Create GPIO controller based on type
+         * @param type Controller type ("stub", "bananapi", "real", "cdev", "mmio")
+         * @param chipPath GPIO chip device used by "cdev"
+         * @param lineBase Global pin number of the chip's line 0 (used by "cdev" and "mmio")
+         * @param memDevice Register device used by "mmio" (/dev/gpiomem or /dev/mem)
+         * @return Unique pointer to GPIO controller
+         */
+        static std::unique_ptr<IGpioController> create(const std::string &type,
+                                                       const std::string &chipPath,
+                                                       int lineBase,
+                                                       const std::string &memDevice = MmioGpioController::DEFAULT_DEVICE)
         {
             if (type == "stub")
             {
@@ -43,6 +61,16 @@ namespace Wallbox
                 std::cout << "[GPIO Factory] Creating Banana Pi GPIO controller (production mode)" << std::endl;
                 return std::make_unique<BananaPiGpioController>();
             }
+            else if (type == "cdev")
+            {
+                std::cout << "[GPIO Factory] Creating character device GPIO controller (production mode)" << std::endl;
+                return std::make_unique<CdevGpioController>(chipPath, lineBase);
+            }
+            else if (type == "mmio")
+            {
+                std::cout << "[GPIO Factory] Creating memory-mapped GPIO controller (production mode)" << std::endl;
+                return std::make_unique<MmioGpioController>(GpioRegisterLayout::amlogicG12(lineBase), memDevice);
+            }
 
             std::cerr << "[GPIO Factory] Unknown GPIO type: " << type << ", defaulting to stub" << std::endl;
             return std::make_unique<StubGpioController>();
@@ -0,0 +1,34 @@
+#ifndef GPIO_METRICS_H
+#define GPIO_METRICS_H
+
+#include "Metrics.h"
+
+namespace Wallbox
+{
+
+    /**
+     * @brief Pin read/write counters of one GPIO backend
+     *
+     * Shared by all controllers of the same backend; each backend keeps one
+     * in a function-local static so the registry is only searched once.
+     */
+    struct GpioMetrics
+    {
+        Counter &writes; ///< Pin levels written (a batched write counts every pin)
+        Counter &reads;
+        Counter &errors;
+
+        explicit GpioMetrics(const char *backend)
+            : writes(MetricsRegistry::instance().counter("wallbox_gpio_writes_total", "GPIO pin writes",
+                                                         {{"backend", backend}})),
+              reads(MetricsRegistry::instance().counter("wallbox_gpio_reads_total", "GPIO pin reads",
+                                                        {{"backend", backend}})),
+              errors(MetricsRegistry::instance().counter("wallbox_gpio_errors_total", "Failed GPIO reads and writes",
+                                                         {{"backend", backend}}))
+        {
+        }
+    };
+
+} // namespace Wallbox
+
+#endif // GPIO_METRICS_H
@@ -3,9 +3,16 @@
 
 #include "ICpSignalReader.h"
 #include "IGpioController.h"
+#include "ICpSampleSource.h"
+#include "CpWaveformAnalyzer.h"
+#include "CpStateFilter.h"
 #include <memory>
 #include <thread>
 #include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <utility>
 #include <vector>
 
 namespace Wallbox
@@ -17,6 +24,19 @@ namespace Wallbox
      * Reads Control Pilot signal from physical pins using voltage divider
      * and ADC (Analog-to-Digital Converter) or digital threshold detection.
      *
+     * Monitoring is edge-driven when the GPIO backend supports watchPin():
+     * a CP change is evaluated as soon as the kernel reports the edge and
+     * the pin is only resampled until the change is confirmed. Otherwise
+     * a thread samples every 100 ms.
+     *
+     * With an ADC sample source the reader measures the real waveform
+     * instead: a thread waits for 10 ms blocks (ten PWM periods) and
+     * measures plateau voltage and duty cycle. This is the only mode that
+     * sees states B, D, E and F.
+     *
+     * In every mode samples pass a CpStateFilter (hysteresis, N-of-M
+     * voting, minimum dwell) before a change reaches the callbacks.
+     *
      * Design Patterns:
      * - Strategy Pattern: Concrete strategy for hardware reading
      * - Dependency Injection: Receives GPIO controller
@@ -33,8 +53,18 @@ namespace Wallbox
          * @brief Constructor with GPIO controller
          * @param gpio GPIO controller for pin access
          * @param cpPin Pin number for CP signal reading
+         * @param filter Debounce settings between sampling and callbacks
+         */
+        HardwareCpSignalReader(std::shared_ptr<IGpioController> gpio, int cpPin,
+                               const CpFilterConfig &filter = CpFilterConfig());
+
+        /**
+         * @brief Constructor with ADC sampling
+         * @param adc CP sample source (IIO device or replay)
+         * @param filter Debounce settings between sampling and callbacks
          */
-        HardwareCpSignalReader(std::shared_ptr<IGpioController> gpio, int cpPin);
+        explicit HardwareCpSignalReader(std::unique_ptr<ICpSampleSource> adc,
+                                        const CpFilterConfig &filter = CpFilterConfig());
         ~HardwareCpSignalReader() override;
 
         bool initialize() override;
@@ -46,21 +76,95 @@ namespace Wallbox
         void stopMonitoring() override;
         bool isInitialized() const override { return m_initialized; }
         bool isMonitoring() const override { return m_monitoring.load(); }
+        CpFilterStats getFilterStats() const override;
+
+        /**
+         * @brief CLOCK_MONOTONIC time (ns) of the last CP state change
+         *
+         * The time of the first sample that voted for the new state: the
+         * kernel's edge timestamp with edge-driven monitoring, the sample
+         * clock of the ADC. 0 before the first change.
+         */
+        uint64_t lastChangeTimestampNs() const override { return m_lastChangeNs.load(); }
+
+        /**
+         * @brief Plateau voltages and duty cycle of the latest ADC block
+         *
+         * All zero without an ADC sample source.
+         */
+        CpMeasurement lastMeasurement() const;
 
     private:
         std::shared_ptr<IGpioController> m_gpio;
         int m_cpPin;
         bool m_initialized;
         std::atomic<bool> m_monitoring;
+        bool m_edgeDriven; ///< Monitor thread sleeps until an edge instead of polling
         std::thread m_monitorThread;
-        CpState m_currentState;
+        mutable std::mutex m_stateMutex; ///< Guards the filter; serializes edges and sampling
+        CpStateFilter m_filter;
+        std::mutex m_wakeupMutex;
+        std::condition_variable m_wakeup;
+        bool m_edgeSeen;
+        std::atomic<uint64_t> m_lastChangeNs;
         std::vector<CpStateChangeCallback> m_callbacks;
+        std::vector<std::pair<CpState, CpState>> m_pendingChanges; ///< Filter decisions not yet notified; m_stateMutex
+        std::mutex m_notifyMutex;                                  ///< Serializes callbacks in the order of the changes
+        std::vector<std::pair<CpState, CpState>> m_notifying;      ///< Being notified; m_notifyMutex
+        std::unique_ptr<ICpSampleSource> m_adc;
+        mutable std::mutex m_measurementMutex;
+        CpMeasurement m_lastMeasurement;
+        uint64_t m_sampleClockNs; ///< Time of the next ADC sample, advanced by the sample count
 
         /**
          * @brief Monitor loop running in separate thread
          */
         void monitorLoop();
 
+        /**
+         * @brief ADC sampling loop running in separate thread
+         */
+        void adcLoop();
+
+        /**
+         * @brief Measure one ADC block and pass it to the filter
+         */
+        void processBlock(const int32_t *millivolts, size_t count);
+
+        /**
+         * @brief Samples per ADC block (10 ms)
+         */
+        size_t adcBlockSize() const;
+
+        /**
+         * @brief Filter a CP voltage sample, notifying listeners if the state changed
+         * @param millivolts Sampled voltage
+         * @param timestampNs CLOCK_MONOTONIC time of the sample
+         */
+        void addVoltageSample(int32_t millivolts, uint64_t timestampNs);
+
+        /**
+         * @brief Filter a classified sample, notifying listeners if the state changed
+         */
+        void addStateSample(CpState state, uint64_t timestampNs);
+
+        /**
+         * @brief Queue a filter decision for notification; called with m_stateMutex held
+         */
+        void recordChange(CpState oldState);
+
+        /**
+         * @brief Notify listeners of queued changes, without holding m_stateMutex
+         *
+         * Callbacks may query the reader (readCpState(), getFilterStats()).
+         */
+        void publishChanges();
+
+        /**
+         * @brief Wake the monitor thread (edge seen or monitoring stopped)
+         */
+        void wakeMonitor();
+
         /**
          * @brief Convert voltage reading to CP state
          * @param voltage Voltage in mV
@@ -74,6 +178,11 @@ namespace Wallbox
          */
         int readVoltage();
 
+        /**
+         * @brief Map a digital CP level to the voltage it stands for
+         */
+        static int levelToVoltage(PinValue value);
+
         /**
          * @brief Notify all callbacks of state change
          * @param oldState Previous state
@@ -1,28 +1,24 @@
 #ifndef HTTP_API_SERVER_H
 #define HTTP_API_SERVER_H
 
+#include "EventStream.h"
+#include "HttpRouter.h"
+#include "JsonWriter.h"
+#include "VersionedResource.h"
+#include "WorkerPool.h"
 #include <string>
 #include <functional>
 #include <memory>
 #include <thread>
 #include <atomic>
-#include <map>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace Wallbox
 {
 
-    /**
-     * @brief HTTP Request structure
-     */
-    struct HttpRequest
-    {
-        std::string method; // GET, POST, PUT, DELETE
-        std::string path;   // /api/charging/start
-        std::string body;   // JSON payload
-        std::map<std::string, std::string> headers;
-        std::map<std::string, std::string> params;
-    };
-
     /**
      * @brief HTTP Response structure
      */
@@ -31,6 +27,9 @@ namespace Wallbox
         int statusCode = 200;
         std::string contentType = "application/json";
         std::string body;
+        std::string etag;                   ///< Sent as ETag header when not empty
+        EventStream *eventStream = nullptr; ///< Set to keep the connection open as an SSE stream
+        VersionedResource *resource = nullptr; ///< Set to answer from the resource's current version
 
         void setJson(const std::string &json)
         {
@@ -41,20 +40,76 @@ namespace Wallbox
         void setError(int code, const std::string &message)
         {
             statusCode = code;
-            body = "{\"error\":\"" + message + "\"}";
+            contentType = "application/json";
+            body.clear();
+            JsonWriter(body).beginObject().field("error", message).endObject();
+        }
+
+        /**
+         * @brief Answer with text/event-stream and subscribe the connection
+         */
+        void openEventStream(EventStream &stream)
+        {
+            contentType = "text/event-stream";
+            eventStream = &stream;
+        }
+
+        /**
+         * @brief Answer from a versioned resource (ETag, 304, long-poll)
+         */
+        void serveResource(VersionedResource &versioned)
+        {
+            contentType = "application/json";
+            resource = &versioned;
         }
     };
 
     /**
-     * @brief Handler function type
+     * @brief Tuning parameters for the HTTP server event loop
      */
-    using HttpHandler = std::function<void(const HttpRequest &, HttpResponse &)>;
+    struct HttpServerConfig
+    {
+        size_t workerThreads = 4;       ///< Handler threads (fixed, created at start)
+        size_t maxConnections = 64;     ///< Open connections before accept() is paused
+        size_t maxQueuedRequests = 128; ///< Requests waiting for a worker before 503
+        size_t maxHeaderBytes = 8192;   ///< Request line + headers before 431
+        size_t maxBodyBytes = 65536;    ///< Decoded request body before 413
+        int idleTimeoutMs = 5000;             ///< Close keep-alive connections idle this long
+        size_t maxRequestsPerConnection = 100; ///< Requests served before a connection is closed
+        int longPollTimeoutMs = 25000;         ///< ?since= requests answer 304 after this long
+    };
 
     /**
      * @brief Simple HTTP REST API Server for React app integration
      *
      * Provides REST endpoints for controlling the wallbox from a web/React app.
      *
+     * A single event-loop thread multiplexes the listening socket and all
+     * client connections with edge-triggered epoll. Complete requests are
+     * handed to a fixed WorkerPool; responses come back to the loop through
+     * an eventfd and are written without blocking. When maxConnections is
+     * reached the loop stops accepting and leaves new clients in the listen
+     * backlog until a connection closes.
+     *
+     * Connections are persistent (HTTP/1.1 keep-alive) until they idle out,
+     * reach maxRequestsPerConnection or the client asks to close. Pipelined
+     * requests are buffered and answered strictly in order, one worker task
+     * per connection at a time.
+     *
+     * Versioned resources are answered from an immutable snapshot: a
+     * matching If-None-Match gets 304, and ?since=<version> parks the
+     * connection on the event loop until the next version is published.
+     *
+     * Event streams (SSE) stay attached to their connection: frames
+     * published on an EventStream are queued as shared buffers on every
+     * subscribed connection and written by the event loop.
+     *
+     * Requests are parsed incrementally by HttpRequestParser directly in the
+     * connection's receive buffer; handlers get slices into that buffer, so
+     * the connection stops reading while a request is with a worker.
+     * Routes must be registered before
+     * start() because workers read the route table without locking.
+     *
      * Design Patterns:
      * - Command Pattern: Each endpoint represents a command
      * - Observer Pattern: Notifies React app of state changes
@@ -66,6 +121,7 @@ namespace Wallbox
     {
     public:
         HttpApiServer(int port = 8080);
+        HttpApiServer(int port, const HttpServerConfig &config);
         ~HttpApiServer();
 
         // Server lifecycle
@@ -73,7 +129,8 @@ namespace Wallbox
         void stop();
         bool isRunning() const { return m_running; }
 
-        // Route registration
+        // Route registration; paths may contain {param} segments and a trailing *
+        void registerRoute(HttpMethod method, const std::string &path, HttpHandler handler);
         void registerRoute(const std::string &method, const std::string &path, HttpHandler handler);
 
         // Convenience methods for common HTTP methods
@@ -82,36 +139,113 @@ namespace Wallbox
         void PUT(const std::string &path, HttpHandler handler);
         void DELETE(const std::string &path, HttpHandler handler);
 
+        /**
+         * @brief Serve an EventStream as Server-Sent Events on GET path
+         *
+         * Clients may resume with the Last-Event-ID header (or the
+         * lastEventId query parameter) and receive missed events still in
+         * the stream's replay buffer.
+         */
+        void registerEventStream(const std::string &path, std::shared_ptr<EventStream> stream);
+
+        /**
+         * @brief Serve a VersionedResource on GET path
+         *
+         * The response carries the version as ETag. If-None-Match with the
+         * current ETag answers 304; ?since=<version> equal to the current
+         * version waits up to longPollTimeoutMs for the next version and
+         * answers 304 if none arrives.
+         */
+        void registerVersionedResource(const std::string &path, std::shared_ptr<VersionedResource> resource);
+
+        const HttpServerConfig &getConfig() const { return m_config; }
+
     private:
+        struct Connection;
+
+        /**
+         * @brief Response produced by a worker, delivered back to the event loop
+         */
+        struct Completion
+        {
+            int fd;
+            uint64_t connectionId;
+            bool keepAlive;
+            std::string response;
+            EventStream *stream;  ///< Non-null: switch the connection to SSE
+            uint64_t lastEventId; ///< Replay frames after this id
+            VersionedResource *watch; ///< Non-null: long-poll, no response yet
+            uint64_t watchVersion;    ///< Answer once the resource moves past this version
+        };
+
         int m_port;
+        HttpServerConfig m_config;
         int m_serverSocket;
+        int m_epollFd;
+        int m_wakeFd;
         std::atomic<bool> m_running;
         std::thread m_serverThread;
-        std::map<std::string, std::map<std::string, HttpHandler>> m_routes;
+        HttpRouter m_router;
+        std::vector<std::shared_ptr<EventStream>> m_eventStreams;
+        std::vector<std::shared_ptr<VersionedResource>> m_resources;
+
+        // Event loop state (owned by the server thread)
+        std::unordered_map<int, std::unique_ptr<Connection>> m_connections;
+        uint64_t m_nextConnectionId;
+        bool m_acceptPaused;
+
+        // Worker -> event loop hand-off
+        WorkerPool m_workers;
+        std::mutex m_completionMutex;
+        std::vector<Completion> m_completions;
 
         void serverLoop();
-        void handleClient(int clientSocket);
-        HttpRequest parseRequest(const std::string &requestData);
-        std::string buildResponse(const HttpResponse &response);
+        void acceptConnections();
+        void readFromConnection(Connection &connection);
+        void processInput(Connection &connection);
+        void dispatchRequest(Connection &connection);
+        void processCompletions();
+        bool queueResponse(Connection &connection, std::string response);
+        void subscribeToStream(Connection &connection, EventStream &stream, uint64_t lastEventId);
+        void deliverEvents();
+        void deliverResourceChanges();
+        void answerWatch(Connection &connection, bool notModified);
+        void resumeInput(Connection &connection);
+        bool flushOutput(Connection &connection);
+        void closeConnection(int fd);
+        void closeIdleConnections();
+        void closeAllConnections();
+        void wakeEventLoop();
+        void handleRequest(HttpRequest &request, Completion &completion);
+        void resolveResource(const HttpRequest &request, HttpResponse &response, Completion &completion);
+        std::string buildResponse(const HttpResponse &response, bool keepAlive);
         void enableCORS(HttpResponse &response);
-        HttpHandler findHandler(const std::string &method, const std::string &path);
     };
 
     /**
-     * @brief Helper to build JSON responses
+     * @brief Helper to build flat JSON objects
+     *
+     * Kept for existing callers; new code should write into the response
+     * body with JsonWriter directly.
      */
     class JsonBuilder
     {
     public:
+        JsonBuilder();
+
+        JsonBuilder(const JsonBuilder &) = delete;
+        JsonBuilder &operator=(const JsonBuilder &) = delete;
+
         JsonBuilder &add(const std::string &key, const std::string &value);
+        JsonBuilder &add(const std::string &key, const char *value);
         JsonBuilder &add(const std::string &key, int value);
         JsonBuilder &add(const std::string &key, bool value);
         JsonBuilder &add(const std::string &key, double value);
         std::string build();
 
     private:
-        std::string m_json = "{";
-        bool m_first = true;
+        std::string m_json;
+        JsonWriter m_writer;
     };
 
 } // namespace Wallbox
@@ -0,0 +1,198 @@
+#ifndef HTTP_REQUEST_PARSER_H
+#define HTTP_REQUEST_PARSER_H
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace Wallbox
+{
+
+    /**
+     * @brief Non-owning view of a character range
+     *
+     * Points into the connection's input buffer; valid only while the
+     * request that owns it is being handled.
+     */
+    struct StringRef
+    {
+        const char *data = nullptr;
+        size_t size = 0;
+
+        StringRef() = default;
+        StringRef(const char *text, size_t length) : data(text), size(length) {}
+
+        bool empty() const { return size == 0; }
+        std::string str() const { return std::string(data, size); }
+
+        bool operator==(const char *text) const
+        {
+            return std::strlen(text) == size && std::memcmp(data, text, size) == 0;
+        }
+        bool operator!=(const char *text) const { return !(*this == text); }
+
+        bool equalsIgnoreCase(const char *text) const;
+    };
+
+    /**
+     * @brief Name/value pair of slices (header or query parameter)
+     */
+    struct HttpField
+    {
+        StringRef name;
+        StringRef value;
+    };
+
+    /**
+     * @brief HTTP Request structure
+     *
+     * All members are slices into the receive buffer, so handing a request
+     * to a handler allocates nothing. Header and parameter storage is a
+     * fixed array; requests with more headers are rejected with 431.
+     */
+    struct HttpRequest
+    {
+        static constexpr size_t MAX_HEADERS = 32;
+        static constexpr size_t MAX_PARAMS = 16;
+
+        StringRef method;  // GET, POST, PUT, DELETE
+        StringRef path;    // /api/charging/start
+        StringRef query;   // a=1&b=2 (without '?')
+        StringRef version; // HTTP/1.1
+        StringRef body;    // JSON payload (de-chunked)
+        HttpField headers[MAX_HEADERS];
+        size_t headerCount = 0;
+        HttpField params[MAX_PARAMS];
+        size_t paramCount = 0;
+        bool keepAlive = true;
+
+        /**
+         * @brief Case-insensitive header lookup
+         * @return Empty slice if the header is absent
+         */
+        StringRef getHeader(const char *name) const;
+
+        /**
+         * @brief Query or path parameter lookup
+         * @return Empty slice if the parameter is absent
+         */
+        StringRef getParam(const char *name) const;
+
+        /**
+         * @brief Append a parameter
+         * @return false if the parameter array is full
+         */
+        bool addParam(StringRef name, StringRef value);
+    };
+
+    /**
+     * @brief Size limits enforced while parsing
+     */
+    struct HttpParserLimits
+    {
+        size_t maxHeaderBytes = 8192; ///< Request line + headers, exceeded -> 431
+        size_t maxBodyBytes = 65536;  ///< Decoded body, exceeded -> 413
+    };
+
+    /**
+     * @brief Incremental HTTP/1.x request parser
+     *
+     * State machine that can be fed a growing buffer after every read:
+     * parse() resumes where the previous call stopped, so a request split
+     * over several TCP segments is scanned once. Bodies are framed by
+     * Content-Length or Transfer-Encoding: chunked; chunked bodies are
+     * decoded in place, so the body slice is always contiguous.
+     *
+     * The parser keeps offsets, not pointers, between calls so the caller
+     * may grow (and reallocate) the buffer while a request is incomplete.
+     * Once parse() returns Complete the buffer must stay untouched until
+     * the request has been handled, then the caller drops getConsumed()
+     * bytes from the front and calls reset() for the next request.
+     */
+    class HttpRequestParser
+    {
+    public:
+        enum class Result
+        {
+            Incomplete,
+            Complete,
+            Error
+        };
+
+        explicit HttpRequestParser(const HttpParserLimits &limits = HttpParserLimits());
+
+        /**
+         * @brief Continue parsing the buffer
+         * @param buffer Start of the request (may be modified for de-chunking)
+         * @param length Number of valid bytes in buffer
+         * @param request Filled when the result is Complete
+         */
+        Result parse(char *buffer, size_t length, HttpRequest &request);
+
+        void reset();
+
+        /**
+         * @brief Bytes of the buffer occupied by the completed request
+         *
+         * Anything after this offset belongs to the next pipelined request.
+         */
+        size_t getConsumed() const { return m_position; }
+
+        /** @brief HTTP status to answer with after Result::Error (400, 413, 431, 501) */
+        int getErrorStatus() const { return m_errorStatus; }
+        const char *getErrorMessage() const { return m_errorMessage; }
+
+    private:
+        enum class State
+        {
+            RequestLine,
+            Headers,
+            Body,
+            ChunkSize,
+            ChunkData,
+            ChunkDataEnd,
+            Trailers,
+            Complete,
+            Error
+        };
+
+        struct Span
+        {
+            size_t offset;
+            size_t length;
+        };
+
+        HttpParserLimits m_limits;
+        State m_state;
+        size_t m_position;
+        int m_errorStatus;
+        const char *m_errorMessage;
+
+        Span m_method;
+        Span m_target;
+        Span m_version;
+        Span m_headerNames[HttpRequest::MAX_HEADERS];
+        Span m_headerValues[HttpRequest::MAX_HEADERS];
+        size_t m_headerCount;
+
+        bool m_chunked;
+        bool m_hasContentLength;
+        bool m_connectionClose;
+        bool m_connectionKeepAlive;
+        size_t m_contentLength;
+        size_t m_bodyOffset;
+        size_t m_bodyLength;
+        size_t m_chunkRemaining;
+
+        bool nextLine(const char *buffer, size_t length, size_t &lineEnd, size_t &nextStart) const;
+        bool parseRequestLine(const char *buffer, size_t lineEnd);
+        bool parseHeaderLine(const char *buffer, size_t lineEnd);
+        bool finishHeaders();
+        bool parseChunkSize(const char *buffer, size_t lineEnd);
+        void fillRequest(const char *buffer, HttpRequest &request) const;
+        Result fail(int status, const char *message);
+    };
+
+} // namespace Wallbox
+
+#endif // HTTP_REQUEST_PARSER_H
@@ -0,0 +1,116 @@
+#ifndef HTTP_ROUTER_H
+#define HTTP_ROUTER_H
+
+#include "HttpRequestParser.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Wallbox
+{
+
+    struct HttpResponse;
+
+    /**
+     * @brief Handler function type
+     */
+    using HttpHandler = std::function<void(const HttpRequest &, HttpResponse &)>;
+
+    /**
+     * @brief Request methods known to the router
+     */
+    enum class HttpMethod
+    {
+        GET,
+        POST,
+        PUT,
+        DELETE,
+        PATCH,
+        HEAD,
+        OPTIONS,
+        UNKNOWN
+    };
+
+    HttpMethod parseHttpMethod(StringRef method);
+    const char *httpMethodToString(HttpMethod method);
+
+    /**
+     * @brief Route table compiled into a trie of path segments
+     *
+     * Patterns are split on '/' at registration time. A segment is either
+     * literal text, a parameter "{name}" matching any single segment, or
+     * "*" as the last segment matching the rest of the path. Literal
+     * segments win over parameters, parameters over wildcards, as long as
+     * they have a handler for the request method: otherwise the search
+     * goes on in the other branches, and 405 is only the answer when the
+     * path matched no route with that method.
+     *
+     * match() walks the trie once per request segment, comparing slices of
+     * the request path in place, and appends captured values to
+     * HttpRequest::params ("*" for the wildcard), so a lookup is O(path
+     * length) and never allocates. Routes are added before the server starts
+     * and the table is read-only afterwards.
+     */
+    class HttpRouter
+    {
+    public:
+        enum class MatchResult
+        {
+            Found,
+            NotFound,        ///< No route for this path
+            MethodNotAllowed ///< Path exists, but not for this method
+        };
+
+        HttpRouter();
+        ~HttpRouter();
+
+        HttpRouter(const HttpRouter &) = delete;
+        HttpRouter &operator=(const HttpRouter &) = delete;
+
+        /**
+         * @brief Register a handler for a method and path pattern
+         * @return false if the pattern is invalid (e.g. "*" not last)
+         */
+        bool add(HttpMethod method, const std::string &pattern, HttpHandler handler);
+
+        /**
+         * @brief Find the handler for a request
+         * @param request Its params receive the captured path parameters
+         * @param handler Set when the result is Found
+         */
+        MatchResult match(HttpMethod method, StringRef path, HttpRequest &request,
+                          const HttpHandler *&handler) const;
+
+        size_t getRouteCount() const { return m_routeCount; }
+
+    private:
+        static constexpr size_t METHOD_COUNT = static_cast<size_t>(HttpMethod::UNKNOWN);
+
+        struct Node
+        {
+            std::string segment;
+            std::vector<std::unique_ptr<Node>> literals;
+            std::unique_ptr<Node> parameter;
+            std::string parameterName;
+            std::unique_ptr<Node> wildcard;
+            HttpHandler handlers[METHOD_COUNT];
+            bool hasHandler = false;
+        };
+
+        std::unique_ptr<Node> m_root;
+        size_t m_routeCount;
+
+        /**
+         * @brief Depth-first search for a node with a handler for method
+         * @param pathMatched Set when a node matched the path but not the method
+         */
+        const Node *matchNode(const Node &node, HttpMethod method, const char *path, size_t length,
+                              size_t position, HttpRequest &request, bool &pathMatched) const;
+
+        static bool accepts(const Node &node, HttpMethod method, bool &pathMatched);
+    };
+
+} // namespace Wallbox
+
+#endif // HTTP_ROUTER_H
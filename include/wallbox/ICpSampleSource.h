@@ -0,0 +1,50 @@
+#ifndef ICP_SAMPLE_SOURCE_H
+#define ICP_SAMPLE_SOURCE_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Wallbox
+{
+
+    /**
+     * @brief Source of sampled Control Pilot voltages (ADC)
+     *
+     * Delivers the CP waveform in blocks, already converted to the
+     * voltage on the CP line. Implementations block in the kernel while
+     * waiting for data.
+     */
+    class ICpSampleSource
+    {
+    public:
+        virtual ~ICpSampleSource() = default;
+
+        /**
+         * @brief Start sampling
+         * @return true if successful, false otherwise
+         */
+        virtual bool open() = 0;
+
+        /**
+         * @brief Stop sampling and release the device
+         */
+        virtual void close() = 0;
+
+        /**
+         * @brief Read the next block of samples
+         * @param millivolts Output buffer for CP voltages in mV
+         * @param maxSamples Capacity of millivolts
+         * @param timeoutMs Longest wait for data
+         * @return Samples stored, 0 on timeout, -1 on error or end of data
+         */
+        virtual int readBlock(int32_t *millivolts, size_t maxSamples, int timeoutMs) = 0;
+
+        /**
+         * @brief Sampling rate in Hz
+         */
+        virtual unsigned sampleRateHz() const = 0;
+    };
+
+} // namespace Wallbox
+
+#endif // ICP_SAMPLE_SOURCE_H
@@ -24,6 +24,21 @@ namespace Wallbox
         UNKNOWN = 6  ///< Cannot determine state
     };
 
+    /**
+     * @brief Counters of the CP state filter
+     */
+    struct CpFilterStats
+    {
+        uint64_t samples;        ///< Samples evaluated
+        uint64_t rawTransitions; ///< Changes an unfiltered reader would have reported
+        uint64_t transitions;    ///< Changes reported to listeners
+
+        /**
+         * @brief Transitions held back as noise
+         */
+        uint64_t suppressed() const { return rawTransitions > transitions ? rawTransitions - transitions : 0; }
+    };
+
     /**
      * @brief Callback for CP state changes
      * @param oldState Previous CP state
@@ -99,6 +114,18 @@ namespace Wallbox
          * @return true if monitoring
          */
         virtual bool isMonitoring() const = 0;
+
+        /**
+         * @brief Counters of the state filter between sampling and callbacks
+         * @return All zero for readers that do not filter
+         */
+        virtual CpFilterStats getFilterStats() const { return CpFilterStats{0, 0, 0}; }
+
+        /**
+         * @brief CLOCK_MONOTONIC time (ns) the last state change was first seen
+         * @return 0 if the reader does not timestamp changes
+         */
+        virtual uint64_t lastChangeTimestampNs() const { return 0; }
     };
 
 } // namespace Wallbox
@@ -9,6 +9,10 @@
 #ifndef IGPIO_CONTROLLER_H
 #define IGPIO_CONTROLLER_H
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
 namespace Wallbox
 {
 
@@ -30,6 +34,37 @@ namespace Wallbox
         HIGH = 1
     };
 
+    /**
+     * @brief Signal edges reported by watchPin()
+     */
+    enum class PinEdge
+    {
+        RISING = 1,
+        FALLING = 2,
+        BOTH = 3
+    };
+
+    /**
+     * @brief Edge on a watched input pin
+     */
+    struct PinEvent
+    {
+        int pin;
+        PinValue value;       ///< Level after the edge
+        uint64_t timestampNs; ///< CLOCK_MONOTONIC time of the edge
+    };
+
+    using PinEventCallback = std::function<void(const PinEvent &event)>;
+
+    /**
+     * @brief One output level in a batched write
+     */
+    struct PinWrite
+    {
+        int pin;
+        PinValue value;
+    };
+
     /**
      * @brief Interface for GPIO control operations
      *
@@ -76,6 +111,55 @@ namespace Wallbox
          */
         virtual PinValue digitalRead(int pin) const = 0;
 
+        /**
+         * @brief Write several output pins as one operation
+         *
+         * Backends that can update several lines at once override this;
+         * the default writes the pins one by one.
+         * @param writes Pins and values to write
+         * @param count Number of entries in writes
+         * @return true if all pins were written
+         */
+        virtual bool writeMany(const PinWrite *writes, size_t count)
+        {
+            bool ok = true;
+            for (size_t i = 0; i < count; ++i)
+            {
+                ok = digitalWrite(writes[i].pin, writes[i].value) && ok;
+            }
+            return ok;
+        }
+
+        /**
+         * @brief Report edges on an input pin as they happen
+         *
+         * The backend waits for edges in the kernel on its own thread and
+         * calls the callback there. Callbacks must not block and must not
+         * reconfigure pins. Backends without edge support return false;
+         * callers then fall back to polling digitalRead().
+         * @param pin Input pin (setPinMode(pin, INPUT) first)
+         * @param edge Edges to report
+         * @param callback Called for every reported edge
+         * @return true if edges will be reported
+         */
+        virtual bool watchPin(int pin, PinEdge edge, PinEventCallback callback)
+        {
+            (void)pin;
+            (void)edge;
+            (void)callback;
+            return false;
+        }
+
+        /**
+         * @brief Stop reporting edges on a pin
+         *
+         * When this returns, the pin's callback is no longer running.
+         */
+        virtual void unwatchPin(int pin)
+        {
+            (void)pin;
+        }
+
         /**
          * @brief Check if GPIO is initialized
          * @return true if initialized
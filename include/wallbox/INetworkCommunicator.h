@@ -11,11 +11,43 @@
 
 #include <functional>
 #include <vector>
+#include <cstddef>
 #include <cstdint>
+#include <type_traits>
 
 namespace Wallbox
 {
 
+    /**
+     * @brief Non-owning view of a byte range (data + size)
+     *
+     * Lets messages travel between socket and handler without being copied
+     * into a std::vector. A received span points into the communicator's
+     * receive buffers and is only valid during the callback.
+     */
+    struct ByteSpan
+    {
+        const uint8_t *data;
+        size_t size;
+
+        ByteSpan() : data(nullptr), size(0) {}
+        ByteSpan(const uint8_t *bytes, size_t length) : data(bytes), size(length) {}
+        explicit ByteSpan(const std::vector<uint8_t> &bytes) : data(bytes.data()), size(bytes.size()) {}
+
+        /**
+         * @brief View the bytes of a trivially copyable object (e.g. a protocol struct)
+         */
+        template <typename T>
+        static ByteSpan of(const T &object)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "ByteSpan::of requires a trivially copyable type");
+            return ByteSpan(reinterpret_cast<const uint8_t *>(&object), sizeof(T));
+        }
+
+        bool empty() const { return size == 0; }
+        uint8_t operator[](size_t index) const { return data[index]; }
+    };
+
     /**
      * @brief Interface for network communication
      *
@@ -26,6 +58,7 @@ namespace Wallbox
     {
     public:
         using MessageCallback = std::function<void(const std::vector<uint8_t> &)>;
+        using SpanCallback = std::function<void(ByteSpan)>;
 
         virtual ~INetworkCommunicator() = default;
 
@@ -47,17 +80,86 @@ namespace Wallbox
          */
         virtual bool send(const std::vector<uint8_t> &data) = 0;
 
+        /**
+         * @brief Send data straight from the caller's memory
+         *
+         * The default copies into a vector for implementations that only
+         * provide send(const std::vector<uint8_t>&).
+         * @param data Data to send
+         * @return true if sent successfully, false otherwise
+         */
+        virtual bool send(ByteSpan data)
+        {
+            return send(std::vector<uint8_t>(data.data, data.data + data.size));
+        }
+
+        /**
+         * @brief Send several messages queued in the same tick
+         *
+         * Implementations may hand them to the kernel in one call. The
+         * default sends them one by one and stops at the first failure.
+         * @param messages Array of messages
+         * @param count Number of messages
+         * @return true if all were sent
+         */
+        virtual bool sendBatch(const ByteSpan *messages, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (!send(messages[i]))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
         /**
          * @brief Start receiving messages (non-blocking)
          * @param callback Function to call when message is received
          */
         virtual void startReceiving(MessageCallback callback) = 0;
 
+        /**
+         * @brief Start receiving messages as spans (no copy per message)
+         *
+         * The span is only valid during the callback. The default adapts
+         * the vector-based startReceiving().
+         * @param callback Function to call when message is received
+         */
+        virtual void startReceiving(SpanCallback callback)
+        {
+            startReceiving(MessageCallback([callback](const std::vector<uint8_t> &message)
+                                           { callback(ByteSpan(message)); }));
+        }
+
         /**
          * @brief Stop receiving messages
          */
         virtual void stopReceiving() = 0;
 
+        /**
+         * @brief Descriptor that becomes readable when messages are waiting
+         *
+         * Lets an event loop own the receive path instead of a receive
+         * thread: poll this fd and call receivePending() when it is ready.
+         * Do not combine with startReceiving().
+         * @return -1 if messages are only delivered through startReceiving()
+         */
+        virtual int receiveFd() const { return -1; }
+
+        /**
+         * @brief Deliver the messages that are already queued, without blocking
+         *
+         * Spans are only valid during the callback.
+         * @return Number of messages delivered, -1 if not supported
+         */
+        virtual int receivePending(const SpanCallback &callback)
+        {
+            (void)callback;
+            return -1;
+        }
+
         /**
          * @brief Check if connected
          * @return true if connected
@@ -0,0 +1,115 @@
+#ifndef IIO_CP_SAMPLE_SOURCE_H
+#define IIO_CP_SAMPLE_SOURCE_H
+
+#include "ICpSampleSource.h"
+#include <string>
+#include <vector>
+
+namespace Wallbox
+{
+
+    /**
+     * @brief Sample layout of an IIO scan element ("le:u12/16>>0")
+     */
+    struct IioScanFormat
+    {
+        bool bigEndian;
+        bool isSigned;
+        unsigned realBits;
+        unsigned storageBits;
+        unsigned shift;
+
+        /**
+         * @brief Parse the contents of scan_elements/in_<channel>_type
+         * @return false if the string is not a supported format
+         */
+        static bool parse(const std::string &text, IioScanFormat &format);
+
+        /**
+         * @brief Render in the sysfs notation
+         */
+        std::string toString() const;
+    };
+
+    /**
+     * @brief Settings of the CP ADC and its analog front end
+     */
+    struct IioCpConfig
+    {
+        std::string device;       ///< IIO device name, e.g. "iio:device0"
+        std::string channel;      ///< Scan element, e.g. "voltage0"
+        unsigned sampleRateHz;    ///< Requested sampling frequency
+        int frontEndOffsetMv;     ///< ADC input voltage for 0 V on the CP line
+        int frontEndGainX1000;    ///< CP volts per ADC volt, times 1000
+        std::string replayFile;   ///< Read a capture instead of the device (see IioCpSampleSource)
+        std::string sysfsRoot;    ///< Normally /sys/bus/iio/devices
+        std::string devRoot;      ///< Normally /dev
+
+        IioCpConfig()
+            : device("iio:device0"),
+              channel("voltage0"),
+              sampleRateHz(20000),
+              frontEndOffsetMv(1650),
+              frontEndGainX1000(7273),
+              sysfsRoot("/sys/bus/iio/devices"),
+              devRoot("/dev")
+        {
+        }
+    };
+
+    /**
+     * @brief CP sampling through the Linux IIO buffered interface
+     *
+     * open() enables the channel's scan element and the buffer in sysfs
+     * and opens the device's character device; readBlock() waits in
+     * poll() and converts a whole block of raw scans in one pass.
+     *
+     * With replayFile set, the same decoder reads a capture instead, so
+     * the pipeline runs without hardware. A capture is one header line,
+     *
+     *   IIO <format> <scale mV/LSB> <sample rate Hz>
+     *
+     * followed by the raw scans as read from /dev/iio:deviceN, e.g.
+     * produced with `echo "IIO le:u12/16>>0 0.805664 20000" > cp.iio &&
+     * cat /dev/iio:device0 >> cp.iio`. Replay ends with the file.
+     *
+     * Only the configured channel may be enabled on the device.
+     */
+    class IioCpSampleSource : public ICpSampleSource
+    {
+    public:
+        explicit IioCpSampleSource(const IioCpConfig &config);
+        ~IioCpSampleSource() override;
+
+        bool open() override;
+        void close() override;
+        int readBlock(int32_t *millivolts, size_t maxSamples, int timeoutMs) override;
+        unsigned sampleRateHz() const override { return m_sampleRateHz; }
+
+        const IioScanFormat &format() const { return m_format; }
+
+        /**
+         * @brief Convert raw scans to CP millivolts
+         * @param raw Scans as read from the device
+         * @param count Number of scans
+         * @param millivolts Output, count entries
+         */
+        void decode(const uint8_t *raw, size_t count, int32_t *millivolts) const;
+
+    private:
+        IioCpConfig m_config;
+        IioScanFormat m_format;
+        double m_scaleMv;        ///< ADC millivolts per LSB
+        unsigned m_sampleRateHz;
+        int m_fd;
+        bool m_bufferEnabled;
+        std::vector<uint8_t> m_raw;
+
+        bool openDevice();
+        bool openReplay();
+        std::string devicePath(const std::string &attribute) const;
+    };
+
+} // namespace Wallbox
+
+#endif // IIO_CP_SAMPLE_SOURCE_H
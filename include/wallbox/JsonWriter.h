@@ -0,0 +1,87 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Wallbox
+{
+
+    /**
+     * @brief Streaming JSON writer appending to a caller-owned buffer
+     *
+     * Writes directly into the given std::string, so a buffer that is
+     * cleared and reused keeps its capacity and steady-state output does
+     * not allocate. Strings are escaped; numbers are formatted by hand
+     * (no iostream, no locale). Commas are tracked per nesting level in a
+     * bit mask, up to MAX_DEPTH levels.
+     *
+     * Usage:
+     * @code
+     *   JsonWriter json(buffer);
+     *   json.beginObject().field("state", "IDLE").field("relay", true).endObject();
+     * @endcode
+     */
+    class JsonWriter
+    {
+    public:
+        static constexpr int MAX_DEPTH = 32;
+
+        explicit JsonWriter(std::string &buffer);
+
+        JsonWriter &beginObject();
+        JsonWriter &endObject();
+        JsonWriter &beginArray();
+        JsonWriter &endArray();
+
+        JsonWriter &key(const char *name);
+        JsonWriter &key(const std::string &name);
+
+        JsonWriter &value(const char *text);
+        JsonWriter &value(const std::string &text);
+        JsonWriter &value(bool flag);
+        JsonWriter &value(int number);
+        JsonWriter &value(long number);
+        JsonWriter &value(long long number);
+        JsonWriter &value(unsigned number);
+        JsonWriter &value(unsigned long number);
+        JsonWriter &value(unsigned long long number);
+        JsonWriter &value(double number);
+        JsonWriter &nullValue();
+
+        /**
+         * @brief Insert already serialized JSON as the next value
+         */
+        JsonWriter &rawValue(const char *json, size_t length);
+        JsonWriter &rawValue(const std::string &json) { return rawValue(json.data(), json.size()); }
+
+        template <typename T>
+        JsonWriter &field(const char *name, const T &fieldValue)
+        {
+            key(name);
+            return value(fieldValue);
+        }
+
+        std::string &buffer() { return m_buffer; }
+
+        // Formatting primitives, also usable without a writer
+        static void appendEscaped(std::string &out, const char *text, size_t length);
+        static void appendInteger(std::string &out, long long number);
+        static void appendUnsigned(std::string &out, unsigned long long number);
+        static void appendDouble(std::string &out, double number);
+
+    private:
+        std::string &m_buffer;
+        uint32_t m_hasElements; ///< Bit per depth: a value was already written
+        int m_depth;
+        bool m_afterKey;
+
+        void beforeValue();
+        void open(char bracket);
+        void close(char bracket);
+    };
+
+} // namespace Wallbox
+
+#endif // JSON_WRITER_H
@@ -0,0 +1,182 @@
+#ifndef LATENCY_TRACER_H
+#define LATENCY_TRACER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Wallbox
+{
+
+    class Histogram;
+
+    /**
+     * @brief What started a trace
+     */
+    enum class TraceOrigin : uint8_t
+    {
+        NONE = 0,
+        UDP = 1,    ///< Datagram from the ISO 15118 stack
+        CP_EDGE = 2 ///< Control pilot state change
+    };
+
+    /**
+     * @brief Stages a trace passes on its way to the outputs
+     */
+    enum class TraceStage : uint8_t
+    {
+        RECEIVE = 0,     ///< recvmmsg() / CP edge until the loop picks it up
+        PARSE = 1,       ///< Decoding the message
+        TRANSITION = 2,  ///< ChargingStateMachine::transitionTo, including synchronous listeners
+        GPIO_WRITE = 3,  ///< Output pins reaching the GPIO backend
+        RELAY = 4,       ///< setRelayState until the relay pin is written
+        STATUS_SEND = 5, ///< Status datagram back to the stack
+        COUNT = 6
+    };
+
+    /**
+     * @brief A trace in progress, cheap to copy into posted work
+     */
+    struct TraceContext
+    {
+        uint32_t id = 0; ///< 0: no trace
+        TraceOrigin origin = TraceOrigin::NONE;
+        uint64_t originNs = 0; ///< CLOCK_MONOTONIC
+
+        bool active() const { return id != 0; }
+    };
+
+    /**
+     * @brief One finished stage as kept in the ring
+     */
+    struct TraceSpanRecord
+    {
+        uint64_t sequence; ///< 1-based; 0 while being written
+        uint64_t startNs;
+        uint64_t endNs;
+        uint64_t originNs;
+        uint32_t traceId;
+        uint32_t thread; ///< Kernel thread id
+        TraceOrigin origin;
+        TraceStage stage;
+        uint8_t reserved[6];
+    };
+
+    /**
+     * @brief End-to-end latency tracing from UDP receive / CP edge to the outputs
+     *
+     * A trace is started where work enters the controller and made current
+     * on the handling thread with a TraceScope; TraceSpans opened further
+     * down (parse, transition, GPIO write, status send) attach to it. Work
+     * posted to another thread carries current() along and resumes it there.
+     *
+     * Finished spans go into a fixed ring (one atomic increment, no lock;
+     * the oldest spans are overwritten) and into log-linear histograms on
+     * /metrics: the span's own duration per stage and the time from the
+     * origin to the end of the stage. Without a current trace a span costs
+     * one thread-local check.
+     */
+    class LatencyTracer
+    {
+    public:
+        static constexpr size_t CAPACITY = 8192; ///< Spans kept in the ring
+
+        static LatencyTracer &instance();
+
+        static uint64_t nowNs();
+
+        /**
+         * @brief Trace current on this thread (inactive if none)
+         */
+        static TraceContext current();
+
+        TraceContext begin(TraceOrigin origin, uint64_t originNs);
+        void record(const TraceContext &context, TraceStage stage, uint64_t startNs, uint64_t endNs);
+
+        /**
+         * @brief Spans currently in the ring, oldest first
+         */
+        void snapshot(std::vector<TraceSpanRecord> &spans) const;
+
+        /**
+         * @brief Chrome trace-event JSON (chrome://tracing, Perfetto)
+         * @param all Also traces that only got as far as parsing (idle heartbeats)
+         */
+        void writeChromeTrace(std::string &out, bool all = false) const;
+
+        static const char *stageName(TraceStage stage);
+        static const char *originName(TraceOrigin origin);
+
+    private:
+        LatencyTracer();
+        ~LatencyTracer() = delete;
+        LatencyTracer(const LatencyTracer &) = delete;
+        LatencyTracer &operator=(const LatencyTracer &) = delete;
+
+        friend class TraceScope;
+        static void setCurrent(const TraceContext &context);
+
+        std::unique_ptr<TraceSpanRecord[]> m_slots;
+        std::atomic<uint64_t> m_next;
+        std::atomic<uint32_t> m_nextTraceId;
+        Histogram *m_stageDuration[static_cast<size_t>(TraceStage::COUNT)];
+        Histogram *m_sinceOrigin[3][static_cast<size_t>(TraceStage::COUNT)]; ///< [origin][stage]
+    };
+
+    /**
+     * @brief Makes a trace current on this thread until the end of the scope
+     */
+    class TraceScope
+    {
+    public:
+        /**
+         * @brief Start a new trace
+         */
+        TraceScope(TraceOrigin origin, uint64_t originNs);
+
+        /**
+         * @brief Continue a trace begun elsewhere (no-op if inactive)
+         */
+        explicit TraceScope(const TraceContext &context);
+
+        ~TraceScope();
+
+        const TraceContext &context() const { return m_context; }
+
+    private:
+        TraceScope(const TraceScope &) = delete;
+        TraceScope &operator=(const TraceScope &) = delete;
+
+        TraceContext m_context;
+        TraceContext m_previous;
+    };
+
+    /**
+     * @brief Times one stage of the current trace; does nothing without one
+     */
+    class TraceSpan
+    {
+    public:
+        explicit TraceSpan(TraceStage stage);
+        ~TraceSpan() { end(); }
+
+        /**
+         * @brief Finish early; later calls do nothing
+         */
+        void end();
+
+    private:
+        TraceSpan(const TraceSpan &) = delete;
+        TraceSpan &operator=(const TraceSpan &) = delete;
+
+        TraceContext m_context;
+        TraceStage m_stage;
+        uint64_t m_startNs;
+    };
+
+} // namespace Wallbox
+
+#endif // LATENCY_TRACER_H
@@ -0,0 +1,264 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ctime>
+
+/**
+ * @brief Lowest level compiled in (0 = TRACE ... 4 = ERROR, 5 = nothing)
+ *
+ * Statements below this level are removed by the compiler together with
+ * the evaluation of their arguments. CMake sets it per build mode.
+ */
+#ifndef WALLBOX_LOG_MIN_LEVEL
+#define WALLBOX_LOG_MIN_LEVEL 1
+#endif
+
+namespace Wallbox
+{
+
+    enum class LogLevel : uint8_t
+    {
+        TRACE = 0,
+        DEBUG,
+        INFO,
+        WARN,
+        ERROR,
+        OFF
+    };
+
+    /**
+     * @brief Destinations of a log line, as a bit mask
+     *
+     * Bit 0 is stdout; every opened file gets its own bit from
+     * Logger::openFile().
+     */
+    using LogSinks = uint8_t;
+    constexpr LogSinks LOG_SINK_CONSOLE = 0x01;
+
+    /**
+     * @brief One log line as it travels from the caller to the writer thread
+     *
+     * Fixed size so the per-thread rings never allocate. Text longer than
+     * TEXT_CAPACITY is cut and ends in "...".
+     */
+    struct LogRecord
+    {
+        static constexpr size_t TAG_CAPACITY = 16;
+        static constexpr size_t TEXT_CAPACITY = 228;
+
+        uint64_t timestampNs; ///< steady_clock, converted to wall time by the writer
+        LogLevel level;
+        LogSinks sinks;
+        uint16_t length;
+        char tag[TAG_CAPACITY]; ///< NUL-terminated, may be empty
+        char text[TEXT_CAPACITY];
+    };
+
+    struct LoggerStats
+    {
+        uint64_t written; ///< Lines handed to the sinks
+        uint64_t dropped; ///< Lines lost to full per-thread rings
+        uint64_t batches; ///< Writer passes that wrote something
+        uint64_t writes;  ///< writev() calls
+    };
+
+    /**
+     * @brief Asynchronous logger
+     *
+     * Callers format into a LogLine on their own stack and push the finished
+     * record into a lock-free ring owned by their thread (created on the
+     * thread's first log line). A single writer thread drains all rings,
+     * merges them by timestamp, formats the time prefix and hands each sink
+     * one writev() per batch. In the steady state a caller neither allocates,
+     * locks nor makes a system call. The exceptions: a thread's first log
+     * line allocates its ring and takes the registry lock, and a push that
+     * finds the writer waiting takes the wake mutex to notify it. When a
+     * thread's ring is full the line is dropped and counted instead of
+     * blocking the caller.
+     *
+     * Use the WALLBOX_LOG_* macros rather than LogLine directly so disabled
+     * levels cost nothing. After shutdown() (also run at exit) lines are
+     * written synchronously.
+     */
+    class Logger
+    {
+    public:
+        static constexpr size_t THREAD_RING_CAPACITY = 256;
+        static constexpr int MAX_FILE_SINKS = 7;
+
+        static Logger &instance();
+
+        /**
+         * @brief Runtime level check (the compile-time one is in the macros)
+         */
+        static bool isEnabled(LogLevel level)
+        {
+            return static_cast<int>(level) >= s_level.load(std::memory_order_relaxed);
+        }
+
+        static void setLevel(LogLevel level);
+        static LogLevel getLevel();
+
+        /**
+         * @brief Parse "trace", "debug", "info", "warn"/"warning", "error", "off" (any case)
+         * @return false if name is not a level
+         */
+        static bool parseLevel(const std::string &name, LogLevel &level);
+        static const char *levelName(LogLevel level);
+
+        /**
+         * @brief Open a file (append) as an additional sink
+         * @return Sink bit for LogLine, 0 on failure
+         */
+        LogSinks openFile(const std::string &path);
+
+        /**
+         * @brief Write what is pending for the file, then close it
+         */
+        void closeFile(LogSinks sink);
+
+        /**
+         * @brief Queue a finished record (called by LogLine)
+         */
+        void submit(const LogRecord &record);
+
+        /**
+         * @brief Block until every line submitted before the call is written
+         */
+        void flush();
+
+        /**
+         * @brief Write what is pending and stop the writer thread
+         */
+        void shutdown();
+
+        LoggerStats getStats() const;
+
+    private:
+        struct ThreadBuffer;
+
+        Logger();
+        ~Logger() = delete;
+        Logger(const Logger &) = delete;
+        Logger &operator=(const Logger &) = delete;
+
+        void writerLoop();
+        bool hasPending();
+        size_t drain();
+        void writeRecords(const LogRecord *records, size_t count);
+        size_t formatPrefix(const LogRecord &record, char *out);
+        void writeSink(int fd, LogSinks sink, const LogRecord *records, const char *prefixes,
+                       const size_t *prefixLengths, size_t count);
+
+        static std::atomic<int> s_level;
+
+        // Producers
+        std::atomic<bool> m_running;
+        std::atomic<bool> m_waiting;
+        mutable std::mutex m_registryMutex; ///< Guards m_buffers (thread start/exit, writer drain)
+        std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+        uint64_t m_retiredDropped;
+
+        // Writer wakeup and flush handshake
+        std::mutex m_wakeMutex;
+        std::condition_variable m_wakeup;
+        std::condition_variable m_flushed;
+        uint64_t m_passes;
+        uint64_t m_flushTarget;
+        std::thread m_writer;
+
+        // Sinks
+        std::mutex m_sinkMutex;
+        int m_fileFds[MAX_FILE_SINKS];
+
+        // Writer-only state
+        std::vector<LogRecord> m_batch;
+        std::vector<char> m_prefixes;
+        std::vector<size_t> m_prefixLengths;
+        int64_t m_wallOffsetNs; ///< system_clock minus steady_clock at startup
+        time_t m_cachedSecond;
+        char m_cachedDate[24];
+
+        std::atomic<uint64_t> m_written;
+        std::atomic<uint64_t> m_batches;
+        std::atomic<uint64_t> m_writes;
+    };
+
+    /**
+     * @brief Builds one log line on the caller's stack and submits it when destroyed
+     *
+     * The timestamp is taken at construction, so a line built across
+     * several statements sorts by when it was started.
+     */
+    class LogLine
+    {
+    public:
+        LogLine(LogLevel level, const char *tag, LogSinks sinks = LOG_SINK_CONSOLE);
+
+        /**
+         * @brief Line for a free-form level name ("INFO", "CMD", ...)
+         *
+         * Names that are not levels log at INFO with the name as tag.
+         */
+        LogLine(const std::string &levelName, LogSinks sinks);
+
+        ~LogLine();
+
+        LogLine(const LogLine &) = delete;
+        LogLine &operator=(const LogLine &) = delete;
+
+        LogLine &operator<<(const char *text);
+        LogLine &operator<<(const std::string &text);
+        LogLine &operator<<(char value);
+        LogLine &operator<<(bool value);
+        LogLine &operator<<(int value);
+        LogLine &operator<<(unsigned int value);
+        LogLine &operator<<(long value);
+        LogLine &operator<<(unsigned long value);
+        LogLine &operator<<(long long value);
+        LogLine &operator<<(unsigned long long value);
+        LogLine &operator<<(double value);
+
+    private:
+        void start(LogLevel level, const char *tag, LogSinks sinks);
+        void append(const char *data, size_t length);
+        void appendUnsigned(unsigned long long value, bool negative);
+
+        LogRecord m_record;
+        bool m_enabled;
+        bool m_truncated;
+    };
+
+} // namespace Wallbox
+
+/**
+ * @brief Log statement: WALLBOX_LOG_INFO("Relay") << "state " << on;
+ *
+ * The compile-time comparison removes statements below
+ * WALLBOX_LOG_MIN_LEVEL; the runtime check skips the formatting of lines
+ * below the configured level. Either way the arguments are not evaluated.
+ */
+#define WALLBOX_LOG(level, tag)                                                   \
+    if (static_cast<int>(::Wallbox::LogLevel::level) < WALLBOX_LOG_MIN_LEVEL ||   \
+        !::Wallbox::Logger::isEnabled(::Wallbox::LogLevel::level))                \
+    {                                                                             \
+    }                                                                             \
+    else                                                                          \
+        ::Wallbox::LogLine(::Wallbox::LogLevel::level, tag)
+
+#define WALLBOX_LOG_TRACE(tag) WALLBOX_LOG(TRACE, tag)
+#define WALLBOX_LOG_DEBUG(tag) WALLBOX_LOG(DEBUG, tag)
+#define WALLBOX_LOG_INFO(tag) WALLBOX_LOG(INFO, tag)
+#define WALLBOX_LOG_WARN(tag) WALLBOX_LOG(WARN, tag)
+#define WALLBOX_LOG_ERROR(tag) WALLBOX_LOG(ERROR, tag)
+
+#endif // LOGGER_H
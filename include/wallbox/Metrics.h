@@ -0,0 +1,156 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Wallbox
+{
+
+    /**
+     * @brief Monotonic counter (relaxed atomic)
+     */
+    class Counter
+    {
+    public:
+        Counter() : m_value(0) {}
+
+        void inc(uint64_t amount = 1) { m_value.fetch_add(amount, std::memory_order_relaxed); }
+        uint64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<uint64_t> m_value;
+    };
+
+    /**
+     * @brief Value that goes up and down (relaxed atomic)
+     */
+    class Gauge
+    {
+    public:
+        Gauge() : m_value(0) {}
+
+        void set(int64_t value) { m_value.store(value, std::memory_order_relaxed); }
+        void add(int64_t amount) { m_value.fetch_add(amount, std::memory_order_relaxed); }
+        int64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<int64_t> m_value;
+    };
+
+    /**
+     * @brief Latency histogram with fixed buckets
+     *
+     * Observations are in nanoseconds and exported in seconds. Each
+     * observation is a short bucket search and three relaxed increments;
+     * a scrape reads the buckets one by one, so it may see an observation
+     * in count but not yet in its bucket.
+     */
+    class Histogram
+    {
+    public:
+        /**
+         * @param boundsNs Upper bucket bounds, ascending; +Inf is implicit
+         */
+        explicit Histogram(const std::vector<uint64_t> &boundsNs);
+
+        void observe(uint64_t valueNs);
+
+        const std::vector<uint64_t> &bounds() const { return m_bounds; }
+        uint64_t bucketCount(size_t index) const { return m_buckets[index].load(std::memory_order_relaxed); }
+        uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+        uint64_t sumNs() const { return m_sumNs.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief 10 us ... 1 s in 1-2.5-5 steps
+         */
+        static const std::vector<uint64_t> &latencyBoundsNs();
+
+        /**
+         * @brief HDR-style log-linear bounds: each power of two from lowestNs
+         *        up to highestNs split into subBuckets equal steps
+         */
+        static std::vector<uint64_t> logLinearBoundsNs(uint64_t lowestNs, uint64_t highestNs, unsigned subBuckets);
+
+    private:
+        std::vector<uint64_t> m_bounds;
+        std::unique_ptr<std::atomic<uint64_t>[]> m_buckets; ///< One per bound plus +Inf, not cumulative
+        std::atomic<uint64_t> m_count;
+        std::atomic<uint64_t> m_sumNs;
+    };
+
+    /**
+     * @brief Process-wide metrics, exported in the Prometheus text format
+     *
+     * Components look their metrics up once (usually into a function-local
+     * static) and then update them with relaxed atomics only. Metrics live
+     * as long as the process; asking again for the same name and labels
+     * returns the same object, so several instances of a component add up.
+     *
+     * The registry mutex is taken by registration and by render(), never
+     * when a metric is updated, so a scrape does not block the control path.
+     */
+    class MetricsRegistry
+    {
+    public:
+        using Labels = std::initializer_list<std::pair<const char *, std::string>>;
+
+        static MetricsRegistry &instance();
+
+        Counter &counter(const std::string &name, const std::string &help, Labels labels = {});
+        Gauge &gauge(const std::string &name, const std::string &help, Labels labels = {});
+        Histogram &histogram(const std::string &name, const std::string &help, Labels labels = {},
+                             const std::vector<uint64_t> &boundsNs = Histogram::latencyBoundsNs());
+
+        /**
+         * @brief Append all metrics in the text exposition format (version 0.0.4)
+         */
+        void render(std::string &out) const;
+
+        static constexpr const char *CONTENT_TYPE = "text/plain; version=0.0.4; charset=utf-8";
+
+    private:
+        enum class Type
+        {
+            COUNTER,
+            GAUGE,
+            HISTOGRAM
+        };
+
+        struct Series
+        {
+            std::string labels; ///< Rendered: key="value",...
+            std::unique_ptr<Counter> counter;
+            std::unique_ptr<Gauge> gauge;
+            std::unique_ptr<Histogram> histogram;
+        };
+
+        struct Family
+        {
+            std::string name;
+            std::string help;
+            Type type;
+            std::vector<std::unique_ptr<Series>> series;
+        };
+
+        MetricsRegistry() = default;
+        ~MetricsRegistry() = delete;
+        MetricsRegistry(const MetricsRegistry &) = delete;
+        MetricsRegistry &operator=(const MetricsRegistry &) = delete;
+
+        Series &find(const std::string &name, const std::string &help, Type type, Labels labels);
+
+        mutable std::mutex m_mutex;
+        std::vector<std::unique_ptr<Family>> m_families;
+    };
+
+} // namespace Wallbox
+
+#endif // METRICS_H
@@ -0,0 +1,114 @@
+#ifndef MMIO_GPIO_CONTROLLER_H
+#define MMIO_GPIO_CONTROLLER_H
+
+#include "IGpioController.h"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+namespace Wallbox
+{
+
+    /**
+     * @brief Register map of a SoC GPIO block
+     *
+     * Describes where direction, output and input bits of each pin bank
+     * live, as 32-bit word indices into the register block. Pins are the
+     * global numbers also used by sysfs, so configured pins stay valid
+     * across backends.
+     */
+    struct GpioRegisterLayout
+    {
+        struct Bank
+        {
+            int firstPin;          ///< Global number of the bank's first pin
+            int pinCount;
+            int firstBit;          ///< Bit of the first pin in each register
+            int directionReg;
+            bool directionInputSet; ///< Direction bit set means input (Amlogic) rather than output
+            int outputReg;
+            int inputReg;
+            int setReg;            ///< Write-1-to-set output register, -1 if the SoC has none
+            int clearReg;          ///< Write-1-to-clear output register, -1 if the SoC has none
+        };
+
+        off_t physicalBase;  ///< Page-aligned physical address mapped from /dev/mem
+        size_t blockOffset;  ///< Offset of the register block inside the mapping
+        size_t mapSize;      ///< Bytes to map
+        std::vector<Bank> banks;
+
+        /**
+         * @brief Amlogic S905X3 (Banana Pi M5) periphs GPIO block
+         * @param lineBase Global pin number the kernel assigns to the block's first line
+         *
+         * Register offsets follow the mainline meson-g12a pinctrl driver.
+         * The block has no set/clear registers, so outputs are updated by
+         * read-modify-write of the bank's output register.
+         */
+        static GpioRegisterLayout amlogicG12(int lineBase);
+    };
+
+    /**
+     * @brief GPIO controller on memory-mapped SoC registers
+     *
+     * Maps the GPIO register block once (via /dev/gpiomem or /dev/mem)
+     * and turns every pin access into a volatile load or store: no system
+     * call at all after initialize(). Accesses hold a mutex, which
+     * serializes read-modify-write cycles and keeps shutdown() from
+     * unmapping the registers under a reader; other users of the same bank (kernel drivers)
+     * are not coordinated with, so only pins owned by this process may be
+     * configured here.
+     *
+     * Design Pattern: Strategy Pattern
+     * SOLID Principle: Liskov Substitution Principle
+     */
+    class MmioGpioController : public IGpioController
+    {
+    public:
+        /**
+         * @param layout Register map of the SoC
+         * @param device /dev/gpiomem (exposes the GPIO page at offset 0) or /dev/mem
+         */
+        explicit MmioGpioController(const GpioRegisterLayout &layout, const std::string &device = DEFAULT_DEVICE);
+
+        /**
+         * @brief Use an already mapped register block (tests, fake register files)
+         * @param registers Start of the register block; not unmapped by this class
+         */
+        MmioGpioController(const GpioRegisterLayout &layout, volatile uint32_t *registers);
+
+        ~MmioGpioController() override;
+
+        bool initialize() override;
+        void shutdown() override;
+
+        bool setPinMode(int pin, PinMode mode) override;
+        bool digitalWrite(int pin, PinValue value) override;
+        PinValue digitalRead(int pin) const override;
+        bool isInitialized() const override;
+
+        /**
+         * @brief Write several pins under one lock acquisition
+         */
+        bool writeMany(const PinWrite *writes, size_t count) override;
+
+        static constexpr const char *DEFAULT_DEVICE = "/dev/gpiomem";
+
+    private:
+        GpioRegisterLayout m_layout;
+        std::string m_device;
+        void *m_mapping;
+        volatile uint32_t *m_registers;
+        mutable std::mutex m_mutex;
+
+        const GpioRegisterLayout::Bank *findBank(int pin) const;
+        void setBit(int reg, uint32_t mask, bool set);
+        void writePin(const GpioRegisterLayout::Bank &bank, int pin, bool high);
+    };
+
+} // namespace Wallbox
+
+#endif // MMIO_GPIO_CONTROLLER_H
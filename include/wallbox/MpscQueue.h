@@ -0,0 +1,106 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace Wallbox
+{
+
+    /**
+     * @brief Unbounded lock-free multi-producer/single-consumer queue
+     *
+     * Linked list with a stub node (D. Vyukov's MPSC queue): push() is one
+     * atomic exchange plus a store and never blocks or retries, pop() is
+     * only ever called by the single consumer. Between a producer's
+     * exchange and its store the new element is not yet visible, so pop()
+     * may briefly report empty while a push is in flight; consumers that
+     * are woken by the producer after push() returns never miss elements.
+     *
+     * Producer and consumer ends live on separate cache lines, kept apart
+     * by padding rather than alignas so that objects holding a queue can
+     * be allocated with plain new.
+     */
+    template <typename T>
+    class MpscQueue
+    {
+    public:
+        MpscQueue()
+            : m_head(new Node()),
+              m_tail(m_head.load())
+        {
+        }
+
+        ~MpscQueue()
+        {
+            T value;
+            while (pop(value))
+            {
+            }
+            delete m_tail;
+        }
+
+        MpscQueue(const MpscQueue &) = delete;
+        MpscQueue &operator=(const MpscQueue &) = delete;
+
+        /**
+         * @brief Append an element (any thread)
+         */
+        void push(T value)
+        {
+            Node *node = new Node(std::move(value));
+            Node *previous = m_head.exchange(node, std::memory_order_acq_rel);
+            previous->next.store(node, std::memory_order_release);
+        }
+
+        /**
+         * @brief Take the oldest element (consumer thread only)
+         * @return false if the queue is empty
+         */
+        bool pop(T &value)
+        {
+            Node *tail = m_tail;
+            Node *next = tail->next.load(std::memory_order_acquire);
+            if (next == nullptr)
+            {
+                return false;
+            }
+
+            // next becomes the new stub; its moved-from value is dropped with it later
+            value = std::move(next->value);
+            m_tail = next;
+            delete tail;
+            return true;
+        }
+
+        /**
+         * @brief true if pop() would fail (consumer thread only)
+         */
+        bool empty() const
+        {
+            return m_tail->next.load(std::memory_order_acquire) == nullptr;
+        }
+
+    private:
+        struct Node
+        {
+            Node() : value(), next(nullptr) {}
+            explicit Node(T &&item) : value(std::move(item)), next(nullptr) {}
+
+            T value;
+            std::atomic<Node *> next;
+        };
+
+        static constexpr size_t CACHE_LINE = 64;
+
+        char m_padBefore[CACHE_LINE];
+        std::atomic<Node *> m_head; ///< Last node, swapped by producers
+        char m_padHead[CACHE_LINE - sizeof(std::atomic<Node *>)];
+        Node *m_tail; ///< Stub before the oldest element, consumer only
+        char m_padTail[CACHE_LINE - sizeof(Node *)];
+    };
+
+} // namespace Wallbox
+
+#endif // MPSC_QUEUE_H
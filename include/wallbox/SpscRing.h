@@ -0,0 +1,109 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Wallbox
+{
+
+    /**
+     * @brief Bounded lock-free single-producer/single-consumer ring
+     *
+     * Capacity is rounded up to a power of two. Slots are allocated once
+     * and reused: push() assigns into the slot, so element types that keep
+     * their storage on assignment (std::string) stop allocating once the
+     * ring has warmed up. A full ring rejects the push; the producer never
+     * waits for the consumer.
+     *
+     * One thread may push and one (other) thread may pop at a time.
+     *
+     * The indices are kept a cache line apart by padding rather than
+     * alignas, so the ring can be allocated with plain new.
+     */
+    template <typename T>
+    class SpscRing
+    {
+    public:
+        explicit SpscRing(size_t capacity)
+            : m_slots(roundUp(capacity)),
+              m_mask(m_slots.size() - 1),
+              m_head(0),
+              m_tail(0)
+        {
+        }
+
+        SpscRing(const SpscRing &) = delete;
+        SpscRing &operator=(const SpscRing &) = delete;
+
+        /**
+         * @brief Append a copy of value (producer only)
+         * @return false if the ring is full
+         */
+        bool push(const T &value)
+        {
+            uint64_t head = m_head.load(std::memory_order_relaxed);
+            if (head - m_tail.load(std::memory_order_acquire) >= m_slots.size())
+            {
+                return false;
+            }
+            m_slots[head & m_mask] = value;
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Copy out the oldest element (consumer only)
+         * @return false if the ring is empty
+         */
+        bool pop(T &value)
+        {
+            uint64_t tail = m_tail.load(std::memory_order_relaxed);
+            if (tail == m_head.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            value = m_slots[tail & m_mask];
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Elements waiting (exact for producer and consumer, a snapshot for others)
+         */
+        size_t size() const
+        {
+            return static_cast<size_t>(m_head.load(std::memory_order_acquire) -
+                                       m_tail.load(std::memory_order_acquire));
+        }
+
+        bool empty() const { return size() == 0; }
+        size_t capacity() const { return m_slots.size(); }
+
+    private:
+        static size_t roundUp(size_t capacity)
+        {
+            size_t size = 1;
+            while (size < capacity)
+            {
+                size <<= 1;
+            }
+            return size;
+        }
+
+        static constexpr size_t CACHE_LINE = 64;
+
+        std::vector<T> m_slots;
+        size_t m_mask;
+        char m_padShared[CACHE_LINE];
+        std::atomic<uint64_t> m_head; ///< Next slot to write, producer
+        char m_padHead[CACHE_LINE - sizeof(std::atomic<uint64_t>)];
+        std::atomic<uint64_t> m_tail; ///< Next slot to read, consumer
+        char m_padTail[CACHE_LINE - sizeof(std::atomic<uint64_t>)];
+    };
+
+} // namespace Wallbox
+
+#endif // SPSC_RING_H
@@ -12,7 +12,9 @@
 #include <string>
 #include <thread>
 #include <atomic>
+#include <memory>
 #include <arpa/inet.h>
+#include <netinet/in.h>
 #include <sys/socket.h>
 
 namespace Wallbox
@@ -20,6 +22,21 @@ namespace Wallbox
 
     /**
      * @brief UDP implementation of network communicator
+     *
+     * The receive thread blocks in poll() on the socket and a wakeup
+     * eventfd, so it costs no CPU while idle and handles a datagram as soon
+     * as it arrives. Queued datagrams are drained in batches with
+     * recvmmsg(); stopReceiving() signals the eventfd to end the thread.
+     *
+     * The recvmmsg() batch buffers are allocated once and reused as a ring:
+     * span callbacks see the datagram in place, so the path from socket to
+     * handler performs no heap allocation. Instead of the receive thread,
+     * an event loop may poll receiveFd() and drain it with receivePending().
+     *
+     * The destination (IP address or hostname) is resolved once in
+     * connect(). With connectedSocket the socket is also connect()ed to it:
+     * sends skip the per-packet route lookup, but the kernel then only
+     * delivers datagrams coming from exactly that address and port.
      */
     class UdpCommunicator : public INetworkCommunicator
     {
@@ -28,29 +45,50 @@ namespace Wallbox
          * @brief Construct UDP communicator
          * @param listenPort Local port to listen on
          * @param sendPort Remote port to send to
-         * @param sendAddress Destination IP address
+         * @param sendAddress Destination IP address or hostname
+         * @param connectedSocket connect() the socket to the destination
          */
-        UdpCommunicator(int listenPort, int sendPort, const std::string &sendAddress);
+        UdpCommunicator(int listenPort, int sendPort, const std::string &sendAddress,
+                        bool connectedSocket = false);
         ~UdpCommunicator() override;
 
         // INetworkCommunicator interface implementation
+
+        /**
+         * @brief Open, bind and (optionally) connect the socket
+         * @return false on error or if already connected (call disconnect() first)
+         */
         bool connect() override;
         void disconnect() override;
         bool send(const std::vector<uint8_t> &data) override;
+        bool send(ByteSpan data) override;
+        bool sendBatch(const ByteSpan *messages, size_t count) override;
         void startReceiving(MessageCallback callback) override;
+        void startReceiving(SpanCallback callback) override;
         void stopReceiving() override;
         bool isConnected() const override;
+        int receiveFd() const override { return m_socketFd; }
+        int receivePending(const SpanCallback &callback) override;
 
     private:
+        struct ReceiveBatch;
+
         int m_listenPort;
         int m_sendPort;
         std::string m_sendAddress;
+        bool m_connectedSocket;
+        sockaddr_in m_destination; ///< Resolved once in connect()
         int m_socketFd;
-        bool m_running;
-        MessageCallback m_messageCallback;
+        int m_wakeFd; ///< eventfd that interrupts poll() on shutdown
+        std::atomic<bool> m_running;
+        SpanCallback m_messageCallback;
         std::thread m_receiveThread;
+        std::unique_ptr<ReceiveBatch> m_batch; ///< recvmmsg() buffers, allocated on first receive
 
+        bool resolveDestination();
+        int receiveBatch(const SpanCallback &callback);
         void receiveLoop();
+        void wakeReceiveThread();
     };
 
 } // namespace Wallbox
@@ -0,0 +1,56 @@
+#ifndef VERSIONED_RESOURCE_H
+#define VERSIONED_RESOURCE_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace Wallbox
+{
+
+    /**
+     * @brief One immutable version of a resource body
+     */
+    struct ResourceVersion
+    {
+        uint64_t version;
+        std::string etag; ///< Quoted strong validator, e.g. "\"42\""
+        std::string body;
+    };
+
+    /**
+     * @brief Pre-rendered resource served by version (ETag / long-poll)
+     *
+     * The owner publishes a new body whenever the underlying data changes;
+     * readers take the current version with a single atomic shared_ptr load
+     * and never block the publisher. HttpApiServer::registerVersionedResource()
+     * answers GET requests from it directly: If-None-Match gets 304 and
+     * ?since=<version> waits on the event loop until the next publish().
+     *
+     * publish() must not be called concurrently for the same resource;
+     * versions are expected to increase.
+     */
+    class VersionedResource
+    {
+    public:
+        using Snapshot = std::shared_ptr<const ResourceVersion>;
+
+        VersionedResource();
+
+        void publish(uint64_t version, const std::string &body);
+
+        Snapshot get() const { return std::atomic_load(&m_current); }
+
+        void setNotifier(std::function<void()> notifier);
+
+    private:
+        Snapshot m_current;
+        std::function<void()> m_notifier;
+        std::mutex m_notifierMutex;
+    };
+
+} // namespace Wallbox
+
+#endif // VERSIONED_RESOURCE_H
@@ -5,14 +5,80 @@
 #include "INetworkCommunicator.h"
 #include "ChargingStateMachine.h"
 #include "ICpSignalReader.h"
+#include "JsonWriter.h"
+#include "EventLoop.h"
 #include "../../external/LibPubWallbox/IsoStackCtrlProtocol.h"
 #include <memory>
 #include <string>
 #include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <vector>
 
 namespace Wallbox
 {
 
+    /**
+     * @brief Callback for controller events pushed to clients
+     * @param event Event name: "state", "relay" or "cp"
+     * @param data JSON object describing the change, including the full status
+     */
+    using WallboxEventCallback = std::function<void(const std::string &event, const std::string &data)>;
+
+    /**
+     * @brief Immutable view of the controller status at one version
+     *
+     * Rebuilt only when state, relay or enable changes; readers share it
+     * without locking. The JSON bodies are pre-rendered for the API.
+     */
+    struct StatusSnapshot
+    {
+        uint64_t version; ///< Increases by one per change, from a per-boot epoch (never reused across restarts)
+        ChargingState state;
+        bool wallboxEnabled;
+        bool relayEnabled;
+        bool charging;
+        std::time_t timestamp;  ///< Time of the change that produced this version
+        std::string statusJson; ///< Body of GET /api/status
+        std::string relayJson;  ///< Body of GET /api/relay
+    };
+
+    using StatusSnapshotPtr = std::shared_ptr<const StatusSnapshot>;
+
+    /**
+     * @brief Callback for new status snapshots
+     */
+    using StatusSnapshotCallback = std::function<void(const StatusSnapshotPtr &snapshot)>;
+
+    /**
+     * @brief GPIO output counters
+     */
+    struct GpioWriteStats
+    {
+        uint64_t writes;      ///< Pin writes that reached the GPIO controller
+        uint64_t writesSaved; ///< Pin writes skipped because the pin already had that level
+    };
+
+    /**
+     * @brief Time from a CP state change until the outputs have followed it
+     *
+     * Measured from the first sample of the new CP state (the kernel edge
+     * timestamp with edge events) until the state machine, relay and LEDs
+     * have been updated on the controller loop.
+     */
+    struct CpLatencyStats
+    {
+        uint64_t count;
+        uint64_t lastNs;
+        uint64_t maxNs;
+        uint64_t totalNs;
+
+        uint64_t meanNs() const { return count == 0 ? 0 : totalNs / count; }
+    };
+
     /**
      * @brief Main controller for the wallbox system
      *
@@ -28,6 +94,17 @@ namespace Wallbox
      * - Dependency Inversion: Depends on abstractions (interfaces)
      * - Open/Closed: Extensible through interface implementations
      *
+     * run() is a single event loop: simulator datagrams, CP changes, status
+     * heartbeat and LED blink timers are all events on it, and the thread
+     * sleeps while none is pending. Status goes to the simulator as soon as
+     * it changes and otherwise every status_heartbeat_ms.
+     *
+     * The loop thread is the only one that changes controller state (relay,
+     * enable flag, state machine, outputs). The public control methods may
+     * be called from any thread: they are queued as commands on the loop's
+     * lock-free queue and wait for their result; submit() queues a command
+     * without waiting. Queries read the immutable status snapshot.
+     *
      * Note: Pin definitions moved to Configuration class for centralization
      */
     class WallboxController
@@ -48,23 +125,45 @@ namespace Wallbox
         void shutdown();
         bool isRunning() const { return m_running; }
 
-        // Main control loop
+        /**
+         * @brief Run the controller loop until stop() (blocks)
+         *
+         * Must be called after initialize() and return before shutdown().
+         */
         void run();
+
+        /**
+         * @brief Make run() return; safe from any thread and signal handlers
+         */
         void stop();
 
-        // Charging control
+        using Command = std::function<bool()>;
+        using CommandCallback = std::function<void(bool result)>;
+
+        /**
+         * @brief Queue a command for the controller loop
+         * @return Future for the command's result
+         */
+        std::future<bool> submit(Command command);
+
+        /**
+         * @brief Queue a command; done is called with the result on the loop thread
+         */
+        void submit(Command command, CommandCallback done);
+
+        // Charging control (thread-safe, run as commands on the loop)
         bool startCharging();
         bool stopCharging();
         bool pauseCharging();
         bool resumeCharging();
 
-        // State queries
+        // State queries (from the status snapshot)
         ChargingState getCurrentState() const;
         std::string getStateString() const;
-        bool isRelayEnabled() const { return m_relayEnabled; }
-        bool isWallboxEnabled() const { return m_wallboxEnabled; }
+        bool isRelayEnabled() const { return getStatusSnapshot()->relayEnabled; }
+        bool isWallboxEnabled() const { return getStatusSnapshot()->wallboxEnabled; }
 
-        // System control
+        // System control (thread-safe, run as commands on the loop)
         bool enableWallbox();
         bool disableWallbox();
         bool setRelayState(bool enabled);
@@ -72,28 +171,142 @@ namespace Wallbox
         // API for external control (React app, etc.)
         std::string getStatusJson() const;
 
+        /**
+         * @brief Append the status JSON to a reusable buffer (no temporary string)
+         */
+        void appendStatusJson(std::string &buffer) const;
+
+        /**
+         * @brief Current status snapshot (lock-free, never null)
+         */
+        StatusSnapshotPtr getStatusSnapshot() const { return std::atomic_load(&m_snapshot); }
+
+        /**
+         * @brief Register for new status snapshots
+         *
+         * The callback is invoked once immediately with the current snapshot,
+         * then for every new version, in version order. It must not block.
+         */
+        void addSnapshotListener(StatusSnapshotCallback callback);
+
+        /**
+         * @brief Register for state, relay and CP change events
+         *
+         * Listeners run synchronously on the thread that caused the change
+         * and must not block.
+         */
+        void addEventListener(WallboxEventCallback callback);
+
+        /**
+         * @brief Output write counters (LED pattern diffing)
+         */
+        GpioWriteStats getGpioWriteStats() const;
+
+        /**
+         * @brief CP state filter counters (suppressed transitions)
+         */
+        CpFilterStats getCpFilterStats() const;
+
+        /**
+         * @brief Delivery counters of the asynchronous state change listeners
+         */
+        ListenerStats getStateDispatchStats() const;
+
+        /**
+         * @brief CP change to output update latency
+         */
+        CpLatencyStats getCpLatencyStats() const;
+
     private:
+        /**
+         * @brief Last level written to an output pin
+         */
+        struct PinShadow
+        {
+            int pin;
+            bool known; ///< False until written successfully
+            bool high;
+        };
+
         // Dependencies (Dependency Injection)
         std::unique_ptr<IGpioController> m_gpio;
         std::unique_ptr<INetworkCommunicator> m_network;
         std::unique_ptr<ChargingStateMachine> m_stateMachine;
         std::unique_ptr<ICpSignalReader> m_cpReader;
 
-        // State
+        // State (loop thread only, see class comment)
         std::atomic<bool> m_running;
+        std::atomic<bool> m_shutDown; ///< shutdown() has run since the last initialize()
         bool m_relayEnabled;
         bool m_wallboxEnabled;
         CpState m_currentCpState;
         std::string m_operatingMode;
+        std::vector<WallboxEventCallback> m_eventListeners;
+        std::mutex m_eventListenerMutex;
+        StatusSnapshotPtr m_snapshot; ///< Accessed with std::atomic_load/atomic_store
+        std::vector<StatusSnapshotCallback> m_snapshotListeners;
+        std::mutex m_snapshotMutex; ///< Serializes snapshot rebuilds and listener calls
+        std::vector<PinShadow> m_pinShadow;     ///< Output levels as last written
+        std::vector<PinWrite> m_pendingLeds;    ///< LED pattern staged by updateLeds()
+        std::vector<PinWrite> m_changedOutputs; ///< Scratch list of writes that reach the hardware
+        std::mutex m_outputMutex;               ///< Guards the output vectors, serializes GPIO writes
+        std::atomic<uint64_t> m_gpioWrites;
+        std::atomic<uint64_t> m_gpioWritesSaved;
+        PinValue m_buttonLevel;  ///< Last reported button level (GPIO edge thread only)
+        uint64_t m_lastButtonNs; ///< Time of the last reported button edge
+
+        // Controller loop
+        EventLoop m_loop;
+        int m_heartbeatTimer;                  ///< Re-armed by every status send
+        int m_blinkTimer;                      ///< Toggles m_blinkOn for blinking LED patterns
+        uint32_t m_heartbeatMs;
+        std::atomic<uint32_t> m_blinkIntervalMs; ///< Current blink period, 0 when no LED blinks
+        std::atomic<bool> m_blinkOn;
+        std::atomic<bool> m_statusSendPending; ///< A status send is already posted to the loop
+        INetworkCommunicator::SpanCallback m_onMessage;
+        std::atomic<uint64_t> m_cpLatencyCount;
+        std::atomic<uint64_t> m_cpLatencyLastNs;
+        std::atomic<uint64_t> m_cpLatencyMaxNs;
+        std::atomic<uint64_t> m_cpLatencyTotalNs;
+        bool m_journalOpened; ///< This controller opened the EventJournal and closes it
+
+        /**
+         * @brief Run a command on the loop thread and wait for its result
+         *
+         * Runs inline when already on the loop thread; while the loop is
+         * not running the calling thread drains the command queue itself.
+         */
+        bool execute(Command command);
+
+        // Command implementations (loop thread)
+        bool startChargingOnLoop();
+        bool stopChargingOnLoop();
+        bool pauseChargingOnLoop();
+        bool resumeChargingOnLoop();
+        bool enableWallboxOnLoop();
+        bool disableWallboxOnLoop();
+        bool setRelayStateOnLoop(bool enabled);
 
         // Private methods
         void setupGpio();
         void updateLeds();
         void sendStatusToSimulator();
-        void processNetworkMessage(const std::vector<uint8_t> &message);
+        void requestStatusSend();
+        void recordCpLatency(uint64_t changeNs);
+        uint32_t blinkIntervalFor(ChargingState state) const;
+        void processNetworkMessage(ByteSpan message);
         void onStateChange(ChargingState oldState, ChargingState newState, const std::string &reason);
         void onCpStateChange(CpState oldState, CpState newState);
         void mapCpStateToChargingState(CpState cpState);
+        void refreshSnapshot();
+        void notifyEvent(const std::string &event, const std::string &data);
+        void onButtonEdge(const PinEvent &event);
+
+        // Output control
+        bool writeOutputs(const PinWrite *writes, size_t count);
+        bool writeOutputsLocked(const PinWrite *writes, size_t count);
+        PinShadow &shadowFor(int pin);
+        void flushLeds();
 
         // LED control
         void setLedState(int pin, bool on);
@@ -0,0 +1,71 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Wallbox
+{
+
+    /**
+     * @brief Fixed-size thread pool with a bounded task queue
+     *
+     * Threads are created once in start() and reused for every task, so
+     * the cost of a request no longer includes thread creation. The queue
+     * is bounded: trySubmit() refuses work instead of growing without limit,
+     * which lets the caller apply backpressure (e.g. answer 503).
+     *
+     * Design Pattern: Thread Pool
+     */
+    class WorkerPool
+    {
+    public:
+        using Task = std::function<void()>;
+
+        /**
+         * @brief Construct worker pool
+         * @param threadCount Number of worker threads (at least 1)
+         * @param maxQueuedTasks Maximum number of tasks waiting for a worker
+         */
+        WorkerPool(size_t threadCount, size_t maxQueuedTasks);
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool &) = delete;
+        WorkerPool &operator=(const WorkerPool &) = delete;
+
+        void start();
+
+        /**
+         * @brief Stop accepting tasks, finish queued ones and join all threads
+         */
+        void stop();
+
+        /**
+         * @brief Queue a task for execution
+         * @return false if the pool is stopped or the queue is full
+         */
+        bool trySubmit(Task task);
+
+        size_t getThreadCount() const { return m_threadCount; }
+        size_t getQueuedTasks() const;
+
+    private:
+        size_t m_threadCount;
+        size_t m_maxQueuedTasks;
+        bool m_running;
+        std::deque<Task> m_tasks;
+        std::vector<std::thread> m_threads;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_condition;
+
+        void workerLoop();
+    };
+
+} // namespace Wallbox
+
+#endif // WORKER_POOL_H
@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+"""
+Compare two Google Benchmark JSON reports (wallbox_bench --benchmark_out=...).
+
+Usage:
+    compare_benchmarks.py baseline.json current.json [--threshold 10]
+
+Prints the change in real time per benchmark and exits with 1 if any
+benchmark got slower by more than the threshold (percent). With repeated
+runs (--benchmark_repetitions) the median aggregate is compared.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        report = json.load(f)
+
+    results = {}
+    for bench in report.get("benchmarks", []):
+        if bench.get("error_occurred"):
+            continue
+        aggregate = bench.get("aggregate_name")
+        if aggregate not in (None, "median"):
+            continue
+        name = bench.get("run_name", bench["name"])
+        # Prefer the median over single iterations of the same benchmark
+        if aggregate == "median" or name not in results:
+            results[name] = (bench["real_time"], bench.get("time_unit", "ns"))
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two benchmark JSON reports")
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="Slowdown in percent that counts as a regression (default 10)")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+
+    regressions = []
+    width = max([len(name) for name in current] + [9])
+    print(f"{'Benchmark':<{width}}  {'Baseline':>12}  {'Current':>12}  {'Change':>8}")
+    for name, (time, unit) in current.items():
+        if name not in baseline:
+            print(f"{name:<{width}}  {'-':>12}  {time:>9.1f} {unit:<2}  {'new':>8}")
+            continue
+        before, before_unit = baseline[name]
+        if before_unit != unit or before <= 0:
+            continue
+        change = (time - before) / before * 100.0
+        marker = " <--" if change > args.threshold else ""
+        print(f"{name:<{width}}  {before:>9.1f} {unit:<2}  {time:>9.1f} {unit:<2}  {change:>+7.1f}%{marker}")
+        if change > args.threshold:
+            regressions.append(name)
+
+    for name in baseline:
+        if name not in current:
+            print(f"{name:<{width}}  (missing in current run)")
+
+    if regressions:
+        print(f"\n{len(regressions)} benchmark(s) slower by more than {args.threshold:g}%")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
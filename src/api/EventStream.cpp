@@ -0,0 +1,90 @@
+#include "EventStream.h"
+
+namespace Wallbox
+{
+
+    EventStream::EventStream(size_t replayCapacity)
+        : m_replayCapacity(replayCapacity),
+          m_nextId(1)
+    {
+    }
+
+    uint64_t EventStream::publish(const std::string &event, const std::string &data)
+    {
+        std::function<void()> notifier;
+        uint64_t id;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            id = m_nextId++;
+
+            // Serialized once; all subscribers send the same bytes
+            std::string text;
+            text.reserve(event.size() + data.size() + 40);
+            text += "id: ";
+            text += std::to_string(id);
+            text += "\nevent: ";
+            text += event;
+            text += "\ndata: ";
+            text += data;
+            text += "\n\n";
+            Frame frame = std::make_shared<const EventFrame>(EventFrame{id, std::move(text)});
+
+            m_replay.push_back(frame);
+            if (m_replay.size() > m_replayCapacity)
+            {
+                m_replay.pop_front();
+            }
+            // Nothing drains the pending list until a server is attached
+            if (m_notifier)
+            {
+                m_pending.push_back(std::move(frame));
+                notifier = m_notifier;
+            }
+        }
+
+        if (notifier)
+        {
+            notifier();
+        }
+        return id;
+    }
+
+    void EventStream::replaySince(uint64_t lastEventId, std::vector<Frame> &frames) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // An id from the future means ids restarted with the process: replay everything
+        if (lastEventId >= m_nextId)
+        {
+            lastEventId = 0;
+        }
+
+        for (const auto &frame : m_replay)
+        {
+            if (frame->id > lastEventId)
+            {
+                frames.push_back(frame);
+            }
+        }
+    }
+
+    void EventStream::takePending(std::vector<Frame> &frames)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        frames.swap(m_pending);
+        m_pending.clear();
+    }
+
+    void EventStream::setNotifier(std::function<void()> notifier)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_notifier = std::move(notifier);
+    }
+
+    uint64_t EventStream::getLastEventId() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_nextId - 1;
+    }
+
+} // namespace Wallbox
@@ -1,18 +1,176 @@
 #include "HttpApiServer.h"
+#include "Metrics.h"
+#include <algorithm>
 #include <iostream>
-#include <sstream>
 #include <cstring>
 #include <cerrno>
+#include <cstdlib>
+#include <chrono>
+#include <deque>
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
 namespace Wallbox
 {
 
+    namespace
+    {
+        constexpr int MAX_EPOLL_EVENTS = 64;
+        constexpr size_t READ_CHUNK_SIZE = 4096;
+        constexpr int IDLE_SWEEP_INTERVAL_MS = 1000;
+        constexpr int EVENT_STREAM_HEARTBEAT_MS = 15000;
+        constexpr size_t MAX_QUEUED_EVENT_FRAMES = 256;
+
+        bool setNonBlocking(int fd)
+        {
+            int flags = fcntl(fd, F_GETFL, 0);
+            return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+        }
+
+        // epoll user data: connection id in the upper half guards against fd reuse
+        // within one batch of events; the listen socket and eventfd use id 0
+        uint64_t makeEventData(int fd, uint64_t connectionId)
+        {
+            return (connectionId << 32) | static_cast<uint32_t>(fd);
+        }
+
+        Counter &responseCounter(int statusCode)
+        {
+            static Counter *classes[] = {
+                &MetricsRegistry::instance().counter("wallbox_http_responses_total", "HTTP responses by status class", {{"code", "1xx"}}),
+                &MetricsRegistry::instance().counter("wallbox_http_responses_total", "HTTP responses by status class", {{"code", "2xx"}}),
+                &MetricsRegistry::instance().counter("wallbox_http_responses_total", "HTTP responses by status class", {{"code", "3xx"}}),
+                &MetricsRegistry::instance().counter("wallbox_http_responses_total", "HTTP responses by status class", {{"code", "4xx"}}),
+                &MetricsRegistry::instance().counter("wallbox_http_responses_total", "HTTP responses by status class", {{"code", "5xx"}})};
+            int index = statusCode / 100 - 1;
+            return *classes[index < 0 ? 4 : (index > 4 ? 4 : index)];
+        }
+
+        const char *statusText(int statusCode)
+        {
+            switch (statusCode)
+            {
+            case 200:
+                return "OK";
+            case 201:
+                return "Created";
+            case 204:
+                return "No Content";
+            case 304:
+                return "Not Modified";
+            case 400:
+                return "Bad Request";
+            case 404:
+                return "Not Found";
+            case 405:
+                return "Method Not Allowed";
+            case 413:
+                return "Payload Too Large";
+            case 431:
+                return "Request Header Fields Too Large";
+            case 500:
+                return "Internal Server Error";
+            case 501:
+                return "Not Implemented";
+            case 503:
+                return "Service Unavailable";
+            default:
+                return "Unknown";
+            }
+        }
+
+        uint64_t parseUnsigned(StringRef text)
+        {
+            uint64_t value = 0;
+            for (size_t i = 0; i < text.size && text.data[i] >= '0' && text.data[i] <= '9'; ++i)
+            {
+                value = value * 10 + static_cast<uint64_t>(text.data[i] - '0');
+            }
+            return value;
+        }
+
+        // If-None-Match may list several tags or use weak ones (W/"7"); the quoted tag is enough
+        bool etagMatches(StringRef ifNoneMatch, const std::string &etag)
+        {
+            if (ifNoneMatch == "*")
+            {
+                return true;
+            }
+            const char *end = ifNoneMatch.data + ifNoneMatch.size;
+            return std::search(ifNoneMatch.data, end, etag.begin(), etag.end()) != end;
+        }
+
+        void fillFromSnapshot(HttpResponse &response, const VersionedResource::Snapshot &snapshot, bool notModified)
+        {
+            response.etag = snapshot->etag;
+            if (notModified)
+            {
+                response.statusCode = 304;
+                response.body.clear();
+            }
+            else
+            {
+                response.statusCode = 200;
+                response.body = snapshot->body;
+            }
+        }
+    } // namespace
+
+    /**
+     * @brief Per-client state, owned and touched only by the event loop thread
+     */
+    struct HttpApiServer::Connection
+    {
+        int fd = -1;
+        uint64_t id = 0;
+        std::string input; // Receive buffer, reused for every request on this connection
+        std::string output;
+        size_t outputOffset = 0;
+        HttpRequestParser parser;
+        HttpRequest request;          // Slices into input, valid while busy
+        bool busy = false;            // A worker is handling a request
+        bool readPending = false;     // Input arrived while busy; read it after completion
+        bool closePending = false;    // Close requested while busy; close after completion
+        bool closeAfterWrite = false; // Close once output is flushed
+        bool peerClosed = false;      // Client sent FIN; finish pipelined work, then close
+        size_t requestsServed = 0;
+        std::chrono::steady_clock::time_point lastActivity;
+
+        // Server-Sent Events subscription (stream != nullptr)
+        EventStream *stream = nullptr;
+        uint64_t lastEventId = 0; // Newest frame queued, skips duplicates from replay
+        std::deque<EventStream::Frame> frames;
+        size_t frameOffset = 0;
+
+        // Long-poll on a versioned resource (watching != nullptr)
+        VersionedResource *watching = nullptr;
+        uint64_t watchVersion = 0;
+        bool watchKeepAlive = false;
+        std::chrono::steady_clock::time_point watchDeadline;
+
+        explicit Connection(const HttpParserLimits &limits) : parser(limits) {}
+    };
+
     HttpApiServer::HttpApiServer(int port)
-        : m_port(port), m_serverSocket(-1), m_running(false)
+        : HttpApiServer(port, HttpServerConfig())
+    {
+    }
+
+    HttpApiServer::HttpApiServer(int port, const HttpServerConfig &config)
+        : m_port(port),
+          m_config(config),
+          m_serverSocket(-1),
+          m_epollFd(-1),
+          m_wakeFd(-1),
+          m_running(false),
+          m_nextConnectionId(1),
+          m_acceptPaused(false),
+          m_workers(config.workerThreads, config.maxQueuedRequests)
     {
     }
 
@@ -64,8 +222,9 @@ namespace Wallbox
             return false;
         }
 
-        // Listen
-        if (listen(m_serverSocket, 10) < 0)
+        // Listen; the backlog holds clients while accept() is paused at the connection cap
+        if (listen(m_serverSocket, static_cast<int>(m_config.maxConnections)) < 0 ||
+            !setNonBlocking(m_serverSocket))
         {
             std::cerr << "Failed to listen on HTTP server socket" << std::endl;
             close(m_serverSocket);
@@ -73,248 +232,943 @@ namespace Wallbox
             return false;
         }
 
+        // Event loop: epoll for sockets, eventfd for worker completions and shutdown
+        m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+        m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (m_epollFd < 0 || m_wakeFd < 0)
+        {
+            std::cerr << "Failed to create HTTP event loop: " << strerror(errno) << std::endl;
+            stop();
+            return false;
+        }
+
+        epoll_event listenEvent{};
+        listenEvent.events = EPOLLIN | EPOLLET;
+        listenEvent.data.u64 = makeEventData(m_serverSocket, 0);
+        epoll_event wakeEvent{};
+        wakeEvent.events = EPOLLIN | EPOLLET;
+        wakeEvent.data.u64 = makeEventData(m_wakeFd, 0);
+        if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_serverSocket, &listenEvent) < 0 ||
+            epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &wakeEvent) < 0)
+        {
+            std::cerr << "Failed to register HTTP sockets with epoll: " << strerror(errno) << std::endl;
+            stop();
+            return false;
+        }
+
+        m_workers.start();
         m_running = true;
         m_serverThread = std::thread([this]()
                                      { serverLoop(); });
 
-        std::cout << "HTTP API Server started on port " << m_port << std::endl;
+        std::cout << "HTTP API Server started on port " << m_port
+                  << " (" << m_workers.getThreadCount() << " workers, max "
+                  << m_config.maxConnections << " connections)" << std::endl;
         std::cout << "React app can connect to: http://localhost:" << m_port << std::endl;
         return true;
     }
 
     void HttpApiServer::stop()
     {
-        if (!m_running)
+        bool wasRunning = m_running.exchange(false);
+
+        if (m_serverThread.joinable())
         {
-            return;
+            wakeEventLoop();
+            m_serverThread.join();
         }
 
-        m_running = false;
+        for (auto &stream : m_eventStreams)
+        {
+            stream->setNotifier(nullptr);
+        }
+        for (auto &resource : m_resources)
+        {
+            resource->setNotifier(nullptr);
+        }
+
+        // Let in-flight handlers finish; their completions are discarded below
+        m_workers.stop();
+        closeAllConnections();
+        m_completions.clear();
 
         if (m_serverSocket >= 0)
         {
             close(m_serverSocket);
             m_serverSocket = -1;
         }
+        if (m_wakeFd >= 0)
+        {
+            close(m_wakeFd);
+            m_wakeFd = -1;
+        }
+        if (m_epollFd >= 0)
+        {
+            close(m_epollFd);
+            m_epollFd = -1;
+        }
 
-        if (m_serverThread.joinable())
+        if (wasRunning)
         {
-            m_serverThread.join();
+            std::cout << "HTTP API Server stopped" << std::endl;
         }
+    }
+
+    void HttpApiServer::registerRoute(HttpMethod method, const std::string &path, HttpHandler handler)
+    {
+        // Labelled by the route pattern, not the request path, so the number of series stays fixed
+        std::string methodName = httpMethodToString(method);
+        Counter &requests = MetricsRegistry::instance().counter(
+            "wallbox_http_requests_total", "HTTP requests by route", {{"method", methodName}, {"route", path}});
+        Histogram &duration = MetricsRegistry::instance().histogram(
+            "wallbox_http_request_duration_seconds", "Time spent in route handlers", {{"method", methodName}, {"route", path}});
+
+        HttpHandler timed = [handler, &requests, &duration](const HttpRequest &req, HttpResponse &res)
+        {
+            requests.inc();
+            auto start = std::chrono::steady_clock::now();
+            try
+            {
+                handler(req, res);
+            }
+            catch (...)
+            {
+                duration.observe(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                           std::chrono::steady_clock::now() - start)
+                                                           .count()));
+                throw;
+            }
+            duration.observe(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                       std::chrono::steady_clock::now() - start)
+                                                       .count()));
+        };
 
-        std::cout << "HTTP API Server stopped" << std::endl;
+        if (m_router.add(method, path, std::move(timed)))
+        {
+            std::cout << "Registered route: " << httpMethodToString(method) << " " << path << std::endl;
+        }
     }
 
     void HttpApiServer::registerRoute(const std::string &method, const std::string &path, HttpHandler handler)
     {
-        m_routes[method][path] = handler;
-        std::cout << "Registered route: " << method << " " << path << std::endl;
+        registerRoute(parseHttpMethod(StringRef(method.data(), method.size())), path, std::move(handler));
     }
 
     void HttpApiServer::GET(const std::string &path, HttpHandler handler)
     {
-        registerRoute("GET", path, handler);
+        registerRoute(HttpMethod::GET, path, std::move(handler));
     }
 
     void HttpApiServer::POST(const std::string &path, HttpHandler handler)
     {
-        registerRoute("POST", path, handler);
+        registerRoute(HttpMethod::POST, path, std::move(handler));
     }
 
     void HttpApiServer::PUT(const std::string &path, HttpHandler handler)
     {
-        registerRoute("PUT", path, handler);
+        registerRoute(HttpMethod::PUT, path, std::move(handler));
     }
 
     void HttpApiServer::DELETE(const std::string &path, HttpHandler handler)
     {
-        registerRoute("DELETE", path, handler);
+        registerRoute(HttpMethod::DELETE, path, std::move(handler));
+    }
+
+    void HttpApiServer::registerEventStream(const std::string &path, std::shared_ptr<EventStream> stream)
+    {
+        EventStream *target = stream.get();
+        target->setNotifier([this]()
+                            { wakeEventLoop(); });
+        m_eventStreams.push_back(std::move(stream));
+
+        registerRoute(HttpMethod::GET, path, [target](const HttpRequest &, HttpResponse &res)
+                      { res.openEventStream(*target); });
+    }
+
+    void HttpApiServer::registerVersionedResource(const std::string &path, std::shared_ptr<VersionedResource> resource)
+    {
+        VersionedResource *target = resource.get();
+        target->setNotifier([this]()
+                            { wakeEventLoop(); });
+        m_resources.push_back(std::move(resource));
+
+        registerRoute(HttpMethod::GET, path, [target](const HttpRequest &, HttpResponse &res)
+                      { res.serveResource(*target); });
     }
 
     void HttpApiServer::serverLoop()
     {
+        epoll_event events[MAX_EPOLL_EVENTS];
+        auto lastIdleSweep = std::chrono::steady_clock::now();
+
         while (m_running)
         {
-            sockaddr_in clientAddr{};
-            socklen_t clientLen = sizeof(clientAddr);
+            // Only wake periodically while there are connections that could go idle
+            int timeoutMs = m_connections.empty() ? -1 : IDLE_SWEEP_INTERVAL_MS;
+            int count = epoll_wait(m_epollFd, events, MAX_EPOLL_EVENTS, timeoutMs);
+            if (count < 0)
+            {
+                if (errno != EINTR)
+                {
+                    std::cerr << "HTTP event loop error: " << strerror(errno) << std::endl;
+                }
+                continue;
+            }
+
+            for (int i = 0; i < count && m_running; ++i)
+            {
+                int fd = static_cast<int>(events[i].data.u64 & 0xFFFFFFFFu);
+                uint64_t connectionId = events[i].data.u64 >> 32;
+                uint32_t flags = events[i].events;
+
+                if (fd == m_serverSocket)
+                {
+                    acceptConnections();
+                    continue;
+                }
 
-            int clientSocket = accept(m_serverSocket, (struct sockaddr *)&clientAddr, &clientLen);
+                if (fd == m_wakeFd)
+                {
+                    uint64_t value;
+                    while (read(m_wakeFd, &value, sizeof(value)) > 0)
+                    {
+                    }
+                    processCompletions();
+                    deliverEvents();
+                    deliverResourceChanges();
+                    continue;
+                }
+
+                auto it = m_connections.find(fd);
+                if (it == m_connections.end() || it->second->id != connectionId)
+                {
+                    continue;
+                }
+                Connection &connection = *it->second;
+                if (connection.closePending)
+                {
+                    continue;
+                }
+
+                if (flags & (EPOLLERR | EPOLLHUP))
+                {
+                    closeConnection(fd);
+                    continue;
+                }
+                if ((flags & EPOLLRDHUP) && (connection.busy || connection.watching != nullptr))
+                {
+                    // Gone during a handler or a parked long-poll: free the slot now
+                    // instead of holding it until the answer goes to a dead socket
+                    closeConnection(fd);
+                    continue;
+                }
+                if ((flags & EPOLLOUT) && !flushOutput(connection))
+                {
+                    continue;
+                }
+                if (flags & EPOLLIN)
+                {
+                    readFromConnection(connection);
+                }
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            if (now - lastIdleSweep >= std::chrono::milliseconds(IDLE_SWEEP_INTERVAL_MS))
+            {
+                closeIdleConnections();
+                lastIdleSweep = now;
+            }
+        }
+    }
+
+    void HttpApiServer::acceptConnections()
+    {
+        // Edge-triggered: accept until the backlog is empty or the cap is reached
+        while (m_connections.size() < m_config.maxConnections)
+        {
+            int clientSocket = accept4(m_serverSocket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
             if (clientSocket < 0)
             {
-                if (m_running)
+                if (errno == EINTR || errno == ECONNABORTED)
+                {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
                 {
-                    std::cerr << "Failed to accept client connection" << std::endl;
+                    std::cerr << "Failed to accept client connection: " << strerror(errno) << std::endl;
                 }
+                m_acceptPaused = false;
+                return;
+            }
+
+            uint64_t connectionId = m_nextConnectionId++;
+            epoll_event event{};
+            event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+            event.data.u64 = makeEventData(clientSocket, connectionId);
+            if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, clientSocket, &event) < 0)
+            {
+                std::cerr << "Failed to register client connection: " << strerror(errno) << std::endl;
+                close(clientSocket);
                 continue;
             }
 
-            // Handle client in a separate thread for better performance
-            std::thread([this, clientSocket]()
-                        { handleClient(clientSocket); })
-                .detach();
+            HttpParserLimits limits;
+            limits.maxHeaderBytes = m_config.maxHeaderBytes;
+            limits.maxBodyBytes = m_config.maxBodyBytes;
+            std::unique_ptr<Connection> connection(new Connection(limits));
+            connection->fd = clientSocket;
+            connection->id = connectionId;
+            connection->lastActivity = std::chrono::steady_clock::now();
+            m_connections[clientSocket] = std::move(connection);
+        }
+
+        // Backpressure: leave further clients in the kernel backlog until a slot frees up
+        m_acceptPaused = true;
+    }
+
+    void HttpApiServer::readFromConnection(Connection &connection)
+    {
+        // A worker holds slices into connection.input; growing it now could
+        // reallocate under the handler. The data waits in the socket instead,
+        // also while a long-poll is parked.
+        if (connection.busy || connection.watching != nullptr)
+        {
+            connection.readPending = true;
+            return;
+        }
+
+        while (true)
+        {
+            // Read straight into the per-connection buffer, no intermediate copy
+            size_t used = connection.input.size();
+            connection.input.resize(used + READ_CHUNK_SIZE);
+            ssize_t bytesRead = read(connection.fd, &connection.input[used], READ_CHUNK_SIZE);
+            connection.input.resize(used + (bytesRead > 0 ? static_cast<size_t>(bytesRead) : 0));
+
+            if (bytesRead > 0)
+            {
+                if (connection.input.size() > m_config.maxHeaderBytes + m_config.maxBodyBytes + READ_CHUNK_SIZE)
+                {
+                    break; // Enough to decide; the parser rejects or completes the request
+                }
+                continue;
+            }
+            if (bytesRead == 0)
+            {
+                connection.peerClosed = true;
+                break;
+            }
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                connection.peerClosed = true;
+            }
+            break;
         }
+
+        connection.lastActivity = std::chrono::steady_clock::now();
+        processInput(connection);
     }
 
-    void HttpApiServer::handleClient(int clientSocket)
+    void HttpApiServer::processInput(Connection &connection)
     {
-        char buffer[4096];
-        ssize_t bytesRead = read(clientSocket, buffer, sizeof(buffer) - 1);
+        // One request in flight per connection keeps pipelined responses in order;
+        // later requests stay buffered in connection.input until this one completes
+        if (connection.busy || connection.closeAfterWrite || connection.watching != nullptr)
+        {
+            return;
+        }
 
-        if (bytesRead > 0)
+        if (connection.stream != nullptr)
         {
-            buffer[bytesRead] = '\0';
-            std::string requestData(buffer);
+            // An SSE client has nothing more to say; only watch for it closing
+            connection.input.clear();
+            if (connection.peerClosed)
+            {
+                closeConnection(connection.fd);
+            }
+            return;
+        }
+
+        if (!connection.input.empty())
+        {
+            HttpRequestParser::Result result =
+                connection.parser.parse(&connection.input[0], connection.input.size(), connection.request);
+            if (result == HttpRequestParser::Result::Complete)
+            {
+                dispatchRequest(connection);
+                return;
+            }
+            if (result == HttpRequestParser::Result::Error)
+            {
+                HttpResponse response;
+                response.setError(connection.parser.getErrorStatus(), connection.parser.getErrorMessage());
+                connection.closeAfterWrite = true;
+                queueResponse(connection, buildResponse(response, false));
+                return;
+            }
+        }
+
+        if (connection.peerClosed && connection.output.empty())
+        {
+            closeConnection(connection.fd);
+        }
+    }
+
+    void HttpApiServer::dispatchRequest(Connection &connection)
+    {
+        int fd = connection.fd;
+        uint64_t id = connection.id;
+        bool keepAlive = m_running && !connection.peerClosed && connection.request.keepAlive &&
+                         connection.requestsServed + 1 < m_config.maxRequestsPerConnection;
+
+        // The connection outlives the task: closeConnection() defers while busy
+        HttpRequest *request = &connection.request;
+
+        connection.busy = true;
+        bool queued = m_workers.trySubmit([this, fd, id, keepAlive, request]()
+                                          {
+            Completion completion{fd, id, keepAlive, std::string(), nullptr, 0, nullptr, 0};
+            handleRequest(*request, completion);
+            {
+                std::lock_guard<std::mutex> lock(m_completionMutex);
+                m_completions.push_back(std::move(completion));
+            }
+            wakeEventLoop(); });
 
-            HttpRequest request = parseRequest(requestData);
+        if (!queued)
+        {
+            // All workers busy and queue full: shed load instead of queueing unboundedly
+            connection.busy = false;
             HttpResponse response;
+            response.setError(503, "Server busy");
+            connection.closeAfterWrite = true;
+            queueResponse(connection, buildResponse(response, false));
+        }
+    }
 
-            // Enable CORS for React app
-            enableCORS(response);
+    void HttpApiServer::processCompletions()
+    {
+        std::vector<Completion> completions;
+        {
+            std::lock_guard<std::mutex> lock(m_completionMutex);
+            completions.swap(m_completions);
+        }
 
-            // Handle OPTIONS for CORS preflight
-            if (request.method == "OPTIONS")
+        for (auto &completion : completions)
+        {
+            auto it = m_connections.find(completion.fd);
+            if (it == m_connections.end() || it->second->id != completion.connectionId)
             {
-                response.statusCode = 204;
-                response.body = "";
+                continue; // Client went away while the handler was running
             }
-            else
+
+            Connection &connection = *it->second;
+            connection.busy = false;
+            if (connection.closePending)
+            {
+                closeConnection(completion.fd);
+                continue;
+            }
+
+            // Handler is done with the slices: drop the request, keep the buffer capacity
+            connection.input.erase(0, connection.parser.getConsumed());
+            connection.parser.reset();
+            connection.requestsServed++;
+            connection.lastActivity = std::chrono::steady_clock::now();
+            if (completion.watch != nullptr)
+            {
+                // Long-poll: deliverResourceChanges() or the idle sweep answers later
+                connection.watching = completion.watch;
+                connection.watchVersion = completion.watchVersion;
+                connection.watchKeepAlive = completion.keepAlive;
+                connection.watchDeadline = connection.lastActivity +
+                                           std::chrono::milliseconds(m_config.longPollTimeoutMs);
+                continue;
+            }
+            if (!completion.keepAlive)
+            {
+                connection.closeAfterWrite = true;
+            }
+
+            if (!queueResponse(connection, std::move(completion.response)))
+            {
+                continue;
+            }
+            if (completion.stream != nullptr)
+            {
+                subscribeToStream(connection, *completion.stream, completion.lastEventId);
+                continue;
+            }
+
+            resumeInput(connection);
+        }
+    }
+
+    void HttpApiServer::resumeInput(Connection &connection)
+    {
+        // Pipelined requests already buffered, or waiting in the socket, are served next
+        if (connection.readPending)
+        {
+            connection.readPending = false;
+            readFromConnection(connection);
+        }
+        else
+        {
+            processInput(connection);
+        }
+    }
+
+    bool HttpApiServer::queueResponse(Connection &connection, std::string response)
+    {
+        if (connection.output.empty())
+        {
+            connection.output = std::move(response);
+            connection.outputOffset = 0;
+        }
+        else
+        {
+            connection.output.append(response);
+        }
+        return flushOutput(connection);
+    }
+
+    void HttpApiServer::subscribeToStream(Connection &connection, EventStream &stream, uint64_t lastEventId)
+    {
+        connection.stream = &stream;
+        connection.lastEventId = lastEventId;
+
+        std::vector<EventStream::Frame> missed;
+        stream.replaySince(lastEventId, missed);
+        for (auto &frame : missed)
+        {
+            connection.frames.push_back(std::move(frame));
+            connection.lastEventId = connection.frames.back()->id;
+        }
+        flushOutput(connection);
+    }
+
+    void HttpApiServer::deliverEvents()
+    {
+        std::vector<EventStream::Frame> frames;
+        std::vector<int> subscribers;
+
+        for (auto &stream : m_eventStreams)
+        {
+            frames.clear();
+            stream->takePending(frames);
+            if (frames.empty())
             {
-                // Find and execute handler
-                HttpHandler handler = findHandler(request.method, request.path);
-                if (handler)
+                continue;
+            }
+
+            subscribers.clear();
+            for (const auto &entry : m_connections)
+            {
+                if (entry.second->stream == stream.get() && !entry.second->closePending)
                 {
-                    try
-                    {
-                        handler(request, response);
-                    }
-                    catch (const std::exception &e)
+                    subscribers.push_back(entry.first);
+                }
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            for (int fd : subscribers)
+            {
+                auto it = m_connections.find(fd);
+                if (it == m_connections.end())
+                {
+                    continue; // Closed while flushing an earlier subscriber
+                }
+
+                Connection &connection = *it->second;
+                for (const auto &frame : frames)
+                {
+                    if (frame->id > connection.lastEventId)
                     {
-                        response.setError(500, std::string("Internal error: ") + e.what());
+                        connection.frames.push_back(frame);
+                        connection.lastEventId = frame->id;
                     }
                 }
-                else
+
+                // A client that cannot keep up is dropped; it resumes via Last-Event-ID
+                if (connection.frames.size() > MAX_QUEUED_EVENT_FRAMES)
                 {
-                    response.setError(404, "Endpoint not found: " + request.method + " " + request.path);
+                    closeConnection(fd);
+                    continue;
                 }
+                connection.lastActivity = now;
+                flushOutput(connection);
             }
+        }
+    }
 
-            // Send response
-            std::string responseStr = buildResponse(response);
-            write(clientSocket, responseStr.c_str(), responseStr.length());
+    void HttpApiServer::deliverResourceChanges()
+    {
+        std::vector<int> changed;
+        for (const auto &entry : m_connections)
+        {
+            const Connection &connection = *entry.second;
+            if (connection.watching != nullptr && !connection.closePending &&
+                connection.watching->get()->version != connection.watchVersion)
+            {
+                changed.push_back(entry.first);
+            }
         }
 
-        close(clientSocket);
+        for (int fd : changed)
+        {
+            auto it = m_connections.find(fd);
+            if (it != m_connections.end())
+            {
+                answerWatch(*it->second, false);
+            }
+        }
     }
 
-    HttpRequest HttpApiServer::parseRequest(const std::string &requestData)
+    void HttpApiServer::answerWatch(Connection &connection, bool notModified)
     {
-        HttpRequest request;
-        std::istringstream stream(requestData);
-        std::string line;
+        HttpResponse response;
+        fillFromSnapshot(response, connection.watching->get(), notModified);
 
-        // Parse request line (GET /path HTTP/1.1)
-        if (std::getline(stream, line))
+        bool keepAlive = connection.watchKeepAlive && m_running;
+        connection.watching = nullptr;
+        connection.lastActivity = std::chrono::steady_clock::now();
+        if (!keepAlive)
         {
-            std::istringstream lineStream(line);
-            lineStream >> request.method >> request.path;
+            connection.closeAfterWrite = true;
+        }
 
-            // Extract query parameters
-            size_t queryPos = request.path.find('?');
-            if (queryPos != std::string::npos)
+        if (queueResponse(connection, buildResponse(response, keepAlive)))
+        {
+            resumeInput(connection);
+        }
+    }
+
+    bool HttpApiServer::flushOutput(Connection &connection)
+    {
+        while (connection.outputOffset < connection.output.size())
+        {
+            ssize_t written = send(connection.fd,
+                                   connection.output.data() + connection.outputOffset,
+                                   connection.output.size() - connection.outputOffset,
+                                   MSG_NOSIGNAL);
+            if (written > 0)
+            {
+                connection.outputOffset += static_cast<size_t>(written);
+                continue;
+            }
+            if (written < 0 && errno == EINTR)
             {
-                std::string query = request.path.substr(queryPos + 1);
-                request.path = request.path.substr(0, queryPos);
+                continue;
+            }
+            if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                return true; // EPOLLOUT will resume the write
+            }
+
+            closeConnection(connection.fd);
+            return false;
+        }
+
+        connection.output.clear();
+        connection.outputOffset = 0;
 
-                // Parse query parameters (simplified)
-                size_t pos = 0;
-                while (pos < query.length())
+        while (!connection.frames.empty())
+        {
+            const std::string &text = connection.frames.front()->text;
+            ssize_t written = send(connection.fd,
+                                   text.data() + connection.frameOffset,
+                                   text.size() - connection.frameOffset,
+                                   MSG_NOSIGNAL);
+            if (written > 0)
+            {
+                connection.frameOffset += static_cast<size_t>(written);
+                if (connection.frameOffset == text.size())
                 {
-                    size_t eqPos = query.find('=', pos);
-                    size_t ampPos = query.find('&', pos);
-                    if (eqPos != std::string::npos)
-                    {
-                        std::string key = query.substr(pos, eqPos - pos);
-                        std::string value = query.substr(eqPos + 1,
-                                                         (ampPos != std::string::npos ? ampPos : query.length()) - eqPos - 1);
-                        request.params[key] = value;
-                    }
-                    pos = (ampPos != std::string::npos) ? ampPos + 1 : query.length();
+                    connection.frames.pop_front();
+                    connection.frameOffset = 0;
                 }
+                continue;
+            }
+            if (written < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                return true;
             }
+
+            closeConnection(connection.fd);
+            return false;
         }
 
-        // Parse headers
-        while (std::getline(stream, line) && line != "\r")
+        if (!connection.busy && connection.watching == nullptr &&
+            (connection.closeAfterWrite || (connection.peerClosed && connection.input.empty())))
+        {
+            closeConnection(connection.fd);
+            return false;
+        }
+        return true;
+    }
+
+    void HttpApiServer::closeConnection(int fd)
+    {
+        auto it = m_connections.find(fd);
+        if (it == m_connections.end())
         {
-            size_t colonPos = line.find(':');
-            if (colonPos != std::string::npos)
+            return;
+        }
+        if (it->second->busy)
+        {
+            // A worker still reads the request buffer; finish closing on completion
+            it->second->closePending = true;
+            return;
+        }
+
+        epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        m_connections.erase(it);
+
+        if (m_acceptPaused && m_running)
+        {
+            acceptConnections();
+        }
+    }
+
+    void HttpApiServer::closeAllConnections()
+    {
+        for (auto &entry : m_connections)
+        {
+            close(entry.first);
+        }
+        m_connections.clear();
+    }
+
+    void HttpApiServer::wakeEventLoop()
+    {
+        if (m_wakeFd >= 0)
+        {
+            uint64_t one = 1;
+            ssize_t result = write(m_wakeFd, &one, sizeof(one));
+            (void)result;
+        }
+    }
+
+    void HttpApiServer::closeIdleConnections()
+    {
+        auto now = std::chrono::steady_clock::now();
+        auto idleTimeout = std::chrono::milliseconds(m_config.idleTimeoutMs);
+
+        auto heartbeatInterval = std::chrono::milliseconds(EVENT_STREAM_HEARTBEAT_MS);
+
+        std::vector<int> expired;
+        std::vector<int> heartbeats;
+        std::vector<int> pollTimeouts;
+        for (const auto &entry : m_connections)
+        {
+            const Connection &connection = *entry.second;
+            if (connection.watching != nullptr)
+            {
+                if (now >= connection.watchDeadline)
+                {
+                    pollTimeouts.push_back(entry.first);
+                }
+            }
+            else if (connection.stream != nullptr)
+            {
+                // Event streams never idle out; a comment line keeps proxies from closing them
+                if (now - connection.lastActivity >= heartbeatInterval && connection.frames.empty())
+                {
+                    heartbeats.push_back(entry.first);
+                }
+            }
+            else if (!connection.busy && connection.output.empty() &&
+                     now - connection.lastActivity >= idleTimeout)
+            {
+                expired.push_back(entry.first);
+            }
+        }
+
+        for (int fd : expired)
+        {
+            closeConnection(fd);
+        }
+        for (int fd : pollTimeouts)
+        {
+            auto it = m_connections.find(fd);
+            if (it != m_connections.end() && it->second->watching != nullptr)
+            {
+                answerWatch(*it->second, true);
+            }
+        }
+        for (int fd : heartbeats)
+        {
+            auto it = m_connections.find(fd);
+            if (it != m_connections.end())
             {
-                std::string key = line.substr(0, colonPos);
-                std::string value = line.substr(colonPos + 2);
-                if (!value.empty() && value.back() == '\r')
+                it->second->lastActivity = now;
+                queueResponse(*it->second, ": keep-alive\n\n");
+            }
+        }
+    }
+
+    void HttpApiServer::handleRequest(HttpRequest &request, Completion &completion)
+    {
+        HttpResponse response;
+
+        // Enable CORS for React app
+        enableCORS(response);
+
+        // Handle OPTIONS for CORS preflight
+        if (request.method == "OPTIONS")
+        {
+            response.statusCode = 204;
+            response.body = "";
+        }
+        else
+        {
+            const HttpHandler *handler = nullptr;
+            HttpRouter::MatchResult result =
+                m_router.match(parseHttpMethod(request.method), request.path, request, handler);
+            if (result == HttpRouter::MatchResult::Found)
+            {
+                try
+                {
+                    (*handler)(request, response);
+                }
+                catch (const std::exception &e)
                 {
-                    value.pop_back();
+                    response.setError(500, std::string("Internal error: ") + e.what());
                 }
-                request.headers[key] = value;
+            }
+            else if (result == HttpRouter::MatchResult::MethodNotAllowed)
+            {
+                response.setError(405, "Method not allowed: " + request.method.str() + " " + request.path.str());
+            }
+            else
+            {
+                response.setError(404, "Endpoint not found: " + request.method.str() + " " + request.path.str());
             }
         }
 
-        // Parse body
-        std::string body;
-        while (std::getline(stream, line))
+        if (response.eventStream != nullptr && response.statusCode == 200)
         {
-            body += line;
+            StringRef resumeFrom = request.getHeader("Last-Event-ID");
+            if (resumeFrom.empty())
+            {
+                resumeFrom = request.getParam("lastEventId");
+            }
+
+            // Without a resume point the client starts with the next event
+            completion.stream = response.eventStream;
+            completion.lastEventId = resumeFrom.empty()
+                                         ? response.eventStream->getLastEventId()
+                                         : parseUnsigned(resumeFrom);
+            completion.keepAlive = true;
         }
-        request.body = body;
 
-        return request;
+        if (response.resource != nullptr && response.statusCode == 200)
+        {
+            resolveResource(request, response, completion);
+            if (completion.watch != nullptr)
+            {
+                return; // Parked; the event loop builds the response
+            }
+        }
+
+        completion.response = buildResponse(response, completion.keepAlive);
     }
 
-    std::string HttpApiServer::buildResponse(const HttpResponse &response)
+    void HttpApiServer::resolveResource(const HttpRequest &request, HttpResponse &response, Completion &completion)
     {
-        std::ostringstream oss;
+        VersionedResource::Snapshot snapshot = response.resource->get();
 
-        // Status line
-        oss << "HTTP/1.1 " << response.statusCode << " ";
-        switch (response.statusCode)
+        StringRef since = request.getParam("since");
+        if (!since.empty())
         {
-        case 200:
-            oss << "OK";
-            break;
-        case 201:
-            oss << "Created";
-            break;
-        case 204:
-            oss << "No Content";
-            break;
-        case 400:
-            oss << "Bad Request";
-            break;
-        case 404:
-            oss << "Not Found";
-            break;
-        case 500:
-            oss << "Internal Server Error";
-            break;
-        default:
-            oss << "Unknown";
-            break;
+            // Long-poll: the client already has this version, wait for the next one
+            if (parseUnsigned(since) == snapshot->version)
+            {
+                completion.watch = response.resource;
+                completion.watchVersion = snapshot->version;
+                return;
+            }
+            fillFromSnapshot(response, snapshot, false);
+            return;
         }
-        oss << "\r\n";
+
+        fillFromSnapshot(response, snapshot, etagMatches(request.getHeader("If-None-Match"), snapshot->etag));
+    }
+
+    std::string HttpApiServer::buildResponse(const HttpResponse &response, bool keepAlive)
+    {
+        responseCounter(response.statusCode).inc();
+
+        std::string out;
+        out.reserve(256 + response.body.size());
+
+        // Status line
+        out += "HTTP/1.1 ";
+        JsonWriter::appendUnsigned(out, static_cast<unsigned>(response.statusCode));
+        out += ' ';
+        out += statusText(response.statusCode);
+        out += "\r\n";
 
         // Headers
-        oss << "Content-Type: " << response.contentType << "\r\n";
-        oss << "Content-Length: " << response.body.length() << "\r\n";
-        oss << "Access-Control-Allow-Origin: *\r\n";
-        oss << "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n";
-        oss << "Access-Control-Allow-Headers: Content-Type, Authorization\r\n";
-        oss << "Connection: close\r\n";
-        oss << "\r\n";
+        out += "Content-Type: ";
+        out += response.contentType;
+        out += "\r\n";
+        if (!response.etag.empty())
+        {
+            // Clients must revalidate; unchanged status then costs a bodiless 304
+            out += "ETag: ";
+            out += response.etag;
+            out += "\r\nCache-Control: no-cache\r\n";
+        }
+        if (response.eventStream != nullptr)
+        {
+            // Unbounded body: events follow until either side closes
+            out += "Cache-Control: no-cache\r\n";
+            out += "X-Accel-Buffering: no\r\n";
+        }
+        else if (response.statusCode != 204 && response.statusCode != 304)
+        {
+            out += "Content-Length: ";
+            JsonWriter::appendUnsigned(out, response.body.size());
+            out += "\r\n";
+        }
+        out += "Access-Control-Allow-Origin: *\r\n";
+        out += "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n";
+        out += "Access-Control-Allow-Headers: Content-Type, Authorization, If-None-Match\r\n";
+        out += "Access-Control-Expose-Headers: ETag\r\n";
+        if (response.eventStream != nullptr)
+        {
+            out += "Connection: keep-alive\r\n";
+        }
+        else if (keepAlive)
+        {
+            out += "Connection: keep-alive\r\nKeep-Alive: timeout=";
+            JsonWriter::appendUnsigned(out, static_cast<unsigned>(m_config.idleTimeoutMs / 1000));
+            out += "\r\n";
+        }
+        else
+        {
+            out += "Connection: close\r\n";
+        }
+        out += "\r\n";
 
-        // Body
-        oss << response.body;
+        // Body (for event streams: reconnect delay hint for EventSource)
+        if (response.eventStream != nullptr)
+        {
+            out += "retry: 2000\n\n";
+        }
+        out += response.body;
 
-        return oss.str();
+        return out;
     }
 
     void HttpApiServer::enableCORS(HttpResponse &response)
@@ -322,54 +1176,40 @@ namespace Wallbox
         // CORS headers are added in buildResponse
     }
 
-    HttpHandler HttpApiServer::findHandler(const std::string &method, const std::string &path)
+    // JsonBuilder implementation
+    JsonBuilder::JsonBuilder()
+        : m_writer(m_json)
     {
-        auto methodIt = m_routes.find(method);
-        if (methodIt != m_routes.end())
-        {
-            auto pathIt = methodIt->second.find(path);
-            if (pathIt != methodIt->second.end())
-            {
-                return pathIt->second;
-            }
-        }
-        return nullptr;
+        m_writer.beginObject();
     }
 
-    // JsonBuilder implementation
     JsonBuilder &JsonBuilder::add(const std::string &key, const std::string &value)
     {
-        if (!m_first)
-            m_json += ",";
-        m_json += "\"" + key + "\":\"" + value + "\"";
-        m_first = false;
+        m_writer.key(key).value(value);
+        return *this;
+    }
+
+    JsonBuilder &JsonBuilder::add(const std::string &key, const char *value)
+    {
+        m_writer.key(key).value(value);
         return *this;
     }
 
     JsonBuilder &JsonBuilder::add(const std::string &key, int value)
     {
-        if (!m_first)
-            m_json += ",";
-        m_json += "\"" + key + "\":" + std::to_string(value);
-        m_first = false;
+        m_writer.key(key).value(value);
         return *this;
     }
 
     JsonBuilder &JsonBuilder::add(const std::string &key, bool value)
     {
-        if (!m_first)
-            m_json += ",";
-        m_json += "\"" + key + "\":" + (value ? "true" : "false");
-        m_first = false;
+        m_writer.key(key).value(value);
         return *this;
     }
 
     JsonBuilder &JsonBuilder::add(const std::string &key, double value)
     {
-        if (!m_first)
-            m_json += ",";
-        m_json += "\"" + key + "\":" + std::to_string(value);
-        m_first = false;
+        m_writer.key(key).value(value);
         return *this;
     }
 
@@ -0,0 +1,563 @@
+#include "HttpRequestParser.h"
+#include <cctype>
+#include <limits>
+
+namespace Wallbox
+{
+
+    namespace
+    {
+        constexpr size_t MAX_CHUNK_LINE_BYTES = 1024;
+
+        bool equalsIgnoreCase(const char *data, size_t size, const char *text)
+        {
+            size_t i = 0;
+            for (; i < size && text[i]; ++i)
+            {
+                if (std::tolower(static_cast<unsigned char>(data[i])) !=
+                    std::tolower(static_cast<unsigned char>(text[i])))
+                {
+                    return false;
+                }
+            }
+            return i == size && text[i] == '\0';
+        }
+
+        bool isTokenChar(char c)
+        {
+            return std::isalnum(static_cast<unsigned char>(c)) || std::strchr("!#$%&'*+-.^_`|~", c) != nullptr;
+        }
+
+        bool isWhitespace(char c)
+        {
+            return c == ' ' || c == '\t';
+        }
+
+        int hexValue(char c)
+        {
+            if (c >= '0' && c <= '9')
+                return c - '0';
+            if (c >= 'a' && c <= 'f')
+                return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F')
+                return c - 'A' + 10;
+            return -1;
+        }
+
+        // Checks a comma-separated header value (e.g. Connection) for a token
+        bool containsToken(const char *data, size_t size, const char *token)
+        {
+            size_t start = 0;
+            while (start < size)
+            {
+                size_t end = start;
+                while (end < size && data[end] != ',')
+                {
+                    ++end;
+                }
+
+                size_t first = start;
+                size_t last = end;
+                while (first < last && isWhitespace(data[first]))
+                    ++first;
+                while (last > first && isWhitespace(data[last - 1]))
+                    --last;
+
+                if (equalsIgnoreCase(data + first, last - first, token))
+                {
+                    return true;
+                }
+                start = end + 1;
+            }
+            return false;
+        }
+    } // namespace
+
+    bool StringRef::equalsIgnoreCase(const char *text) const
+    {
+        return Wallbox::equalsIgnoreCase(data, size, text);
+    }
+
+    StringRef HttpRequest::getHeader(const char *name) const
+    {
+        for (size_t i = 0; i < headerCount; ++i)
+        {
+            if (headers[i].name.equalsIgnoreCase(name))
+            {
+                return headers[i].value;
+            }
+        }
+        return StringRef();
+    }
+
+    StringRef HttpRequest::getParam(const char *name) const
+    {
+        for (size_t i = 0; i < paramCount; ++i)
+        {
+            if (params[i].name == name)
+            {
+                return params[i].value;
+            }
+        }
+        return StringRef();
+    }
+
+    bool HttpRequest::addParam(StringRef name, StringRef value)
+    {
+        if (paramCount >= MAX_PARAMS)
+        {
+            return false;
+        }
+        params[paramCount].name = name;
+        params[paramCount].value = value;
+        ++paramCount;
+        return true;
+    }
+
+    HttpRequestParser::HttpRequestParser(const HttpParserLimits &limits)
+        : m_limits(limits)
+    {
+        reset();
+    }
+
+    void HttpRequestParser::reset()
+    {
+        m_state = State::RequestLine;
+        m_position = 0;
+        m_errorStatus = 0;
+        m_errorMessage = "";
+        m_method = Span{0, 0};
+        m_target = Span{0, 0};
+        m_version = Span{0, 0};
+        m_headerCount = 0;
+        m_chunked = false;
+        m_hasContentLength = false;
+        m_connectionClose = false;
+        m_connectionKeepAlive = false;
+        m_contentLength = 0;
+        m_bodyOffset = 0;
+        m_bodyLength = 0;
+        m_chunkRemaining = 0;
+    }
+
+    HttpRequestParser::Result HttpRequestParser::parse(char *buffer, size_t length, HttpRequest &request)
+    {
+        size_t lineEnd = 0;
+        size_t nextStart = 0;
+
+        while (true)
+        {
+            switch (m_state)
+            {
+            case State::RequestLine:
+            case State::Headers:
+                if (!nextLine(buffer, length, lineEnd, nextStart))
+                {
+                    if (length > m_limits.maxHeaderBytes)
+                    {
+                        return fail(431, "Request header fields too large");
+                    }
+                    return Result::Incomplete;
+                }
+                if (nextStart > m_limits.maxHeaderBytes)
+                {
+                    return fail(431, "Request header fields too large");
+                }
+
+                if (m_state == State::RequestLine)
+                {
+                    // Tolerate empty lines before the request line (RFC 7230 3.5)
+                    if (lineEnd > m_position && !parseRequestLine(buffer, lineEnd))
+                    {
+                        return Result::Error;
+                    }
+                    if (lineEnd > m_position)
+                    {
+                        m_state = State::Headers;
+                    }
+                }
+                else if (lineEnd == m_position)
+                {
+                    m_position = nextStart;
+                    if (!finishHeaders())
+                    {
+                        return Result::Error;
+                    }
+                    continue;
+                }
+                else if (!parseHeaderLine(buffer, lineEnd))
+                {
+                    return Result::Error;
+                }
+                m_position = nextStart;
+                break;
+
+            case State::Body:
+                if (length - m_bodyOffset < m_contentLength)
+                {
+                    return Result::Incomplete;
+                }
+                m_position = m_bodyOffset + m_contentLength;
+                m_bodyLength = m_contentLength;
+                m_state = State::Complete;
+                break;
+
+            case State::ChunkSize:
+                if (!nextLine(buffer, length, lineEnd, nextStart))
+                {
+                    if (length - m_position > MAX_CHUNK_LINE_BYTES)
+                    {
+                        return fail(400, "Invalid chunk size");
+                    }
+                    return Result::Incomplete;
+                }
+                if (!parseChunkSize(buffer, lineEnd))
+                {
+                    return Result::Error;
+                }
+                m_position = nextStart;
+                break;
+
+            case State::ChunkData:
+            {
+                size_t available = length - m_position;
+                size_t count = available < m_chunkRemaining ? available : m_chunkRemaining;
+                size_t target = m_bodyOffset + m_bodyLength;
+                if (count > 0 && target != m_position)
+                {
+                    // Decode in place: slide chunk payload down over the size lines
+                    std::memmove(buffer + target, buffer + m_position, count);
+                }
+                m_bodyLength += count;
+                m_position += count;
+                m_chunkRemaining -= count;
+                if (m_chunkRemaining > 0)
+                {
+                    return Result::Incomplete;
+                }
+                m_state = State::ChunkDataEnd;
+                break;
+            }
+
+            case State::ChunkDataEnd:
+                if (length - m_position < 1)
+                {
+                    return Result::Incomplete;
+                }
+                if (buffer[m_position] == '\r')
+                {
+                    if (length - m_position < 2)
+                    {
+                        return Result::Incomplete;
+                    }
+                    ++m_position;
+                }
+                if (buffer[m_position] != '\n')
+                {
+                    return fail(400, "Invalid chunk terminator");
+                }
+                ++m_position;
+                m_state = State::ChunkSize;
+                break;
+
+            case State::Trailers:
+                if (!nextLine(buffer, length, lineEnd, nextStart))
+                {
+                    if (length - m_position > m_limits.maxHeaderBytes)
+                    {
+                        return fail(431, "Request header fields too large");
+                    }
+                    return Result::Incomplete;
+                }
+                // Trailer fields are accepted but not exposed
+                if (lineEnd == m_position)
+                {
+                    m_state = State::Complete;
+                }
+                m_position = nextStart;
+                break;
+
+            case State::Complete:
+                fillRequest(buffer, request);
+                return Result::Complete;
+
+            case State::Error:
+                return Result::Error;
+            }
+        }
+    }
+
+    bool HttpRequestParser::nextLine(const char *buffer, size_t length, size_t &lineEnd, size_t &nextStart) const
+    {
+        if (m_position >= length)
+        {
+            return false;
+        }
+
+        const void *newline = std::memchr(buffer + m_position, '\n', length - m_position);
+        if (newline == nullptr)
+        {
+            return false;
+        }
+
+        size_t index = static_cast<size_t>(static_cast<const char *>(newline) - buffer);
+        nextStart = index + 1;
+        lineEnd = (index > m_position && buffer[index - 1] == '\r') ? index - 1 : index;
+        return true;
+    }
+
+    bool HttpRequestParser::parseRequestLine(const char *buffer, size_t lineEnd)
+    {
+        // METHOD SP request-target SP HTTP-version
+        size_t methodEnd = m_position;
+        while (methodEnd < lineEnd && isTokenChar(buffer[methodEnd]))
+        {
+            ++methodEnd;
+        }
+        if (methodEnd == m_position || methodEnd >= lineEnd || buffer[methodEnd] != ' ')
+        {
+            fail(400, "Malformed request line");
+            return false;
+        }
+
+        size_t targetStart = methodEnd + 1;
+        size_t targetEnd = targetStart;
+        while (targetEnd < lineEnd && buffer[targetEnd] != ' ')
+        {
+            ++targetEnd;
+        }
+        if (targetEnd == targetStart || targetEnd >= lineEnd)
+        {
+            fail(400, "Malformed request line");
+            return false;
+        }
+
+        size_t versionStart = targetEnd + 1;
+        size_t versionLength = lineEnd - versionStart;
+        if (versionLength != 8 || std::memcmp(buffer + versionStart, "HTTP/1.", 7) != 0 ||
+            (buffer[versionStart + 7] != '0' && buffer[versionStart + 7] != '1'))
+        {
+            fail(400, "Unsupported HTTP version");
+            return false;
+        }
+
+        m_method = Span{m_position, methodEnd - m_position};
+        m_target = Span{targetStart, targetEnd - targetStart};
+        m_version = Span{versionStart, versionLength};
+        return true;
+    }
+
+    bool HttpRequestParser::parseHeaderLine(const char *buffer, size_t lineEnd)
+    {
+        if (isWhitespace(buffer[m_position]))
+        {
+            fail(400, "Obsolete header line folding");
+            return false;
+        }
+
+        size_t nameEnd = m_position;
+        while (nameEnd < lineEnd && isTokenChar(buffer[nameEnd]))
+        {
+            ++nameEnd;
+        }
+        if (nameEnd == m_position || nameEnd >= lineEnd || buffer[nameEnd] != ':')
+        {
+            fail(400, "Malformed header field");
+            return false;
+        }
+
+        size_t valueStart = nameEnd + 1;
+        size_t valueEnd = lineEnd;
+        while (valueStart < valueEnd && isWhitespace(buffer[valueStart]))
+            ++valueStart;
+        while (valueEnd > valueStart && isWhitespace(buffer[valueEnd - 1]))
+            --valueEnd;
+
+        if (m_headerCount >= HttpRequest::MAX_HEADERS)
+        {
+            fail(431, "Too many header fields");
+            return false;
+        }
+
+        const char *name = buffer + m_position;
+        size_t nameLength = nameEnd - m_position;
+        const char *value = buffer + valueStart;
+        size_t valueLength = valueEnd - valueStart;
+
+        // Framing and connection headers are interpreted here, the rest is passed through
+        if (equalsIgnoreCase(name, nameLength, "content-length"))
+        {
+            if (valueLength == 0)
+            {
+                fail(400, "Invalid Content-Length");
+                return false;
+            }
+            size_t contentLength = 0;
+            for (size_t i = 0; i < valueLength; ++i)
+            {
+                if (!std::isdigit(static_cast<unsigned char>(value[i])) ||
+                    contentLength > (std::numeric_limits<size_t>::max() - 9) / 10)
+                {
+                    fail(400, "Invalid Content-Length");
+                    return false;
+                }
+                contentLength = contentLength * 10 + static_cast<size_t>(value[i] - '0');
+            }
+            if (m_hasContentLength && contentLength != m_contentLength)
+            {
+                fail(400, "Conflicting Content-Length");
+                return false;
+            }
+            m_hasContentLength = true;
+            m_contentLength = contentLength;
+        }
+        else if (equalsIgnoreCase(name, nameLength, "transfer-encoding"))
+        {
+            if (!equalsIgnoreCase(value, valueLength, "chunked"))
+            {
+                fail(501, "Unsupported Transfer-Encoding");
+                return false;
+            }
+            m_chunked = true;
+        }
+        else if (equalsIgnoreCase(name, nameLength, "connection"))
+        {
+            m_connectionClose = m_connectionClose || containsToken(value, valueLength, "close");
+            m_connectionKeepAlive = m_connectionKeepAlive || containsToken(value, valueLength, "keep-alive");
+        }
+
+        m_headerNames[m_headerCount] = Span{m_position, nameLength};
+        m_headerValues[m_headerCount] = Span{valueStart, valueLength};
+        ++m_headerCount;
+        return true;
+    }
+
+    bool HttpRequestParser::finishHeaders()
+    {
+        // Both framings at once is a request smuggling vector; refuse it
+        if (m_chunked && m_hasContentLength)
+        {
+            fail(400, "Both Content-Length and Transfer-Encoding present");
+            return false;
+        }
+
+        m_bodyOffset = m_position;
+        m_bodyLength = 0;
+
+        if (m_chunked)
+        {
+            m_state = State::ChunkSize;
+        }
+        else if (m_contentLength > m_limits.maxBodyBytes)
+        {
+            fail(413, "Request body too large");
+            return false;
+        }
+        else
+        {
+            m_state = m_contentLength > 0 ? State::Body : State::Complete;
+        }
+        return true;
+    }
+
+    bool HttpRequestParser::parseChunkSize(const char *buffer, size_t lineEnd)
+    {
+        size_t chunkSize = 0;
+        size_t index = m_position;
+        for (; index < lineEnd; ++index)
+        {
+            int digit = hexValue(buffer[index]);
+            if (digit < 0)
+            {
+                break;
+            }
+            // Past the limit the size only has to stay over it (rejected below), not overflow
+            if (chunkSize <= m_limits.maxBodyBytes)
+            {
+                chunkSize = chunkSize * 16 + static_cast<size_t>(digit);
+            }
+        }
+
+        // Chunk extensions (";name=value") are ignored
+        if (index == m_position || (index < lineEnd && buffer[index] != ';' && !isWhitespace(buffer[index])))
+        {
+            fail(400, "Invalid chunk size");
+            return false;
+        }
+        if (chunkSize > m_limits.maxBodyBytes - m_bodyLength)
+        {
+            fail(413, "Request body too large");
+            return false;
+        }
+
+        m_chunkRemaining = chunkSize;
+        m_state = chunkSize == 0 ? State::Trailers : State::ChunkData;
+        return true;
+    }
+
+    void HttpRequestParser::fillRequest(const char *buffer, HttpRequest &request) const
+    {
+        request.method = StringRef(buffer + m_method.offset, m_method.length);
+        request.version = StringRef(buffer + m_version.offset, m_version.length);
+        request.body = StringRef(buffer + m_bodyOffset, m_bodyLength);
+
+        const char *target = buffer + m_target.offset;
+        const void *question = std::memchr(target, '?', m_target.length);
+        if (question != nullptr)
+        {
+            size_t pathLength = static_cast<size_t>(static_cast<const char *>(question) - target);
+            request.path = StringRef(target, pathLength);
+            request.query = StringRef(target + pathLength + 1, m_target.length - pathLength - 1);
+        }
+        else
+        {
+            request.path = StringRef(target, m_target.length);
+            request.query = StringRef();
+        }
+
+        request.headerCount = m_headerCount;
+        for (size_t i = 0; i < m_headerCount; ++i)
+        {
+            request.headers[i].name = StringRef(buffer + m_headerNames[i].offset, m_headerNames[i].length);
+            request.headers[i].value = StringRef(buffer + m_headerValues[i].offset, m_headerValues[i].length);
+        }
+
+        // Query parameters (no percent-decoding); extras beyond MAX_PARAMS are dropped
+        request.paramCount = 0;
+        size_t start = 0;
+        const char *query = request.query.data;
+        while (start < request.query.size)
+        {
+            size_t end = start;
+            while (end < request.query.size && query[end] != '&')
+            {
+                ++end;
+            }
+            if (end > start)
+            {
+                size_t equals = start;
+                while (equals < end && query[equals] != '=')
+                {
+                    ++equals;
+                }
+                size_t valueStart = equals < end ? equals + 1 : end;
+                request.addParam(StringRef(query + start, equals - start),
+                                 StringRef(query + valueStart, end - valueStart));
+            }
+            start = end + 1;
+        }
+
+        // HTTP/1.1 defaults to persistent connections, HTTP/1.0 must opt in
+        bool http11 = request.version == "HTTP/1.1";
+        request.keepAlive = http11 ? !m_connectionClose : m_connectionKeepAlive;
+    }
+
+    HttpRequestParser::Result HttpRequestParser::fail(int status, const char *message)
+    {
+        m_state = State::Error;
+        m_errorStatus = status;
+        m_errorMessage = message;
+        return Result::Error;
+    }
+
+} // namespace Wallbox
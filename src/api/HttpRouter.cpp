@@ -0,0 +1,247 @@
+#include "HttpRouter.h"
+#include <iostream>
+
+namespace Wallbox
+{
+
+    namespace
+    {
+        const char *const WILDCARD_PARAM = "*";
+
+        size_t segmentEnd(const char *path, size_t length, size_t position)
+        {
+            while (position < length && path[position] != '/')
+            {
+                ++position;
+            }
+            return position;
+        }
+
+        size_t skipSlashes(const char *path, size_t length, size_t position)
+        {
+            while (position < length && path[position] == '/')
+            {
+                ++position;
+            }
+            return position;
+        }
+    } // namespace
+
+    HttpMethod parseHttpMethod(StringRef method)
+    {
+        static const HttpMethod methods[] = {HttpMethod::GET, HttpMethod::POST, HttpMethod::PUT,
+                                             HttpMethod::DELETE, HttpMethod::PATCH, HttpMethod::HEAD,
+                                             HttpMethod::OPTIONS};
+        for (HttpMethod candidate : methods)
+        {
+            if (method == httpMethodToString(candidate))
+            {
+                return candidate;
+            }
+        }
+        return HttpMethod::UNKNOWN;
+    }
+
+    const char *httpMethodToString(HttpMethod method)
+    {
+        switch (method)
+        {
+        case HttpMethod::GET:
+            return "GET";
+        case HttpMethod::POST:
+            return "POST";
+        case HttpMethod::PUT:
+            return "PUT";
+        case HttpMethod::DELETE:
+            return "DELETE";
+        case HttpMethod::PATCH:
+            return "PATCH";
+        case HttpMethod::HEAD:
+            return "HEAD";
+        case HttpMethod::OPTIONS:
+            return "OPTIONS";
+        default:
+            return "UNKNOWN";
+        }
+    }
+
+    HttpRouter::HttpRouter()
+        : m_root(new Node()),
+          m_routeCount(0)
+    {
+    }
+
+    HttpRouter::~HttpRouter() = default;
+
+    bool HttpRouter::add(HttpMethod method, const std::string &pattern, HttpHandler handler)
+    {
+        if (method == HttpMethod::UNKNOWN || !handler)
+        {
+            std::cerr << "Invalid route: " << pattern << std::endl;
+            return false;
+        }
+
+        Node *node = m_root.get();
+        const char *path = pattern.c_str();
+        size_t length = pattern.size();
+        size_t position = skipSlashes(path, length, 0);
+
+        while (position < length)
+        {
+            size_t end = segmentEnd(path, length, position);
+            std::string segment(path + position, end - position);
+            position = skipSlashes(path, length, end);
+
+            if (segment == WILDCARD_PARAM)
+            {
+                if (position < length)
+                {
+                    std::cerr << "Invalid route (wildcard must be last): " << pattern << std::endl;
+                    return false;
+                }
+                if (!node->wildcard)
+                {
+                    node->wildcard.reset(new Node());
+                }
+                node = node->wildcard.get();
+            }
+            else if (segment.size() > 2 && segment.front() == '{' && segment.back() == '}')
+            {
+                std::string name = segment.substr(1, segment.size() - 2);
+                if (!node->parameter)
+                {
+                    node->parameter.reset(new Node());
+                    node->parameterName = name;
+                }
+                else if (node->parameterName != name)
+                {
+                    std::cerr << "Invalid route (parameter {" << name << "} conflicts with {"
+                              << node->parameterName << "}): " << pattern << std::endl;
+                    return false;
+                }
+                node = node->parameter.get();
+            }
+            else
+            {
+                Node *child = nullptr;
+                for (const auto &literal : node->literals)
+                {
+                    if (literal->segment == segment)
+                    {
+                        child = literal.get();
+                        break;
+                    }
+                }
+                if (child == nullptr)
+                {
+                    node->literals.emplace_back(new Node());
+                    child = node->literals.back().get();
+                    child->segment = segment;
+                }
+                node = child;
+            }
+        }
+
+        HttpHandler &slot = node->handlers[static_cast<size_t>(method)];
+        if (!slot)
+        {
+            ++m_routeCount;
+        }
+        slot = std::move(handler);
+        node->hasHandler = true;
+        return true;
+    }
+
+    HttpRouter::MatchResult HttpRouter::match(HttpMethod method, StringRef path, HttpRequest &request,
+                                              const HttpHandler *&handler) const
+    {
+        handler = nullptr;
+
+        size_t savedParams = request.paramCount;
+        bool pathMatched = false;
+        const Node *node = matchNode(*m_root, method, path.data, path.size, 0, request, pathMatched);
+        if (node == nullptr)
+        {
+            request.paramCount = savedParams;
+            return pathMatched ? MatchResult::MethodNotAllowed : MatchResult::NotFound;
+        }
+
+        handler = &node->handlers[static_cast<size_t>(method)];
+        return MatchResult::Found;
+    }
+
+    bool HttpRouter::accepts(const Node &node, HttpMethod method, bool &pathMatched)
+    {
+        if (!node.hasHandler)
+        {
+            return false;
+        }
+        if (method != HttpMethod::UNKNOWN && node.handlers[static_cast<size_t>(method)])
+        {
+            return true;
+        }
+        pathMatched = true; // Remember for 405, but keep looking in other branches
+        return false;
+    }
+
+    const HttpRouter::Node *HttpRouter::matchNode(const Node &node, HttpMethod method, const char *path,
+                                                  size_t length, size_t position, HttpRequest &request,
+                                                  bool &pathMatched) const
+    {
+        position = skipSlashes(path, length, position);
+        if (position == length)
+        {
+            if (accepts(node, method, pathMatched))
+            {
+                return &node;
+            }
+            if (node.wildcard && accepts(*node.wildcard, method, pathMatched) &&
+                request.addParam(StringRef(WILDCARD_PARAM, 1), StringRef(path + position, 0)))
+            {
+                return node.wildcard.get();
+            }
+            return nullptr;
+        }
+
+        size_t end = segmentEnd(path, length, position);
+        size_t segmentLength = end - position;
+
+        // Literal segments take precedence; fall back (with backtracking) to
+        // parameters and wildcards, also when the literal route lacks the method
+        for (const auto &literal : node.literals)
+        {
+            if (literal->segment.size() == segmentLength &&
+                literal->segment.compare(0, segmentLength, path + position, segmentLength) == 0)
+            {
+                const Node *found = matchNode(*literal, method, path, length, end, request, pathMatched);
+                if (found != nullptr)
+                {
+                    return found;
+                }
+            }
+        }
+
+        if (node.parameter)
+        {
+            size_t savedParams = request.paramCount;
+            if (request.addParam(StringRef(node.parameterName.data(), node.parameterName.size()),
+                                 StringRef(path + position, segmentLength)))
+            {
+                const Node *found = matchNode(*node.parameter, method, path, length, end, request, pathMatched);
+                if (found != nullptr)
+                {
+                    return found;
+                }
+            }
+            request.paramCount = savedParams;
+        }
+
+        if (node.wildcard && accepts(*node.wildcard, method, pathMatched) &&
+            request.addParam(StringRef(WILDCARD_PARAM, 1), StringRef(path + position, length - position)))
+        {
+            return node.wildcard.get();
+        }
+        return nullptr;
+    }
+
+} // namespace Wallbox
@@ -0,0 +1,37 @@
+#include "VersionedResource.h"
+#include "JsonWriter.h"
+
+namespace Wallbox
+{
+
+    VersionedResource::VersionedResource()
+        : m_current(std::make_shared<const ResourceVersion>(ResourceVersion{0, "\"0\"", std::string()}))
+    {
+    }
+
+    void VersionedResource::publish(uint64_t version, const std::string &body)
+    {
+        std::string etag;
+        etag += '"';
+        JsonWriter::appendUnsigned(etag, version);
+        etag += '"';
+        std::atomic_store(&m_current, std::make_shared<const ResourceVersion>(ResourceVersion{version, std::move(etag), body}));
+
+        std::function<void()> notifier;
+        {
+            std::lock_guard<std::mutex> lock(m_notifierMutex);
+            notifier = m_notifier;
+        }
+        if (notifier)
+        {
+            notifier();
+        }
+    }
+
+    void VersionedResource::setNotifier(std::function<void()> notifier)
+    {
+        std::lock_guard<std::mutex> lock(m_notifierMutex);
+        m_notifier = std::move(notifier);
+    }
+
+} // namespace Wallbox
@@ -0,0 +1,110 @@
+#include "WorkerPool.h"
+#include <iostream>
+
+namespace Wallbox
+{
+
+    WorkerPool::WorkerPool(size_t threadCount, size_t maxQueuedTasks)
+        : m_threadCount(threadCount > 0 ? threadCount : 1),
+          m_maxQueuedTasks(maxQueuedTasks > 0 ? maxQueuedTasks : 1),
+          m_running(false)
+    {
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        stop();
+    }
+
+    void WorkerPool::start()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_running)
+        {
+            return;
+        }
+
+        m_running = true;
+        m_threads.reserve(m_threadCount);
+        for (size_t i = 0; i < m_threadCount; ++i)
+        {
+            m_threads.emplace_back([this]()
+                                   { workerLoop(); });
+        }
+    }
+
+    void WorkerPool::stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_running)
+            {
+                return;
+            }
+            m_running = false;
+        }
+
+        m_condition.notify_all();
+        for (auto &thread : m_threads)
+        {
+            if (thread.joinable())
+            {
+                thread.join();
+            }
+        }
+        m_threads.clear();
+    }
+
+    bool WorkerPool::trySubmit(Task task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_running || m_tasks.size() >= m_maxQueuedTasks)
+            {
+                return false;
+            }
+            m_tasks.push_back(std::move(task));
+        }
+
+        m_condition.notify_one();
+        return true;
+    }
+
+    size_t WorkerPool::getQueuedTasks() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_tasks.size();
+    }
+
+    void WorkerPool::workerLoop()
+    {
+        while (true)
+        {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait(lock, [this]()
+                                 { return !m_running || !m_tasks.empty(); });
+
+                // Drain remaining work before exiting so no caller waits forever
+                if (m_tasks.empty())
+                {
+                    return;
+                }
+
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+
+            try
+            {
+                task();
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << "Worker task failed: " << e.what() << std::endl;
+            }
+        }
+    }
+
+} // namespace Wallbox
@@ -1,18 +1,209 @@
 #include "ChargingStateMachine.h"
-#include <iostream>
+#include "EventJournal.h"
+#include "LatencyTracer.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include "SpscRing.h"
+#include <algorithm>
 #include <stdexcept>
+#include <atomic>
+#include <condition_variable>
+#include <thread>
 
 namespace Wallbox
 {
 
+    constexpr size_t ChargingStateMachine::DEFAULT_QUEUE_CAPACITY;
+
+    namespace
+    {
+        // Indexed by ChargingState
+        const char *const STATE_NAMES[] = {"OFF", "IDLE", "CONNECTED", "IDENTIFICATION", "READY",
+                                           "CHARGING", "STOP", "FINISHED", "ERROR"};
+        constexpr size_t STATE_COUNT = sizeof(STATE_NAMES) / sizeof(STATE_NAMES[0]);
+
+        struct StateMetrics
+        {
+            Counter *transitions[STATE_COUNT];
+            Counter &rejected;
+            Gauge &current;
+            Counter &listenerDelivered;
+            Counter &listenerDropped;
+
+            StateMetrics()
+                : rejected(MetricsRegistry::instance().counter("wallbox_state_transitions_rejected_total",
+                                                               "State transitions refused as invalid")),
+                  current(MetricsRegistry::instance().gauge("wallbox_charging_state",
+                                                            "Current charging state (0 = OFF ... 8 = ERROR)")),
+                  listenerDelivered(MetricsRegistry::instance().counter("wallbox_state_listener_events_total",
+                                                                        "State changes handed to listeners",
+                                                                        {{"result", "delivered"}})),
+                  listenerDropped(MetricsRegistry::instance().counter("wallbox_state_listener_events_total",
+                                                                      "State changes handed to listeners",
+                                                                      {{"result", "dropped"}}))
+            {
+                for (size_t i = 0; i < STATE_COUNT; ++i)
+                {
+                    transitions[i] = &MetricsRegistry::instance().counter("wallbox_state_transitions_total",
+                                                                          "State transitions by target state",
+                                                                          {{"to", STATE_NAMES[i]}});
+                }
+            }
+        };
+
+        StateMetrics &stateMetrics()
+        {
+            static StateMetrics metrics;
+            return metrics;
+        }
+    } // namespace
+
+    /**
+     * @brief A registered listener; asynchronous ones own a ring and a thread
+     *
+     * The transitioning thread is the ring's only producer (transitions
+     * happen on one thread at a time), the listener thread its consumer.
+     */
+    struct ChargingStateMachine::Listener
+    {
+        struct Event
+        {
+            ChargingState oldState;
+            ChargingState newState;
+            std::string reason;
+        };
+
+        Listener(ListenerId listenerId, StateChangeCallback listenerCallback, ListenerMode listenerMode, size_t capacity)
+            : id(listenerId),
+              callback(std::move(listenerCallback)),
+              mode(listenerMode),
+              waiting(false),
+              running(true),
+              delivered(0),
+              dropped(0),
+              highWater(0)
+        {
+            if (mode == ListenerMode::ASYNCHRONOUS)
+            {
+                ring.reset(new SpscRing<Event>(capacity));
+                worker = std::thread([this]()
+                                     { run(); });
+            }
+        }
+
+        ~Listener()
+        {
+            stop();
+        }
+
+        void dispatch(ChargingState oldState, ChargingState newState, const std::string &reason)
+        {
+            if (mode == ListenerMode::SYNCHRONOUS)
+            {
+                callback(oldState, newState, reason);
+                delivered.fetch_add(1, std::memory_order_relaxed);
+                stateMetrics().listenerDelivered.inc();
+                return;
+            }
+
+            // Staged in a reused event so the ring slot's string keeps its buffer
+            pending.oldState = oldState;
+            pending.newState = newState;
+            pending.reason.assign(reason);
+            if (!ring->push(pending))
+            {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                stateMetrics().listenerDropped.inc();
+                return;
+            }
+
+            size_t depth = ring->size();
+            if (depth > highWater.load(std::memory_order_relaxed))
+            {
+                highWater.store(depth, std::memory_order_relaxed);
+            }
+
+            // Pairs with the fence in run(): either we see waiting or it sees the event
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (waiting.load(std::memory_order_relaxed))
+            {
+                std::lock_guard<std::mutex> lock(wakeMutex);
+                wakeup.notify_one();
+            }
+        }
+
+        void run()
+        {
+            Event event;
+            while (true)
+            {
+                while (ring->pop(event))
+                {
+                    callback(event.oldState, event.newState, event.reason);
+                    delivered.fetch_add(1, std::memory_order_relaxed);
+                    stateMetrics().listenerDelivered.inc();
+                }
+
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                waiting.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (!running.load())
+                {
+                    return;
+                }
+                if (ring->empty())
+                {
+                    wakeup.wait(lock);
+                }
+                waiting.store(false, std::memory_order_relaxed);
+            }
+        }
+
+        void stop()
+        {
+            if (!worker.joinable())
+            {
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(wakeMutex);
+                running = false;
+            }
+            wakeup.notify_one();
+            worker.join();
+        }
+
+        ListenerStats stats() const
+        {
+            return ListenerStats{delivered.load(), dropped.load(), highWater.load()};
+        }
+
+        const ListenerId id;
+        const StateChangeCallback callback;
+        const ListenerMode mode;
+        std::unique_ptr<SpscRing<Event>> ring;
+        Event pending; ///< Producer-side staging event
+        std::thread worker;
+        std::mutex wakeMutex;
+        std::condition_variable wakeup;
+        std::atomic<bool> waiting; ///< Worker is about to sleep or sleeping
+        std::atomic<bool> running;
+        std::atomic<uint64_t> delivered;
+        std::atomic<uint64_t> dropped;
+        std::atomic<size_t> highWater;
+    };
+
     ChargingStateMachine::ChargingStateMachine()
-        : m_currentState(ChargingState::IDLE)
+        : m_currentState(ChargingState::IDLE),
+          m_listeners(std::make_shared<const ListenerList>()),
+          m_nextListenerId(1)
     {
+        stateMetrics().current.set(static_cast<int64_t>(m_currentState));
     }
 
     ChargingStateMachine::~ChargingStateMachine()
     {
-        m_listeners.clear();
+        clearStateChangeListeners();
     }
 
     std::string ChargingStateMachine::getStateString() const
@@ -57,21 +248,30 @@ namespace Wallbox
 
         if (!isValidTransition(m_currentState, newState))
         {
-            std::cerr << "Invalid state transition: " << getStateString(m_currentState)
-                      << " -> " << getStateString(newState) << std::endl;
+            WALLBOX_LOG_WARN("StateMachine") << "Invalid state transition: " << getStateString(m_currentState)
+                                             << " -> " << getStateString(newState);
+            stateMetrics().rejected.inc();
             return false;
         }
 
+        TraceSpan span(TraceStage::TRANSITION);
         ChargingState oldState = m_currentState;
         m_currentState = newState;
 
-        std::cout << "State transition: " << getStateString(oldState)
-                  << " -> " << getStateString(newState);
-        if (!reason.empty())
+        StateMetrics &metrics = stateMetrics();
+        size_t index = static_cast<size_t>(newState);
+        if (index < STATE_COUNT)
         {
-            std::cout << " (" << reason << ")";
+            metrics.transitions[index]->inc();
         }
-        std::cout << std::endl;
+        metrics.current.set(static_cast<int64_t>(newState));
+
+        WALLBOX_LOG_INFO("StateMachine") << "State transition: " << getStateString(oldState)
+                                         << " -> " << getStateString(newState)
+                                         << (reason.empty() ? "" : " (") << reason
+                                         << (reason.empty() ? "" : ")");
+        EventJournal::instance().record(JournalEvent::STATE_TRANSITION, static_cast<uint32_t>(oldState),
+                                        static_cast<uint32_t>(newState), reason.data(), reason.size());
 
         notifyStateChange(oldState, newState, reason);
         return true;
@@ -153,21 +353,102 @@ namespace Wallbox
         return false;
     }
 
-    void ChargingStateMachine::addStateChangeListener(StateChangeCallback callback)
+    ListenerId ChargingStateMachine::addStateChangeListener(StateChangeCallback callback)
+    {
+        return addStateChangeListener(std::move(callback), ListenerMode::SYNCHRONOUS);
+    }
+
+    ListenerId ChargingStateMachine::addStateChangeListener(StateChangeCallback callback, ListenerMode mode,
+                                                            size_t queueCapacity)
     {
-        m_listeners.push_back(callback);
+        std::lock_guard<std::mutex> lock(m_listenerMutex);
+        ListenerId id = m_nextListenerId++;
+
+        // Copy-on-write: dispatches in progress keep iterating the old list
+        std::shared_ptr<ListenerList> updated = std::make_shared<ListenerList>(*listeners());
+        updated->push_back(std::make_shared<Listener>(id, std::move(callback), mode, queueCapacity));
+        std::atomic_store(&m_listeners, std::shared_ptr<const ListenerList>(std::move(updated)));
+        return id;
+    }
+
+    bool ChargingStateMachine::removeStateChangeListener(ListenerId id)
+    {
+        std::shared_ptr<Listener> removed;
+        {
+            std::lock_guard<std::mutex> lock(m_listenerMutex);
+            std::shared_ptr<ListenerList> updated = std::make_shared<ListenerList>();
+            for (const auto &listener : *listeners())
+            {
+                if (listener->id == id)
+                {
+                    removed = listener;
+                }
+                else
+                {
+                    updated->push_back(listener);
+                }
+            }
+            if (!removed)
+            {
+                return false;
+            }
+            std::atomic_store(&m_listeners, std::shared_ptr<const ListenerList>(std::move(updated)));
+        }
+
+        removed->stop();
+        return true;
     }
 
     void ChargingStateMachine::clearStateChangeListeners()
     {
-        m_listeners.clear();
+        std::shared_ptr<const ListenerList> removed;
+        {
+            std::lock_guard<std::mutex> lock(m_listenerMutex);
+            removed = listeners();
+            std::atomic_store(&m_listeners, std::make_shared<const ListenerList>());
+        }
+
+        for (const auto &listener : *removed)
+        {
+            listener->stop();
+        }
+    }
+
+    ListenerStats ChargingStateMachine::getListenerStats(ListenerId id) const
+    {
+        for (const auto &listener : *listeners())
+        {
+            if (listener->id == id)
+            {
+                return listener->stats();
+            }
+        }
+        return ListenerStats{0, 0, 0};
+    }
+
+    ListenerStats ChargingStateMachine::getDispatchStats() const
+    {
+        ListenerStats total = {0, 0, 0};
+        for (const auto &listener : *listeners())
+        {
+            if (listener->mode == ListenerMode::ASYNCHRONOUS)
+            {
+                ListenerStats stats = listener->stats();
+                total.delivered += stats.delivered;
+                total.dropped += stats.dropped;
+                total.highWater = std::max(total.highWater, stats.highWater);
+            }
+        }
+        return total;
     }
 
     void ChargingStateMachine::notifyStateChange(ChargingState oldState, ChargingState newState, const std::string &reason)
     {
-        for (const auto &listener : m_listeners)
+        // Lock-free snapshot of the list; listeners added meanwhile see the next transition
+        std::shared_ptr<const ListenerList> current = listeners();
+        for (const auto &listener : *current)
         {
-            listener(oldState, newState, reason);
+            listener->dispatch(oldState, newState, reason);
         }
     }
 
@@ -0,0 +1,270 @@
+#include "EventJournal.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+
+namespace Wallbox
+{
+
+    constexpr size_t JournalRecord::DATA_CAPACITY;
+    constexpr uint32_t JournalHeader::VERSION;
+    constexpr size_t EventJournal::MIN_CAPACITY;
+
+    static_assert(sizeof(JournalRecord) == 64, "JournalRecord is a fixed on-disk format");
+    static_assert(sizeof(JournalHeader) == 64, "JournalHeader is a fixed on-disk format");
+
+    namespace
+    {
+        const char MAGIC[8] = {'W', 'B', 'J', 'R', 'N', 'L', '\0', '\0'};
+
+        uint64_t wallNowNs()
+        {
+            timespec now;
+            clock_gettime(CLOCK_REALTIME, &now);
+            return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + static_cast<uint64_t>(now.tv_nsec);
+        }
+
+        uint32_t currentThreadId()
+        {
+            // One syscall per thread, not per record
+            thread_local uint32_t id = static_cast<uint32_t>(::syscall(SYS_gettid));
+            return id;
+        }
+
+        bool validHeader(const JournalHeader &header, size_t fileSize, std::string &error)
+        {
+            if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0)
+            {
+                error = "not an event journal";
+                return false;
+            }
+            if (header.version != JournalHeader::VERSION || header.recordSize != sizeof(JournalRecord))
+            {
+                error = "unsupported journal version " + std::to_string(header.version);
+                return false;
+            }
+            if (header.capacity == 0 || fileSize < sizeof(JournalHeader) + header.capacity * sizeof(JournalRecord))
+            {
+                error = "truncated journal";
+                return false;
+            }
+            return true;
+        }
+    } // namespace
+
+    EventJournal &EventJournal::instance()
+    {
+        // Never destroyed: threads may still record while statics are torn down
+        static EventJournal *journal = new EventJournal();
+        return *journal;
+    }
+
+    EventJournal::EventJournal()
+        : m_records(nullptr),
+          m_writers(0),
+          m_header(nullptr),
+          m_mapping(nullptr),
+          m_mappingSize(0),
+          m_capacity(0)
+    {
+    }
+
+    bool EventJournal::open(const std::string &path, size_t maxBytes)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_mapping)
+        {
+            std::cerr << "Event journal already open" << std::endl;
+            return false;
+        }
+
+        size_t capacity = std::max((maxBytes - std::min(maxBytes, sizeof(JournalHeader))) / sizeof(JournalRecord),
+                                   MIN_CAPACITY);
+        size_t size = sizeof(JournalHeader) + capacity * sizeof(JournalRecord);
+
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0)
+        {
+            std::cerr << "Cannot open event journal " << path << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        struct stat info;
+        bool reuse = false;
+        if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) == size)
+        {
+            JournalHeader existing;
+            std::string ignored;
+            reuse = pread(fd, &existing, sizeof(existing), 0) == static_cast<ssize_t>(sizeof(existing)) &&
+                    validHeader(existing, size, ignored) && existing.capacity == capacity;
+        }
+
+        // A fresh file is all zeros: every slot reads as never written
+        if (!reuse && (ftruncate(fd, 0) != 0 || ftruncate(fd, static_cast<off_t>(size)) != 0))
+        {
+            std::cerr << "Cannot size event journal " << path << ": " << strerror(errno) << std::endl;
+            ::close(fd);
+            return false;
+        }
+
+        void *mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED)
+        {
+            std::cerr << "Cannot map event journal " << path << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        m_mapping = mapping;
+        m_mappingSize = size;
+        m_capacity = capacity;
+        m_header = static_cast<JournalHeader *>(mapping);
+        if (!reuse)
+        {
+            std::memcpy(m_header->magic, MAGIC, sizeof(MAGIC));
+            m_header->version = JournalHeader::VERSION;
+            m_header->recordSize = sizeof(JournalRecord);
+            m_header->capacity = capacity;
+            m_header->next = 0;
+        }
+
+        m_records.store(reinterpret_cast<JournalRecord *>(static_cast<char *>(mapping) + sizeof(JournalHeader)));
+        return true;
+    }
+
+    void EventJournal::close()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_mapping)
+        {
+            return;
+        }
+
+        // Pairs with record(): either it sees nullptr or we see it in progress
+        m_records.store(nullptr);
+        while (m_writers.load() != 0)
+        {
+            std::this_thread::yield();
+        }
+
+        msync(m_mapping, m_mappingSize, MS_SYNC);
+        munmap(m_mapping, m_mappingSize);
+        m_mapping = nullptr;
+        m_header = nullptr;
+        m_mappingSize = 0;
+        m_capacity = 0;
+    }
+
+    void EventJournal::record(JournalEvent type, uint32_t arg0, uint32_t arg1, const void *data, size_t size)
+    {
+        m_writers.fetch_add(1);
+        JournalRecord *records = m_records.load();
+        if (!records)
+        {
+            m_writers.fetch_sub(1, std::memory_order_release);
+            return;
+        }
+
+        uint64_t sequence = __atomic_add_fetch(&m_header->next, 1, __ATOMIC_RELAXED);
+        JournalRecord &slot = records[(sequence - 1) % m_capacity];
+
+        // Readers skip a slot whose sequence is 0 or changed while they copied it
+        __atomic_store_n(&slot.sequence, 0, __ATOMIC_RELAXED);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.timestampNs = wallNowNs();
+        slot.type = type;
+        slot.reserved = 0;
+        slot.arg0 = arg0;
+        slot.arg1 = arg1;
+        slot.thread = currentThreadId();
+        size_t length = std::min(size, JournalRecord::DATA_CAPACITY);
+        if (length > 0)
+        {
+            std::memcpy(slot.data, data, length);
+        }
+        std::memset(slot.data + length, 0, JournalRecord::DATA_CAPACITY - length);
+        slot.length = static_cast<uint16_t>(length);
+
+        __atomic_store_n(&slot.sequence, sequence, __ATOMIC_RELEASE);
+        m_writers.fetch_sub(1, std::memory_order_release);
+    }
+
+    bool EventJournal::readFile(const std::string &path, std::vector<JournalRecord> &records, std::string &error)
+    {
+        records.clear();
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            error = strerror(errno);
+            return false;
+        }
+
+        struct stat info;
+        JournalHeader header;
+        if (fstat(fd, &info) != 0 ||
+            pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)))
+        {
+            error = "cannot read journal header";
+            ::close(fd);
+            return false;
+        }
+        if (!validHeader(header, static_cast<size_t>(info.st_size), error))
+        {
+            ::close(fd);
+            return false;
+        }
+
+        std::vector<JournalRecord> slots(header.capacity);
+        size_t bytes = slots.size() * sizeof(JournalRecord);
+        ssize_t got = pread(fd, slots.data(), bytes, sizeof(JournalHeader));
+        ::close(fd);
+        if (got != static_cast<ssize_t>(bytes))
+        {
+            error = "cannot read journal records";
+            return false;
+        }
+
+        for (size_t i = 0; i < slots.size(); ++i)
+        {
+            // Unwritten, in progress, or left over from a different geometry
+            const JournalRecord &slot = slots[i];
+            if (slot.sequence != 0 && (slot.sequence - 1) % header.capacity == i &&
+                slot.length <= JournalRecord::DATA_CAPACITY)
+            {
+                records.push_back(slot);
+            }
+        }
+        std::sort(records.begin(), records.end(), [](const JournalRecord &a, const JournalRecord &b)
+                  { return a.sequence < b.sequence; });
+        return true;
+    }
+
+    const char *EventJournal::eventName(JournalEvent type)
+    {
+        switch (type)
+        {
+        case JournalEvent::STATE_TRANSITION:
+            return "STATE";
+        case JournalEvent::RELAY:
+            return "RELAY";
+        case JournalEvent::CP_CHANGE:
+            return "CP";
+        case JournalEvent::UDP_RX:
+            return "UDP_RX";
+        case JournalEvent::UDP_TX:
+            return "UDP_TX";
+        default:
+            return "UNKNOWN";
+        }
+    }
+
+} // namespace Wallbox
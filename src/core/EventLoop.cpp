@@ -0,0 +1,275 @@
+#include "EventLoop.h"
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+namespace Wallbox
+{
+
+    namespace
+    {
+        constexpr int MAX_EVENTS = 16;
+    } // namespace
+
+    EventLoop::EventLoop()
+        : m_epollFd(-1),
+          m_wakeFd(-1),
+          m_wakePending(false),
+          m_running(false),
+          m_stopRequested(false),
+          m_loopThread(std::thread::id()),
+          m_wakeups(0)
+    {
+    }
+
+    EventLoop::~EventLoop()
+    {
+        close();
+    }
+
+    bool EventLoop::open()
+    {
+        if (m_epollFd >= 0)
+        {
+            return true;
+        }
+
+        m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+        m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (m_epollFd < 0 || m_wakeFd < 0)
+        {
+            std::cerr << "[EventLoop] Cannot create epoll/eventfd: " << strerror(errno) << std::endl;
+            close();
+            return false;
+        }
+
+        epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.fd = m_wakeFd;
+        if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &event) < 0)
+        {
+            std::cerr << "[EventLoop] Cannot watch eventfd: " << strerror(errno) << std::endl;
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void EventLoop::close()
+    {
+        for (int timer : m_timers)
+        {
+            ::close(timer);
+        }
+        m_timers.clear();
+        m_watches.clear();
+
+        if (m_wakeFd >= 0)
+        {
+            ::close(m_wakeFd);
+            m_wakeFd = -1;
+        }
+        if (m_epollFd >= 0)
+        {
+            ::close(m_epollFd);
+            m_epollFd = -1;
+        }
+    }
+
+    bool EventLoop::addFd(int fd, uint32_t events, FdHandler handler)
+    {
+        if (m_epollFd < 0)
+        {
+            return false;
+        }
+
+        epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = events;
+        event.data.fd = fd;
+        if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event) < 0)
+        {
+            std::cerr << "[EventLoop] Cannot watch fd " << fd << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        m_watches.push_back(Watch{fd, std::make_shared<FdHandler>(std::move(handler))});
+        return true;
+    }
+
+    void EventLoop::removeFd(int fd)
+    {
+        for (auto it = m_watches.begin(); it != m_watches.end(); ++it)
+        {
+            if (it->fd == fd)
+            {
+                epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+                m_watches.erase(it);
+                return;
+            }
+        }
+    }
+
+    int EventLoop::addTimer(Task handler)
+    {
+        int timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (timer < 0)
+        {
+            std::cerr << "[EventLoop] Cannot create timerfd: " << strerror(errno) << std::endl;
+            return -1;
+        }
+
+        // Drain the expiration count before calling the handler, or epoll keeps reporting it
+        bool added = addFd(timer, EPOLLIN, [timer, handler](uint32_t)
+                           {
+            uint64_t expirations = 0;
+            if (read(timer, &expirations, sizeof(expirations)) == sizeof(expirations))
+            {
+                handler();
+            } });
+        if (!added)
+        {
+            ::close(timer);
+            return -1;
+        }
+
+        m_timers.push_back(timer);
+        return timer;
+    }
+
+    bool EventLoop::armTimer(int timer, uint32_t intervalMs, bool periodic)
+    {
+        itimerspec spec;
+        std::memset(&spec, 0, sizeof(spec));
+        spec.it_value.tv_sec = intervalMs / 1000;
+        spec.it_value.tv_nsec = static_cast<long>(intervalMs % 1000) * 1000000L;
+        if (periodic)
+        {
+            spec.it_interval = spec.it_value;
+        }
+        return timerfd_settime(timer, 0, &spec, nullptr) == 0;
+    }
+
+    void EventLoop::post(Task task)
+    {
+        m_tasks.push(std::move(task));
+        if (!m_wakePending.exchange(true))
+        {
+            wake();
+        }
+    }
+
+    bool EventLoop::runPending()
+    {
+        std::unique_lock<std::mutex> consumer(m_consumerMutex, std::try_to_lock);
+        if (!consumer.owns_lock())
+        {
+            return false;
+        }
+
+        m_loopThread.store(std::this_thread::get_id());
+        runTasks();
+        m_loopThread.store(std::thread::id());
+        return true;
+    }
+
+    void EventLoop::run()
+    {
+        if (m_epollFd < 0)
+        {
+            std::cerr << "[EventLoop] Not open" << std::endl;
+            return;
+        }
+
+        std::lock_guard<std::mutex> consumer(m_consumerMutex);
+        m_loopThread.store(std::this_thread::get_id());
+        m_running.store(true);
+
+        epoll_event events[MAX_EVENTS];
+        while (!m_stopRequested.load())
+        {
+            int count = epoll_wait(m_epollFd, events, MAX_EVENTS, -1);
+            if (count < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                std::cerr << "[EventLoop] epoll_wait failed: " << strerror(errno) << std::endl;
+                break;
+            }
+            m_wakeups.fetch_add(1, std::memory_order_relaxed);
+
+            for (int i = 0; i < count; ++i)
+            {
+                if (events[i].data.fd == m_wakeFd)
+                {
+                    uint64_t value;
+                    ssize_t result = read(m_wakeFd, &value, sizeof(value));
+                    (void)result;
+                    runTasks();
+                }
+                else
+                {
+                    dispatch(events[i].data.fd, events[i].events);
+                }
+            }
+        }
+
+        // Tasks posted before stop() still run; later ones wait for runPending() or the next run()
+        m_running.store(false);
+        runTasks();
+        m_stopRequested.store(false);
+        m_loopThread.store(std::thread::id());
+    }
+
+    void EventLoop::stop()
+    {
+        m_stopRequested.store(true);
+        wake();
+    }
+
+    void EventLoop::wake()
+    {
+        if (m_wakeFd >= 0)
+        {
+            uint64_t one = 1;
+            ssize_t result = write(m_wakeFd, &one, sizeof(one));
+            (void)result;
+        }
+    }
+
+    void EventLoop::runTasks()
+    {
+        // Clear before draining: a post() after this point writes the eventfd again.
+        // The exchange (not a store) also makes the pushes behind a skipped wakeup visible.
+        m_wakePending.exchange(false);
+
+        Task task;
+        while (m_tasks.pop(task))
+        {
+            task();
+        }
+        task = nullptr;
+    }
+
+    void EventLoop::dispatch(int fd, uint32_t events)
+    {
+        // Handlers may remove watches (even their own): keep the handler alive for the call
+        for (const auto &watch : m_watches)
+        {
+            if (watch.fd == fd)
+            {
+                std::shared_ptr<FdHandler> handler = watch.handler;
+                (*handler)(events);
+                return;
+            }
+        }
+    }
+
+} // namespace Wallbox
@@ -0,0 +1,306 @@
+#include "JsonWriter.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace Wallbox
+{
+
+    namespace
+    {
+        // Fixed-point range for appendDouble(); beyond it %.17g is used
+        constexpr double FIXED_POINT_LIMIT = 1e12;
+        constexpr unsigned long long FRACTION_SCALE = 1000000ULL; // 6 decimals, like std::to_string
+        constexpr int FRACTION_DIGITS = 6;
+
+        bool needsEscape(unsigned char c)
+        {
+            return c < 0x20 || c == '"' || c == '\\';
+        }
+    } // namespace
+
+    JsonWriter::JsonWriter(std::string &buffer)
+        : m_buffer(buffer),
+          m_hasElements(0),
+          m_depth(0),
+          m_afterKey(false)
+    {
+    }
+
+    JsonWriter &JsonWriter::beginObject()
+    {
+        open('{');
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::endObject()
+    {
+        close('}');
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::beginArray()
+    {
+        open('[');
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::endArray()
+    {
+        close(']');
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::key(const char *name)
+    {
+        beforeValue();
+        m_buffer += '"';
+        appendEscaped(m_buffer, name, std::strlen(name));
+        m_buffer += "\":";
+        m_afterKey = true;
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::key(const std::string &name)
+    {
+        beforeValue();
+        m_buffer += '"';
+        appendEscaped(m_buffer, name.data(), name.size());
+        m_buffer += "\":";
+        m_afterKey = true;
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::value(const char *text)
+    {
+        beforeValue();
+        m_buffer += '"';
+        appendEscaped(m_buffer, text, std::strlen(text));
+        m_buffer += '"';
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::value(const std::string &text)
+    {
+        beforeValue();
+        m_buffer += '"';
+        appendEscaped(m_buffer, text.data(), text.size());
+        m_buffer += '"';
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::value(bool flag)
+    {
+        beforeValue();
+        m_buffer += flag ? "true" : "false";
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::value(int number)
+    {
+        return value(static_cast<long long>(number));
+    }
+
+    JsonWriter &JsonWriter::value(long number)
+    {
+        return value(static_cast<long long>(number));
+    }
+
+    JsonWriter &JsonWriter::value(long long number)
+    {
+        beforeValue();
+        appendInteger(m_buffer, number);
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::value(unsigned number)
+    {
+        return value(static_cast<unsigned long long>(number));
+    }
+
+    JsonWriter &JsonWriter::value(unsigned long number)
+    {
+        return value(static_cast<unsigned long long>(number));
+    }
+
+    JsonWriter &JsonWriter::value(unsigned long long number)
+    {
+        beforeValue();
+        appendUnsigned(m_buffer, number);
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::value(double number)
+    {
+        beforeValue();
+        appendDouble(m_buffer, number);
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::nullValue()
+    {
+        beforeValue();
+        m_buffer += "null";
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::rawValue(const char *json, size_t length)
+    {
+        beforeValue();
+        m_buffer.append(json, length);
+        return *this;
+    }
+
+    void JsonWriter::beforeValue()
+    {
+        if (m_afterKey)
+        {
+            m_afterKey = false;
+            return;
+        }
+
+        uint32_t bit = 1u << (m_depth % MAX_DEPTH);
+        if (m_hasElements & bit)
+        {
+            m_buffer += ',';
+        }
+        m_hasElements |= bit;
+    }
+
+    void JsonWriter::open(char bracket)
+    {
+        beforeValue();
+        m_buffer += bracket;
+        ++m_depth;
+        m_hasElements &= ~(1u << (m_depth % MAX_DEPTH));
+    }
+
+    void JsonWriter::close(char bracket)
+    {
+        if (m_depth > 0)
+        {
+            --m_depth;
+        }
+        m_buffer += bracket;
+    }
+
+    void JsonWriter::appendEscaped(std::string &out, const char *text, size_t length)
+    {
+        static const char HEX[] = "0123456789abcdef";
+
+        size_t runStart = 0;
+        for (size_t i = 0; i < length; ++i)
+        {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            if (!needsEscape(c))
+            {
+                continue;
+            }
+
+            // Copy the unescaped run in one go
+            out.append(text + runStart, i - runStart);
+            runStart = i + 1;
+
+            switch (c)
+            {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            case '\b':
+                out += "\\b";
+                break;
+            case '\f':
+                out += "\\f";
+                break;
+            default:
+                out += "\\u00";
+                out += HEX[c >> 4];
+                out += HEX[c & 0x0F];
+                break;
+            }
+        }
+        out.append(text + runStart, length - runStart);
+    }
+
+    void JsonWriter::appendUnsigned(std::string &out, unsigned long long number)
+    {
+        char digits[24];
+        char *end = digits + sizeof(digits);
+        char *cursor = end;
+        do
+        {
+            *--cursor = static_cast<char>('0' + number % 10);
+            number /= 10;
+        } while (number != 0);
+        out.append(cursor, static_cast<size_t>(end - cursor));
+    }
+
+    void JsonWriter::appendInteger(std::string &out, long long number)
+    {
+        if (number < 0)
+        {
+            out += '-';
+            // Negate in unsigned arithmetic so LLONG_MIN does not overflow
+            appendUnsigned(out, 0ULL - static_cast<unsigned long long>(number));
+            return;
+        }
+        appendUnsigned(out, static_cast<unsigned long long>(number));
+    }
+
+    void JsonWriter::appendDouble(std::string &out, double number)
+    {
+        if (!std::isfinite(number))
+        {
+            out += "null"; // JSON has no NaN/Infinity
+            return;
+        }
+
+        double magnitude = std::fabs(number);
+        if (magnitude >= FIXED_POINT_LIMIT)
+        {
+            char text[32];
+            int length = std::snprintf(text, sizeof(text), "%.17g", number);
+            out.append(text, static_cast<size_t>(length));
+            return;
+        }
+
+        // Fixed point with 6 decimals, trailing zeros trimmed
+        unsigned long long scaled = static_cast<unsigned long long>(std::llround(magnitude * FRACTION_SCALE));
+        if (number < 0 && scaled != 0)
+        {
+            out += '-';
+        }
+        appendUnsigned(out, scaled / FRACTION_SCALE);
+
+        unsigned long long fraction = scaled % FRACTION_SCALE;
+        if (fraction != 0)
+        {
+            char digits[FRACTION_DIGITS];
+            int count = FRACTION_DIGITS;
+            for (int i = FRACTION_DIGITS - 1; i >= 0; --i)
+            {
+                digits[i] = static_cast<char>('0' + fraction % 10);
+                fraction /= 10;
+            }
+            while (count > 0 && digits[count - 1] == '0')
+            {
+                --count;
+            }
+            out += '.';
+            out.append(digits, static_cast<size_t>(count));
+        }
+    }
+
+} // namespace Wallbox
@@ -0,0 +1,337 @@
+#include "LatencyTracer.h"
+#include "JsonWriter.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <unordered_map>
+
+namespace Wallbox
+{
+
+    constexpr size_t LatencyTracer::CAPACITY;
+
+    static_assert(sizeof(TraceSpanRecord) == 48, "TraceSpanRecord should stay compact");
+
+    namespace
+    {
+        constexpr size_t STAGE_COUNT = static_cast<size_t>(TraceStage::COUNT);
+
+        thread_local TraceContext t_current;
+
+        uint32_t currentThreadId()
+        {
+            thread_local uint32_t id = static_cast<uint32_t>(::syscall(SYS_gettid));
+            return id;
+        }
+
+        double toMicroseconds(uint64_t ns)
+        {
+            return static_cast<double>(ns) / 1000.0;
+        }
+
+        /**
+         * @brief Stages that mean the trace changed something (not an idle heartbeat)
+         */
+        bool isAction(TraceStage stage)
+        {
+            return stage != TraceStage::RECEIVE && stage != TraceStage::PARSE;
+        }
+    } // namespace
+
+    LatencyTracer &LatencyTracer::instance()
+    {
+        // Never destroyed: spans may still be recorded while statics are torn down
+        static LatencyTracer *tracer = new LatencyTracer();
+        return *tracer;
+    }
+
+    LatencyTracer::LatencyTracer()
+        : m_slots(new TraceSpanRecord[CAPACITY]),
+          m_next(0),
+          m_nextTraceId(1)
+    {
+        std::memset(m_slots.get(), 0, sizeof(TraceSpanRecord) * CAPACITY);
+
+        // 1 us ... ~1 s, two steps per power of two (at most 1/3 relative error)
+        std::vector<uint64_t> bounds = Histogram::logLinearBoundsNs(1000, 1000000000, 2);
+        MetricsRegistry &registry = MetricsRegistry::instance();
+        for (size_t stage = 0; stage < STAGE_COUNT; ++stage)
+        {
+            const char *name = stageName(static_cast<TraceStage>(stage));
+            m_stageDuration[stage] = &registry.histogram("wallbox_trace_stage_seconds",
+                                                         "Duration of one traced stage",
+                                                         {{"stage", name}}, bounds);
+            m_sinceOrigin[0][stage] = nullptr;
+            for (uint8_t origin = 1; origin <= 2; ++origin)
+            {
+                // Receive and parse start at the origin: their duration already says it
+                m_sinceOrigin[origin][stage] =
+                    isAction(static_cast<TraceStage>(stage))
+                        ? &registry.histogram("wallbox_trace_since_origin_seconds",
+                                              "Time from the trace origin (UDP receive, CP edge) to the end of a stage",
+                                              {{"origin", originName(static_cast<TraceOrigin>(origin))}, {"stage", name}},
+                                              bounds)
+                        : nullptr;
+            }
+        }
+    }
+
+    uint64_t LatencyTracer::nowNs()
+    {
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + static_cast<uint64_t>(now.tv_nsec);
+    }
+
+    TraceContext LatencyTracer::current()
+    {
+        return t_current;
+    }
+
+    void LatencyTracer::setCurrent(const TraceContext &context)
+    {
+        t_current = context;
+    }
+
+    TraceContext LatencyTracer::begin(TraceOrigin origin, uint64_t originNs)
+    {
+        TraceContext context;
+        context.id = m_nextTraceId.fetch_add(1, std::memory_order_relaxed);
+        if (context.id == 0)
+        {
+            context.id = m_nextTraceId.fetch_add(1, std::memory_order_relaxed); // Skip 0 on wrap
+        }
+        context.origin = origin;
+        context.originNs = originNs;
+        return context;
+    }
+
+    void LatencyTracer::record(const TraceContext &context, TraceStage stage, uint64_t startNs, uint64_t endNs)
+    {
+        size_t stageIndex = static_cast<size_t>(stage);
+        size_t originIndex = static_cast<size_t>(context.origin);
+        if (!context.active() || stageIndex >= STAGE_COUNT || originIndex > 2)
+        {
+            return;
+        }
+
+        endNs = std::max(endNs, startNs);
+        m_stageDuration[stageIndex]->observe(endNs - startNs);
+        if (m_sinceOrigin[originIndex][stageIndex] && endNs >= context.originNs)
+        {
+            m_sinceOrigin[originIndex][stageIndex]->observe(endNs - context.originNs);
+        }
+
+        uint64_t sequence = m_next.fetch_add(1, std::memory_order_relaxed) + 1;
+        TraceSpanRecord &slot = m_slots[(sequence - 1) % CAPACITY];
+
+        // Readers skip a slot whose sequence is 0 or changed while they copied it
+        __atomic_store_n(&slot.sequence, 0, __ATOMIC_RELAXED);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.startNs = startNs;
+        slot.endNs = endNs;
+        slot.originNs = context.originNs;
+        slot.traceId = context.id;
+        slot.thread = currentThreadId();
+        slot.origin = context.origin;
+        slot.stage = stage;
+
+        __atomic_store_n(&slot.sequence, sequence, __ATOMIC_RELEASE);
+    }
+
+    void LatencyTracer::snapshot(std::vector<TraceSpanRecord> &spans) const
+    {
+        spans.clear();
+        spans.reserve(CAPACITY);
+        for (size_t i = 0; i < CAPACITY; ++i)
+        {
+            const TraceSpanRecord &slot = m_slots[i];
+            uint64_t before = __atomic_load_n(&slot.sequence, __ATOMIC_ACQUIRE);
+            if (before == 0)
+            {
+                continue;
+            }
+            TraceSpanRecord copy = slot;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (__atomic_load_n(&slot.sequence, __ATOMIC_RELAXED) != before)
+            {
+                continue; // Overwritten while copying
+            }
+            copy.sequence = before;
+            spans.push_back(copy);
+        }
+        std::sort(spans.begin(), spans.end(), [](const TraceSpanRecord &a, const TraceSpanRecord &b)
+                  { return a.sequence < b.sequence; });
+    }
+
+    void LatencyTracer::writeChromeTrace(std::string &out, bool all) const
+    {
+        struct Summary
+        {
+            TraceOrigin origin;
+            uint64_t originNs;
+            uint64_t endNs;
+            bool action;
+        };
+
+        std::vector<TraceSpanRecord> spans;
+        snapshot(spans);
+
+        std::vector<uint32_t> order;
+        std::unordered_map<uint32_t, Summary> traces;
+        for (const auto &span : spans)
+        {
+            auto inserted = traces.insert(std::make_pair(span.traceId, Summary{span.origin, span.originNs, span.endNs, false}));
+            if (inserted.second)
+            {
+                order.push_back(span.traceId);
+            }
+            Summary &summary = inserted.first->second;
+            summary.endNs = std::max(summary.endNs, span.endNs);
+            summary.action = summary.action || isAction(span.stage);
+        }
+
+        int pid = static_cast<int>(getpid());
+        JsonWriter json(out);
+        json.beginObject()
+            .field("displayTimeUnit", "ns")
+            .key("traceEvents")
+            .beginArray();
+
+        json.beginObject()
+            .field("name", "process_name")
+            .field("ph", "M")
+            .field("pid", pid)
+            .key("args")
+            .beginObject()
+            .field("name", "wallbox")
+            .endObject()
+            .endObject();
+
+        // Whole traces as async events: they overlap each other and cross threads
+        for (uint32_t id : order)
+        {
+            const Summary &summary = traces[id];
+            if (!all && !summary.action)
+            {
+                continue;
+            }
+            const char *name = originName(summary.origin);
+            json.beginObject()
+                .field("name", name)
+                .field("cat", "trace")
+                .field("ph", "b")
+                .field("id", id)
+                .field("ts", toMicroseconds(summary.originNs))
+                .field("pid", pid)
+                .endObject();
+            json.beginObject()
+                .field("name", name)
+                .field("cat", "trace")
+                .field("ph", "e")
+                .field("id", id)
+                .field("ts", toMicroseconds(summary.endNs))
+                .field("pid", pid)
+                .endObject();
+        }
+
+        for (const auto &span : spans)
+        {
+            if (!all && !traces[span.traceId].action)
+            {
+                continue;
+            }
+            json.beginObject()
+                .field("name", stageName(span.stage))
+                .field("cat", originName(span.origin))
+                .field("ph", "X")
+                .field("ts", toMicroseconds(span.startNs))
+                .field("dur", toMicroseconds(span.endNs - span.startNs))
+                .field("pid", pid)
+                .field("tid", span.thread)
+                .key("args")
+                .beginObject()
+                .field("trace", span.traceId)
+                .field("sinceOriginUs", toMicroseconds(span.endNs - std::min(span.endNs, span.originNs)))
+                .endObject()
+                .endObject();
+        }
+
+        json.endArray().endObject();
+    }
+
+    const char *LatencyTracer::stageName(TraceStage stage)
+    {
+        switch (stage)
+        {
+        case TraceStage::RECEIVE:
+            return "receive";
+        case TraceStage::PARSE:
+            return "parse";
+        case TraceStage::TRANSITION:
+            return "transition";
+        case TraceStage::GPIO_WRITE:
+            return "gpio_write";
+        case TraceStage::RELAY:
+            return "relay";
+        case TraceStage::STATUS_SEND:
+            return "status_send";
+        default:
+            return "unknown";
+        }
+    }
+
+    const char *LatencyTracer::originName(TraceOrigin origin)
+    {
+        switch (origin)
+        {
+        case TraceOrigin::UDP:
+            return "udp";
+        case TraceOrigin::CP_EDGE:
+            return "cp_edge";
+        default:
+            return "none";
+        }
+    }
+
+    TraceScope::TraceScope(TraceOrigin origin, uint64_t originNs)
+        : m_context(LatencyTracer::instance().begin(origin, originNs)),
+          m_previous(LatencyTracer::current())
+    {
+        LatencyTracer::setCurrent(m_context);
+    }
+
+    TraceScope::TraceScope(const TraceContext &context)
+        : m_context(context),
+          m_previous(LatencyTracer::current())
+    {
+        LatencyTracer::setCurrent(m_context);
+    }
+
+    TraceScope::~TraceScope()
+    {
+        LatencyTracer::setCurrent(m_previous);
+    }
+
+    TraceSpan::TraceSpan(TraceStage stage)
+        : m_context(LatencyTracer::current()),
+          m_stage(stage),
+          m_startNs(m_context.active() ? LatencyTracer::nowNs() : 0)
+    {
+    }
+
+    void TraceSpan::end()
+    {
+        if (!m_context.active())
+        {
+            return;
+        }
+        LatencyTracer::instance().record(m_context, m_stage, m_startNs, LatencyTracer::nowNs());
+        m_context = TraceContext();
+    }
+
+} // namespace Wallbox
@@ -0,0 +1,644 @@
+#include "Logger.h"
+#include "SpscRing.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace Wallbox
+{
+
+    constexpr size_t LogRecord::TAG_CAPACITY;
+    constexpr size_t LogRecord::TEXT_CAPACITY;
+    constexpr size_t Logger::THREAD_RING_CAPACITY;
+    constexpr int Logger::MAX_FILE_SINKS;
+
+    std::atomic<int> Logger::s_level(static_cast<int>(LogLevel::INFO));
+
+    namespace
+    {
+        constexpr size_t PREFIX_CAPACITY = 64; ///< "[date time.ms] [LEVEL] [tag] "
+        constexpr size_t MAX_BATCH = 4096;     ///< Records written per writer pass
+        constexpr int IDLE_WAIT_MS = 500;      ///< Writer re-checks the rings at least this often
+        constexpr int FLUSH_TIMEOUT_MS = 2000;
+        constexpr int IOV_LIMIT = IOV_MAX;
+
+        const char NEWLINE = '\n';
+        const char TRUNCATED[] = "...";
+
+        uint64_t steadyNowNs()
+        {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                             std::chrono::steady_clock::now().time_since_epoch())
+                                             .count());
+        }
+
+        /**
+         * @brief writev() the whole vector, retrying on short writes and EINTR
+         * @return false on a write error (the rest of the vector is skipped)
+         */
+        bool writeAll(int fd, iovec *iov, int count)
+        {
+            while (count > 0)
+            {
+                ssize_t written = ::writev(fd, iov, count);
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    return false;
+                }
+
+                size_t remaining = static_cast<size_t>(written);
+                while (count > 0 && remaining >= iov->iov_len)
+                {
+                    remaining -= iov->iov_len;
+                    ++iov;
+                    --count;
+                }
+                if (count > 0)
+                {
+                    iov->iov_base = static_cast<char *>(iov->iov_base) + remaining;
+                    iov->iov_len -= remaining;
+                }
+            }
+            return true;
+        }
+
+        // The calling thread's ring; the writer reclaims it once the thread has exited
+        thread_local std::shared_ptr<void> t_buffer;
+    } // namespace
+
+    struct Logger::ThreadBuffer
+    {
+        ThreadBuffer()
+            : ring(THREAD_RING_CAPACITY),
+              dropped(0)
+        {
+            // Allocated with make_shared, which only guarantees fundamental alignment in C++14
+            static_assert(alignof(ThreadBuffer) <= alignof(std::max_align_t),
+                          "ThreadBuffer must not be over-aligned");
+        }
+
+        SpscRing<LogRecord> ring;
+        std::atomic<uint64_t> dropped;
+    };
+
+    Logger &Logger::instance()
+    {
+        // Never destroyed: threads may still log while statics are torn down
+        static Logger *logger = new Logger();
+        return *logger;
+    }
+
+    Logger::Logger()
+        : m_running(true),
+          m_waiting(false),
+          m_retiredDropped(0),
+          m_passes(0),
+          m_flushTarget(0),
+          m_cachedSecond(-1),
+          m_written(0),
+          m_batches(0),
+          m_writes(0)
+    {
+        std::fill(m_fileFds, m_fileFds + MAX_FILE_SINKS, -1);
+        m_cachedDate[0] = '\0';
+
+        int64_t wallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::system_clock::now().time_since_epoch())
+                             .count();
+        m_wallOffsetNs = wallNs - static_cast<int64_t>(steadyNowNs());
+
+        m_batch.reserve(MAX_BATCH);
+        m_prefixes.resize(MAX_BATCH * PREFIX_CAPACITY);
+        m_prefixLengths.resize(MAX_BATCH);
+
+        m_writer = std::thread([this]()
+                               { writerLoop(); });
+        std::atexit([]()
+                    { Logger::instance().shutdown(); });
+    }
+
+    void Logger::setLevel(LogLevel level)
+    {
+        s_level.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+
+    LogLevel Logger::getLevel()
+    {
+        return static_cast<LogLevel>(s_level.load(std::memory_order_relaxed));
+    }
+
+    bool Logger::parseLevel(const std::string &name, LogLevel &level)
+    {
+        std::string lower(name);
+        std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c)
+                       { return static_cast<char>(std::tolower(c)); });
+
+        if (lower == "trace")
+            level = LogLevel::TRACE;
+        else if (lower == "debug")
+            level = LogLevel::DEBUG;
+        else if (lower == "info")
+            level = LogLevel::INFO;
+        else if (lower == "warn" || lower == "warning")
+            level = LogLevel::WARN;
+        else if (lower == "error")
+            level = LogLevel::ERROR;
+        else if (lower == "off")
+            level = LogLevel::OFF;
+        else
+            return false;
+        return true;
+    }
+
+    const char *Logger::levelName(LogLevel level)
+    {
+        switch (level)
+        {
+        case LogLevel::TRACE:
+            return "TRACE";
+        case LogLevel::DEBUG:
+            return "DEBUG";
+        case LogLevel::INFO:
+            return "INFO";
+        case LogLevel::WARN:
+            return "WARN";
+        case LogLevel::ERROR:
+            return "ERROR";
+        default:
+            return "OFF";
+        }
+    }
+
+    LogSinks Logger::openFile(const std::string &path)
+    {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0)
+        {
+            return 0;
+        }
+
+        std::lock_guard<std::mutex> lock(m_sinkMutex);
+        for (int i = 0; i < MAX_FILE_SINKS; ++i)
+        {
+            if (m_fileFds[i] < 0)
+            {
+                m_fileFds[i] = fd;
+                return static_cast<LogSinks>(LOG_SINK_CONSOLE << (i + 1));
+            }
+        }
+        ::close(fd);
+        return 0;
+    }
+
+    void Logger::closeFile(LogSinks sink)
+    {
+        flush();
+
+        std::lock_guard<std::mutex> lock(m_sinkMutex);
+        for (int i = 0; i < MAX_FILE_SINKS; ++i)
+        {
+            if (sink == (LOG_SINK_CONSOLE << (i + 1)) && m_fileFds[i] >= 0)
+            {
+                ::close(m_fileFds[i]);
+                m_fileFds[i] = -1;
+            }
+        }
+    }
+
+    void Logger::submit(const LogRecord &record)
+    {
+        if (!m_running.load(std::memory_order_acquire))
+        {
+            writeRecords(&record, 1);
+            return;
+        }
+
+        ThreadBuffer *buffer = static_cast<ThreadBuffer *>(t_buffer.get());
+        if (!buffer)
+        {
+            auto created = std::make_shared<ThreadBuffer>();
+            buffer = created.get();
+            {
+                std::lock_guard<std::mutex> lock(m_registryMutex);
+                m_buffers.push_back(created);
+            }
+            t_buffer = std::move(created);
+        }
+
+        if (!buffer->ring.push(record))
+        {
+            buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        // Pairs with the fence in writerLoop(): either we see waiting or it sees the record
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_waiting.load(std::memory_order_relaxed))
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            m_wakeup.notify_one();
+        }
+    }
+
+    void Logger::flush()
+    {
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        if (!m_running.load(std::memory_order_acquire))
+        {
+            return;
+        }
+
+        // The pass in progress may have missed our lines; the one after cannot
+        uint64_t target = m_passes + 2;
+        m_flushTarget = std::max(m_flushTarget, target);
+        m_wakeup.notify_one();
+        m_flushed.wait_for(lock, std::chrono::milliseconds(FLUSH_TIMEOUT_MS), [this, target]()
+                           { return m_passes >= target || !m_running.load(std::memory_order_acquire); });
+    }
+
+    void Logger::shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            if (!m_running.load(std::memory_order_acquire))
+            {
+                return;
+            }
+            m_running.store(false, std::memory_order_release);
+        }
+        m_wakeup.notify_one();
+        m_flushed.notify_all();
+
+        if (m_writer.joinable())
+        {
+            m_writer.join();
+        }
+
+        // Lines pushed while the writer was finishing
+        while (drain() > 0)
+        {
+        }
+    }
+
+    LoggerStats Logger::getStats() const
+    {
+        LoggerStats stats;
+        stats.written = m_written.load(std::memory_order_relaxed);
+        stats.batches = m_batches.load(std::memory_order_relaxed);
+        stats.writes = m_writes.load(std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(m_registryMutex);
+        stats.dropped = m_retiredDropped;
+        for (const auto &buffer : m_buffers)
+        {
+            stats.dropped += buffer->dropped.load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+
+    void Logger::writerLoop()
+    {
+        while (true)
+        {
+            size_t written = drain();
+
+            {
+                std::lock_guard<std::mutex> lock(m_wakeMutex);
+                m_passes++;
+            }
+            m_flushed.notify_all();
+
+            if (written > 0)
+            {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            if (!m_running.load(std::memory_order_acquire))
+            {
+                break;
+            }
+            if (m_passes < m_flushTarget)
+            {
+                continue;
+            }
+
+            m_waiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!hasPending())
+            {
+                m_wakeup.wait_for(lock, std::chrono::milliseconds(IDLE_WAIT_MS));
+            }
+            m_waiting.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    bool Logger::hasPending()
+    {
+        std::lock_guard<std::mutex> lock(m_registryMutex);
+        for (const auto &buffer : m_buffers)
+        {
+            if (!buffer->ring.empty())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t Logger::drain()
+    {
+        m_batch.clear();
+        {
+            std::lock_guard<std::mutex> lock(m_registryMutex);
+            LogRecord record;
+            for (auto it = m_buffers.begin(); it != m_buffers.end();)
+            {
+                ThreadBuffer &buffer = **it;
+                while (m_batch.size() < MAX_BATCH && buffer.ring.pop(record))
+                {
+                    m_batch.push_back(record);
+                }
+
+                // Only the registry holds it: the thread has exited
+                if (it->use_count() == 1 && buffer.ring.empty())
+                {
+                    m_retiredDropped += buffer.dropped.load(std::memory_order_relaxed);
+                    it = m_buffers.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+
+        if (m_batch.empty())
+        {
+            return 0;
+        }
+
+        // Rings are in order per thread; merge threads by timestamp
+        std::stable_sort(m_batch.begin(), m_batch.end(), [](const LogRecord &a, const LogRecord &b)
+                         { return a.timestampNs < b.timestampNs; });
+        writeRecords(m_batch.data(), m_batch.size());
+        m_batches.fetch_add(1, std::memory_order_relaxed);
+        return m_batch.size();
+    }
+
+    void Logger::writeRecords(const LogRecord *records, size_t count)
+    {
+        // The prefix buffers are shared by the writer and post-shutdown direct writes
+        std::lock_guard<std::mutex> lock(m_sinkMutex);
+        for (size_t i = 0; i < count; ++i)
+        {
+            m_prefixLengths[i] = formatPrefix(records[i], &m_prefixes[i * PREFIX_CAPACITY]);
+        }
+        const char *prefixes = m_prefixes.data();
+        const size_t *prefixLengths = m_prefixLengths.data();
+
+        writeSink(STDOUT_FILENO, LOG_SINK_CONSOLE, records, prefixes, prefixLengths, count);
+        for (int i = 0; i < MAX_FILE_SINKS; ++i)
+        {
+            if (m_fileFds[i] >= 0)
+            {
+                writeSink(m_fileFds[i], static_cast<LogSinks>(LOG_SINK_CONSOLE << (i + 1)),
+                          records, prefixes, prefixLengths, count);
+            }
+        }
+        m_written.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    size_t Logger::formatPrefix(const LogRecord &record, char *out)
+    {
+        int64_t wallNs = static_cast<int64_t>(record.timestampNs) + m_wallOffsetNs;
+        time_t second = static_cast<time_t>(wallNs / 1000000000);
+        int millis = static_cast<int>((wallNs / 1000000) % 1000);
+
+        // localtime_r() once per second, not per line
+        if (second != m_cachedSecond)
+        {
+            struct tm local;
+            localtime_r(&second, &local);
+            strftime(m_cachedDate, sizeof(m_cachedDate), "%Y-%m-%d %H:%M:%S", &local);
+            m_cachedSecond = second;
+        }
+
+        int length;
+        if (record.tag[0] != '\0')
+        {
+            length = std::snprintf(out, PREFIX_CAPACITY, "[%s.%03d] [%s] [%s] ",
+                                   m_cachedDate, millis, levelName(record.level), record.tag);
+        }
+        else
+        {
+            length = std::snprintf(out, PREFIX_CAPACITY, "[%s.%03d] [%s] ",
+                                   m_cachedDate, millis, levelName(record.level));
+        }
+        return std::min(static_cast<size_t>(std::max(length, 0)), PREFIX_CAPACITY - 1);
+    }
+
+    void Logger::writeSink(int fd, LogSinks sink, const LogRecord *records, const char *prefixes,
+                           const size_t *prefixLengths, size_t count)
+    {
+        iovec iov[IOV_LIMIT];
+        int used = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (!(records[i].sinks & sink))
+            {
+                continue;
+            }
+
+            iov[used++] = {const_cast<char *>(prefixes + i * PREFIX_CAPACITY), prefixLengths[i]};
+            iov[used++] = {const_cast<char *>(records[i].text), records[i].length};
+            iov[used++] = {const_cast<char *>(&NEWLINE), 1};
+            if (used + 3 > IOV_LIMIT)
+            {
+                writeAll(fd, iov, used);
+                m_writes.fetch_add(1, std::memory_order_relaxed);
+                used = 0;
+            }
+        }
+
+        if (used > 0)
+        {
+            writeAll(fd, iov, used);
+            m_writes.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    LogLine::LogLine(LogLevel level, const char *tag, LogSinks sinks)
+    {
+        start(level, tag, sinks);
+    }
+
+    LogLine::LogLine(const std::string &levelName, LogSinks sinks)
+    {
+        LogLevel level;
+        if (Logger::parseLevel(levelName, level))
+        {
+            start(level, "", sinks);
+        }
+        else
+        {
+            start(LogLevel::INFO, levelName.c_str(), sinks);
+        }
+    }
+
+    void LogLine::start(LogLevel level, const char *tag, LogSinks sinks)
+    {
+        m_enabled = sinks != 0 && level != LogLevel::OFF && Logger::isEnabled(level);
+        m_truncated = false;
+        m_record.length = 0;
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        m_record.timestampNs = steadyNowNs();
+        m_record.level = level;
+        m_record.sinks = sinks;
+        size_t tagLength = tag ? std::min(std::strlen(tag), LogRecord::TAG_CAPACITY - 1) : 0;
+        std::memcpy(m_record.tag, tag, tagLength);
+        m_record.tag[tagLength] = '\0';
+    }
+
+    LogLine::~LogLine()
+    {
+        if (m_enabled)
+        {
+            Logger::instance().submit(m_record);
+        }
+    }
+
+    void LogLine::append(const char *data, size_t length)
+    {
+        if (!m_enabled || m_truncated)
+        {
+            return;
+        }
+
+        size_t room = LogRecord::TEXT_CAPACITY - m_record.length;
+        if (length <= room)
+        {
+            std::memcpy(m_record.text + m_record.length, data, length);
+            m_record.length = static_cast<uint16_t>(m_record.length + length);
+            return;
+        }
+
+        // Cut and mark; later appends are ignored
+        size_t keep = LogRecord::TEXT_CAPACITY - (sizeof(TRUNCATED) - 1);
+        if (m_record.length < keep)
+        {
+            std::memcpy(m_record.text + m_record.length, data, keep - m_record.length);
+        }
+        std::memcpy(m_record.text + keep, TRUNCATED, sizeof(TRUNCATED) - 1);
+        m_record.length = static_cast<uint16_t>(LogRecord::TEXT_CAPACITY);
+        m_truncated = true;
+    }
+
+    void LogLine::appendUnsigned(unsigned long long value, bool negative)
+    {
+        char digits[24];
+        char *end = digits + sizeof(digits);
+        char *p = end;
+        do
+        {
+            *--p = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        if (negative)
+        {
+            *--p = '-';
+        }
+        append(p, static_cast<size_t>(end - p));
+    }
+
+    LogLine &LogLine::operator<<(const char *text)
+    {
+        if (text)
+        {
+            append(text, std::strlen(text));
+        }
+        return *this;
+    }
+
+    LogLine &LogLine::operator<<(const std::string &text)
+    {
+        append(text.data(), text.size());
+        return *this;
+    }
+
+    LogLine &LogLine::operator<<(char value)
+    {
+        append(&value, 1);
+        return *this;
+    }
+
+    LogLine &LogLine::operator<<(bool value)
+    {
+        return *this << (value ? "true" : "false");
+    }
+
+    LogLine &LogLine::operator<<(int value)
+    {
+        return *this << static_cast<long long>(value);
+    }
+
+    LogLine &LogLine::operator<<(unsigned int value)
+    {
+        appendUnsigned(value, false);
+        return *this;
+    }
+
+    LogLine &LogLine::operator<<(long value)
+    {
+        return *this << static_cast<long long>(value);
+    }
+
+    LogLine &LogLine::operator<<(unsigned long value)
+    {
+        appendUnsigned(value, false);
+        return *this;
+    }
+
+    LogLine &LogLine::operator<<(long long value)
+    {
+        // Negate in unsigned arithmetic so LLONG_MIN does not overflow
+        unsigned long long magnitude = static_cast<unsigned long long>(value);
+        appendUnsigned(value < 0 ? 0 - magnitude : magnitude, value < 0);
+        return *this;
+    }
+
+    LogLine &LogLine::operator<<(unsigned long long value)
+    {
+        appendUnsigned(value, false);
+        return *this;
+    }
+
+    LogLine &LogLine::operator<<(double value)
+    {
+        if (m_enabled)
+        {
+            char buffer[32];
+            int length = std::snprintf(buffer, sizeof(buffer), "%g", value);
+            append(buffer, static_cast<size_t>(std::max(length, 0)));
+        }
+        return *this;
+    }
+
+} // namespace Wallbox
@@ -0,0 +1,275 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+namespace Wallbox
+{
+
+    constexpr const char *MetricsRegistry::CONTENT_TYPE;
+
+    namespace
+    {
+        void appendEscaped(std::string &out, const std::string &text, bool quotes)
+        {
+            for (char c : text)
+            {
+                if (c == '\\')
+                {
+                    out += "\\\\";
+                }
+                else if (c == '\n')
+                {
+                    out += "\\n";
+                }
+                else if (c == '"' && quotes)
+                {
+                    out += "\\\"";
+                }
+                else
+                {
+                    out += c;
+                }
+            }
+        }
+
+        void appendUnsigned(std::string &out, uint64_t value)
+        {
+            char buffer[24];
+            int length = std::snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(value));
+            out.append(buffer, static_cast<size_t>(length));
+        }
+
+        void appendSeconds(std::string &out, uint64_t ns)
+        {
+            char buffer[32];
+            int length = std::snprintf(buffer, sizeof(buffer), "%.9g", static_cast<double>(ns) / 1e9);
+            out.append(buffer, static_cast<size_t>(length));
+        }
+
+        /**
+         * @brief name{labels,extra} with empty parts left out
+         */
+        void appendName(std::string &out, const std::string &name, const char *suffix,
+                        const std::string &labels, const std::string &extra)
+        {
+            out += name;
+            out += suffix;
+            if (labels.empty() && extra.empty())
+            {
+                return;
+            }
+            out += '{';
+            out += labels;
+            if (!labels.empty() && !extra.empty())
+            {
+                out += ',';
+            }
+            out += extra;
+            out += '}';
+        }
+    } // namespace
+
+    Histogram::Histogram(const std::vector<uint64_t> &boundsNs)
+        : m_bounds(boundsNs),
+          m_buckets(new std::atomic<uint64_t>[boundsNs.size() + 1]),
+          m_count(0),
+          m_sumNs(0)
+    {
+        std::sort(m_bounds.begin(), m_bounds.end());
+        for (size_t i = 0; i <= m_bounds.size(); ++i)
+        {
+            m_buckets[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void Histogram::observe(uint64_t valueNs)
+    {
+        size_t index = static_cast<size_t>(std::lower_bound(m_bounds.begin(), m_bounds.end(), valueNs) - m_bounds.begin());
+        m_buckets[index].fetch_add(1, std::memory_order_relaxed);
+        m_sumNs.fetch_add(valueNs, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const std::vector<uint64_t> &Histogram::latencyBoundsNs()
+    {
+        static const std::vector<uint64_t> bounds = {
+            10000, 25000, 50000, 100000, 250000, 500000,
+            1000000, 2500000, 5000000, 10000000, 25000000, 50000000,
+            100000000, 250000000, 500000000, 1000000000};
+        return bounds;
+    }
+
+    std::vector<uint64_t> Histogram::logLinearBoundsNs(uint64_t lowestNs, uint64_t highestNs, unsigned subBuckets)
+    {
+        std::vector<uint64_t> bounds;
+        uint64_t base = std::max<uint64_t>(lowestNs, 1);
+        unsigned steps = std::max(subBuckets, 1u);
+        bounds.push_back(base);
+        while (bounds.back() < highestNs)
+        {
+            for (unsigned i = 1; i <= steps; ++i)
+            {
+                uint64_t bound = base + base * i / steps;
+                if (bound > bounds.back())
+                {
+                    bounds.push_back(bound);
+                }
+            }
+            base *= 2;
+        }
+        return bounds;
+    }
+
+    MetricsRegistry &MetricsRegistry::instance()
+    {
+        // Never destroyed: metric references are held for the life of the process
+        static MetricsRegistry *registry = new MetricsRegistry();
+        return *registry;
+    }
+
+    MetricsRegistry::Series &MetricsRegistry::find(const std::string &name, const std::string &help, Type type, Labels labels)
+    {
+        std::string rendered;
+        for (const auto &label : labels)
+        {
+            if (!rendered.empty())
+            {
+                rendered += ',';
+            }
+            rendered += label.first;
+            rendered += "=\"";
+            appendEscaped(rendered, label.second, true);
+            rendered += '"';
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto family = std::find_if(m_families.begin(), m_families.end(), [&name](const std::unique_ptr<Family> &f)
+                                   { return f->name == name; });
+        if (family == m_families.end())
+        {
+            std::unique_ptr<Family> created(new Family{name, help, type, {}});
+            family = m_families.insert(m_families.end(), std::move(created));
+        }
+        else if ((*family)->type != type)
+        {
+            throw std::invalid_argument("Metric " + name + " registered with a different type");
+        }
+
+        for (auto &series : (*family)->series)
+        {
+            if (series->labels == rendered)
+            {
+                return *series;
+            }
+        }
+        (*family)->series.emplace_back(new Series());
+        Series &series = *(*family)->series.back();
+        series.labels = rendered;
+        return series;
+    }
+
+    Counter &MetricsRegistry::counter(const std::string &name, const std::string &help, Labels labels)
+    {
+        Series &series = find(name, help, Type::COUNTER, labels);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!series.counter)
+        {
+            series.counter.reset(new Counter());
+        }
+        return *series.counter;
+    }
+
+    Gauge &MetricsRegistry::gauge(const std::string &name, const std::string &help, Labels labels)
+    {
+        Series &series = find(name, help, Type::GAUGE, labels);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!series.gauge)
+        {
+            series.gauge.reset(new Gauge());
+        }
+        return *series.gauge;
+    }
+
+    Histogram &MetricsRegistry::histogram(const std::string &name, const std::string &help, Labels labels,
+                                          const std::vector<uint64_t> &boundsNs)
+    {
+        Series &series = find(name, help, Type::HISTOGRAM, labels);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!series.histogram)
+        {
+            series.histogram.reset(new Histogram(boundsNs));
+        }
+        return *series.histogram;
+    }
+
+    void MetricsRegistry::render(std::string &out) const
+    {
+        static const char *const TYPE_NAMES[] = {"counter", "gauge", "histogram"};
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto &family : m_families)
+        {
+            out += "# HELP ";
+            out += family->name;
+            out += ' ';
+            appendEscaped(out, family->help, false);
+            out += "\n# TYPE ";
+            out += family->name;
+            out += ' ';
+            out += TYPE_NAMES[static_cast<int>(family->type)];
+            out += '\n';
+
+            for (const auto &series : family->series)
+            {
+                if (series->counter)
+                {
+                    appendName(out, family->name, "", series->labels, "");
+                    out += ' ';
+                    appendUnsigned(out, series->counter->value());
+                    out += '\n';
+                }
+                else if (series->gauge)
+                {
+                    appendName(out, family->name, "", series->labels, "");
+                    out += ' ';
+                    out += std::to_string(series->gauge->value());
+                    out += '\n';
+                }
+                else if (series->histogram)
+                {
+                    const Histogram &histogram = *series->histogram;
+                    uint64_t cumulative = 0;
+                    for (size_t i = 0; i <= histogram.bounds().size(); ++i)
+                    {
+                        cumulative += histogram.bucketCount(i);
+                        std::string le = "le=\"";
+                        if (i < histogram.bounds().size())
+                        {
+                            appendSeconds(le, histogram.bounds()[i]);
+                        }
+                        else
+                        {
+                            le += "+Inf";
+                        }
+                        le += '"';
+                        appendName(out, family->name, "_bucket", series->labels, le);
+                        out += ' ';
+                        appendUnsigned(out, cumulative);
+                        out += '\n';
+                    }
+                    appendName(out, family->name, "_sum", series->labels, "");
+                    out += ' ';
+                    appendSeconds(out, histogram.sumNs());
+                    out += '\n';
+                    // Keep _count equal to the +Inf bucket even while observations race the scrape
+                    appendName(out, family->name, "_count", series->labels, "");
+                    out += ' ';
+                    appendUnsigned(out, cumulative);
+                    out += '\n';
+                }
+            }
+        }
+    }
+
+} // namespace Wallbox
@@ -2,35 +2,136 @@
 #include "Configuration.h"
 #include "CpSignalReaderFactory.h"
 #include "IsoStackCtrlProtocol.h"
+#include "EventJournal.h"
+#include "GpioEdgeWatcher.h"
+#include "LatencyTracer.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include <algorithm>
 #include <iostream>
 #include <thread>
 #include <chrono>
-#include <sstream>
 #include <ctime>
 #include <cstring>
+#include <future>
+#include <random>
+#include <sys/epoll.h>
 
 using namespace Iso15118;
 
 namespace Wallbox
 {
 
+    namespace
+    {
+        constexpr int COMMAND_POLL_MS = 10; ///< execute(): how often a waiting caller checks for a stopped loop
+
+        struct ControllerMetrics
+        {
+            Counter &commands;
+            Histogram &commandDuration;
+            Counter &relayToggles;
+            Gauge &relayOn;
+            Gauge &wallboxEnabled;
+            Counter &gpioWritesSaved;
+            Counter &cpChanges;
+            Histogram &cpToOutputs;
+            Counter &udpShort;
+
+            ControllerMetrics()
+                : commands(MetricsRegistry::instance().counter("wallbox_commands_total",
+                                                               "Commands run on the controller loop")),
+                  commandDuration(MetricsRegistry::instance().histogram("wallbox_command_duration_seconds",
+                                                                        "Time from submitting a command to its result")),
+                  relayToggles(MetricsRegistry::instance().counter("wallbox_relay_toggles_total",
+                                                                   "Relay changes between ON and OFF")),
+                  relayOn(MetricsRegistry::instance().gauge("wallbox_relay_on", "1 while the relay is ON")),
+                  wallboxEnabled(MetricsRegistry::instance().gauge("wallbox_enabled", "1 while the wallbox is enabled")),
+                  gpioWritesSaved(MetricsRegistry::instance().counter("wallbox_gpio_writes_saved_total",
+                                                                      "Output writes skipped because the pin already had the level")),
+                  cpChanges(MetricsRegistry::instance().counter("wallbox_cp_changes_total", "Control pilot state changes")),
+                  cpToOutputs(MetricsRegistry::instance().histogram("wallbox_cp_to_outputs_seconds",
+                                                                    "Time from a CP change to the outputs being updated")),
+                  udpShort(MetricsRegistry::instance().counter("wallbox_udp_rx_short_total",
+                                                               "Datagrams too short for a stack state message"))
+            {
+            }
+        };
+
+        ControllerMetrics &controllerMetrics()
+        {
+            static ControllerMetrics metrics;
+            return metrics;
+        }
+
+        /**
+         * @brief First snapshot version of this process: a per-boot epoch times 2^32, plus one
+         *
+         * Versions (and the ETags made from them) of different runs never
+         * meet, so an If-None-Match or ?since= from before a restart can not
+         * match a different body. The epoch has 20 bits, which keeps every
+         * version below 2^53 and exact in JavaScript clients.
+         */
+        uint64_t firstSnapshotVersion()
+        {
+            std::random_device random;
+            uint64_t seed = (static_cast<uint64_t>(random()) << 16) ^ static_cast<uint64_t>(std::time(nullptr)) ^
+                            static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+            uint64_t epoch = seed % ((1ULL << 20) - 1) + 1;
+            return (epoch << 32) + 1;
+        }
+    } // namespace
+
     WallboxController::WallboxController(std::unique_ptr<IGpioController> gpio,
                                          std::unique_ptr<INetworkCommunicator> network)
         : m_gpio(std::move(gpio)),
           m_network(std::move(network)),
           m_stateMachine(std::make_unique<ChargingStateMachine>()),
           m_running(false),
+          m_shutDown(false),
           m_relayEnabled(false),
           m_wallboxEnabled(true),
           m_currentCpState(CpState::UNKNOWN),
-          m_operatingMode("simulator") // Default to simulator mode
+          m_operatingMode("simulator"), // Default to simulator mode
+          m_gpioWrites(0),
+          m_gpioWritesSaved(0),
+          m_buttonLevel(PinValue::HIGH),
+          m_lastButtonNs(0),
+          m_heartbeatTimer(-1),
+          m_blinkTimer(-1),
+          m_heartbeatMs(1000),
+          m_blinkIntervalMs(0),
+          m_blinkOn(false),
+          m_statusSendPending(false),
+          m_cpLatencyCount(0),
+          m_cpLatencyLastNs(0),
+          m_cpLatencyMaxNs(0),
+          m_cpLatencyTotalNs(0),
+          m_journalOpened(false)
     {
+        m_onMessage = [this](ByteSpan message)
+        {
+            processNetworkMessage(message);
+        };
+
         // Register for state change notifications (Observer Pattern)
         m_stateMachine->addStateChangeListener(
             [this](ChargingState oldState, ChargingState newState, const std::string &reason)
             {
                 onStateChange(oldState, newState, reason);
             });
+
+        // Informational only: runs on the listener thread, off the transition path
+        m_stateMachine->addStateChangeListener(
+            [this](ChargingState oldState, ChargingState newState, const std::string &)
+            {
+                WALLBOX_LOG_DEBUG("Wallbox") << "Controller responding to state change: "
+                                             << m_stateMachine->getStateString(oldState) << " -> "
+                                             << m_stateMachine->getStateString(newState);
+            },
+            ListenerMode::ASYNCHRONOUS);
+
+        refreshSnapshot();
     }
 
     WallboxController::~WallboxController()
@@ -41,6 +142,15 @@ namespace Wallbox
     bool WallboxController::initialize()
     {
         std::cout << "Initializing Wallbox Controller..." << std::endl;
+        m_shutDown = false;
+
+        // Post-mortem trace of transitions, relay, CP and UDP traffic
+        const Configuration &config = Configuration::getInstance();
+        if (!config.getEventJournalFile().empty())
+        {
+            m_journalOpened = EventJournal::instance().open(
+                config.getEventJournalFile(), static_cast<size_t>(std::max(0, config.getEventJournalSizeKb())) * 1024);
+        }
 
         // Initialize GPIO
         if (!m_gpio->initialize())
@@ -50,6 +160,24 @@ namespace Wallbox
         }
 
         setupGpio();
+        refreshSnapshot();
+
+        // Register the trace histograms before the first trace, off the control path
+        LatencyTracer::instance();
+
+        // Controller loop: everything below reports into it
+        if (!m_loop.open())
+        {
+            std::cerr << "Failed to create controller event loop" << std::endl;
+            return false;
+        }
+        m_heartbeatMs = static_cast<uint32_t>(std::max(1, Configuration::getInstance().getStatusHeartbeatMs()));
+        m_heartbeatTimer = m_loop.addTimer([this]()
+                                           { sendStatusToSimulator(); });
+        m_blinkTimer = m_loop.addTimer([this]()
+                                       {
+            m_blinkOn = !m_blinkOn;
+            updateLeds(); });
 
         // Initialize network
         if (!m_network->connect())
@@ -58,9 +186,20 @@ namespace Wallbox
             return false;
         }
 
-        // Start receiving network messages
-        m_network->startReceiving([this](const std::vector<uint8_t> &message)
-                                  { processNetworkMessage(message); });
+        // Receive on the loop when the communicator exposes its socket, else hand messages over
+        int receiveFd = m_network->receiveFd();
+        if (receiveFd < 0 || !m_loop.addFd(receiveFd, EPOLLIN, [this](uint32_t)
+                                            { m_network->receivePending(m_onMessage); }))
+        {
+            m_network->startReceiving([this](ByteSpan message)
+                                      {
+                std::vector<uint8_t> copy(message.data, message.data + message.size);
+                TraceContext trace = LatencyTracer::current();
+                m_loop.post([this, copy, trace]()
+                            {
+                    TraceScope scope(trace);
+                    processNetworkMessage(ByteSpan(copy)); }); });
+        }
 
         // Initialize CP signal reader using Factory Pattern
         // Determine operating mode from environment or configuration
@@ -86,9 +225,20 @@ namespace Wallbox
                 return false;
             }
 
-            // Register CP state change callback (Observer Pattern)
+            // Register CP state change callback (Observer Pattern); handled on the controller loop
             m_cpReader->onStateChange([this](CpState oldState, CpState newState)
-                                      { onCpStateChange(oldState, newState); });
+                                      {
+                uint64_t changeNs = m_cpReader->lastChangeTimestampNs();
+                if (changeNs == 0)
+                {
+                    changeNs = GpioEdgeWatcher::monotonicNowNs();
+                }
+                m_loop.post([this, oldState, newState, changeNs]()
+                            {
+                    TraceScope trace(TraceOrigin::CP_EDGE, changeNs);
+                    LatencyTracer::instance().record(trace.context(), TraceStage::RECEIVE, changeNs, LatencyTracer::nowNs());
+                    onCpStateChange(oldState, newState);
+                    recordCpLatency(changeNs); }); });
 
             // Start monitoring CP signal
             m_cpReader->startMonitoring();
@@ -109,10 +259,18 @@ namespace Wallbox
 
     void WallboxController::shutdown()
     {
+        // Called explicitly and again from the destructor: only the first call tears down
+        if (m_shutDown.exchange(true))
+        {
+            return;
+        }
+
         std::cout << "Shutting down Wallbox Controller..." << std::endl;
 
         m_running = false;
 
+        // run() has returned: from here on this thread is the only one changing state
+
         // Stop CP monitoring
         if (m_cpReader)
         {
@@ -123,15 +281,19 @@ namespace Wallbox
         // Stop charging if active
         if (m_stateMachine->isCharging())
         {
-            stopCharging();
+            stopChargingOnLoop();
         }
 
         // Disable relay
-        setRelayState(false);
+        setRelayStateOnLoop(false);
 
         // Shutdown network
         if (m_network)
         {
+            if (m_network->receiveFd() >= 0)
+            {
+                m_loop.removeFd(m_network->receiveFd());
+            }
             m_network->stopReceiving();
             m_network->disconnect();
         }
@@ -139,53 +301,140 @@ namespace Wallbox
         // Shutdown GPIO
         if (m_gpio)
         {
+            m_gpio->unwatchPin(Configuration::getInstance().getButtonPin());
             m_gpio->shutdown();
         }
 
+        if (m_journalOpened)
+        {
+            EventJournal::instance().close();
+            m_journalOpened = false;
+        }
+
+        m_loop.close();
+        m_heartbeatTimer = -1;
+        m_blinkTimer = -1;
+
         std::cout << "Wallbox Controller shutdown complete" << std::endl;
     }
 
     void WallboxController::run()
     {
-        m_running = true;
+        if (!m_loop.isOpen())
+        {
+            std::cerr << "Wallbox Controller not initialized" << std::endl;
+            return;
+        }
 
+        m_running = true;
         std::cout << "Wallbox Controller running..." << std::endl;
 
-        auto lastStatusSend = std::chrono::steady_clock::now();
-        const auto statusInterval = std::chrono::milliseconds(100); // Send status every 100ms to match simulator
+        // Button edges arrive through IGpioController::watchPin() (see setupGpio);
+        // status, LEDs, CP changes and simulator messages through the loop
+        updateLeds();
+        sendStatusToSimulator();
+        m_loop.run();
+
+        m_running = false;
+        std::cout << "Wallbox Controller loop stopped (" << m_loop.wakeups() << " wakeups)" << std::endl;
+    }
+
+    void WallboxController::stop()
+    {
+        m_running = false;
+        m_loop.stop();
+    }
+
+    std::future<bool> WallboxController::submit(Command command)
+    {
+        auto promise = std::make_shared<std::promise<bool>>();
+        std::future<bool> result = promise->get_future();
+        m_loop.post([promise, command]()
+                    { promise->set_value(command()); });
+        return result;
+    }
+
+    void WallboxController::submit(Command command, CommandCallback done)
+    {
+        m_loop.post([command, done]()
+                    { done(command()); });
+    }
 
-        while (m_running)
+    bool WallboxController::execute(Command command)
+    {
+        ControllerMetrics &metrics = controllerMetrics();
+        metrics.commands.inc();
+        if (m_loop.inLoopThread())
         {
-            // Update LEDs based on current state
-            updateLeds();
+            return command();
+        }
 
-            // Send status to simulator periodically
-            auto now = std::chrono::steady_clock::now();
-            if (now - lastStatusSend >= statusInterval)
+        uint64_t submittedNs = GpioEdgeWatcher::monotonicNowNs();
+        std::future<bool> result = submit(std::move(command));
+        // While the loop is stopped (startup, shutdown) the waiting caller runs the queue itself;
+        // a running loop owns its queue and is only waited on
+        if (!m_loop.isRunning())
+        {
+            m_loop.runPending();
+        }
+        while (result.wait_for(std::chrono::milliseconds(COMMAND_POLL_MS)) != std::future_status::ready)
+        {
+            if (!m_loop.isRunning())
             {
-                sendStatusToSimulator();
-                lastStatusSend = now;
+                m_loop.runPending();
             }
+        }
+        metrics.commandDuration.observe(GpioEdgeWatcher::monotonicNowNs() - submittedNs);
+        return result.get();
+    }
 
-            // Check for button press (if implemented)
-            // PinValue buttonState = m_gpio->digitalRead(Configuration::Pins::BUTTON);
+    bool WallboxController::startCharging()
+    {
+        return execute([this]()
+                       { return startChargingOnLoop(); });
+    }
 
-            // Small delay to prevent CPU spinning
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        }
+    bool WallboxController::stopCharging()
+    {
+        return execute([this]()
+                       { return stopChargingOnLoop(); });
     }
 
-    void WallboxController::stop()
+    bool WallboxController::pauseCharging()
     {
-        m_running = false;
+        return execute([this]()
+                       { return pauseChargingOnLoop(); });
     }
 
-    bool WallboxController::startCharging()
+    bool WallboxController::resumeCharging()
+    {
+        return execute([this]()
+                       { return resumeChargingOnLoop(); });
+    }
+
+    bool WallboxController::enableWallbox()
+    {
+        return execute([this]()
+                       { return enableWallboxOnLoop(); });
+    }
+
+    bool WallboxController::disableWallbox()
+    {
+        return execute([this]()
+                       { return disableWallboxOnLoop(); });
+    }
+
+    bool WallboxController::setRelayState(bool enabled)
+    {
+        return execute([this, enabled]()
+                       { return setRelayStateOnLoop(enabled); });
+    }
+
+    bool WallboxController::startChargingOnLoop()
     {
         if (!m_wallboxEnabled)
         {
-            std::cerr << "\n⚠️  Cannot start charging: wallbox is disabled" << std::endl;
-            std::cout << "\n[WALLBOX] ❌ Command rejected - wallbox disabled" << std::endl;
+            WALLBOX_LOG_WARN("Wallbox") << "❌ Cannot start charging: wallbox is disabled";
             return false;
         }
 
@@ -194,17 +443,17 @@ namespace Wallbox
             return false;
         }
 
-        std::cout << "\n[WALLBOX → SIMULATOR] ✓ Starting charging sequence" << std::endl;
+        WALLBOX_LOG_INFO("Wallbox") << "✓ Starting charging sequence";
 
         // Enable relay for charging
-        return setRelayState(true);
+        return setRelayStateOnLoop(true);
     }
 
-    bool WallboxController::stopCharging()
+    bool WallboxController::stopChargingOnLoop()
     {
         if (!m_wallboxEnabled)
         {
-            std::cerr << "\n⚠️  Cannot stop charging: wallbox is disabled" << std::endl;
+            WALLBOX_LOG_WARN("Wallbox") << "Cannot stop charging: wallbox is disabled";
             return false;
         }
 
@@ -213,99 +462,196 @@ namespace Wallbox
             return false;
         }
 
-        std::cout << "\n[WALLBOX → SIMULATOR] Stopping charging" << std::endl;
+        WALLBOX_LOG_INFO("Wallbox") << "Stopping charging";
 
         // Disable relay
-        return setRelayState(false);
+        return setRelayStateOnLoop(false);
     }
 
-    bool WallboxController::pauseCharging()
+    bool WallboxController::pauseChargingOnLoop()
     {
         if (!m_wallboxEnabled)
         {
-            std::cerr << "\n⚠️  Cannot pause charging: wallbox is disabled" << std::endl;
+            WALLBOX_LOG_WARN("Wallbox") << "Cannot pause charging: wallbox is disabled";
             return false;
         }
 
-        std::cout << "\n[WALLBOX → SIMULATOR] Pausing charging" << std::endl;
+        WALLBOX_LOG_INFO("Wallbox") << "Pausing charging";
         return m_stateMachine->pauseCharging("User requested");
     }
 
-    bool WallboxController::resumeCharging()
+    bool WallboxController::resumeChargingOnLoop()
     {
         if (!m_wallboxEnabled)
         {
-            std::cerr << "\n⚠️  Cannot resume charging: wallbox is disabled" << std::endl;
+            WALLBOX_LOG_WARN("Wallbox") << "Cannot resume charging: wallbox is disabled";
             return false;
         }
 
-        std::cout << "\n[WALLBOX → SIMULATOR] Resuming charging" << std::endl;
+        WALLBOX_LOG_INFO("Wallbox") << "Resuming charging";
         return m_stateMachine->resumeCharging("User requested");
     }
 
     ChargingState WallboxController::getCurrentState() const
     {
-        return m_stateMachine->getCurrentState();
+        return getStatusSnapshot()->state;
     }
 
     std::string WallboxController::getStateString() const
     {
-        return m_stateMachine->getStateString();
+        return m_stateMachine->getStateString(getStatusSnapshot()->state);
     }
 
-    bool WallboxController::enableWallbox()
+    bool WallboxController::enableWallboxOnLoop()
     {
         m_wallboxEnabled = true;
-        std::cout << "\n[WALLBOX] 🟢 Wallbox ENABLED - Relay ON by default" << std::endl;
-        setRelayState(true); // Relay ON when wallbox enabled
+        controllerMetrics().wallboxEnabled.set(1);
+        WALLBOX_LOG_INFO("Wallbox") << "🟢 Wallbox ENABLED - Relay ON by default";
+        setRelayStateOnLoop(true); // Relay ON when wallbox enabled
+        refreshSnapshot();
         updateLeds();
         return true;
     }
 
-    bool WallboxController::disableWallbox()
+    bool WallboxController::disableWallboxOnLoop()
     {
         // Stop charging if active
         if (m_stateMachine->isCharging())
         {
-            std::cout << "\n[WALLBOX] Stopping active charging before disable..." << std::endl;
-            stopCharging();
+            WALLBOX_LOG_INFO("Wallbox") << "Stopping active charging before disable...";
+            stopChargingOnLoop();
         }
 
         m_wallboxEnabled = false;
-        setRelayState(false); // Relay OFF when wallbox disabled
-        std::cout << "\n[WALLBOX] 🔴 Wallbox DISABLED - Relay OFF" << std::endl;
+        controllerMetrics().wallboxEnabled.set(0);
+        setRelayStateOnLoop(false); // Relay OFF when wallbox disabled
+        WALLBOX_LOG_INFO("Wallbox") << "🔴 Wallbox DISABLED - Relay OFF";
+        refreshSnapshot();
         updateLeds();
         return true;
     }
 
-    bool WallboxController::setRelayState(bool enabled)
+    bool WallboxController::setRelayStateOnLoop(bool enabled)
     {
-        PinValue value = enabled ? PinValue::HIGH : PinValue::LOW;
-        auto &config = Configuration::getInstance();
+        PinWrite write = {Configuration::getInstance().getRelayPin(), enabled ? PinValue::HIGH : PinValue::LOW};
 
-        if (!m_gpio->digitalWrite(config.getRelayPin(), value))
+        TraceSpan span(TraceStage::RELAY);
+        bool written = writeOutputs(&write, 1);
+        span.end();
+        if (!written)
         {
-            std::cerr << "Failed to set relay state" << std::endl;
+            WALLBOX_LOG_ERROR("Wallbox") << "Failed to set relay state";
             return false;
         }
 
+        bool changed = m_relayEnabled != enabled;
         m_relayEnabled = enabled;
-        std::cout << "\n[WALLBOX → SIMULATOR] Relay state: "
-                  << (enabled ? "ON" : "OFF") << std::endl;
+        controllerMetrics().relayOn.set(enabled ? 1 : 0);
+        if (changed)
+        {
+            controllerMetrics().relayToggles.inc();
+        }
+        WALLBOX_LOG_INFO("Wallbox") << "Relay state: " << (enabled ? "ON" : "OFF");
+        EventJournal::instance().record(JournalEvent::RELAY, enabled ? 1 : 0, changed ? 1 : 0);
+
+        if (changed)
+        {
+            refreshSnapshot();
+
+            std::string data;
+            JsonWriter json(data);
+            json.beginObject()
+                .field("type", "relay")
+                .field("relayEnabled", enabled)
+                .key("status")
+                .rawValue(getStatusSnapshot()->statusJson)
+                .endObject();
+            notifyEvent("relay", data);
+        }
         return true;
     }
 
     std::string WallboxController::getStatusJson() const
     {
-        std::ostringstream json;
-        json << "{"
-             << "\"state\":\"" << getStateString() << "\","
-             << "\"wallboxEnabled\":" << (m_wallboxEnabled ? "true" : "false") << ","
-             << "\"relayEnabled\":" << (m_relayEnabled ? "true" : "false") << ","
-             << "\"charging\":" << (m_stateMachine->isCharging() ? "true" : "false") << ","
-             << "\"timestamp\":" << std::time(nullptr)
-             << "}";
-        return json.str();
+        std::string json;
+        appendStatusJson(json);
+        return json;
+    }
+
+    void WallboxController::appendStatusJson(std::string &buffer) const
+    {
+        buffer += getStatusSnapshot()->statusJson;
+    }
+
+    void WallboxController::addSnapshotListener(StatusSnapshotCallback callback)
+    {
+        std::lock_guard<std::mutex> lock(m_snapshotMutex);
+        callback(std::atomic_load(&m_snapshot));
+        m_snapshotListeners.push_back(std::move(callback));
+    }
+
+    void WallboxController::refreshSnapshot()
+    {
+        std::lock_guard<std::mutex> lock(m_snapshotMutex);
+
+        ChargingState state = m_stateMachine->getCurrentState();
+        bool charging = m_stateMachine->isCharging();
+        StatusSnapshotPtr current = std::atomic_load(&m_snapshot);
+        if (current && current->state == state && current->charging == charging &&
+            current->wallboxEnabled == m_wallboxEnabled && current->relayEnabled == m_relayEnabled)
+        {
+            return; // Nothing visible changed; keep version and ETag
+        }
+
+        std::shared_ptr<StatusSnapshot> snapshot = std::make_shared<StatusSnapshot>();
+        static const uint64_t firstVersion = firstSnapshotVersion();
+        snapshot->version = current ? current->version + 1 : firstVersion;
+        snapshot->state = state;
+        snapshot->wallboxEnabled = m_wallboxEnabled;
+        snapshot->relayEnabled = m_relayEnabled;
+        snapshot->charging = charging;
+        snapshot->timestamp = std::time(nullptr);
+
+        std::string stateString = m_stateMachine->getStateString(state);
+        JsonWriter(snapshot->statusJson)
+            .beginObject()
+            .field("version", snapshot->version)
+            .field("state", stateString)
+            .field("wallboxEnabled", snapshot->wallboxEnabled)
+            .field("relayEnabled", snapshot->relayEnabled)
+            .field("charging", snapshot->charging)
+            .field("timestamp", static_cast<long long>(snapshot->timestamp))
+            .endObject();
+        JsonWriter(snapshot->relayJson)
+            .beginObject()
+            .field("version", snapshot->version)
+            .field("relayEnabled", snapshot->relayEnabled)
+            .field("state", stateString)
+            .endObject();
+
+        StatusSnapshotPtr published = snapshot;
+        std::atomic_store(&m_snapshot, published);
+        for (const auto &listener : m_snapshotListeners)
+        {
+            listener(published);
+        }
+
+        requestStatusSend();
+    }
+
+    void WallboxController::requestStatusSend()
+    {
+        // Several changes in one loop iteration produce one datagram
+        if (m_loop.isOpen() && !m_statusSendPending.exchange(true))
+        {
+            // The send finishes the trace that caused it (the first one, when coalesced)
+            TraceContext trace = LatencyTracer::current();
+            m_loop.post([this, trace]()
+                        {
+                TraceScope scope(trace);
+                m_statusSendPending = false;
+                sendStatusToSimulator(); });
+        }
     }
 
     void WallboxController::setupGpio()
@@ -320,28 +666,54 @@ namespace Wallbox
 
         // Configure input pins (button uses CP pin)
         m_gpio->setPinMode(config.getButtonPin(), PinMode::INPUT);
+        m_buttonLevel = m_gpio->digitalRead(config.getButtonPin());
+        if (!m_gpio->watchPin(config.getButtonPin(), PinEdge::BOTH, [this](const PinEvent &event)
+                              { onButtonEdge(event); }))
+        {
+            std::cout << "Button edge events not supported by this GPIO backend" << std::endl;
+        }
 
-        // Initialize LEDs to OFF
-        m_gpio->digitalWrite(config.getLedGreenPin(), PinValue::LOW);
-        m_gpio->digitalWrite(config.getLedYellowPin(), PinValue::LOW);
-        m_gpio->digitalWrite(config.getLedRedPin(), PinValue::LOW);
+        // Pin levels are unknown after (re)initialization: write all of them once
+        {
+            std::lock_guard<std::mutex> lock(m_outputMutex);
+            m_pinShadow.clear();
+        }
 
-        // Relay ON by default when wallbox is enabled
-        m_gpio->digitalWrite(config.getRelayPin(), m_wallboxEnabled ? PinValue::HIGH : PinValue::LOW);
+        // Initialize LEDs to OFF, relay ON by default when wallbox is enabled
+        const PinWrite initial[] = {
+            {config.getLedGreenPin(), PinValue::LOW},
+            {config.getLedYellowPin(), PinValue::LOW},
+            {config.getLedRedPin(), PinValue::LOW},
+            {config.getRelayPin(), m_wallboxEnabled ? PinValue::HIGH : PinValue::LOW}};
+        writeOutputs(initial, sizeof(initial) / sizeof(initial[0]));
         m_relayEnabled = m_wallboxEnabled;
+        controllerMetrics().relayOn.set(m_relayEnabled ? 1 : 0);
+        controllerMetrics().wallboxEnabled.set(m_wallboxEnabled ? 1 : 0);
     }
 
     void WallboxController::updateLeds()
     {
         auto &config = Configuration::getInstance();
 
+        // Blinking patterns are driven by the blink timer
+        ChargingState state = m_stateMachine->getCurrentState();
+        uint32_t blinkMs = m_wallboxEnabled ? blinkIntervalFor(state) : 0;
+        if (m_blinkIntervalMs.exchange(blinkMs) != blinkMs && m_blinkTimer >= 0)
+        {
+            m_loop.armTimer(m_blinkTimer, blinkMs);
+        }
+
         if (!m_wallboxEnabled)
         {
             // Wallbox disabled: Red ON, others OFF, Relay OFF
             setLedState(config.getLedGreenPin(), false);
             setLedState(config.getLedYellowPin(), false);
             setLedState(config.getLedRedPin(), true); // Red ON when disabled
-            setRelayState(false);                     // Relay OFF when disabled
+            flushLeds();
+            if (m_relayEnabled)
+            {
+                setRelayStateOnLoop(false); // Relay OFF when disabled
+            }
             return;
         }
 
@@ -352,10 +724,10 @@ namespace Wallbox
         // Ensure relay is ON when wallbox is enabled (default state)
         if (!m_relayEnabled)
         {
-            setRelayState(true);
+            setRelayStateOnLoop(true);
         }
 
-        switch (m_stateMachine->getCurrentState())
+        switch (state)
         {
         case ChargingState::OFF:
             showErrorLeds(); // OFF state shows as error (no power)
@@ -383,6 +755,26 @@ namespace Wallbox
         default:
             break;
         }
+
+        flushLeds();
+    }
+
+    uint32_t WallboxController::blinkIntervalFor(ChargingState state) const
+    {
+        switch (state)
+        {
+        case ChargingState::IDLE:
+        case ChargingState::STOP:
+        case ChargingState::FINISHED:
+            return 500; // Idle: yellow blinks
+        case ChargingState::CONNECTED:
+        case ChargingState::IDENTIFICATION:
+            return 700; // Connected: green blinks slowly
+        case ChargingState::READY:
+            return 300; // Ready: green blinks fast
+        default:
+            return 0;
+        }
     }
 
     void WallboxController::sendStatusToSimulator()
@@ -439,32 +831,29 @@ namespace Wallbox
 
         if (firstSend)
         {
-            std::cout << "\n[WALLBOX] ✓ Starting to send status to simulator" << std::endl;
-            std::cout << "  Initial state: enable=" << (m_wallboxEnabled ? "true" : "false")
-                      << " relay=" << (m_relayEnabled ? "ON" : "OFF")
-                      << " state=" << getStateString() << std::endl;
+            WALLBOX_LOG_INFO("Wallbox") << "✓ Starting to send status to simulator (enable="
+                                        << (m_wallboxEnabled ? "true" : "false")
+                                        << " relay=" << (m_relayEnabled ? "ON" : "OFF")
+                                        << " state=" << getStateString() << ")";
             firstSend = false;
         }
 
         if (m_wallboxEnabled != lastSentEnable)
         {
-            std::cout << "\n[WALLBOX → SIMULATOR] Sending enable status: "
-                      << (m_wallboxEnabled ? "ENABLED" : "DISABLED") << std::endl;
+            WALLBOX_LOG_INFO("Simulator") << "Sending enable status: " << (m_wallboxEnabled ? "ENABLED" : "DISABLED");
             lastSentEnable = m_wallboxEnabled;
         }
 
         if (m_relayEnabled != lastSentRelay)
         {
-            std::cout << "\n[WALLBOX → SIMULATOR] Sending relay status: "
-                      << (m_relayEnabled ? "ON" : "OFF") << std::endl;
+            WALLBOX_LOG_INFO("Simulator") << "Sending relay status: " << (m_relayEnabled ? "ON" : "OFF");
             lastSentRelay = m_relayEnabled;
         }
 
         if (currentState != lastSentState)
         {
-            std::cout << "\n[WALLBOX → SIMULATOR] Sending state change: "
-                      << m_stateMachine->getStateString(lastSentState) << " → "
-                      << getStateString() << std::endl;
+            WALLBOX_LOG_INFO("Simulator") << "Sending state change: " << m_stateMachine->getStateString(lastSentState)
+                                          << " → " << getStateString();
             lastSentState = currentState;
         }
 
@@ -475,23 +864,31 @@ namespace Wallbox
             // Silent log to file only - no console spam
         }
 
-        // Send via network
-        std::vector<uint8_t> message(sizeof(cmd));
-        std::memcpy(message.data(), &cmd, sizeof(cmd));
-        m_network->send(message);
+        // Send via network, straight from the stack
+        TraceSpan span(TraceStage::STATUS_SEND);
+        m_network->send(ByteSpan::of(cmd));
+        span.end();
+
+        // Next heartbeat one full period after this send
+        if (m_heartbeatTimer >= 0)
+        {
+            m_loop.armTimer(m_heartbeatTimer, m_heartbeatMs);
+        }
     }
 
-    void WallboxController::processNetworkMessage(const std::vector<uint8_t> &message)
+    void WallboxController::processNetworkMessage(ByteSpan message)
     {
+        TraceSpan parse(TraceStage::PARSE);
+
         // Check if this is a CP state message (0x03 = CP state update)
-        if (message.size() >= 2 && message[0] == 0x03)
+        if (message.size >= 2 && message[0] == 0x03)
         {
             // CP signal message - forward to CP reader if in simulator mode
             if (m_cpReader && m_operatingMode == "simulator")
             {
                 // Cast to SimulatorCpSignalReader to call handleMessage
                 // Note: In production, use dynamic_cast or visitor pattern
-                std::cout << "[WallboxController] Received CP signal message" << std::endl;
+                WALLBOX_LOG_DEBUG("Wallbox") << "Received CP signal message";
                 // For now, manually parse and call setCpState
                 // This is a temporary solution until we refactor the network callback
             }
@@ -499,10 +896,10 @@ namespace Wallbox
         }
 
         // Parse and handle network messages from simulator
-        if (message.size() >= sizeof(stSeIsoStackState))
+        if (message.size >= sizeof(stSeIsoStackState))
         {
             stSeIsoStackState state;
-            std::memcpy(&state, message.data(), sizeof(state));
+            std::memcpy(&state, message.data, sizeof(state));
 
             // Show feedback when receiving simulator state
             static enIsoChargingState lastState = enIsoChargingState::idle;
@@ -511,32 +908,30 @@ namespace Wallbox
 
             bool contactorCmd = (state.seHardwareCmd.mainContactor != 0);
             bool enableCmd = (state.seHardwareCmd.sourceEnable != 0);
+            parse.end();
 
             if (state.isoStackState.state != lastState || contactorCmd != lastContactor || enableCmd != lastEnableCmd)
             {
-                std::cout << "\n[SIMULATOR → WALLBOX] ";
-
                 if (enableCmd != lastEnableCmd)
                 {
-                    std::cout << "Enable: " << (lastEnableCmd ? "true" : "false")
-                              << " → " << (enableCmd ? "true" : "false") << "  ";
+                    WALLBOX_LOG_INFO("Simulator") << "Enable: " << lastEnableCmd << " → " << enableCmd;
 
                     if (enableCmd && !m_wallboxEnabled)
                     {
-                        std::cout << "\n[WALLBOX] 🟢 Enable requested by simulator";
-                        enableWallbox();
+                        WALLBOX_LOG_INFO("Wallbox") << "🟢 Enable requested by simulator";
+                        enableWallboxOnLoop();
                     }
                     else if (!enableCmd && m_wallboxEnabled)
                     {
-                        std::cout << "\n[WALLBOX] 🔴 Disable requested by simulator";
-                        disableWallbox();
+                        WALLBOX_LOG_INFO("Wallbox") << "🔴 Disable requested by simulator";
+                        disableWallboxOnLoop();
                     }
                 }
 
                 if (state.isoStackState.state != lastState)
                 {
-                    std::cout << "State: " << enIsoChargingState_toString(lastState)
-                              << " → " << enIsoChargingState_toString(state.isoStackState.state) << "  ";
+                    WALLBOX_LOG_INFO("Simulator") << "State: " << enIsoChargingState_toString(lastState)
+                                                  << " → " << enIsoChargingState_toString(state.isoStackState.state);
 
                     // Enforce state transition order: idle → ready → charging
                     // stop can be called from any state
@@ -548,7 +943,7 @@ namespace Wallbox
                         // idle can transition from any state (always allowed)
                         if (currentWallboxState != ChargingState::IDLE)
                         {
-                            std::cout << "\n[WALLBOX] 🔄 Transitioning to IDLE";
+                            WALLBOX_LOG_INFO("Wallbox") << "🔄 Transitioning to IDLE";
                             m_stateMachine->stopCharging("Simulator state: idle");
                         }
                         break;
@@ -557,16 +952,16 @@ namespace Wallbox
                         // ready can only be reached from idle AND relay must be ON
                         if (!m_relayEnabled)
                         {
-                            std::cout << "\n[WALLBOX] ❌ Cannot go to READY: Relay must be ON first";
+                            WALLBOX_LOG_INFO("Wallbox") << "❌ Cannot go to READY: Relay must be ON first";
                         }
                         else if (currentWallboxState == ChargingState::IDLE)
                         {
-                            std::cout << "\n[WALLBOX] ✓ Vehicle ready - prepared for charging";
+                            WALLBOX_LOG_INFO("Wallbox") << "✓ Vehicle ready - prepared for charging";
                             // No state machine transition needed, just acknowledgment
                         }
                         else
                         {
-                            std::cout << "\n[WALLBOX] ❌ Cannot go to READY: Must be in IDLE state first";
+                            WALLBOX_LOG_INFO("Wallbox") << "❌ Cannot go to READY: Must be in IDLE state first";
                         }
                         break;
 
@@ -574,18 +969,18 @@ namespace Wallbox
                         // charging can only be reached from ready (via idle) AND relay must be ON
                         if (!m_relayEnabled)
                         {
-                            std::cout << "\n[WALLBOX] ❌ Cannot start charging: Relay must be ON";
+                            WALLBOX_LOG_INFO("Wallbox") << "❌ Cannot start charging: Relay must be ON";
                         }
                         else if (currentWallboxState == ChargingState::IDLE && lastState == enIsoChargingState::ready)
                         {
                             if (m_wallboxEnabled)
                             {
-                                std::cout << "\n[WALLBOX] 🔄 Starting charging (idle → ready → charging)";
+                                WALLBOX_LOG_INFO("Wallbox") << "🔄 Starting charging (idle → ready → charging)";
                                 m_stateMachine->startCharging("Simulator state: charging");
                             }
                             else
                             {
-                                std::cout << "\n[WALLBOX] ❌ Cannot start charging: Wallbox disabled";
+                                WALLBOX_LOG_INFO("Wallbox") << "❌ Cannot start charging: Wallbox disabled";
                             }
                         }
                         else if (currentWallboxState == ChargingState::CHARGING)
@@ -594,7 +989,7 @@ namespace Wallbox
                         }
                         else
                         {
-                            std::cout << "\n[WALLBOX] ❌ Cannot start charging: Must go idle → ready → charge";
+                            WALLBOX_LOG_INFO("Wallbox") << "❌ Cannot start charging: Must go idle → ready → charge";
                         }
                         break;
 
@@ -602,7 +997,7 @@ namespace Wallbox
                         // stop can be called from any state (always allowed)
                         if (m_stateMachine->isCharging())
                         {
-                            std::cout << "\n[WALLBOX] 🔄 Stopping charging (stop command)";
+                            WALLBOX_LOG_INFO("Wallbox") << "🔄 Stopping charging (stop command)";
                             m_stateMachine->stopCharging("Simulator state: stop");
                         }
                         break;
@@ -614,53 +1009,100 @@ namespace Wallbox
 
                 if (contactorCmd != lastContactor)
                 {
-                    std::cout << "Contactor: " << (lastContactor ? "ON" : "OFF")
-                              << " → " << (contactorCmd ? "ON" : "OFF");
+                    WALLBOX_LOG_INFO("Simulator") << "Contactor: " << (lastContactor ? "ON" : "OFF")
+                                                  << " → " << (contactorCmd ? "ON" : "OFF");
 
                     // Apply contactor command only if wallbox is enabled
                     if (!m_wallboxEnabled && contactorCmd)
                     {
-                        std::cout << " ❌ REJECTED (wallbox disabled)";
+                        WALLBOX_LOG_INFO("Wallbox") << "❌ Contactor REJECTED (wallbox disabled)";
                     }
                     else
                     {
                         // Apply the contactor command
                         if (contactorCmd && !m_relayEnabled)
                         {
-                            std::cout << "\n[WALLBOX] ⚡ Activating contactor";
-                            setRelayState(true);
+                            WALLBOX_LOG_INFO("Wallbox") << "⚡ Activating contactor";
+                            setRelayStateOnLoop(true);
                         }
                         else if (!contactorCmd && m_relayEnabled)
                         {
-                            std::cout << "\n[WALLBOX] 🔌 Deactivating contactor";
-                            setRelayState(false);
+                            WALLBOX_LOG_INFO("Wallbox") << "🔌 Deactivating contactor";
+                            setRelayStateOnLoop(false);
                         }
                     }
                 }
 
-                std::cout << std::endl;
-
                 lastState = state.isoStackState.state;
                 lastContactor = contactorCmd;
                 lastEnableCmd = enableCmd;
 
                 // Send immediate status update when state changes
-                sendStatusToSimulator();
+                requestStatusSend();
             }
         }
+        else
+        {
+            controllerMetrics().udpShort.inc();
+        }
     }
 
     void WallboxController::onStateChange(ChargingState oldState, ChargingState newState, const std::string &reason)
     {
-        std::cout << "Controller responding to state change: "
-                  << m_stateMachine->getStateString(oldState) << " -> "
-                  << m_stateMachine->getStateString(newState) << std::endl;
-
         // Update LEDs when state changes
         updateLeds();
+        refreshSnapshot();
+
+        // Push to API clients (Server-Sent Events)
+        std::string data;
+        JsonWriter json(data);
+        json.beginObject()
+            .field("type", "state")
+            .field("from", m_stateMachine->getStateString(oldState))
+            .field("to", m_stateMachine->getStateString(newState))
+            .field("reason", reason)
+            .key("status")
+            .rawValue(getStatusSnapshot()->statusJson)
+            .endObject();
+        notifyEvent("state", data);
+    }
 
-        // Send state change notification over network
-        // (Implementation would depend on protocol)
+    void WallboxController::addEventListener(WallboxEventCallback callback)
+    {
+        std::lock_guard<std::mutex> lock(m_eventListenerMutex);
+        m_eventListeners.push_back(std::move(callback));
+    }
+
+    void WallboxController::onButtonEdge(const PinEvent &event)
+    {
+        // Contact bounce: ignore repeated levels and edges shortly after the last one
+        const uint64_t debounceNs = 20 * 1000000ULL;
+        if (event.value == m_buttonLevel ||
+            (m_lastButtonNs != 0 && event.timestampNs - m_lastButtonNs < debounceNs))
+        {
+            return;
+        }
+        m_buttonLevel = event.value;
+        m_lastButtonNs = event.timestampNs;
+
+        std::string data;
+        JsonWriter json(data);
+        json.beginObject()
+            .field("type", "button")
+            .field("level", event.value == PinValue::HIGH ? "HIGH" : "LOW")
+            .field("timestampNs", event.timestampNs)
+            .endObject();
+        notifyEvent("button", data);
+    }
+
+    void WallboxController::notifyEvent(const std::string &event, const std::string &data)
+    {
+        // Listeners may be added by the API layer after the CP monitor thread is running
+        std::lock_guard<std::mutex> lock(m_eventListenerMutex);
+        for (const auto &listener : m_eventListeners)
+        {
+            listener(event, data);
+        }
     }
 
     /**
@@ -670,15 +1112,30 @@ namespace Wallbox
      */
     void WallboxController::onCpStateChange(CpState oldState, CpState newState)
     {
-        std::cout << "[WallboxController] CP State Change: ";
-
         if (m_cpReader)
         {
-            std::cout << m_cpReader->getCpStateString(oldState) << " -> "
-                      << m_cpReader->getCpStateString(newState) << std::endl;
+            WALLBOX_LOG_INFO("Wallbox") << "CP state change: " << m_cpReader->getCpStateString(oldState)
+                                        << " -> " << m_cpReader->getCpStateString(newState);
         }
 
         m_currentCpState = newState;
+        controllerMetrics().cpChanges.inc();
+        EventJournal::instance().record(JournalEvent::CP_CHANGE, static_cast<uint32_t>(oldState),
+                                        static_cast<uint32_t>(newState));
+
+        if (m_cpReader)
+        {
+            std::string data;
+            JsonWriter json(data);
+            json.beginObject()
+                .field("type", "cp")
+                .field("from", m_cpReader->getCpStateString(oldState))
+                .field("to", m_cpReader->getCpStateString(newState))
+                .key("status")
+                .rawValue(getStatusSnapshot()->statusJson)
+                .endObject();
+            notifyEvent("cp", data);
+        }
 
         // Map CP state to charging state transitions
         mapCpStateToChargingState(newState);
@@ -756,16 +1213,16 @@ namespace Wallbox
 
         case CpState::UNKNOWN:
         default:
-            std::cerr << "[WallboxController] Unknown CP state, no action taken" << std::endl;
+            WALLBOX_LOG_WARN("Wallbox") << "Unknown CP state, no action taken";
             return;
         }
 
         // Request state transition
         if (m_stateMachine->getCurrentState() != targetState)
         {
-            std::cout << "[WallboxController] Requesting state transition: "
-                      << m_stateMachine->getStateString(m_stateMachine->getCurrentState())
-                      << " -> " << m_stateMachine->getStateString(targetState) << std::endl;
+            WALLBOX_LOG_INFO("Wallbox") << "Requesting state transition: "
+                                        << m_stateMachine->getStateString(m_stateMachine->getCurrentState())
+                                        << " -> " << m_stateMachine->getStateString(targetState);
 
             // Trigger appropriate state machine method based on target state
             switch (targetState)
@@ -773,7 +1230,7 @@ namespace Wallbox
             case ChargingState::IDLE:
                 if (m_stateMachine->isCharging())
                 {
-                    stopCharging();
+                    stopChargingOnLoop();
                 }
                 break;
             case ChargingState::CONNECTED:
@@ -785,17 +1242,17 @@ namespace Wallbox
             case ChargingState::CHARGING:
                 if (m_wallboxEnabled && !m_stateMachine->isCharging())
                 {
-                    startCharging();
+                    startChargingOnLoop();
                 }
                 break;
             case ChargingState::STOP:
                 if (m_stateMachine->isCharging())
                 {
-                    stopCharging();
+                    stopChargingOnLoop();
                 }
                 break;
             case ChargingState::ERROR:
-                stopCharging();
+                stopChargingOnLoop();
                 m_stateMachine->enterErrorState("CP signal error");
                 break;
             default:
@@ -804,24 +1261,124 @@ namespace Wallbox
         }
     }
 
+    GpioWriteStats WallboxController::getGpioWriteStats() const
+    {
+        return GpioWriteStats{m_gpioWrites.load(), m_gpioWritesSaved.load()};
+    }
+
+    CpFilterStats WallboxController::getCpFilterStats() const
+    {
+        return m_cpReader ? m_cpReader->getFilterStats() : CpFilterStats{0, 0, 0};
+    }
+
+    ListenerStats WallboxController::getStateDispatchStats() const
+    {
+        return m_stateMachine->getDispatchStats();
+    }
+
+    CpLatencyStats WallboxController::getCpLatencyStats() const
+    {
+        return CpLatencyStats{m_cpLatencyCount.load(), m_cpLatencyLastNs.load(),
+                              m_cpLatencyMaxNs.load(), m_cpLatencyTotalNs.load()};
+    }
+
+    void WallboxController::recordCpLatency(uint64_t changeNs)
+    {
+        // Written on the loop thread only; readers may see the fields of neighbouring updates
+        uint64_t now = GpioEdgeWatcher::monotonicNowNs();
+        uint64_t latency = now > changeNs ? now - changeNs : 0;
+        m_cpLatencyLastNs.store(latency);
+        m_cpLatencyTotalNs.fetch_add(latency);
+        if (latency > m_cpLatencyMaxNs.load())
+        {
+            m_cpLatencyMaxNs.store(latency);
+        }
+        m_cpLatencyCount.fetch_add(1);
+        controllerMetrics().cpToOutputs.observe(latency);
+    }
+
+    bool WallboxController::writeOutputs(const PinWrite *writes, size_t count)
+    {
+        std::lock_guard<std::mutex> lock(m_outputMutex);
+        return writeOutputsLocked(writes, count);
+    }
+
+    bool WallboxController::writeOutputsLocked(const PinWrite *writes, size_t count)
+    {
+        // Only pins whose level differs from the last write reach the hardware
+        m_changedOutputs.clear();
+        for (size_t i = 0; i < count; ++i)
+        {
+            const PinShadow &shadow = shadowFor(writes[i].pin);
+            if (shadow.known && shadow.high == (writes[i].value == PinValue::HIGH))
+            {
+                m_gpioWritesSaved.fetch_add(1, std::memory_order_relaxed);
+                controllerMetrics().gpioWritesSaved.inc();
+                continue;
+            }
+            m_changedOutputs.push_back(writes[i]);
+        }
+
+        if (m_changedOutputs.empty())
+        {
+            return true;
+        }
+
+        TraceSpan span(TraceStage::GPIO_WRITE);
+        bool ok = m_gpio->writeMany(m_changedOutputs.data(), m_changedOutputs.size());
+        span.end();
+        m_gpioWrites.fetch_add(m_changedOutputs.size(), std::memory_order_relaxed);
+
+        // A failed write leaves the level unknown so the next update retries it
+        for (const auto &write : m_changedOutputs)
+        {
+            PinShadow &shadow = shadowFor(write.pin);
+            shadow.known = ok;
+            shadow.high = (write.value == PinValue::HIGH);
+        }
+        return ok;
+    }
+
+    WallboxController::PinShadow &WallboxController::shadowFor(int pin)
+    {
+        for (auto &shadow : m_pinShadow)
+        {
+            if (shadow.pin == pin)
+            {
+                return shadow;
+            }
+        }
+        m_pinShadow.push_back(PinShadow{pin, false, false});
+        return m_pinShadow.back();
+    }
+
+    void WallboxController::flushLeds()
+    {
+        std::lock_guard<std::mutex> lock(m_outputMutex);
+        writeOutputsLocked(m_pendingLeds.data(), m_pendingLeds.size());
+        m_pendingLeds.clear();
+    }
+
     void WallboxController::setLedState(int pin, bool on)
     {
-        m_gpio->digitalWrite(pin, on ? PinValue::HIGH : PinValue::LOW);
+        PinValue value = on ? PinValue::HIGH : PinValue::LOW;
+        std::lock_guard<std::mutex> lock(m_outputMutex);
+        for (auto &write : m_pendingLeds)
+        {
+            if (write.pin == pin)
+            {
+                write.value = value;
+                return;
+            }
+        }
+        m_pendingLeds.push_back(PinWrite{pin, value});
     }
 
     void WallboxController::showIdleLeds()
     {
         auto &config = Configuration::getInstance();
         // Idle: Yellow BLINK (enabled/waiting), Green OFF (no car), Red OFF
-        static auto lastToggle = std::chrono::steady_clock::now();
-        static bool yellowState = false;
-
-        auto now = std::chrono::steady_clock::now();
-        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastToggle).count() >= 500)
-        {
-            yellowState = !yellowState;
-            lastToggle = now;
-        }
+        bool yellowState = m_blinkOn; // Toggled every 500 ms by the blink timer
 
         setLedState(config.getLedGreenPin(), false);        // Green OFF - no car
         setLedState(config.getLedYellowPin(), yellowState); // Yellow BLINKING - wallbox idle
@@ -832,15 +1389,7 @@ namespace Wallbox
     {
         auto &config = Configuration::getInstance();
         // Connected: Yellow ON (enabled), Green BLINK slow (car connected), Red OFF
-        static auto lastToggle = std::chrono::steady_clock::now();
-        static bool greenState = false;
-
-        auto now = std::chrono::steady_clock::now();
-        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastToggle).count() >= 700)
-        {
-            greenState = !greenState;
-            lastToggle = now;
-        }
+        bool greenState = m_blinkOn; // Toggled every 700 ms by the blink timer
 
         setLedState(config.getLedGreenPin(), greenState); // Green BLINKING - car connected
         setLedState(config.getLedYellowPin(), true);      // Yellow ON - wallbox enabled
@@ -851,15 +1400,7 @@ namespace Wallbox
     {
         auto &config = Configuration::getInstance();
         // Ready: Yellow ON (enabled), Green BLINK (ready to charge), Red OFF
-        static auto lastToggle = std::chrono::steady_clock::now();
-        static bool greenState = false;
-
-        auto now = std::chrono::steady_clock::now();
-        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastToggle).count() >= 300)
-        {
-            greenState = !greenState;
-            lastToggle = now;
-        }
+        bool greenState = m_blinkOn; // Toggled every 300 ms by the blink timer
 
         setLedState(config.getLedGreenPin(), greenState); // Green BLINKING - ready
         setLedState(config.getLedYellowPin(), true);      // Yellow ON - wallbox enabled
@@ -888,8 +1429,7 @@ namespace Wallbox
     {
         auto &config = Configuration::getInstance();
         // Paused: Yellow ON, Green BLINK, Red OFF
-        static bool greenState = false;
-        greenState = !greenState;
+        bool greenState = m_blinkOn;
         setLedState(config.getLedGreenPin(), greenState); // Green BLINKING
         setLedState(config.getLedYellowPin(), true);      // Yellow ON
         setLedState(config.getLedRedPin(), false);        // Red OFF
@@ -10,8 +10,9 @@
 
 using namespace Wallbox;
 
-// Global flag for signal handling
+// Global flag and controller for signal handling
 static std::atomic<bool> g_shutdownRequested(false);
+static WallboxController *g_controller = nullptr;
 
 /**
  * @brief Signal handler for graceful shutdown
@@ -20,6 +21,10 @@ void signalHandler(int signal)
 {
     std::cout << "\nReceived signal " << signal << ", shutting down..." << std::endl;
     g_shutdownRequested = true;
+    if (g_controller)
+    {
+        g_controller->stop();
+    }
 }
 
 /**
@@ -87,6 +92,7 @@ int main(int argc, char *argv[])
 
         // Inject dependencies into controller
         WallboxController controller(std::move(gpio), std::move(network));
+        g_controller = &controller;
 
         // Initialize system
         if (!controller.initialize())
@@ -99,16 +105,16 @@ int main(int argc, char *argv[])
         std::cout << "Current state: " << controller.getStateString() << std::endl;
         std::cout << std::endl;
 
-        // Main loop (runs until shutdown signal)
-        while (!g_shutdownRequested && controller.isRunning())
+        // Controller event loop (runs until shutdown signal)
+        if (!g_shutdownRequested)
         {
-            // Controller handles its own event loop
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            controller.run();
         }
 
         // Graceful shutdown
         std::cout << "\nInitiating shutdown sequence..." << std::endl;
         controller.shutdown();
+        g_controller = nullptr;
 
         std::cout << "Wallbox controller stopped cleanly." << std::endl;
         return 0;
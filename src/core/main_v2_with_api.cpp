@@ -13,8 +13,9 @@
 
 using namespace Wallbox;
 
-// Global flag for signal handling
+// Global flag and controller for signal handling
 static std::atomic<bool> g_shutdownRequested(false);
+static WallboxController *g_controller = nullptr;
 
 /**
  * @brief Signal handler for graceful shutdown
@@ -23,6 +24,10 @@ void signalHandler(int signal)
 {
     std::cout << "\nReceived signal " << signal << ", shutting down..." << std::endl;
     g_shutdownRequested = true;
+    if (g_controller)
+    {
+        g_controller->stop();
+    }
 }
 
 /**
@@ -217,6 +222,7 @@ int main(int argc, char *argv[])
 
         // Create controller
         WallboxController controller(std::move(gpio), std::move(network));
+        g_controller = &controller;
 
         // Initialize controller
         if (!controller.initialize())
@@ -260,16 +266,17 @@ int main(int argc, char *argv[])
         std::cout << "╚════════════════════════════════════════════════╝" << std::endl;
         std::cout << std::endl;
 
-        // Main loop
-        while (!g_shutdownRequested)
+        // Controller event loop (runs until shutdown signal)
+        if (!g_shutdownRequested)
         {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            controller.run();
         }
 
         // Graceful shutdown
         std::cout << "\nInitiating shutdown sequence..." << std::endl;
         apiServer.stop();
         controller.shutdown();
+        g_controller = nullptr;
 
         std::cout << "Wallbox controller stopped cleanly." << std::endl;
         return 0;
@@ -60,7 +60,8 @@ int main(int argc, char *argv[])
     try
     {
         // Create GPIO controller
-        auto gpio = GpioFactory::create(config.getGpioType());
+        auto gpio = GpioFactory::create(config.getGpioType(), config.getGpioChip(),
+                                        config.getGpioLineBase(), config.getGpioMemDevice());
 
         // Create simple controller
         g_controller = std::make_unique<SimpleWallboxController>(
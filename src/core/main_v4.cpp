@@ -2,9 +2,6 @@
 #include <csignal>
 #include <memory>
 #include <iostream>
-#include <fstream>
-#include <chrono>
-#include <iomanip>
 #include <sstream>
 
 using namespace Wallbox;
@@ -12,39 +9,15 @@ using namespace Wallbox;
 // Global application instance for signal handling
 static std::unique_ptr<Application> g_application;
 
-// Log file
-static std::ofstream g_logFile;
-
-/**
- * @brief Get formatted timestamp
- */
-std::string getTimestamp()
-{
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                  now.time_since_epoch()) %
-              1000;
-
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
-    ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
-    return ss.str();
-}
+// Log file sink
+static LogSinks g_logSink = 0;
 
 /**
  * @brief Unified logging function - writes only to file
  */
 void logMessage(const std::string &level, const std::string &message)
 {
-    std::string logLine = "[" + getTimestamp() + "] [" + level + "] " + message;
-
-    // Write to log file only
-    if (g_logFile.is_open())
-    {
-        g_logFile << logLine << std::endl;
-        g_logFile.flush();
-    }
+    LogLine(level, g_logSink) << message;
 }
 
 /**
@@ -118,8 +91,8 @@ int main(int argc, char *argv[])
     }
 
     // Open log file
-    g_logFile.open("/tmp/wallbox_main.log", std::ios::out | std::ios::app);
-    if (!g_logFile.is_open())
+    g_logSink = Logger::instance().openFile("/tmp/wallbox_main.log");
+    if (!g_logSink)
     {
         std::cerr << "Warning: Could not open log file /tmp/wallbox_main.log" << std::endl;
     }
@@ -146,8 +119,6 @@ int main(int argc, char *argv[])
         {
             logMessage("ERROR", "Failed to initialize application");
             std::cerr << "Failed to initialize application" << std::endl;
-            if (g_logFile.is_open())
-                g_logFile.close();
             return 1;
         }
 
@@ -180,8 +151,6 @@ int main(int argc, char *argv[])
         g_application->shutdown();
         logMessage("INFO", "Application shutdown complete");
 
-        if (g_logFile.is_open())
-            g_logFile.close();
         return 0;
     }
     catch (const std::exception &e)
@@ -190,16 +159,12 @@ int main(int argc, char *argv[])
         ss << "Fatal error: " << e.what();
         logMessage("ERROR", ss.str());
         std::cerr << ss.str() << std::endl;
-        if (g_logFile.is_open())
-            g_logFile.close();
         return 1;
     }
     catch (...)
     {
         logMessage("ERROR", "Unknown fatal error occurred");
         std::cerr << "Unknown fatal error occurred" << std::endl;
-        if (g_logFile.is_open())
-            g_logFile.close();
         return 1;
     }
 }
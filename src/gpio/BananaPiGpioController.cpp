@@ -1,17 +1,32 @@
 #include "BananaPiGpioController.h"
+#include "GpioMetrics.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <thread>
 #include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
 #include <unistd.h>
 #include <sys/stat.h>
 
 namespace Wallbox
 {
 
-    BananaPiGpioController::BananaPiGpioController()
-        : m_initialized(false)
+    namespace
+    {
+        GpioMetrics &gpioMetrics()
+        {
+            static GpioMetrics metrics("sysfs");
+            return metrics;
+        }
+    } // namespace
+
+    BananaPiGpioController::BananaPiGpioController(const std::string &gpioPath)
+        : m_initialized(false),
+          m_gpioPath(gpioPath)
     {
         std::cout << "[BananaPi GPIO] Using real hardware GPIO via sysfs" << std::endl;
     }
@@ -27,9 +42,9 @@ namespace Wallbox
 
         // Check if GPIO sysfs is available
         struct stat info;
-        if (stat(GPIO_PATH, &info) != 0)
+        if (stat(m_gpioPath.c_str(), &info) != 0)
         {
-            std::cerr << "[BananaPi GPIO] Error: GPIO sysfs not available at " << GPIO_PATH << std::endl;
+            std::cerr << "[BananaPi GPIO] Error: GPIO sysfs not available at " << m_gpioPath << std::endl;
             return false;
         }
 
@@ -40,6 +55,8 @@ namespace Wallbox
 
     void BananaPiGpioController::shutdown()
     {
+        m_edgeWatcher.clear();
+        closeValueFds();
         if (m_initialized)
         {
             std::cout << "[BananaPi GPIO] Shutting down GPIO..." << std::endl;
@@ -73,7 +90,8 @@ namespace Wallbox
             return false;
         }
 
-        return true;
+        // Open the value file now so the first read/write does not pay for it
+        return valueFd(pin) >= 0;
     }
 
     bool BananaPiGpioController::digitalWrite(int pin, PinValue value)
@@ -83,15 +101,18 @@ namespace Wallbox
         if (!setValue(pin, val))
         {
             std::cerr << "[BananaPi GPIO] Failed to write to pin " << pin << std::endl;
+            gpioMetrics().errors.inc();
             return false;
         }
 
+        gpioMetrics().writes.inc();
         return true;
     }
 
     PinValue BananaPiGpioController::digitalRead(int pin) const
     {
         int value = getValue(pin);
+        gpioMetrics().reads.inc();
         return (value == 1) ? PinValue::HIGH : PinValue::LOW;
     }
 
@@ -99,7 +120,7 @@ namespace Wallbox
     {
         // Check if pin is already exported
         std::ostringstream pinPath;
-        pinPath << GPIO_PATH << "/gpio" << pin;
+        pinPath << m_gpioPath << "/gpio" << pin;
 
         struct stat info;
         if (stat(pinPath.str().c_str(), &info) == 0)
@@ -110,7 +131,7 @@ namespace Wallbox
 
         // Export the pin
         std::ostringstream exportPath;
-        exportPath << GPIO_PATH << "/export";
+        exportPath << m_gpioPath << "/export";
 
         std::ofstream exportFile(exportPath.str());
         if (!exportFile.is_open())
@@ -138,7 +159,7 @@ namespace Wallbox
     bool BananaPiGpioController::unexportPin(int pin)
     {
         std::ostringstream unexportPath;
-        unexportPath << GPIO_PATH << "/unexport";
+        unexportPath << m_gpioPath << "/unexport";
 
         std::ofstream unexportFile(unexportPath.str());
         if (!unexportFile.is_open())
@@ -155,7 +176,7 @@ namespace Wallbox
     bool BananaPiGpioController::setDirection(int pin, const std::string &direction)
     {
         std::ostringstream directionPath;
-        directionPath << GPIO_PATH << "/gpio" << pin << "/direction";
+        directionPath << m_gpioPath << "/gpio" << pin << "/direction";
 
         std::ofstream directionFile(directionPath.str());
         if (!directionFile.is_open())
@@ -170,41 +191,141 @@ namespace Wallbox
         return true;
     }
 
-    bool BananaPiGpioController::setValue(int pin, int value) const
+    bool BananaPiGpioController::setEdge(int pin, const std::string &edge)
+    {
+        std::ostringstream edgePath;
+        edgePath << m_gpioPath << "/gpio" << pin << "/edge";
+
+        std::ofstream edgeFile(edgePath.str());
+        if (!edgeFile.is_open())
+        {
+            std::cerr << "[BananaPi GPIO] Cannot open edge file: " << edgePath.str() << std::endl;
+            return false;
+        }
+
+        edgeFile << edge;
+        edgeFile.close();
+
+        return true;
+    }
+
+    bool BananaPiGpioController::watchPin(int pin, PinEdge edge, PinEventCallback callback)
+    {
+        int fd = valueFd(pin);
+        if (!m_initialized || fd < 0)
+        {
+            return false;
+        }
+
+        const char *edgeName = edge == PinEdge::RISING ? "rising" : edge == PinEdge::FALLING ? "falling"
+                                                                                               : "both";
+        if (!setEdge(pin, edgeName))
+        {
+            return false;
+        }
+
+        // Reading the value acknowledges any edge that is already pending
+        getValue(pin);
+
+        bool watching = m_edgeWatcher.watch(pin, fd, POLLPRI | POLLERR, [fd, pin, callback]()
+                                            {
+            char digit = '0';
+            if (pread(fd, &digit, 1, 0) != 1)
+            {
+                return;
+            }
+            callback(PinEvent{pin, digit == '1' ? PinValue::HIGH : PinValue::LOW, GpioEdgeWatcher::monotonicNowNs()}); });
+
+        if (watching)
+        {
+            std::cout << "[BananaPi GPIO] Watching pin " << pin << " for " << edgeName << " edges" << std::endl;
+        }
+        return watching;
+    }
+
+    void BananaPiGpioController::unwatchPin(int pin)
     {
-        std::ostringstream valuePath;
-        valuePath << GPIO_PATH << "/gpio" << pin << "/value";
+        if (!m_edgeWatcher.isWatching(pin))
+        {
+            return;
+        }
+        m_edgeWatcher.unwatch(pin);
+        setEdge(pin, "none");
+    }
 
-        std::ofstream valueFile(valuePath.str());
-        if (!valueFile.is_open())
+    bool BananaPiGpioController::setValue(int pin, int value) const
+    {
+        int fd = valueFd(pin);
+        if (fd < 0)
         {
-            std::cerr << "[BananaPi GPIO] Cannot open value file: " << valuePath.str() << std::endl;
             return false;
         }
 
-        valueFile << value;
-        valueFile.close();
+        const char digit = value ? '1' : '0';
+        if (pwrite(fd, &digit, 1, 0) != 1)
+        {
+            std::cerr << "[BananaPi GPIO] Cannot write value of pin " << pin << ": " << strerror(errno) << std::endl;
+            return false;
+        }
 
         return true;
     }
 
     int BananaPiGpioController::getValue(int pin) const
     {
-        std::ostringstream valuePath;
-        valuePath << GPIO_PATH << "/gpio" << pin << "/value";
+        int fd = valueFd(pin);
+        if (fd < 0)
+        {
+            return 0;
+        }
 
-        std::ifstream valueFile(valuePath.str());
-        if (!valueFile.is_open())
+        // sysfs regenerates the value on every read at offset 0
+        char digit = '0';
+        if (pread(fd, &digit, 1, 0) != 1)
         {
-            std::cerr << "[BananaPi GPIO] Cannot open value file: " << valuePath.str() << std::endl;
+            std::cerr << "[BananaPi GPIO] Cannot read value of pin " << pin << ": " << strerror(errno) << std::endl;
             return 0;
         }
 
-        int value;
-        valueFile >> value;
-        valueFile.close();
+        return digit == '1' ? 1 : 0;
+    }
 
-        return value;
+    int BananaPiGpioController::valueFd(int pin) const
+    {
+        std::lock_guard<std::mutex> lock(m_valueFdMutex);
+
+        auto it = m_valueFds.find(pin);
+        if (it != m_valueFds.end())
+        {
+            return it->second;
+        }
+
+        // Pins used without setPinMode() (e.g. exported by a script) are opened on first use
+        std::string valuePath = m_gpioPath + "/gpio" + std::to_string(pin) + "/value";
+        int fd = open(valuePath.c_str(), O_RDWR | O_CLOEXEC);
+        if (fd < 0)
+        {
+            // Input pins may refuse writes; reading is all they need
+            fd = open(valuePath.c_str(), O_RDONLY | O_CLOEXEC);
+        }
+        if (fd < 0)
+        {
+            std::cerr << "[BananaPi GPIO] Cannot open value file: " << valuePath << std::endl;
+            return -1;
+        }
+
+        m_valueFds[pin] = fd;
+        return fd;
+    }
+
+    void BananaPiGpioController::closeValueFds()
+    {
+        std::lock_guard<std::mutex> lock(m_valueFdMutex);
+        for (const auto &entry : m_valueFds)
+        {
+            close(entry.second);
+        }
+        m_valueFds.clear();
     }
 
 } // namespace Wallbox
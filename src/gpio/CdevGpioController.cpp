@@ -0,0 +1,541 @@
+#include "CdevGpioController.h"
+#include "GpioMetrics.h"
+#include <algorithm>
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+
+namespace Wallbox
+{
+
+    namespace
+    {
+        constexpr const char *CONSUMER = "wallbox";
+        constexpr size_t EVENT_BATCH_SIZE = 16;
+
+        GpioMetrics &gpioMetrics()
+        {
+            static GpioMetrics metrics("cdev");
+            return metrics;
+        }
+
+        uint64_t edgeFlags(int edge)
+        {
+            uint64_t flags = GPIO_V2_LINE_FLAG_INPUT;
+            if (edge & static_cast<int>(PinEdge::RISING))
+            {
+                flags |= GPIO_V2_LINE_FLAG_EDGE_RISING;
+            }
+            if (edge & static_cast<int>(PinEdge::FALLING))
+            {
+                flags |= GPIO_V2_LINE_FLAG_EDGE_FALLING;
+            }
+            return flags;
+        }
+
+        struct WatchedLine
+        {
+            uint32_t offset;
+            int pin;
+            PinEventCallback callback;
+        };
+    } // namespace
+
+    CdevGpioController::CdevGpioController(const std::string &chipPath, int lineBase)
+        : m_chipPath(chipPath),
+          m_lineBase(lineBase),
+          m_chipLines(0),
+          m_chipFd(-1),
+          m_pendingLines(false)
+    {
+        std::cout << "[Cdev GPIO] Using GPIO character device " << m_chipPath << std::endl;
+    }
+
+    CdevGpioController::~CdevGpioController()
+    {
+        shutdown();
+    }
+
+    bool CdevGpioController::initialize()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_chipFd >= 0)
+        {
+            return true;
+        }
+
+        m_chipFd = open(m_chipPath.c_str(), O_RDWR | O_CLOEXEC);
+        if (m_chipFd < 0)
+        {
+            std::cerr << "[Cdev GPIO] Error: cannot open " << m_chipPath << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        gpiochip_info info;
+        std::memset(&info, 0, sizeof(info));
+        if (ioctl(m_chipFd, GPIO_GET_CHIPINFO_IOCTL, &info) < 0)
+        {
+            std::cerr << "[Cdev GPIO] Error: " << m_chipPath << " is not a GPIO chip: " << strerror(errno) << std::endl;
+            close(m_chipFd);
+            m_chipFd = -1;
+            return false;
+        }
+        m_chipLines = info.lines;
+
+        std::cout << "[Cdev GPIO] " << info.name << " (" << info.label << "), "
+                  << info.lines << " lines, line base " << m_lineBase << std::endl;
+        return true;
+    }
+
+    void CdevGpioController::shutdown()
+    {
+        std::lock_guard<std::mutex> config(m_configMutex);
+        // Joins the watcher thread, so not under m_mutex
+        m_edgeWatcher.clear();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (int fd : m_requestFds)
+        {
+            close(fd);
+        }
+        m_requestFds.clear();
+        m_pendingLines = false;
+        if (m_chipFd >= 0)
+        {
+            std::cout << "[Cdev GPIO] Releasing GPIO lines..." << std::endl;
+            close(m_chipFd);
+            m_chipFd = -1;
+        }
+        m_lines.clear();
+    }
+
+    bool CdevGpioController::isInitialized() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_chipFd >= 0;
+    }
+
+    bool CdevGpioController::setPinMode(int pin, PinMode mode)
+    {
+        std::lock_guard<std::mutex> config(m_configMutex);
+        int request;
+        int fd;
+        GpioEdgeWatcher::ReadyHandler handler;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_chipFd < 0)
+            {
+                std::cerr << "[Cdev GPIO] Not initialized" << std::endl;
+                return false;
+            }
+
+            long offset = static_cast<long>(pin) - m_lineBase;
+            if (offset < 0 || offset >= static_cast<long>(m_chipLines))
+            {
+                std::cerr << "[Cdev GPIO] Pin " << pin << " is not on " << m_chipPath
+                          << " (lines " << m_lineBase << "-" << m_lineBase + static_cast<long>(m_chipLines) - 1 << ")" << std::endl;
+                return false;
+            }
+
+            int index = findLine(pin);
+            if (index < 0)
+            {
+                if (m_lines.size() >= GPIO_V2_LINES_MAX)
+                {
+                    std::cerr << "[Cdev GPIO] Too many lines requested" << std::endl;
+                    return false;
+                }
+                // Requested together with the other new lines on first use
+                m_lines.push_back(Line{pin, static_cast<uint32_t>(offset), mode, false, 0, nullptr, -1, 0});
+                m_pendingLines = true;
+                return true;
+            }
+
+            Line &line = m_lines[index];
+            if (line.mode == mode)
+            {
+                return true;
+            }
+            Line previous = line;
+            line.mode = mode;
+            line.edge = 0;
+            line.callback = nullptr;
+            if (line.request < 0)
+            {
+                return true;
+            }
+
+            request = line.request;
+            if (!configureRequest(request))
+            {
+                line = previous;
+                return false;
+            }
+            fd = m_requestFds[request];
+            handler = edgeHandler(request);
+        }
+
+        updateWatcher(request, fd, std::move(handler));
+        return true;
+    }
+
+    bool CdevGpioController::digitalWrite(int pin, PinValue value)
+    {
+        PinWrite write = {pin, value};
+        return writeMany(&write, 1);
+    }
+
+    bool CdevGpioController::writeMany(const PinWrite *writes, size_t count)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            int index = findLine(writes[i].pin);
+            if (index < 0 || m_lines[index].mode != PinMode::OUTPUT)
+            {
+                std::cerr << "[Cdev GPIO] Pin " << writes[i].pin << " is not configured as output" << std::endl;
+                gpioMetrics().errors.inc();
+                return false;
+            }
+        }
+
+        // Set before a first request so new outputs start at the written level
+        for (size_t i = 0; i < count; ++i)
+        {
+            m_lines[findLine(writes[i].pin)].high = (writes[i].value == PinValue::HIGH);
+        }
+        if (!requestPending())
+        {
+            gpioMetrics().errors.inc();
+            return false;
+        }
+
+        // One ioctl per request touched; usually all outputs share the first one
+        uint64_t bits[GPIO_V2_LINES_MAX];
+        uint64_t mask[GPIO_V2_LINES_MAX];
+        size_t requests = m_requestFds.size();
+        std::fill(bits, bits + requests, 0);
+        std::fill(mask, mask + requests, 0);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Line &line = m_lines[findLine(writes[i].pin)];
+            mask[line.request] |= 1ULL << line.bit;
+            if (writes[i].value == PinValue::HIGH)
+            {
+                bits[line.request] |= 1ULL << line.bit;
+            }
+        }
+
+        for (size_t request = 0; request < requests; ++request)
+        {
+            if (mask[request] != 0 && !setValues(m_requestFds[request], bits[request], mask[request]))
+            {
+                gpioMetrics().errors.inc();
+                return false;
+            }
+        }
+        gpioMetrics().writes.inc(count);
+        return true;
+    }
+
+    PinValue CdevGpioController::digitalRead(int pin) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        int index = findLine(pin);
+        if (index < 0 || !requestPending())
+        {
+            std::cerr << "[Cdev GPIO] Pin " << pin << " is not configured" << std::endl;
+            gpioMetrics().errors.inc();
+            return PinValue::LOW;
+        }
+
+        const Line &line = m_lines[index];
+        gpio_v2_line_values lineValues;
+        lineValues.bits = 0;
+        lineValues.mask = 1ULL << line.bit;
+        if (ioctl(m_requestFds[line.request], GPIO_V2_LINE_GET_VALUES_IOCTL, &lineValues) < 0)
+        {
+            std::cerr << "[Cdev GPIO] Cannot read pin " << pin << ": " << strerror(errno) << std::endl;
+            gpioMetrics().errors.inc();
+            return PinValue::LOW;
+        }
+        gpioMetrics().reads.inc();
+
+        return (lineValues.bits & lineValues.mask) ? PinValue::HIGH : PinValue::LOW;
+    }
+
+    bool CdevGpioController::watchPin(int pin, PinEdge edge, PinEventCallback callback)
+    {
+        std::lock_guard<std::mutex> config(m_configMutex);
+        int request;
+        int fd;
+        GpioEdgeWatcher::ReadyHandler handler;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            int index = findLine(pin);
+            if (index < 0 || m_lines[index].mode != PinMode::INPUT)
+            {
+                std::cerr << "[Cdev GPIO] Pin " << pin << " is not configured as input" << std::endl;
+                return false;
+            }
+
+            Line &line = m_lines[index];
+            Line previous = line;
+            line.edge = static_cast<int>(edge);
+            line.callback = std::move(callback);
+            bool configured = line.request < 0 ? requestPending() : configureRequest(line.request);
+            if (!configured)
+            {
+                // A failed request leaves the line pending, a failed reconfiguration leaves it as it was
+                line.edge = previous.edge;
+                line.callback = previous.callback;
+                return false;
+            }
+
+            request = line.request;
+            fd = m_requestFds[request];
+            handler = edgeHandler(request);
+        }
+
+        updateWatcher(request, fd, std::move(handler));
+        return true;
+    }
+
+    void CdevGpioController::unwatchPin(int pin)
+    {
+        std::lock_guard<std::mutex> config(m_configMutex);
+        int request;
+        int fd;
+        GpioEdgeWatcher::ReadyHandler handler;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            int index = findLine(pin);
+            if (index < 0 || m_lines[index].edge == 0)
+            {
+                return;
+            }
+
+            Line &line = m_lines[index];
+            line.callback = nullptr;
+            if (line.request < 0)
+            {
+                line.edge = 0;
+                return;
+            }
+
+            int edge = line.edge;
+            line.edge = 0;
+            request = line.request;
+            if (!configureRequest(request))
+            {
+                // Edge detection stays on in the kernel: keep draining the events, but drop the callback
+                std::cerr << "[Cdev GPIO] Pin " << pin << " still reports edges; they are discarded" << std::endl;
+                line.edge = edge;
+            }
+            fd = m_requestFds[request];
+            handler = edgeHandler(request);
+        }
+
+        updateWatcher(request, fd, std::move(handler));
+    }
+
+    int CdevGpioController::findLine(int pin) const
+    {
+        for (size_t i = 0; i < m_lines.size(); ++i)
+        {
+            if (m_lines[i].pin == pin)
+            {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    bool CdevGpioController::requestPending() const
+    {
+        if (!m_pendingLines)
+        {
+            return true;
+        }
+
+        gpio_v2_line_request request;
+        std::memset(&request, 0, sizeof(request));
+        std::strncpy(request.consumer, CONSUMER, sizeof(request.consumer) - 1);
+
+        int requestIndex = static_cast<int>(m_requestFds.size());
+        for (const auto &line : m_lines)
+        {
+            if (line.request < 0)
+            {
+                line.request = requestIndex;
+                line.bit = request.num_lines;
+                request.offsets[request.num_lines++] = line.offset;
+            }
+        }
+        buildConfig(requestIndex, request.config);
+
+        if (ioctl(m_chipFd, GPIO_V2_GET_LINE_IOCTL, &request) < 0)
+        {
+            std::cerr << "[Cdev GPIO] Line request failed: " << strerror(errno) << std::endl;
+            for (const auto &line : m_lines)
+            {
+                if (line.request == requestIndex)
+                {
+                    line.request = -1;
+                }
+            }
+            return false;
+        }
+
+        m_requestFds.push_back(request.fd);
+        m_pendingLines = false;
+        return true;
+    }
+
+    bool CdevGpioController::configureRequest(int request)
+    {
+        gpio_v2_line_config config;
+        buildConfig(request, config);
+        if (ioctl(m_requestFds[request], GPIO_V2_LINE_SET_CONFIG_IOCTL, &config) < 0)
+        {
+            std::cerr << "[Cdev GPIO] Cannot reconfigure lines: " << strerror(errno) << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void CdevGpioController::buildConfig(int request, gpio_v2_line_config &config) const
+    {
+        std::memset(&config, 0, sizeof(config));
+
+        uint64_t outputMask = 0;
+        uint64_t outputValues = 0;
+        uint64_t edgeMasks[4] = {0, 0, 0, 0}; ///< Indexed by PinEdge bits
+        for (const auto &line : m_lines)
+        {
+            if (line.request != request)
+            {
+                continue;
+            }
+            uint64_t bit = 1ULL << line.bit;
+            if (line.mode == PinMode::OUTPUT)
+            {
+                outputMask |= bit;
+                if (line.high)
+                {
+                    outputValues |= bit;
+                }
+            }
+            else if (line.edge != 0)
+            {
+                edgeMasks[line.edge] |= bit;
+            }
+        }
+
+        // Lines default to input; outputs are overridden and keep their last level
+        config.flags = GPIO_V2_LINE_FLAG_INPUT;
+        if (outputMask != 0)
+        {
+            config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_FLAGS;
+            config.attrs[0].attr.flags = GPIO_V2_LINE_FLAG_OUTPUT;
+            config.attrs[0].mask = outputMask;
+            config.attrs[1].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+            config.attrs[1].attr.values = outputValues;
+            config.attrs[1].mask = outputMask;
+            config.num_attrs = 2;
+        }
+        for (int edge = 1; edge < 4; ++edge)
+        {
+            if (edgeMasks[edge] != 0)
+            {
+                gpio_v2_line_config_attribute &attr = config.attrs[config.num_attrs++];
+                attr.attr.id = GPIO_V2_LINE_ATTR_ID_FLAGS;
+                attr.attr.flags = edgeFlags(edge);
+                attr.mask = edgeMasks[edge];
+            }
+        }
+    }
+
+    GpioEdgeWatcher::ReadyHandler CdevGpioController::edgeHandler(int request) const
+    {
+        // The watcher thread gets its own copy of the callbacks: it never takes m_mutex
+        std::vector<WatchedLine> watched;
+        bool edges = false;
+        for (const auto &line : m_lines)
+        {
+            if (line.request == request && line.edge != 0)
+            {
+                edges = true;
+                if (line.callback)
+                {
+                    watched.push_back(WatchedLine{line.offset, line.pin, line.callback});
+                }
+            }
+        }
+        if (!edges)
+        {
+            return nullptr;
+        }
+
+        int fd = m_requestFds[request];
+        return [fd, watched]()
+        {
+            gpio_v2_line_event events[EVENT_BATCH_SIZE];
+            ssize_t bytes = read(fd, events, sizeof(events));
+            if (bytes <= 0)
+            {
+                return;
+            }
+
+            size_t count = static_cast<size_t>(bytes) / sizeof(events[0]);
+            for (size_t i = 0; i < count; ++i)
+            {
+                for (const auto &line : watched)
+                {
+                    if (line.offset == events[i].offset)
+                    {
+                        PinValue value = events[i].id == GPIO_V2_LINE_EVENT_RISING_EDGE ? PinValue::HIGH : PinValue::LOW;
+                        line.callback(PinEvent{line.pin, value, events[i].timestamp_ns});
+                        break;
+                    }
+                }
+            }
+        };
+    }
+
+    void CdevGpioController::updateWatcher(int request, int fd, GpioEdgeWatcher::ReadyHandler handler)
+    {
+        // Called with m_configMutex only: restarting the watcher joins its thread
+        if (handler)
+        {
+            m_edgeWatcher.watch(request, fd, POLLIN, std::move(handler));
+        }
+        else
+        {
+            m_edgeWatcher.unwatch(request);
+        }
+    }
+
+    bool CdevGpioController::setValues(int fd, uint64_t bits, uint64_t mask)
+    {
+        gpio_v2_line_values lineValues;
+        lineValues.bits = bits;
+        lineValues.mask = mask;
+        if (ioctl(fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &lineValues) < 0)
+        {
+            std::cerr << "[Cdev GPIO] Cannot set line values: " << strerror(errno) << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+} // namespace Wallbox
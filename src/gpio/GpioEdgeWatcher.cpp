@@ -0,0 +1,164 @@
+#include "GpioEdgeWatcher.h"
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+namespace Wallbox
+{
+
+    GpioEdgeWatcher::GpioEdgeWatcher()
+        : m_wakeFd(-1)
+    {
+    }
+
+    GpioEdgeWatcher::~GpioEdgeWatcher()
+    {
+        clear();
+    }
+
+    bool GpioEdgeWatcher::watch(int key, int fd, short events, ReadyHandler handler)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        stopThread();
+
+        bool replaced = false;
+        for (auto &entry : m_entries)
+        {
+            if (entry.key == key)
+            {
+                entry = Entry{key, fd, events, std::move(handler)};
+                replaced = true;
+                break;
+            }
+        }
+        if (!replaced)
+        {
+            m_entries.push_back(Entry{key, fd, events, std::move(handler)});
+        }
+
+        return startThread();
+    }
+
+    void GpioEdgeWatcher::unwatch(int key)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        stopThread();
+
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+        {
+            if (it->key == key)
+            {
+                m_entries.erase(it);
+                break;
+            }
+        }
+
+        if (!m_entries.empty())
+        {
+            startThread();
+        }
+    }
+
+    void GpioEdgeWatcher::clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        stopThread();
+        m_entries.clear();
+    }
+
+    bool GpioEdgeWatcher::isWatching(int key) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto &entry : m_entries)
+        {
+            if (entry.key == key)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint64_t GpioEdgeWatcher::monotonicNowNs()
+    {
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + static_cast<uint64_t>(now.tv_nsec);
+    }
+
+    bool GpioEdgeWatcher::startThread()
+    {
+        m_wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (m_wakeFd < 0)
+        {
+            std::cerr << "[GPIO] Cannot create eventfd for edge watcher: " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        // The thread works on its own copy, so reconfiguration never races with it
+        m_thread = std::thread(&GpioEdgeWatcher::run, this, m_entries);
+        return true;
+    }
+
+    void GpioEdgeWatcher::stopThread()
+    {
+        if (!m_thread.joinable())
+        {
+            return;
+        }
+
+        uint64_t one = 1;
+        ssize_t written = write(m_wakeFd, &one, sizeof(one));
+        (void)written;
+        m_thread.join();
+        close(m_wakeFd);
+        m_wakeFd = -1;
+    }
+
+    void GpioEdgeWatcher::run(std::vector<Entry> entries)
+    {
+        std::vector<pollfd> fds(entries.size() + 1);
+        fds[0] = pollfd{m_wakeFd, POLLIN, 0};
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            fds[i + 1] = pollfd{entries[i].fd, entries[i].events, 0};
+        }
+
+        while (true)
+        {
+            int ready = poll(fds.data(), fds.size(), -1);
+            if (ready < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                std::cerr << "[GPIO] Edge watcher poll failed: " << strerror(errno) << std::endl;
+                return;
+            }
+
+            if (fds[0].revents != 0)
+            {
+                return;
+            }
+
+            for (size_t i = 1; i < fds.size(); ++i)
+            {
+                if (fds[i].revents & POLLNVAL)
+                {
+                    // Closed underneath us: stop polling it instead of spinning
+                    fds[i].fd = -1;
+                }
+                else if (fds[i].revents != 0)
+                {
+                    entries[i - 1].handler();
+                }
+            }
+        }
+    }
+
+} // namespace Wallbox
@@ -0,0 +1,213 @@
+#include "MmioGpioController.h"
+#include "GpioMetrics.h"
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace Wallbox
+{
+
+    namespace
+    {
+        GpioMetrics &gpioMetrics()
+        {
+            static GpioMetrics metrics("mmio");
+            return metrics;
+        }
+    } // namespace
+
+    GpioRegisterLayout GpioRegisterLayout::amlogicG12(int lineBase)
+    {
+        GpioRegisterLayout layout;
+        layout.physicalBase = 0xff634000;
+        layout.blockOffset = 0x440;
+        layout.mapSize = 4096;
+
+        // {first pin, count, first bit, dir reg, dir set = input, out reg, in reg, set reg, clear reg}
+        layout.banks = {
+            /* GPIOZ  */ {lineBase + 0, 16, 0, 0x0c, true, 0x0d, 0x0e, -1, -1},
+            /* GPIOH  */ {lineBase + 16, 9, 0, 0x09, true, 0x0a, 0x0b, -1, -1},
+            /* BOOT   */ {lineBase + 25, 16, 0, 0x00, true, 0x01, 0x02, -1, -1},
+            /* GPIOC  */ {lineBase + 41, 8, 0, 0x03, true, 0x04, 0x05, -1, -1},
+            /* GPIOA  */ {lineBase + 49, 16, 0, 0x10, true, 0x11, 0x12, -1, -1},
+            /* GPIOX  */ {lineBase + 65, 20, 0, 0x06, true, 0x07, 0x08, -1, -1},
+        };
+        return layout;
+    }
+
+    MmioGpioController::MmioGpioController(const GpioRegisterLayout &layout, const std::string &device)
+        : m_layout(layout),
+          m_device(device),
+          m_mapping(nullptr),
+          m_registers(nullptr)
+    {
+        std::cout << "[MMIO GPIO] Using GPIO registers via " << m_device << std::endl;
+    }
+
+    MmioGpioController::MmioGpioController(const GpioRegisterLayout &layout, volatile uint32_t *registers)
+        : m_layout(layout),
+          m_mapping(nullptr),
+          m_registers(registers)
+    {
+    }
+
+    MmioGpioController::~MmioGpioController()
+    {
+        shutdown();
+    }
+
+    bool MmioGpioController::initialize()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_registers != nullptr)
+        {
+            return true;
+        }
+
+        int fd = open(m_device.c_str(), O_RDWR | O_SYNC | O_CLOEXEC);
+        if (fd < 0)
+        {
+            std::cerr << "[MMIO GPIO] Error: cannot open " << m_device << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        // /dev/gpiomem only exposes the GPIO page, /dev/mem needs the physical address
+        off_t offset = (m_device == "/dev/mem") ? m_layout.physicalBase : 0;
+        void *mapping = mmap(nullptr, m_layout.mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, offset);
+        close(fd);
+        if (mapping == MAP_FAILED)
+        {
+            std::cerr << "[MMIO GPIO] Error: cannot map GPIO registers: " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        m_mapping = mapping;
+        m_registers = reinterpret_cast<volatile uint32_t *>(static_cast<char *>(mapping) + m_layout.blockOffset);
+        std::cout << "[MMIO GPIO] Mapped " << m_layout.banks.size() << " GPIO banks" << std::endl;
+        return true;
+    }
+
+    void MmioGpioController::shutdown()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_mapping != nullptr)
+        {
+            munmap(m_mapping, m_layout.mapSize);
+            m_mapping = nullptr;
+            m_registers = nullptr;
+        }
+    }
+
+    bool MmioGpioController::isInitialized() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_registers != nullptr;
+    }
+
+    bool MmioGpioController::setPinMode(int pin, PinMode mode)
+    {
+        const GpioRegisterLayout::Bank *bank = findBank(pin);
+        if (bank == nullptr)
+        {
+            std::cerr << "[MMIO GPIO] Pin " << pin << " is not in the register layout" << std::endl;
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_registers == nullptr)
+        {
+            std::cerr << "[MMIO GPIO] Not initialized" << std::endl;
+            return false;
+        }
+
+        uint32_t mask = 1u << (bank->firstBit + pin - bank->firstPin);
+        bool output = (mode == PinMode::OUTPUT);
+        setBit(bank->directionReg, mask, output != bank->directionInputSet);
+        return true;
+    }
+
+    bool MmioGpioController::digitalWrite(int pin, PinValue value)
+    {
+        PinWrite write = {pin, value};
+        return writeMany(&write, 1);
+    }
+
+    bool MmioGpioController::writeMany(const PinWrite *writes, size_t count)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_registers == nullptr)
+        {
+            std::cerr << "[MMIO GPIO] Not initialized" << std::endl;
+            return false;
+        }
+
+        bool ok = true;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const GpioRegisterLayout::Bank *bank = findBank(writes[i].pin);
+            if (bank == nullptr)
+            {
+                std::cerr << "[MMIO GPIO] Pin " << writes[i].pin << " is not in the register layout" << std::endl;
+                gpioMetrics().errors.inc();
+                ok = false;
+                continue;
+            }
+            writePin(*bank, writes[i].pin, writes[i].value == PinValue::HIGH);
+            gpioMetrics().writes.inc();
+        }
+        return ok;
+    }
+
+    PinValue MmioGpioController::digitalRead(int pin) const
+    {
+        // Under the lock: shutdown() unmaps the registers
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const GpioRegisterLayout::Bank *bank = findBank(pin);
+        if (bank == nullptr || m_registers == nullptr)
+        {
+            std::cerr << "[MMIO GPIO] Cannot read pin " << pin << std::endl;
+            gpioMetrics().errors.inc();
+            return PinValue::LOW;
+        }
+        gpioMetrics().reads.inc();
+
+        uint32_t mask = 1u << (bank->firstBit + pin - bank->firstPin);
+        return (m_registers[bank->inputReg] & mask) ? PinValue::HIGH : PinValue::LOW;
+    }
+
+    const GpioRegisterLayout::Bank *MmioGpioController::findBank(int pin) const
+    {
+        for (const auto &bank : m_layout.banks)
+        {
+            if (pin >= bank.firstPin && pin < bank.firstPin + bank.pinCount)
+            {
+                return &bank;
+            }
+        }
+        return nullptr;
+    }
+
+    void MmioGpioController::setBit(int reg, uint32_t mask, bool set)
+    {
+        uint32_t value = m_registers[reg];
+        m_registers[reg] = set ? (value | mask) : (value & ~mask);
+    }
+
+    void MmioGpioController::writePin(const GpioRegisterLayout::Bank &bank, int pin, bool high)
+    {
+        uint32_t mask = 1u << (bank.firstBit + pin - bank.firstPin);
+
+        // Set/clear registers make the write a single store
+        int strobeReg = high ? bank.setReg : bank.clearReg;
+        if (strobeReg >= 0)
+        {
+            m_registers[strobeReg] = mask;
+            return;
+        }
+        setBit(bank.outputReg, mask, high);
+    }
+
+} // namespace Wallbox
@@ -1,9 +1,20 @@
 #include "StubGpioController.h"
+#include "GpioMetrics.h"
+#include "Logger.h"
 #include <iostream>
 
 namespace Wallbox
 {
 
+    namespace
+    {
+        GpioMetrics &gpioMetrics()
+        {
+            static GpioMetrics metrics("stub");
+            return metrics;
+        }
+    } // namespace
+
     StubGpioController::StubGpioController()
     {
         std::cout << "StubGpioController: Initialized (no hardware access)" << std::endl;
@@ -35,26 +46,28 @@ namespace Wallbox
 
     bool StubGpioController::digitalWrite(int pin, PinValue value)
     {
-        std::string valueStr = (value == PinValue::HIGH) ? "HIGH" : "LOW";
-        std::cout << "StubGpioController: Write pin " << pin << " = " << valueStr << std::endl;
+        WALLBOX_LOG_DEBUG("StubGPIO") << "Write pin " << pin << " = "
+                                      << (value == PinValue::HIGH ? "HIGH" : "LOW");
 
         // Store state for reading back
         m_pinStates[pin] = value;
+        gpioMetrics().writes.inc();
         return true;
     }
 
     PinValue StubGpioController::digitalRead(int pin) const
     {
+        gpioMetrics().reads.inc();
         auto it = m_pinStates.find(pin);
         if (it != m_pinStates.end())
         {
-            std::string valueStr = (it->second == PinValue::HIGH) ? "HIGH" : "LOW";
-            std::cout << "StubGpioController: Read pin " << pin << " = " << valueStr << std::endl;
+            WALLBOX_LOG_DEBUG("StubGPIO") << "Read pin " << pin << " = "
+                                          << (it->second == PinValue::HIGH ? "HIGH" : "LOW");
             return it->second;
         }
 
         // Default to LOW if not previously set
-        std::cout << "StubGpioController: Read pin " << pin << " = LOW (default)" << std::endl;
+        WALLBOX_LOG_DEBUG("StubGPIO") << "Read pin " << pin << " = LOW (default)";
         return PinValue::LOW;
     }
 
@@ -1,18 +1,85 @@
 #include "UdpCommunicator.h"
+#include "EventJournal.h"
+#include "LatencyTracer.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include <algorithm>
 #include <cstring>
+#include <cerrno>
 #include <stdexcept>
 #include <unistd.h>
 #include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/eventfd.h>
 #include <arpa/inet.h>
-#include <iostream>
+#include <memory>
 #include <thread>
-#include <chrono>
 
 namespace Wallbox
 {
 
-    UdpCommunicator::UdpCommunicator(int listenPort, int sendPort, const std::string &sendAddress)
-        : m_listenPort(listenPort), m_sendPort(sendPort), m_sendAddress(sendAddress), m_socketFd(-1), m_running(false)
+    namespace
+    {
+        constexpr unsigned int RECEIVE_BATCH_SIZE = 16; // Datagrams per recvmmsg() call
+        constexpr unsigned int SEND_BATCH_SIZE = 16;    // Datagrams per sendmmsg() call
+        constexpr size_t MAX_DATAGRAM_SIZE = 4096;
+
+        struct UdpMetrics
+        {
+            Counter &rxPackets;
+            Counter &rxBytes;
+            Counter &rxTruncated;
+            Counter &rxErrors;
+            Counter &txPackets;
+            Counter &txBytes;
+            Counter &txDropped;
+
+            UdpMetrics()
+                : rxPackets(MetricsRegistry::instance().counter("wallbox_udp_rx_packets_total", "Datagrams received")),
+                  rxBytes(MetricsRegistry::instance().counter("wallbox_udp_rx_bytes_total", "Bytes received")),
+                  rxTruncated(MetricsRegistry::instance().counter("wallbox_udp_rx_truncated_total",
+                                                                  "Datagrams larger than the receive buffer")),
+                  rxErrors(MetricsRegistry::instance().counter("wallbox_udp_rx_errors_total", "Failed receive calls")),
+                  txPackets(MetricsRegistry::instance().counter("wallbox_udp_tx_packets_total", "Datagrams sent")),
+                  txBytes(MetricsRegistry::instance().counter("wallbox_udp_tx_bytes_total", "Bytes sent")),
+                  txDropped(MetricsRegistry::instance().counter("wallbox_udp_tx_dropped_total",
+                                                                "Datagrams not sent or only partially sent"))
+            {
+            }
+        };
+
+        UdpMetrics &udpMetrics()
+        {
+            static UdpMetrics metrics;
+            return metrics;
+        }
+    } // namespace
+
+    struct UdpCommunicator::ReceiveBatch
+    {
+        std::vector<uint8_t> buffers;
+        iovec iovecs[RECEIVE_BATCH_SIZE];
+        mmsghdr messages[RECEIVE_BATCH_SIZE];
+
+        ReceiveBatch()
+            : buffers(RECEIVE_BATCH_SIZE * MAX_DATAGRAM_SIZE)
+        {
+            std::memset(messages, 0, sizeof(messages));
+            for (unsigned int i = 0; i < RECEIVE_BATCH_SIZE; ++i)
+            {
+                iovecs[i].iov_base = &buffers[i * MAX_DATAGRAM_SIZE];
+                iovecs[i].iov_len = MAX_DATAGRAM_SIZE;
+                messages[i].msg_hdr.msg_iov = &iovecs[i];
+                messages[i].msg_hdr.msg_iovlen = 1;
+            }
+        }
+    };
+
+    UdpCommunicator::UdpCommunicator(int listenPort, int sendPort, const std::string &sendAddress,
+                                     bool connectedSocket)
+        : m_listenPort(listenPort), m_sendPort(sendPort), m_sendAddress(sendAddress),
+          m_connectedSocket(connectedSocket), m_destination(), m_socketFd(-1), m_wakeFd(-1), m_running(false)
     {
     }
 
@@ -23,11 +90,18 @@ namespace Wallbox
 
     bool UdpCommunicator::connect()
     {
+        if (m_socketFd >= 0)
+        {
+            // Replacing the fd would leak it and pull it from under the receive thread
+            WALLBOX_LOG_ERROR("UDP") << "Already connected on port " << m_listenPort << "; disconnect() first";
+            return false;
+        }
+
         // Create UDP socket
         m_socketFd = socket(AF_INET, SOCK_DGRAM, 0);
         if (m_socketFd < 0)
         {
-            std::cerr << "Failed to create UDP socket: " << strerror(errno) << std::endl;
+            WALLBOX_LOG_ERROR("UDP") << "Failed to create UDP socket: " << strerror(errno);
             return false;
         }
 
@@ -35,7 +109,7 @@ namespace Wallbox
         int opt = 1;
         if (setsockopt(m_socketFd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0)
         {
-            std::cerr << "Failed to set SO_REUSEADDR: " << strerror(errno) << std::endl;
+            WALLBOX_LOG_ERROR("UDP") << "Failed to set SO_REUSEADDR: " << strerror(errno);
             close(m_socketFd);
             m_socketFd = -1;
             return false;
@@ -49,30 +123,65 @@ namespace Wallbox
 
         if (bind(m_socketFd, (struct sockaddr *)&listenAddr, sizeof(listenAddr)) < 0)
         {
-            std::cerr << "Failed to bind to port " << m_listenPort << ": "
-                      << strerror(errno) << std::endl;
+            WALLBOX_LOG_ERROR("UDP") << "Failed to bind to port " << m_listenPort << ": "
+                                     << strerror(errno);
             close(m_socketFd);
             m_socketFd = -1;
             return false;
         }
 
-        // Set socket to non-blocking mode
+        if (!resolveDestination())
+        {
+            close(m_socketFd);
+            m_socketFd = -1;
+            return false;
+        }
+
+        if (m_connectedSocket &&
+            ::connect(m_socketFd, (struct sockaddr *)&m_destination, sizeof(m_destination)) < 0)
+        {
+            WALLBOX_LOG_ERROR("UDP") << "Failed to connect UDP socket to " << m_sendAddress << ":" << m_sendPort
+                                     << ": " << strerror(errno);
+            close(m_socketFd);
+            m_socketFd = -1;
+            return false;
+        }
+
+        // Non-blocking: the receive thread waits in poll(), never in recv
         int flags = fcntl(m_socketFd, F_GETFL, 0);
         fcntl(m_socketFd, F_SETFL, flags | O_NONBLOCK);
 
-        std::cout << "UDP communicator connected on port " << m_listenPort << std::endl;
+        WALLBOX_LOG_INFO("UDP") << "UDP communicator connected on port " << m_listenPort
+                                << (m_connectedSocket ? " (connected to " : " (sending to ")
+                                << inet_ntoa(m_destination.sin_addr) << ":" << m_sendPort << ")";
         return true;
     }
 
-    void UdpCommunicator::disconnect()
+    bool UdpCommunicator::resolveDestination()
     {
-        m_running = false;
-
-        if (m_receiveThread.joinable())
+        addrinfo hints{};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_DGRAM;
+
+        // Numeric addresses resolve without a lookup; hostnames are looked up once here
+        addrinfo *result = nullptr;
+        std::string port = std::to_string(m_sendPort);
+        int status = getaddrinfo(m_sendAddress.c_str(), port.c_str(), &hints, &result);
+        if (status != 0 || result == nullptr)
         {
-            m_receiveThread.join();
+            WALLBOX_LOG_ERROR("UDP") << "Invalid send address: " << m_sendAddress << " (" << gai_strerror(status) << ")";
+            return false;
         }
 
+        std::memcpy(&m_destination, result->ai_addr, sizeof(m_destination));
+        freeaddrinfo(result);
+        return true;
+    }
+
+    void UdpCommunicator::disconnect()
+    {
+        stopReceiving();
+
         if (m_socketFd >= 0)
         {
             close(m_socketFd);
@@ -81,48 +190,131 @@ namespace Wallbox
     }
 
     bool UdpCommunicator::send(const std::vector<uint8_t> &data)
+    {
+        return send(ByteSpan(data));
+    }
+
+    bool UdpCommunicator::send(ByteSpan data)
     {
         if (m_socketFd < 0)
         {
-            std::cerr << "Cannot send: socket not connected" << std::endl;
+            WALLBOX_LOG_ERROR("UDP") << "Cannot send: socket not connected";
             return false;
         }
 
-        sockaddr_in sendAddr{};
-        sendAddr.sin_family = AF_INET;
-        sendAddr.sin_port = htons(m_sendPort);
+        ssize_t sent = m_connectedSocket
+                           ? ::send(m_socketFd, data.data, data.size, 0)
+                           : sendto(m_socketFd, data.data, data.size, 0,
+                                    (struct sockaddr *)&m_destination, sizeof(m_destination));
 
-        if (inet_pton(AF_INET, m_sendAddress.c_str(), &sendAddr.sin_addr) <= 0)
+        if (sent < 0)
         {
-            std::cerr << "Invalid send address: " << m_sendAddress << std::endl;
+            udpMetrics().txDropped.inc();
+            // Connected sockets report a missing peer (ICMP port unreachable); not worth a log line
+            if (errno != ECONNREFUSED)
+            {
+                WALLBOX_LOG_ERROR("UDP") << "Failed to send UDP packet: " << strerror(errno);
+            }
             return false;
         }
 
-        ssize_t sent = sendto(m_socketFd, data.data(), data.size(), 0,
-                              (struct sockaddr *)&sendAddr, sizeof(sendAddr));
-
-        if (sent < 0)
+        if (static_cast<size_t>(sent) != data.size)
         {
-            std::cerr << "Failed to send UDP packet: " << strerror(errno) << std::endl;
+            WALLBOX_LOG_ERROR("UDP") << "Partial send: " << sent << "/" << data.size << " bytes";
+            udpMetrics().txDropped.inc();
             return false;
         }
 
-        if (static_cast<size_t>(sent) != data.size())
+        udpMetrics().txPackets.inc();
+        udpMetrics().txBytes.inc(data.size);
+
+        EventJournal::instance().record(JournalEvent::UDP_TX, static_cast<uint32_t>(data.size), 0, data.data, data.size);
+        return true;
+    }
+
+    bool UdpCommunicator::sendBatch(const ByteSpan *messages, size_t count)
+    {
+        if (m_socketFd < 0)
         {
-            std::cerr << "Partial send: " << sent << "/" << data.size() << " bytes" << std::endl;
+            WALLBOX_LOG_ERROR("UDP") << "Cannot send: socket not connected";
             return false;
         }
 
+        mmsghdr headers[SEND_BATCH_SIZE];
+        iovec iovecs[SEND_BATCH_SIZE];
+        size_t done = 0;
+        while (done < count)
+        {
+            unsigned int batch = static_cast<unsigned int>(std::min<size_t>(count - done, SEND_BATCH_SIZE));
+            std::memset(headers, 0, sizeof(headers[0]) * batch);
+            for (unsigned int i = 0; i < batch; ++i)
+            {
+                iovecs[i].iov_base = const_cast<uint8_t *>(messages[done + i].data);
+                iovecs[i].iov_len = messages[done + i].size;
+                headers[i].msg_hdr.msg_iov = &iovecs[i];
+                headers[i].msg_hdr.msg_iovlen = 1;
+                if (!m_connectedSocket)
+                {
+                    headers[i].msg_hdr.msg_name = &m_destination;
+                    headers[i].msg_hdr.msg_namelen = sizeof(m_destination);
+                }
+            }
+
+            // Returns how many went out; the rest are retried in the next round
+            int sent = sendmmsg(m_socketFd, headers, batch, 0);
+            if (sent < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                if (errno != ECONNREFUSED)
+                {
+                    WALLBOX_LOG_ERROR("UDP") << "Failed to send UDP batch: " << strerror(errno);
+                }
+                udpMetrics().txDropped.inc(count - done);
+                return false;
+            }
+            UdpMetrics &metrics = udpMetrics();
+            for (int i = 0; i < sent; ++i)
+            {
+                const ByteSpan &message = messages[done + i];
+                metrics.txPackets.inc();
+                metrics.txBytes.inc(message.size);
+                EventJournal::instance().record(JournalEvent::UDP_TX, static_cast<uint32_t>(message.size), 0,
+                                                message.data, message.size);
+            }
+            done += static_cast<size_t>(sent);
+        }
         return true;
     }
 
     void UdpCommunicator::startReceiving(MessageCallback callback)
+    {
+        // Compatibility path: one vector per receive thread, reused for every message
+        std::shared_ptr<std::vector<uint8_t>> message = std::make_shared<std::vector<uint8_t>>();
+        startReceiving(SpanCallback([callback, message](ByteSpan data)
+                                    {
+            message->assign(data.data, data.data + data.size);
+            callback(*message); }));
+    }
+
+    void UdpCommunicator::startReceiving(SpanCallback callback)
     {
         if (m_socketFd < 0)
         {
             throw std::runtime_error("Cannot start receiving: socket not connected");
         }
 
+        if (m_wakeFd < 0)
+        {
+            m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (m_wakeFd < 0)
+            {
+                throw std::runtime_error(std::string("Cannot start receiving: eventfd failed: ") + strerror(errno));
+            }
+        }
+
         m_messageCallback = callback;
         m_running = true;
 
@@ -136,8 +328,22 @@ namespace Wallbox
 
         if (m_receiveThread.joinable())
         {
+            wakeReceiveThread();
             m_receiveThread.join();
         }
+
+        if (m_wakeFd >= 0)
+        {
+            close(m_wakeFd);
+            m_wakeFd = -1;
+        }
+    }
+
+    void UdpCommunicator::wakeReceiveThread()
+    {
+        uint64_t one = 1;
+        ssize_t result = write(m_wakeFd, &one, sizeof(one));
+        (void)result;
     }
 
     bool UdpCommunicator::isConnected() const
@@ -147,38 +353,102 @@ namespace Wallbox
 
     void UdpCommunicator::receiveLoop()
     {
-        std::vector<uint8_t> buffer(4096);
+        pollfd fds[2];
+        fds[0].fd = m_socketFd;
+        fds[0].events = POLLIN;
+        fds[1].fd = m_wakeFd;
+        fds[1].events = POLLIN;
 
         while (m_running)
         {
-            sockaddr_in senderAddr{};
-            socklen_t senderLen = sizeof(senderAddr);
-
-            ssize_t received = recvfrom(m_socketFd, buffer.data(), buffer.size(), 0,
-                                        (struct sockaddr *)&senderAddr, &senderLen);
-
-            if (received > 0)
+            // Sleep in the kernel until a datagram arrives or stopReceiving() wakes us
+            int ready = poll(fds, 2, -1);
+            if (ready < 0)
             {
-                // Copy received data to appropriately sized vector
-                std::vector<uint8_t> message(buffer.begin(), buffer.begin() + received);
-
-                // Invoke callback if set
-                if (m_messageCallback)
+                if (errno != EINTR)
                 {
-                    m_messageCallback(message);
+                    WALLBOX_LOG_ERROR("UDP") << "UDP poll error: " << strerror(errno);
+                    break;
                 }
+                continue;
             }
-            else if (received < 0)
+            if (fds[1].revents != 0)
             {
-                if (errno != EAGAIN && errno != EWOULDBLOCK)
-                {
-                    std::cerr << "Receive error: " << strerror(errno) << std::endl;
-                }
+                break;
+            }
+
+            // Drain everything queued; a full batch means more may be waiting
+            while (m_running && receiveBatch(m_messageCallback) == static_cast<int>(RECEIVE_BATCH_SIZE))
+            {
+            }
+        }
+    }
+
+    int UdpCommunicator::receivePending(const SpanCallback &callback)
+    {
+        if (m_socketFd < 0)
+        {
+            return -1;
+        }
+
+        int total = 0;
+        int count;
+        do
+        {
+            count = receiveBatch(callback);
+            total += count;
+        } while (count == static_cast<int>(RECEIVE_BATCH_SIZE));
+        return total;
+    }
+
+    int UdpCommunicator::receiveBatch(const SpanCallback &callback)
+    {
+        if (!m_batch)
+        {
+            m_batch.reset(new ReceiveBatch());
+        }
+
+        uint64_t receiveStartNs = LatencyTracer::nowNs();
+        int count;
+        do
+        {
+            count = recvmmsg(m_socketFd, m_batch->messages, RECEIVE_BATCH_SIZE, MSG_DONTWAIT, nullptr);
+        } while (count < 0 && errno == EINTR);
+
+        if (count < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != ECONNREFUSED)
+            {
+                WALLBOX_LOG_ERROR("UDP") << "Receive error: " << strerror(errno);
+                udpMetrics().rxErrors.inc();
             }
+            return 0;
+        }
 
-            // Small delay to prevent CPU spinning
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        uint64_t receiveEndNs = LatencyTracer::nowNs();
+        UdpMetrics &metrics = udpMetrics();
+        for (int i = 0; i < count; ++i)
+        {
+            // Each datagram is its own trace; later ones in the batch include the wait for earlier ones
+            TraceScope trace(TraceOrigin::UDP, receiveStartNs);
+            LatencyTracer::instance().record(trace.context(), TraceStage::RECEIVE, receiveStartNs, receiveEndNs);
+
+            // Handed over in place; the slot is reused by the next recvmmsg()
+            ByteSpan message(static_cast<const uint8_t *>(m_batch->iovecs[i].iov_base), m_batch->messages[i].msg_len);
+            metrics.rxPackets.inc();
+            metrics.rxBytes.inc(message.size);
+            if (m_batch->messages[i].msg_hdr.msg_flags & MSG_TRUNC)
+            {
+                metrics.rxTruncated.inc();
+            }
+            EventJournal::instance().record(JournalEvent::UDP_RX, static_cast<uint32_t>(message.size), 0,
+                                            message.data, message.size);
+            if (callback)
+            {
+                callback(message);
+            }
         }
+        return count;
     }
 
 } // namespace Wallbox
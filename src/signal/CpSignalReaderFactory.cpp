@@ -10,6 +10,9 @@
 #include "CpSignalReaderFactory.h"
 #include "SimulatorCpSignalReader.h"
 #include "HardwareCpSignalReader.h"
+#include "IioCpSampleSource.h"
+#include "Configuration.h"
+#include <algorithm>
 #include <stdexcept>
 #include <iostream>
 
@@ -63,9 +66,34 @@ namespace Wallbox
             throw std::invalid_argument("Invalid CP pin number");
         }
 
+        auto &config = Configuration::getInstance();
+        CpFilterConfig filter(static_cast<unsigned>(std::max(config.getCpFilterVotes(), 1)),
+                              static_cast<unsigned>(std::max(config.getCpFilterWindow(), 1)),
+                              config.getCpFilterHysteresisMv(),
+                              static_cast<uint32_t>(std::max(config.getCpFilterMinDwellMs(), 0)));
+
+        // Sample the real waveform when an ADC (or a capture to replay) is configured
+        if (!config.getCpAdcDevice().empty() || !config.getCpAdcReplayFile().empty())
+        {
+            IioCpConfig adc;
+            if (!config.getCpAdcDevice().empty())
+            {
+                adc.device = config.getCpAdcDevice();
+            }
+            adc.channel = config.getCpAdcChannel();
+            adc.sampleRateHz = static_cast<unsigned>(config.getCpAdcSampleRate());
+            adc.frontEndOffsetMv = config.getCpAdcOffsetMv();
+            adc.frontEndGainX1000 = config.getCpAdcGainX1000();
+            adc.replayFile = config.getCpAdcReplayFile();
+
+            std::cout << "[CpSignalReaderFactory] Creating hardware CP reader (ADC: "
+                      << (adc.replayFile.empty() ? adc.device : adc.replayFile) << ")" << std::endl;
+            return std::make_unique<HardwareCpSignalReader>(std::make_unique<IioCpSampleSource>(adc), filter);
+        }
+
         std::cout << "[CpSignalReaderFactory] Creating hardware CP reader (pin: "
                   << cpPin << ")" << std::endl;
-        return std::make_unique<HardwareCpSignalReader>(gpioController, cpPin);
+        return std::make_unique<HardwareCpSignalReader>(gpioController, cpPin, filter);
     }
 
     /**
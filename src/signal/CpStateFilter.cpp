@@ -0,0 +1,161 @@
+#include "CpStateFilter.h"
+#include "CpWaveformAnalyzer.h"
+#include <algorithm>
+#include <limits>
+
+namespace Wallbox
+{
+
+    namespace
+    {
+        struct VoltageBand
+        {
+            int32_t lowMv; ///< Exclusive
+            int32_t highMv; ///< Inclusive
+        };
+
+        /**
+         * @brief Voltage band of a CP state, as used by CpWaveformAnalyzer::stateForVoltage()
+         * @return false for states without a band (UNKNOWN)
+         */
+        bool bandFor(CpState state, VoltageBand &band)
+        {
+            const int32_t minMv = std::numeric_limits<int32_t>::min();
+            const int32_t maxMv = std::numeric_limits<int32_t>::max();
+            switch (state)
+            {
+            case CpState::STATE_A:
+                band = {11000, maxMv};
+                return true;
+            case CpState::STATE_B:
+                band = {8000, 11000};
+                return true;
+            case CpState::STATE_C:
+                band = {5000, 8000};
+                return true;
+            case CpState::STATE_D:
+                band = {2000, 5000};
+                return true;
+            case CpState::STATE_E:
+                band = {-2000, 2000};
+                return true;
+            case CpState::STATE_F:
+                band = {minMv, -10001};
+                return true;
+            default:
+                return false;
+            }
+        }
+    } // namespace
+
+    constexpr unsigned CpStateFilter::MAX_WINDOW;
+
+    CpStateFilter::CpStateFilter(const CpFilterConfig &config)
+        : m_config(config),
+          m_stats{0, 0, 0}
+    {
+        m_config.window = std::min(std::max(m_config.window, 1u), MAX_WINDOW);
+        m_config.votes = std::min(std::max(m_config.votes, 1u), m_config.window);
+        reset(CpState::UNKNOWN, 0);
+    }
+
+    void CpStateFilter::reset(CpState state, uint64_t timestampNs)
+    {
+        m_state = state;
+        m_changeNs = timestampNs;
+        std::fill(m_window, m_window + MAX_WINDOW, state);
+        std::fill(m_windowNs, m_windowNs + MAX_WINDOW, timestampNs);
+        m_next = 0;
+        m_filled = m_config.window;
+        m_lastRaw = state;
+    }
+
+    bool CpStateFilter::addVoltage(int32_t millivolts, uint64_t timestampNs)
+    {
+        CpState raw = CpWaveformAnalyzer::stateForVoltage(millivolts);
+        return vote(withHysteresis(millivolts, raw), raw, timestampNs);
+    }
+
+    bool CpStateFilter::addState(CpState state, uint64_t timestampNs)
+    {
+        return vote(state, state, timestampNs);
+    }
+
+    bool CpStateFilter::settled() const
+    {
+        for (unsigned i = 0; i < m_filled; ++i)
+        {
+            if (m_window[i] != m_state)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    CpState CpStateFilter::withHysteresis(int32_t millivolts, CpState raw) const
+    {
+        VoltageBand band;
+        if (raw == m_state || !bandFor(m_state, band))
+        {
+            return raw;
+        }
+
+        // Widen the current state's band; 64-bit so the open ends cannot overflow
+        int64_t low = static_cast<int64_t>(band.lowMv) - m_config.hysteresisMv;
+        int64_t high = static_cast<int64_t>(band.highMv) + m_config.hysteresisMv;
+        return (millivolts > low && millivolts <= high) ? m_state : raw;
+    }
+
+    bool CpStateFilter::vote(CpState state, CpState raw, uint64_t timestampNs)
+    {
+        ++m_stats.samples;
+
+        // What an unfiltered reader would have reported (it ignored UNKNOWN)
+        if (raw != CpState::UNKNOWN && raw != m_lastRaw)
+        {
+            if (m_lastRaw != CpState::UNKNOWN)
+            {
+                ++m_stats.rawTransitions;
+            }
+            m_lastRaw = raw;
+        }
+
+        m_window[m_next] = state;
+        m_windowNs[m_next] = timestampNs;
+        m_next = (m_next + 1) % m_config.window;
+        m_filled = std::min(m_filled + 1, m_config.window);
+
+        if (state == m_state || state == CpState::UNKNOWN)
+        {
+            return false;
+        }
+
+        unsigned votes = 0;
+        uint64_t firstVoteNs = timestampNs;
+        for (unsigned i = 0; i < m_filled; ++i)
+        {
+            if (m_window[i] == state)
+            {
+                ++votes;
+                firstVoteNs = std::min(firstVoteNs, m_windowNs[i]);
+            }
+        }
+        if (votes < m_config.votes)
+        {
+            return false;
+        }
+
+        uint64_t heldNs = timestampNs > m_changeNs ? timestampNs - m_changeNs : 0;
+        if (state != CpState::STATE_F && heldNs < static_cast<uint64_t>(m_config.minDwellMs) * 1000000ULL)
+        {
+            return false;
+        }
+
+        m_state = state;
+        m_changeNs = std::max(firstVoteNs, m_changeNs);
+        ++m_stats.transitions;
+        return true;
+    }
+
+} // namespace Wallbox
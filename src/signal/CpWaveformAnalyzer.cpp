@@ -0,0 +1,115 @@
+#include "CpWaveformAnalyzer.h"
+#include <algorithm>
+
+namespace Wallbox
+{
+
+    CpMeasurement CpWaveformAnalyzer::analyze(const int32_t *millivolts, size_t count)
+    {
+        CpMeasurement result = {0, 0, 0, false, static_cast<uint32_t>(count)};
+        if (count == 0)
+        {
+            return result;
+        }
+
+        int32_t minMv = millivolts[0];
+        int32_t maxMv = millivolts[0];
+        for (size_t i = 0; i < count; ++i)
+        {
+            minMv = std::min(minMv, millivolts[i]);
+            maxMv = std::max(maxMv, millivolts[i]);
+        }
+
+        // Branch-free split at the midpoint: masks instead of conditionals
+        const int32_t threshold = minMv + (maxMv - minMv) / 2;
+        int64_t sumAll = 0;
+        int64_t sumHigh = 0;
+        int64_t highCount = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            int32_t sample = millivolts[i];
+            int32_t isHigh = sample > threshold;
+            sumAll += sample;
+            sumHigh += sample & -isHigh;
+            highCount += isHigh;
+        }
+
+        if (maxMv - minMv < MIN_PWM_SWING_MV)
+        {
+            // DC level (state A without PWM, E, F): one plateau
+            int32_t mean = static_cast<int32_t>(sumAll / static_cast<int64_t>(count));
+            result.highMv = mean;
+            result.lowMv = mean;
+            result.dutyPermille = mean > 0 ? 1000 : 0;
+            return result;
+        }
+
+        int64_t lowCount = static_cast<int64_t>(count) - highCount;
+        result.highMv = static_cast<int32_t>(sumHigh / highCount);
+        result.lowMv = static_cast<int32_t>((sumAll - sumHigh) / lowCount);
+        result.dutyPermille = static_cast<uint16_t>((highCount * 1000 + static_cast<int64_t>(count) / 2) /
+                                                    static_cast<int64_t>(count));
+        result.oscillating = true;
+        return result;
+    }
+
+    CpState CpWaveformAnalyzer::classify(const CpMeasurement &measurement)
+    {
+        if (measurement.samples == 0)
+        {
+            return CpState::UNKNOWN;
+        }
+
+        // During PWM the negative half must reach -12 V, else the vehicle diode is missing
+        if (measurement.oscillating && measurement.lowMv > -10000)
+        {
+            return CpState::STATE_F;
+        }
+
+        return stateForVoltage(measurement.highMv);
+    }
+
+    CpState CpWaveformAnalyzer::stateForVoltage(int32_t millivolts)
+    {
+        // IEC 61851-1 voltage thresholds (in mV)
+        if (millivolts > 11000)
+        {
+            return CpState::STATE_A; // 12V - No vehicle
+        }
+        else if (millivolts > 8000)
+        {
+            return CpState::STATE_B; // 9V - Vehicle connected, not ready
+        }
+        else if (millivolts > 5000)
+        {
+            return CpState::STATE_C; // 6V - Vehicle ready to charge
+        }
+        else if (millivolts > 2000)
+        {
+            return CpState::STATE_D; // 3V - Ventilation required
+        }
+        else if (millivolts > -2000)
+        {
+            return CpState::STATE_E; // 0V - No power
+        }
+        else if (millivolts < -10000)
+        {
+            return CpState::STATE_F; // -12V - Error
+        }
+        return CpState::UNKNOWN;
+    }
+
+    uint32_t CpWaveformAnalyzer::maxCurrentMilliamps(uint16_t dutyPermille)
+    {
+        if (dutyPermille >= 100 && dutyPermille <= 850)
+        {
+            return dutyPermille * 60; // duty[%] x 0.6 A
+        }
+        if (dutyPermille > 850 && dutyPermille <= 960)
+        {
+            return (dutyPermille - 640) * 250; // (duty[%] - 64) x 2.5 A
+        }
+        return 0;
+    }
+
+} // namespace Wallbox
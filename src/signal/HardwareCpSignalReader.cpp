@@ -1,4 +1,7 @@
 #include "HardwareCpSignalReader.h"
+#include "GpioEdgeWatcher.h"
+#include "Logger.h"
+#include <algorithm>
 #include <iostream>
 #include <chrono>
 #include <thread>
@@ -6,8 +9,25 @@
 namespace Wallbox
 {
 
-    HardwareCpSignalReader::HardwareCpSignalReader(std::shared_ptr<IGpioController> gpio, int cpPin)
-        : m_gpio(gpio), m_cpPin(cpPin), m_initialized(false), m_monitoring(false), m_currentState(CpState::UNKNOWN)
+    namespace
+    {
+        constexpr auto POLL_INTERVAL = std::chrono::milliseconds(100);
+        constexpr auto SETTLE_INTERVAL = std::chrono::milliseconds(10); ///< Resampling while a change is pending
+    } // namespace
+
+    HardwareCpSignalReader::HardwareCpSignalReader(std::shared_ptr<IGpioController> gpio, int cpPin,
+                                                   const CpFilterConfig &filter)
+        : m_gpio(gpio), m_cpPin(cpPin), m_initialized(false), m_monitoring(false), m_edgeDriven(false),
+          m_filter(filter), m_edgeSeen(false), m_lastChangeNs(0),
+          m_lastMeasurement{0, 0, 0, false, 0}, m_sampleClockNs(0)
+    {
+    }
+
+    HardwareCpSignalReader::HardwareCpSignalReader(std::unique_ptr<ICpSampleSource> adc,
+                                                   const CpFilterConfig &filter)
+        : m_cpPin(-1), m_initialized(false), m_monitoring(false), m_edgeDriven(false),
+          m_filter(filter), m_edgeSeen(false), m_lastChangeNs(0), m_adc(std::move(adc)),
+          m_lastMeasurement{0, 0, 0, false, 0}, m_sampleClockNs(0)
     {
     }
 
@@ -23,6 +43,32 @@ namespace Wallbox
             return true;
         }
 
+        if (m_adc)
+        {
+            if (!m_adc->open())
+            {
+                std::cerr << "[HardwareCpSignalReader] Failed to open CP ADC" << std::endl;
+                return false;
+            }
+
+            // Initial state from the first block, without waiting for confirmation
+            m_sampleClockNs = GpioEdgeWatcher::monotonicNowNs();
+            std::vector<int32_t> block(adcBlockSize());
+            int count = m_adc->readBlock(block.data(), block.size(), 200);
+            CpState initialState = CpState::UNKNOWN;
+            if (count > 0)
+            {
+                processBlock(block.data(), static_cast<size_t>(count));
+                initialState = CpWaveformAnalyzer::classify(lastMeasurement());
+            }
+            m_filter.reset(initialState, m_sampleClockNs);
+
+            m_initialized = true;
+            std::cout << "[HardwareCpSignalReader] Initialized on ADC (" << m_adc->sampleRateHz()
+                      << " Hz), initial state: " << getCpStateString(initialState) << std::endl;
+            return true;
+        }
+
         if (!m_gpio || !m_gpio->isInitialized())
         {
             std::cerr << "[HardwareCpSignalReader] GPIO controller not initialized" << std::endl;
@@ -37,15 +83,20 @@ namespace Wallbox
         }
 
         m_initialized = true;
-        m_currentState = readCpState();
+        CpState initialState = readCpState();
+        m_filter.reset(initialState, GpioEdgeWatcher::monotonicNowNs());
         std::cout << "[HardwareCpSignalReader] Initialized on pin " << m_cpPin
-                  << ", initial state: " << getCpStateString(m_currentState) << std::endl;
+                  << ", initial state: " << getCpStateString(initialState) << std::endl;
         return true;
     }
 
     void HardwareCpSignalReader::shutdown()
     {
         stopMonitoring();
+        if (m_adc)
+        {
+            m_adc->close();
+        }
         m_initialized = false;
     }
 
@@ -56,6 +107,13 @@ namespace Wallbox
             return CpState::UNKNOWN;
         }
 
+        if (m_adc || m_monitoring.load())
+        {
+            // The monitor thread owns the sampling; report its filtered state
+            std::lock_guard<std::mutex> lock(m_stateMutex);
+            return m_filter.state();
+        }
+
         // Read voltage from CP pin
         int voltage = readVoltage();
         return voltageToState(voltage);
@@ -65,8 +123,11 @@ namespace Wallbox
     {
         // In a real implementation, this would read from an ADC
         // For now, we simulate by reading digital pin state and mapping
-        PinValue value = m_gpio->digitalRead(m_cpPin);
+        return levelToVoltage(m_gpio->digitalRead(m_cpPin));
+    }
 
+    int HardwareCpSignalReader::levelToVoltage(PinValue value)
+    {
         // Simulate voltage based on digital reading
         // In real hardware, use ADC to read actual voltage
         if (value == PinValue::HIGH)
@@ -81,35 +142,7 @@ namespace Wallbox
 
     CpState HardwareCpSignalReader::voltageToState(int voltage)
     {
-        // IEC 61851-1 voltage thresholds (in mV)
-        if (voltage > 11000)
-        {
-            return CpState::STATE_A; // 12V - No vehicle
-        }
-        else if (voltage > 8000)
-        {
-            return CpState::STATE_B; // 9V - Vehicle connected, not ready
-        }
-        else if (voltage > 5000)
-        {
-            return CpState::STATE_C; // 6V - Vehicle ready to charge
-        }
-        else if (voltage > 2000)
-        {
-            return CpState::STATE_D; // 3V - Ventilation required
-        }
-        else if (voltage > 500)
-        {
-            return CpState::STATE_E; // 0V - No power
-        }
-        else if (voltage < -10000)
-        {
-            return CpState::STATE_F; // -12V - Error
-        }
-        else
-        {
-            return CpState::UNKNOWN;
-        }
+        return CpWaveformAnalyzer::stateForVoltage(voltage);
     }
 
     std::string HardwareCpSignalReader::getCpStateString(CpState state) const
@@ -153,8 +186,24 @@ namespace Wallbox
         }
 
         m_monitoring.store(true);
+
+        if (m_adc)
+        {
+            m_monitorThread = std::thread(&HardwareCpSignalReader::adcLoop, this);
+            std::cout << "[HardwareCpSignalReader] Started monitoring CP signal (ADC)" << std::endl;
+            return;
+        }
+
+        m_edgeDriven = m_gpio->watchPin(m_cpPin, PinEdge::BOTH, [this](const PinEvent &event)
+                                        {
+            addVoltageSample(levelToVoltage(event.value), event.timestampNs);
+            wakeMonitor(); });
+
+        // With edges the thread only runs until the filter has settled; the
+        // first pass also catches a change between initialize() and arming
         m_monitorThread = std::thread(&HardwareCpSignalReader::monitorLoop, this);
-        std::cout << "[HardwareCpSignalReader] Started monitoring CP signal" << std::endl;
+        std::cout << "[HardwareCpSignalReader] Started monitoring CP signal ("
+                  << (m_edgeDriven ? "edge events" : "polling") << ")" << std::endl;
     }
 
     void HardwareCpSignalReader::stopMonitoring()
@@ -165,31 +214,178 @@ namespace Wallbox
         }
 
         m_monitoring.store(false);
+        if (m_edgeDriven)
+        {
+            m_gpio->unwatchPin(m_cpPin);
+        }
+        wakeMonitor();
         if (m_monitorThread.joinable())
         {
             m_monitorThread.join();
         }
-        std::cout << "[HardwareCpSignalReader] Stopped monitoring CP signal" << std::endl;
+        m_edgeDriven = false;
+
+        CpFilterStats stats = getFilterStats();
+        std::cout << "[HardwareCpSignalReader] Stopped monitoring CP signal (" << stats.transitions
+                  << " transitions, " << stats.suppressed() << " suppressed)" << std::endl;
     }
 
     void HardwareCpSignalReader::monitorLoop()
     {
         while (m_monitoring.load())
         {
-            CpState newState = readCpState();
-            if (newState != m_currentState && newState != CpState::UNKNOWN)
+            addVoltageSample(readVoltage(), GpioEdgeWatcher::monotonicNowNs());
+
+            bool settled;
             {
-                CpState oldState = m_currentState;
-                m_currentState = newState;
-                std::cout << "[HardwareCpSignalReader] CP state changed: "
-                          << getCpStateString(oldState) << " -> "
-                          << getCpStateString(newState) << std::endl;
-                notifyStateChange(oldState, newState);
+                std::lock_guard<std::mutex> lock(m_stateMutex);
+                settled = m_filter.settled();
             }
 
-            // Poll every 100ms
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            // Resample quickly while a change is pending, else wait for an edge or poll
+            std::unique_lock<std::mutex> lock(m_wakeupMutex);
+            auto woken = [this]
+            { return m_edgeSeen || !m_monitoring.load(); };
+            if (!settled)
+            {
+                m_wakeup.wait_for(lock, SETTLE_INTERVAL, woken);
+            }
+            else if (m_edgeDriven)
+            {
+                m_wakeup.wait(lock, woken);
+            }
+            else
+            {
+                m_wakeup.wait_for(lock, POLL_INTERVAL, woken);
+            }
+            m_edgeSeen = false;
+        }
+    }
+
+    void HardwareCpSignalReader::wakeMonitor()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_wakeupMutex);
+            m_edgeSeen = true;
+        }
+        m_wakeup.notify_one();
+    }
+
+    void HardwareCpSignalReader::adcLoop()
+    {
+        std::vector<int32_t> block(adcBlockSize());
+        while (m_monitoring.load())
+        {
+            // Short timeout so stopMonitoring() is noticed promptly
+            int count = m_adc->readBlock(block.data(), block.size(), 100);
+            if (count < 0)
+            {
+                WALLBOX_LOG_ERROR("HardwareCpSignalReader") << "CP ADC stopped delivering samples";
+                break;
+            }
+            if (count > 0)
+            {
+                processBlock(block.data(), static_cast<size_t>(count));
+            }
+        }
+    }
+
+    void HardwareCpSignalReader::processBlock(const int32_t *millivolts, size_t count)
+    {
+        CpMeasurement measurement = CpWaveformAnalyzer::analyze(millivolts, count);
+        {
+            std::lock_guard<std::mutex> lock(m_measurementMutex);
+            m_lastMeasurement = measurement;
+        }
+
+        // Blocks are dated by the sample clock, so replayed captures filter like live input
+        uint64_t timestampNs = m_sampleClockNs;
+        m_sampleClockNs += count * 1000000000ULL / m_adc->sampleRateHz();
+        if (!m_initialized)
+        {
+            return;
+        }
+
+        // A diode fault has no voltage band to apply hysteresis to
+        if (measurement.oscillating && CpWaveformAnalyzer::classify(measurement) == CpState::STATE_F)
+        {
+            addStateSample(CpState::STATE_F, timestampNs);
+        }
+        else
+        {
+            addVoltageSample(measurement.highMv, timestampNs);
+        }
+    }
+
+    size_t HardwareCpSignalReader::adcBlockSize() const
+    {
+        return std::max<size_t>(64, m_adc->sampleRateHz() / 100);
+    }
+
+    CpMeasurement HardwareCpSignalReader::lastMeasurement() const
+    {
+        std::lock_guard<std::mutex> lock(m_measurementMutex);
+        return m_lastMeasurement;
+    }
+
+    CpFilterStats HardwareCpSignalReader::getFilterStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        return m_filter.stats();
+    }
+
+    void HardwareCpSignalReader::addVoltageSample(int32_t millivolts, uint64_t timestampNs)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_stateMutex);
+            CpState oldState = m_filter.state();
+            if (!m_filter.addVoltage(millivolts, timestampNs))
+            {
+                return;
+            }
+            recordChange(oldState);
+        }
+        publishChanges();
+    }
+
+    void HardwareCpSignalReader::addStateSample(CpState state, uint64_t timestampNs)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_stateMutex);
+            CpState oldState = m_filter.state();
+            if (!m_filter.addState(state, timestampNs))
+            {
+                return;
+            }
+            recordChange(oldState);
+        }
+        publishChanges();
+    }
+
+    void HardwareCpSignalReader::recordChange(CpState oldState)
+    {
+        m_lastChangeNs.store(m_filter.changeTimestampNs());
+        m_pendingChanges.emplace_back(oldState, m_filter.state());
+    }
+
+    void HardwareCpSignalReader::publishChanges()
+    {
+        // Whoever gets here first notifies every change queued so far, so
+        // listeners see them in filter order even when the edge and monitor
+        // threads both produce one
+        std::lock_guard<std::mutex> notify(m_notifyMutex);
+        {
+            std::lock_guard<std::mutex> lock(m_stateMutex);
+            m_notifying.swap(m_pendingChanges);
+        }
+
+        for (const auto &change : m_notifying)
+        {
+            WALLBOX_LOG_INFO("HardwareCpSignalReader") << "CP state changed: " << getCpStateString(change.first)
+                                                       << " -> " << getCpStateString(change.second);
+            notifyStateChange(change.first, change.second);
         }
+        m_notifying.clear();
     }
 
     void HardwareCpSignalReader::notifyStateChange(CpState oldState, CpState newState)
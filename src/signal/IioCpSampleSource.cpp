@@ -0,0 +1,329 @@
+#include "IioCpSampleSource.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cerrno>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace Wallbox
+{
+
+    namespace
+    {
+        constexpr const char *REPLAY_MAGIC = "IIO";
+        constexpr size_t MAX_REPLAY_HEADER = 256;
+
+        bool readAttribute(const std::string &path, std::string &value)
+        {
+            std::ifstream file(path);
+            if (!file.is_open())
+            {
+                return false;
+            }
+            std::getline(file, value);
+            return true;
+        }
+
+        bool writeAttribute(const std::string &path, const std::string &value)
+        {
+            std::ofstream file(path);
+            if (!file.is_open())
+            {
+                return false;
+            }
+            file << value;
+            file.close();
+            return !file.fail();
+        }
+
+        template <typename Storage>
+        Storage loadScan(const uint8_t *scan, bool swap);
+
+        template <>
+        uint8_t loadScan<uint8_t>(const uint8_t *scan, bool)
+        {
+            return *scan;
+        }
+
+        template <>
+        uint16_t loadScan<uint16_t>(const uint8_t *scan, bool swap)
+        {
+            uint16_t value;
+            std::memcpy(&value, scan, sizeof(value));
+            return swap ? __builtin_bswap16(value) : value;
+        }
+
+        template <>
+        uint32_t loadScan<uint32_t>(const uint8_t *scan, bool swap)
+        {
+            uint32_t value;
+            std::memcpy(&value, scan, sizeof(value));
+            return swap ? __builtin_bswap32(value) : value;
+        }
+
+        template <typename Storage>
+        void decodeScans(const uint8_t *raw, size_t count, const IioScanFormat &format,
+                         float millivoltsPerLsb, float offsetMv, int32_t *millivolts)
+        {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            const bool swap = !format.bigEndian;
+#else
+            const bool swap = format.bigEndian;
+#endif
+            const uint32_t mask = format.realBits >= 32 ? 0xFFFFFFFFu : ((1u << format.realBits) - 1);
+            const unsigned signShift = 32 - format.realBits;
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                uint32_t bits = (static_cast<uint32_t>(loadScan<Storage>(raw + i * sizeof(Storage), swap)) >> format.shift) & mask;
+                int32_t value = format.isSigned ? static_cast<int32_t>(bits << signShift) >> signShift
+                                                : static_cast<int32_t>(bits);
+                millivolts[i] = static_cast<int32_t>(static_cast<float>(value) * millivoltsPerLsb + offsetMv);
+            }
+        }
+    } // namespace
+
+    bool IioScanFormat::parse(const std::string &text, IioScanFormat &format)
+    {
+        char endian[3] = {0, 0, 0};
+        char sign = 0;
+        unsigned realBits = 0;
+        unsigned storageBits = 0;
+        unsigned shift = 0;
+
+        if (std::sscanf(text.c_str(), "%2[bl]e:%c%u/%u>>%u", endian, &sign, &realBits, &storageBits, &shift) != 5)
+        {
+            return false;
+        }
+        if ((sign != 's' && sign != 'u') || realBits == 0 || realBits > storageBits ||
+            (storageBits != 8 && storageBits != 16 && storageBits != 32) || shift + realBits > storageBits)
+        {
+            return false;
+        }
+
+        format.bigEndian = endian[0] == 'b';
+        format.isSigned = sign == 's';
+        format.realBits = realBits;
+        format.storageBits = storageBits;
+        format.shift = shift;
+        return true;
+    }
+
+    std::string IioScanFormat::toString() const
+    {
+        std::ostringstream text;
+        text << (bigEndian ? "be:" : "le:") << (isSigned ? 's' : 'u')
+             << realBits << '/' << storageBits << ">>" << shift;
+        return text.str();
+    }
+
+    IioCpSampleSource::IioCpSampleSource(const IioCpConfig &config)
+        : m_config(config),
+          m_format{false, false, 12, 16, 0},
+          m_scaleMv(1.0),
+          m_sampleRateHz(config.sampleRateHz),
+          m_fd(-1),
+          m_bufferEnabled(false)
+    {
+    }
+
+    IioCpSampleSource::~IioCpSampleSource()
+    {
+        close();
+    }
+
+    bool IioCpSampleSource::open()
+    {
+        if (m_fd >= 0)
+        {
+            return true;
+        }
+        return m_config.replayFile.empty() ? openDevice() : openReplay();
+    }
+
+    void IioCpSampleSource::close()
+    {
+        if (m_fd >= 0)
+        {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+        if (m_bufferEnabled)
+        {
+            writeAttribute(devicePath("buffer/enable"), "0");
+            m_bufferEnabled = false;
+        }
+    }
+
+    std::string IioCpSampleSource::devicePath(const std::string &attribute) const
+    {
+        return m_config.sysfsRoot + "/" + m_config.device + "/" + attribute;
+    }
+
+    bool IioCpSampleSource::openDevice()
+    {
+        const std::string element = "scan_elements/in_" + m_config.channel;
+
+        // The buffer must be off while scan elements and its length change
+        writeAttribute(devicePath("buffer/enable"), "0");
+
+        if (!writeAttribute(devicePath(element + "_en"), "1"))
+        {
+            std::cerr << "[IIO CP] Cannot enable " << devicePath(element + "_en") << std::endl;
+            return false;
+        }
+
+        std::string type;
+        if (!readAttribute(devicePath(element + "_type"), type) || !IioScanFormat::parse(type, m_format))
+        {
+            std::cerr << "[IIO CP] Unsupported scan format '" << type << "' for " << m_config.channel << std::endl;
+            return false;
+        }
+
+        // Scale is per channel or shared by all channels of the type (in_voltage_scale)
+        std::string scale;
+        std::string channelType = m_config.channel.substr(0, m_config.channel.find_first_of("0123456789"));
+        if (!readAttribute(devicePath("in_" + m_config.channel + "_scale"), scale) &&
+            !readAttribute(devicePath("in_" + channelType + "_scale"), scale))
+        {
+            std::cerr << "[IIO CP] No scale attribute for " << m_config.channel << std::endl;
+            return false;
+        }
+        m_scaleMv = std::strtod(scale.c_str(), nullptr);
+
+        if (!writeAttribute(devicePath("sampling_frequency"), std::to_string(m_config.sampleRateHz)))
+        {
+            std::cout << "[IIO CP] Cannot set sampling_frequency, using the device default" << std::endl;
+        }
+        std::string rate;
+        if (readAttribute(devicePath("sampling_frequency"), rate) && std::strtoul(rate.c_str(), nullptr, 10) > 0)
+        {
+            m_sampleRateHz = static_cast<unsigned>(std::strtoul(rate.c_str(), nullptr, 10));
+        }
+
+        // Room for ~200 ms of samples so a late reader does not lose data
+        writeAttribute(devicePath("buffer/length"), std::to_string(std::max(1024u, m_sampleRateHz / 5)));
+        if (!writeAttribute(devicePath("buffer/enable"), "1"))
+        {
+            std::cerr << "[IIO CP] Cannot enable the IIO buffer of " << m_config.device << std::endl;
+            return false;
+        }
+        m_bufferEnabled = true;
+
+        std::string charDevice = m_config.devRoot + "/" + m_config.device;
+        m_fd = ::open(charDevice.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (m_fd < 0)
+        {
+            std::cerr << "[IIO CP] Cannot open " << charDevice << ": " << strerror(errno) << std::endl;
+            close();
+            return false;
+        }
+
+        std::cout << "[IIO CP] Sampling " << m_config.device << "/" << m_config.channel << " at "
+                  << m_sampleRateHz << " Hz (" << m_format.toString() << ", " << m_scaleMv << " mV/LSB)" << std::endl;
+        return true;
+    }
+
+    bool IioCpSampleSource::openReplay()
+    {
+        m_fd = ::open(m_config.replayFile.c_str(), O_RDONLY | O_CLOEXEC);
+        if (m_fd < 0)
+        {
+            std::cerr << "[IIO CP] Cannot open replay file " << m_config.replayFile << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        char header[MAX_REPLAY_HEADER];
+        ssize_t bytes = pread(m_fd, header, sizeof(header) - 1, 0);
+        char *newline = bytes > 0 ? static_cast<char *>(std::memchr(header, '\n', static_cast<size_t>(bytes))) : nullptr;
+        if (newline == nullptr)
+        {
+            std::cerr << "[IIO CP] Replay file has no header line" << std::endl;
+            close();
+            return false;
+        }
+        *newline = '\0';
+
+        char magic[8] = {0};
+        char format[32] = {0};
+        double scale = 0.0;
+        unsigned rate = 0;
+        if (std::sscanf(header, "%7s %31s %lf %u", magic, format, &scale, &rate) != 4 ||
+            std::strcmp(magic, REPLAY_MAGIC) != 0 || !IioScanFormat::parse(format, m_format) || rate == 0)
+        {
+            std::cerr << "[IIO CP] Invalid replay header: " << header << std::endl;
+            close();
+            return false;
+        }
+
+        m_scaleMv = scale;
+        m_sampleRateHz = rate;
+        lseek(m_fd, newline - header + 1, SEEK_SET);
+
+        std::cout << "[IIO CP] Replaying " << m_config.replayFile << " (" << m_format.toString()
+                  << ", " << m_sampleRateHz << " Hz)" << std::endl;
+        return true;
+    }
+
+    int IioCpSampleSource::readBlock(int32_t *millivolts, size_t maxSamples, int timeoutMs)
+    {
+        if (m_fd < 0)
+        {
+            return -1;
+        }
+
+        if (m_config.replayFile.empty())
+        {
+            pollfd pfd = {m_fd, POLLIN, 0};
+            int ready = poll(&pfd, 1, timeoutMs);
+            if (ready <= 0)
+            {
+                return (ready == 0 || errno == EINTR) ? 0 : -1;
+            }
+        }
+
+        const size_t scanBytes = m_format.storageBits / 8;
+        m_raw.resize(maxSamples * scanBytes);
+        ssize_t bytes = read(m_fd, m_raw.data(), m_raw.size());
+        if (bytes < 0)
+        {
+            return errno == EAGAIN ? 0 : -1;
+        }
+        if (bytes == 0)
+        {
+            return m_config.replayFile.empty() ? 0 : -1;
+        }
+
+        size_t count = static_cast<size_t>(bytes) / scanBytes;
+        decode(m_raw.data(), count, millivolts);
+        return static_cast<int>(count);
+    }
+
+    void IioCpSampleSource::decode(const uint8_t *raw, size_t count, int32_t *millivolts) const
+    {
+        // cp = (adc - offset) * gain, folded into one multiply-add per sample
+        const float gain = static_cast<float>(m_config.frontEndGainX1000) / 1000.0f;
+        const float millivoltsPerLsb = static_cast<float>(m_scaleMv) * gain;
+        const float offsetMv = -static_cast<float>(m_config.frontEndOffsetMv) * gain;
+
+        switch (m_format.storageBits)
+        {
+        case 8:
+            decodeScans<uint8_t>(raw, count, m_format, millivoltsPerLsb, offsetMv, millivolts);
+            break;
+        case 16:
+            decodeScans<uint16_t>(raw, count, m_format, millivoltsPerLsb, offsetMv, millivolts);
+            break;
+        default:
+            decodeScans<uint32_t>(raw, count, m_format, millivoltsPerLsb, offsetMv, millivolts);
+            break;
+        }
+    }
+
+} // namespace Wallbox
@@ -5,7 +5,6 @@
 #include <cstring>
 #include <csignal>
 #include <string>
-#include <iomanip>
 #include <sstream>
 #include <cstdlib>
 
@@ -14,38 +13,17 @@
 #include <unistd.h>
 
 #include "IsoStackCtrlProtocol.h"
+#include "Logger.h"
 
 using namespace Iso15118;
 
-// Log file
-static std::ofstream g_logFile;
-
-// Helper function to get timestamp
-std::string get_timestamp()
-{
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                  now.time_since_epoch()) %
-              1000;
-
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
-    ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
-    return ss.str();
-}
+// Log file sink
+static Wallbox::LogSinks g_logSink = 0;
 
 // Unified logging function - writes only to file
 void log_msg(const std::string &level, const std::string &message)
 {
-    std::string log_line = "[" + get_timestamp() + "] [" + level + "] " + message;
-
-    // Write to log file only
-    if (g_logFile.is_open())
-    {
-        g_logFile << log_line << std::endl;
-        g_logFile.flush();
-    }
+    Wallbox::LogLine(level, g_logSink) << message;
 }
 
 // ---------- Konfiguration ----------
@@ -470,8 +448,8 @@ void process_command(const std::string &cmd)
 int main()
 {
     // Open log file
-    g_logFile.open("/tmp/wallbox_simulator.log", std::ios::out | std::ios::app);
-    if (!g_logFile.is_open())
+    g_logSink = Wallbox::Logger::instance().openFile("/tmp/wallbox_simulator.log");
+    if (!g_logSink)
     {
         std::cerr << "Warning: Could not open log file /tmp/wallbox_simulator.log" << std::endl;
     }
@@ -543,10 +521,7 @@ int main()
     std::cout << "\nSimulator stopped.\n";
 
     // Close log file
-    if (g_logFile.is_open())
-    {
-        g_logFile.close();
-    }
+    Wallbox::Logger::instance().closeFile(g_logSink);
 
     return 0;
 }
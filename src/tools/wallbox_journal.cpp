@@ -0,0 +1,193 @@
+/**
+ * @file wallbox_journal.cpp
+ * @brief Decode a binary event journal (EventJournal) to text or JSON lines
+ *
+ * Usage: wallbox_journal [--json] [--tail N] <journal file>
+ */
+
+#include "EventJournal.h"
+#include "JsonWriter.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace Wallbox;
+
+namespace
+{
+    // Mirrors ChargingState and CpState; the journal stores their numeric values
+    const char *const CHARGING_STATES[] = {"OFF", "IDLE", "CONNECTED", "IDENTIFICATION", "READY",
+                                           "CHARGING", "STOP", "FINISHED", "ERROR"};
+    const char *const CP_STATES[] = {"A", "B", "C", "D", "E", "F", "UNKNOWN"};
+
+    template <size_t N>
+    std::string name(const char *const (&names)[N], uint32_t value)
+    {
+        return value < N ? names[value] : std::to_string(value);
+    }
+
+    std::string formatTime(uint64_t timestampNs)
+    {
+        time_t seconds = static_cast<time_t>(timestampNs / 1000000000ULL);
+        struct tm local;
+        localtime_r(&seconds, &local);
+        char date[32];
+        strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", &local);
+        char text[48];
+        std::snprintf(text, sizeof(text), "%s.%06u", date, static_cast<unsigned>((timestampNs / 1000) % 1000000));
+        return text;
+    }
+
+    std::string hex(const JournalRecord &record)
+    {
+        static const char DIGITS[] = "0123456789abcdef";
+        std::string text;
+        for (uint16_t i = 0; i < record.length; ++i)
+        {
+            if (i > 0)
+            {
+                text += ' ';
+            }
+            text += DIGITS[record.data[i] >> 4];
+            text += DIGITS[record.data[i] & 0x0f];
+        }
+        return text;
+    }
+
+    std::string reason(const JournalRecord &record)
+    {
+        return std::string(reinterpret_cast<const char *>(record.data), record.length);
+    }
+
+    void printText(const JournalRecord &record)
+    {
+        std::cout << formatTime(record.timestampNs) << " #" << record.sequence
+                  << " [" << record.thread << "] " << EventJournal::eventName(record.type) << ' ';
+
+        switch (record.type)
+        {
+        case JournalEvent::STATE_TRANSITION:
+            std::cout << name(CHARGING_STATES, record.arg0) << " -> " << name(CHARGING_STATES, record.arg1);
+            if (record.length > 0)
+            {
+                std::cout << " (" << reason(record) << ")";
+            }
+            break;
+        case JournalEvent::RELAY:
+            std::cout << (record.arg0 ? "ON" : "OFF") << (record.arg1 ? "" : " (unchanged)");
+            break;
+        case JournalEvent::CP_CHANGE:
+            std::cout << name(CP_STATES, record.arg0) << " -> " << name(CP_STATES, record.arg1);
+            break;
+        case JournalEvent::UDP_RX:
+        case JournalEvent::UDP_TX:
+            std::cout << record.arg0 << " bytes: " << hex(record)
+                      << (record.arg0 > record.length ? " ..." : "");
+            break;
+        default:
+            std::cout << record.arg0 << ' ' << record.arg1;
+            break;
+        }
+        std::cout << '\n';
+    }
+
+    void printJson(const JournalRecord &record)
+    {
+        std::string line;
+        JsonWriter json(line);
+        json.beginObject()
+            .field("seq", static_cast<unsigned long long>(record.sequence))
+            .field("timeNs", static_cast<unsigned long long>(record.timestampNs))
+            .field("time", formatTime(record.timestampNs))
+            .field("thread", record.thread)
+            .field("type", EventJournal::eventName(record.type));
+
+        switch (record.type)
+        {
+        case JournalEvent::STATE_TRANSITION:
+            json.field("from", name(CHARGING_STATES, record.arg0))
+                .field("to", name(CHARGING_STATES, record.arg1))
+                .field("reason", reason(record));
+            break;
+        case JournalEvent::RELAY:
+            json.field("on", record.arg0 != 0).field("changed", record.arg1 != 0);
+            break;
+        case JournalEvent::CP_CHANGE:
+            json.field("from", name(CP_STATES, record.arg0)).field("to", name(CP_STATES, record.arg1));
+            break;
+        case JournalEvent::UDP_RX:
+        case JournalEvent::UDP_TX:
+            json.field("size", record.arg0).field("data", hex(record));
+            break;
+        default:
+            json.field("arg0", record.arg0).field("arg1", record.arg1);
+            break;
+        }
+        json.endObject();
+        std::cout << line << '\n';
+    }
+
+    int usage()
+    {
+        std::cerr << "Usage: wallbox_journal [--json] [--tail N] <journal file>" << std::endl;
+        return 2;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    bool json = false;
+    size_t tail = 0;
+    std::string path;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--json")
+        {
+            json = true;
+        }
+        else if (arg == "--tail" && i + 1 < argc)
+        {
+            tail = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (!arg.empty() && arg[0] != '-' && path.empty())
+        {
+            path = arg;
+        }
+        else
+        {
+            return usage();
+        }
+    }
+    if (path.empty())
+    {
+        return usage();
+    }
+
+    std::vector<JournalRecord> records;
+    std::string error;
+    if (!EventJournal::readFile(path, records, error))
+    {
+        std::cerr << path << ": " << error << std::endl;
+        return 1;
+    }
+
+    size_t first = tail > 0 && tail < records.size() ? records.size() - tail : 0;
+    for (size_t i = first; i < records.size(); ++i)
+    {
+        if (json)
+        {
+            printJson(records[i]);
+        }
+        else
+        {
+            printText(records[i]);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include <benchmark/benchmark.h>
+#include "EventLoop.h"
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+using namespace Wallbox;
+
+/**
+ * @brief Controller command queue: lock-free MPSC post against mutex + vector
+ *
+ * LegacyTaskQueue is a copy of the previous EventLoop task hand-off (mutex
+ * protected vector, eventfd write on every post), with its own consumer
+ * thread, kept here only as a baseline.
+ *
+ * - Post: cost per post() for 1..4 producer threads while the consumer
+ *   drains concurrently (contention on the producer side)
+ * - RoundTrip: post a command and wait for its result through a future,
+ *   i.e. what an API handler pays for WallboxController::startCharging()
+ */
+namespace
+{
+    class LegacyTaskQueue
+    {
+    public:
+        LegacyTaskQueue()
+            : m_wakeFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+              m_running(true),
+              m_consumer([this]()
+                         { consume(); })
+        {
+        }
+
+        ~LegacyTaskQueue()
+        {
+            m_running = false;
+            wake();
+            m_consumer.join();
+            close(m_wakeFd);
+        }
+
+        void post(std::function<void()> task)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_taskMutex);
+                m_tasks.push_back(std::move(task));
+            }
+            wake();
+        }
+
+    private:
+        int m_wakeFd;
+        std::atomic<bool> m_running;
+        std::mutex m_taskMutex;
+        std::vector<std::function<void()>> m_tasks;
+        std::thread m_consumer;
+
+        void wake()
+        {
+            uint64_t one = 1;
+            ssize_t result = write(m_wakeFd, &one, sizeof(one));
+            (void)result;
+        }
+
+        void consume()
+        {
+            pollfd pfd = {m_wakeFd, POLLIN, 0};
+            while (m_running.load())
+            {
+                poll(&pfd, 1, -1);
+                uint64_t value;
+                ssize_t result = read(m_wakeFd, &value, sizeof(value));
+                (void)result;
+
+                std::vector<std::function<void()>> tasks;
+                {
+                    std::lock_guard<std::mutex> lock(m_taskMutex);
+                    tasks.swap(m_tasks);
+                }
+                for (auto &task : tasks)
+                {
+                    task();
+                }
+            }
+        }
+    };
+
+    /**
+     * @brief EventLoop running on a background thread for the whole benchmark run
+     */
+    struct RunningLoop
+    {
+        EventLoop loop;
+        std::thread thread;
+
+        RunningLoop()
+        {
+            loop.open();
+            thread = std::thread([this]()
+                                 { loop.run(); });
+        }
+
+        ~RunningLoop()
+        {
+            loop.stop();
+            thread.join();
+        }
+    };
+
+    RunningLoop &runningLoop()
+    {
+        static RunningLoop instance;
+        return instance;
+    }
+
+    LegacyTaskQueue &legacyQueue()
+    {
+        static LegacyTaskQueue instance;
+        return instance;
+    }
+
+    std::atomic<uint64_t> g_executed(0);
+} // namespace
+
+static void BM_PostMpsc(benchmark::State &state)
+{
+    EventLoop &loop = runningLoop().loop;
+    for (auto _ : state)
+    {
+        loop.post([]()
+                  { g_executed.fetch_add(1, std::memory_order_relaxed); });
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PostMpsc)->ThreadRange(1, 4)->UseRealTime();
+
+static void BM_PostMutexVector(benchmark::State &state)
+{
+    LegacyTaskQueue &queue = legacyQueue();
+    for (auto _ : state)
+    {
+        queue.post([]()
+                   { g_executed.fetch_add(1, std::memory_order_relaxed); });
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PostMutexVector)->ThreadRange(1, 4)->UseRealTime();
+
+static void BM_CommandRoundTrip(benchmark::State &state)
+{
+    EventLoop &loop = runningLoop().loop;
+    for (auto _ : state)
+    {
+        auto promise = std::make_shared<std::promise<bool>>();
+        std::future<bool> result = promise->get_future();
+        loop.post([promise]()
+                  { promise->set_value(true); });
+        benchmark::DoNotOptimize(result.get());
+    }
+}
+BENCHMARK(BM_CommandRoundTrip)->UseRealTime();
@@ -0,0 +1,109 @@
+#include <benchmark/benchmark.h>
+#include "CpWaveformAnalyzer.h"
+#include "CpStateFilter.h"
+#include "IioCpSampleSource.h"
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Wallbox;
+
+/**
+ * @brief CP ADC pipeline cost per block
+ *
+ * Blocks are 10 ms of 1 kHz PWM at the given sample rate (20 kHz = 200
+ * samples, the default). Decode converts raw 12-bit scans to CP
+ * millivolts; analyze measures plateaus and duty cycle. The filter
+ * benchmark replays the noisy plug-in trace from tests/data (one sample
+ * per block) and reports how many transitions it suppressed.
+ */
+namespace
+{
+    std::vector<int32_t> pwmMillivolts(size_t count)
+    {
+        std::vector<int32_t> samples(count);
+        size_t period = count / 10;
+        for (size_t i = 0; i < count; ++i)
+        {
+            samples[i] = (i % period) < period / 4 ? 6000 : -12000;
+        }
+        return samples;
+    }
+
+    std::vector<std::pair<uint64_t, int32_t>> loadTrace(const std::string &name)
+    {
+        std::vector<std::pair<uint64_t, int32_t>> samples;
+        std::ifstream file(std::string(WALLBOX_TEST_DATA_DIR) + "/" + name);
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (!line.empty() && line[0] != '#')
+            {
+                uint64_t ms = 0;
+                int32_t mv = 0;
+                std::istringstream(line) >> ms >> mv;
+                samples.emplace_back(ms * 1000000ULL, mv);
+            }
+        }
+        return samples;
+    }
+} // namespace
+
+static void BM_CpAnalyze(benchmark::State &state)
+{
+    std::vector<int32_t> samples = pwmMillivolts(static_cast<size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        CpMeasurement measurement = CpWaveformAnalyzer::analyze(samples.data(), samples.size());
+        benchmark::DoNotOptimize(measurement);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CpAnalyze)->Arg(200)->Arg(2000);
+
+static void BM_IioDecode(benchmark::State &state)
+{
+    size_t count = static_cast<size_t>(state.range(0));
+    std::vector<uint16_t> raw(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        raw[i] = static_cast<uint16_t>((i * 37) & 0x0FFF);
+    }
+    std::vector<int32_t> millivolts(count);
+    IioCpSampleSource source{IioCpConfig()};
+
+    for (auto _ : state)
+    {
+        source.decode(reinterpret_cast<const uint8_t *>(raw.data()), count, millivolts.data());
+        benchmark::DoNotOptimize(millivolts.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_IioDecode)->Arg(200)->Arg(2000);
+
+static void BM_CpFilterTrace(benchmark::State &state)
+{
+    auto trace = loadTrace("cp_plugin_noisy.trace");
+    if (trace.empty())
+    {
+        state.SkipWithError("trace not found");
+        return;
+    }
+
+    CpStateFilter filter;
+    for (auto _ : state)
+    {
+        filter.reset(CpState::STATE_A, 0);
+        for (const auto &sample : trace)
+        {
+            benchmark::DoNotOptimize(filter.addVoltage(sample.second, sample.first));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(trace.size()));
+    state.counters["transitions"] = static_cast<double>(filter.stats().transitions) / state.iterations();
+    state.counters["suppressed"] = static_cast<double>(filter.stats().suppressed()) / state.iterations();
+}
+BENCHMARK(BM_CpFilterTrace);
@@ -0,0 +1,185 @@
+#include <benchmark/benchmark.h>
+#include "BananaPiGpioController.h"
+#include "MmioGpioController.h"
+#include "StubGpioController.h"
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace Wallbox;
+
+/**
+ * @brief sysfs GPIO access against the open-per-call implementation it replaced
+ *
+ * Runs on a stub sysfs tree (gpioN/{direction,value} as regular files in a
+ * temporary directory), so it measures the user-space and VFS cost only;
+ * on real hardware the driver adds the same constant to both sides.
+ * legacySetValue()/legacyGetValue() are copies of the previous
+ * BananaPiGpioController::setValue()/getValue(), kept only as a baseline.
+ * The MMIO variant writes to an anonymous mapping standing in for the
+ * register block, i.e. the cost without the bus access. The stub variant
+ * is the in-memory StubGpioController used in development and simulator
+ * mode (debug log line compiled in but filtered at runtime).
+ */
+namespace
+{
+    constexpr int LED_PIN = 17;
+
+    class StubSysfsTree
+    {
+    public:
+        StubSysfsTree()
+        {
+            char pattern[] = "/tmp/wallbox_gpio_XXXXXX";
+            const char *dir = mkdtemp(pattern);
+            m_root = dir ? dir : "";
+            std::ofstream(m_root + "/export");
+            std::ofstream(m_root + "/unexport");
+            addPin(LED_PIN);
+        }
+
+        ~StubSysfsTree()
+        {
+            std::string command = "rm -rf '" + m_root + "'";
+            int result = std::system(command.c_str());
+            (void)result;
+        }
+
+        const std::string &root() const { return m_root; }
+
+    private:
+        std::string m_root;
+
+        void addPin(int pin)
+        {
+            std::string pinDir = m_root + "/gpio" + std::to_string(pin);
+            mkdir(pinDir.c_str(), 0755);
+            std::ofstream(pinDir + "/direction") << "in";
+            std::ofstream(pinDir + "/value") << "0";
+        }
+    };
+
+    bool legacySetValue(const std::string &gpioPath, int pin, int value)
+    {
+        std::ostringstream valuePath;
+        valuePath << gpioPath << "/gpio" << pin << "/value";
+
+        std::ofstream valueFile(valuePath.str());
+        if (!valueFile.is_open())
+        {
+            return false;
+        }
+
+        valueFile << value;
+        valueFile.close();
+
+        return true;
+    }
+
+    int legacyGetValue(const std::string &gpioPath, int pin)
+    {
+        std::ostringstream valuePath;
+        valuePath << gpioPath << "/gpio" << pin << "/value";
+
+        std::ifstream valueFile(valuePath.str());
+        if (!valueFile.is_open())
+        {
+            return 0;
+        }
+
+        int value;
+        valueFile >> value;
+        valueFile.close();
+
+        return value;
+    }
+} // namespace
+
+static void BM_GpioToggle_Legacy(benchmark::State &state)
+{
+    StubSysfsTree tree;
+    int value = 0;
+    for (auto _ : state)
+    {
+        value ^= 1;
+        benchmark::DoNotOptimize(legacySetValue(tree.root(), LED_PIN, value));
+    }
+}
+BENCHMARK(BM_GpioToggle_Legacy);
+
+static void BM_GpioToggle(benchmark::State &state)
+{
+    StubSysfsTree tree;
+    BananaPiGpioController gpio(tree.root());
+    gpio.initialize();
+    gpio.setPinMode(LED_PIN, PinMode::OUTPUT);
+
+    bool high = false;
+    for (auto _ : state)
+    {
+        high = !high;
+        benchmark::DoNotOptimize(gpio.digitalWrite(LED_PIN, high ? PinValue::HIGH : PinValue::LOW));
+    }
+}
+BENCHMARK(BM_GpioToggle);
+
+static void BM_GpioToggle_Stub(benchmark::State &state)
+{
+    StubGpioController gpio;
+    gpio.initialize();
+    gpio.setPinMode(LED_PIN, PinMode::OUTPUT);
+
+    bool high = false;
+    for (auto _ : state)
+    {
+        high = !high;
+        benchmark::DoNotOptimize(gpio.digitalWrite(LED_PIN, high ? PinValue::HIGH : PinValue::LOW));
+    }
+}
+BENCHMARK(BM_GpioToggle_Stub);
+
+static void BM_GpioRead_Legacy(benchmark::State &state)
+{
+    StubSysfsTree tree;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(legacyGetValue(tree.root(), LED_PIN));
+    }
+}
+BENCHMARK(BM_GpioRead_Legacy);
+
+static void BM_GpioRead(benchmark::State &state)
+{
+    StubSysfsTree tree;
+    BananaPiGpioController gpio(tree.root());
+    gpio.initialize();
+    gpio.setPinMode(LED_PIN, PinMode::INPUT);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(gpio.digitalRead(LED_PIN));
+    }
+}
+BENCHMARK(BM_GpioRead);
+
+static void BM_GpioToggle_Mmio(benchmark::State &state)
+{
+    const size_t mapSize = 4096;
+    void *mapping = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    GpioRegisterLayout layout = GpioRegisterLayout::amlogicG12(0);
+    MmioGpioController gpio(layout, static_cast<volatile uint32_t *>(mapping));
+    gpio.setPinMode(LED_PIN, PinMode::OUTPUT);
+
+    bool high = false;
+    for (auto _ : state)
+    {
+        high = !high;
+        benchmark::DoNotOptimize(gpio.digitalWrite(LED_PIN, high ? PinValue::HIGH : PinValue::LOW));
+    }
+    munmap(mapping, mapSize);
+}
+BENCHMARK(BM_GpioToggle_Mmio);
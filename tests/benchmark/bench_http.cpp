@@ -0,0 +1,171 @@
+#include <benchmark/benchmark.h>
+#include "HttpApiServer.h"
+#include "HttpRequestParser.h"
+#include "JsonWriter.h"
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace Wallbox;
+
+/**
+ * @brief HTTP request handling cost
+ *
+ * - Parse: HttpRequestParser on a complete request already in the buffer
+ *   (what the server does per request once the bytes have arrived)
+ * - RoundTrip: one keep-alive request over loopback to a running
+ *   HttpApiServer: read, parse, route, handler, buildResponse, write,
+ *   plus the client's send/receive; buildResponse is private, so this is
+ *   where its cost shows up
+ */
+namespace
+{
+    const std::string GET_REQUEST =
+        "GET /api/status HTTP/1.1\r\n"
+        "Host: wallbox.local:8080\r\n"
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64)\r\n"
+        "Accept: application/json\r\n"
+        "If-None-Match: \"42\"\r\n"
+        "Connection: keep-alive\r\n"
+        "\r\n";
+
+    const std::string POST_REQUEST =
+        "POST /api/charging/start?source=dashboard HTTP/1.1\r\n"
+        "Host: wallbox.local:8080\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: 48\r\n"
+        "\r\n"
+        "{\"maxCurrent\":16,\"phases\":3,\"user\":\"dashboard\"}";
+
+    constexpr int SERVER_PORT = 47200;
+
+    /**
+     * @brief Blocking keep-alive client reading Content-Length framed responses
+     */
+    class HttpClient
+    {
+    public:
+        HttpClient()
+            : m_fd(socket(AF_INET, SOCK_STREAM, 0))
+        {
+            int one = 1;
+            setsockopt(m_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+
+        ~HttpClient()
+        {
+            close(m_fd);
+        }
+
+        bool connectTo(int port)
+        {
+            sockaddr_in address;
+            std::memset(&address, 0, sizeof(address));
+            address.sin_family = AF_INET;
+            address.sin_port = htons(static_cast<uint16_t>(port));
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            return connect(m_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0;
+        }
+
+        bool request(const std::string &text)
+        {
+            if (send(m_fd, text.data(), text.size(), 0) != static_cast<ssize_t>(text.size()))
+            {
+                return false;
+            }
+
+            m_input.clear();
+            size_t headerEnd = std::string::npos;
+            size_t total = 0;
+            char chunk[4096];
+            while (headerEnd == std::string::npos || m_input.size() < total)
+            {
+                ssize_t got = recv(m_fd, chunk, sizeof(chunk), 0);
+                if (got <= 0)
+                {
+                    return false;
+                }
+                m_input.append(chunk, static_cast<size_t>(got));
+                if (headerEnd == std::string::npos)
+                {
+                    headerEnd = m_input.find("\r\n\r\n");
+                    if (headerEnd != std::string::npos)
+                    {
+                        size_t length = m_input.find("Content-Length: ");
+                        total = headerEnd + 4 +
+                                (length < headerEnd ? std::strtoul(m_input.c_str() + length + 16, nullptr, 10) : 0);
+                    }
+                }
+            }
+            return true;
+        }
+
+    private:
+        int m_fd;
+        std::string m_input;
+    };
+} // namespace
+
+static void BM_HttpParse(benchmark::State &state)
+{
+    std::string buffer = state.range(0) == 0 ? GET_REQUEST : POST_REQUEST;
+    HttpRequestParser parser;
+    for (auto _ : state)
+    {
+        HttpRequest request;
+        parser.reset();
+        benchmark::DoNotOptimize(parser.parse(&buffer[0], buffer.size(), request));
+        benchmark::DoNotOptimize(request.path.size);
+    }
+    state.SetLabel(state.range(0) == 0 ? "GET" : "POST + body");
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(buffer.size()));
+}
+BENCHMARK(BM_HttpParse)->Arg(0)->Arg(1);
+
+static void BM_HttpRoundTrip(benchmark::State &state)
+{
+    HttpServerConfig config;
+    config.maxRequestsPerConnection = 1u << 30;
+    HttpApiServer server(SERVER_PORT, config);
+    server.GET("/api/status", [](const HttpRequest &, HttpResponse &res)
+               {
+        JsonWriter json(res.body);
+        json.beginObject()
+            .field("state", "CHARGING")
+            .field("wallboxEnabled", true)
+            .field("relayEnabled", true)
+            .field("charging", true)
+            .field("timestamp", 1700000000LL)
+            .endObject(); });
+    if (!server.start())
+    {
+        state.SkipWithError("server start failed");
+        return;
+    }
+
+    {
+        HttpClient client;
+        if (!client.connectTo(SERVER_PORT))
+        {
+            state.SkipWithError("connect failed");
+        }
+        else
+        {
+            for (auto _ : state)
+            {
+                if (!client.request(GET_REQUEST))
+                {
+                    state.SkipWithError("request failed");
+                    break;
+                }
+            }
+        }
+    }
+    server.stop();
+}
+BENCHMARK(BM_HttpRoundTrip)->UseRealTime();
@@ -0,0 +1,209 @@
+#include <benchmark/benchmark.h>
+#include "HttpApiServer.h"
+#include "JsonWriter.h"
+#include "StubGpioController.h"
+#include "UdpCommunicator.h"
+#include "WallboxController.h"
+#include <ctime>
+#include <memory>
+#include <sstream>
+#include <string>
+
+using namespace Wallbox;
+
+/**
+ * @brief JsonWriter against the implementations it replaced
+ *
+ * The legacy functions below are verbatim copies of the previous
+ * WallboxController::getStatusJson() (ostringstream) and JsonBuilder
+ * (string concatenation), kept here only as a baseline.
+ * BM_Response_JsonBuilder is today's JsonBuilder (a JsonWriter facade)
+ * and BM_StatusJson_Controller is WallboxController::getStatusJson() on a
+ * controller with stub GPIO and an unconnected UDP communicator.
+ */
+namespace
+{
+    std::string legacyStatusJson(const std::string &state, bool wallboxEnabled, bool relayEnabled, bool charging)
+    {
+        std::ostringstream json;
+        json << "{"
+             << "\"state\":\"" << state << "\","
+             << "\"wallboxEnabled\":" << (wallboxEnabled ? "true" : "false") << ","
+             << "\"relayEnabled\":" << (relayEnabled ? "true" : "false") << ","
+             << "\"charging\":" << (charging ? "true" : "false") << ","
+             << "\"timestamp\":" << std::time(nullptr)
+             << "}";
+        return json.str();
+    }
+
+    class LegacyJsonBuilder
+    {
+    public:
+        LegacyJsonBuilder &add(const std::string &key, const std::string &value)
+        {
+            if (!m_first)
+                m_json += ",";
+            m_json += "\"" + key + "\":\"" + value + "\"";
+            m_first = false;
+            return *this;
+        }
+
+        LegacyJsonBuilder &add(const std::string &key, bool value)
+        {
+            if (!m_first)
+                m_json += ",";
+            m_json += "\"" + key + "\":" + (value ? "true" : "false");
+            m_first = false;
+            return *this;
+        }
+
+        LegacyJsonBuilder &add(const std::string &key, double value)
+        {
+            if (!m_first)
+                m_json += ",";
+            m_json += "\"" + key + "\":" + std::to_string(value);
+            m_first = false;
+            return *this;
+        }
+
+        std::string build() { return m_json + "}"; }
+
+    private:
+        std::string m_json = "{";
+        bool m_first = true;
+    };
+} // namespace
+
+static void BM_StatusJson_Ostringstream(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        std::string json = legacyStatusJson("CHARGING", true, true, true);
+        benchmark::DoNotOptimize(json.data());
+    }
+}
+BENCHMARK(BM_StatusJson_Ostringstream);
+
+static void BM_StatusJson_JsonWriter(benchmark::State &state)
+{
+    std::string buffer;
+    for (auto _ : state)
+    {
+        buffer.clear(); // Reused buffer, as with a per-connection response
+        JsonWriter json(buffer);
+        json.beginObject()
+            .field("state", "CHARGING")
+            .field("wallboxEnabled", true)
+            .field("relayEnabled", true)
+            .field("charging", true)
+            .field("timestamp", static_cast<long long>(std::time(nullptr)))
+            .endObject();
+        benchmark::DoNotOptimize(buffer.data());
+    }
+}
+BENCHMARK(BM_StatusJson_JsonWriter);
+
+static void BM_StatusJson_Controller(benchmark::State &state)
+{
+    WallboxController controller(std::unique_ptr<IGpioController>(new StubGpioController()),
+                                 std::unique_ptr<INetworkCommunicator>(new UdpCommunicator(47310, 47311, "127.0.0.1")));
+    for (auto _ : state)
+    {
+        std::string json = controller.getStatusJson();
+        benchmark::DoNotOptimize(json.data());
+    }
+}
+BENCHMARK(BM_StatusJson_Controller);
+
+static void BM_Response_LegacyJsonBuilder(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        LegacyJsonBuilder json;
+        json.add("success", true)
+            .add("message", std::string("Charging started"))
+            .add("state", std::string("CHARGING"))
+            .add("voltage", 229.87);
+        std::string body = json.build();
+        benchmark::DoNotOptimize(body.data());
+    }
+}
+BENCHMARK(BM_Response_LegacyJsonBuilder);
+
+static void BM_Response_JsonBuilder(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        JsonBuilder json;
+        json.add("success", true)
+            .add("message", "Charging started")
+            .add("state", "CHARGING")
+            .add("voltage", 229.87);
+        std::string body = json.build();
+        benchmark::DoNotOptimize(body.data());
+    }
+}
+BENCHMARK(BM_Response_JsonBuilder);
+
+static void BM_Response_JsonWriter(benchmark::State &state)
+{
+    std::string buffer;
+    for (auto _ : state)
+    {
+        buffer.clear();
+        JsonWriter json(buffer);
+        json.beginObject()
+            .field("success", true)
+            .field("message", "Charging started")
+            .field("state", "CHARGING")
+            .field("voltage", 229.87)
+            .endObject();
+        benchmark::DoNotOptimize(buffer.data());
+    }
+}
+BENCHMARK(BM_Response_JsonWriter);
+
+static void BM_EscapeString(benchmark::State &state)
+{
+    std::string text(static_cast<size_t>(state.range(0)), 'a');
+    for (size_t i = 0; i < text.size(); i += 16)
+    {
+        text[i] = '"';
+    }
+
+    std::string buffer;
+    for (auto _ : state)
+    {
+        buffer.clear();
+        JsonWriter::appendEscaped(buffer, text.data(), text.size());
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_EscapeString)->Arg(64)->Arg(4096);
+
+static void BM_FormatDouble(benchmark::State &state)
+{
+    std::string buffer;
+    double value = 0.0;
+    for (auto _ : state)
+    {
+        buffer.clear();
+        JsonWriter::appendDouble(buffer, value);
+        value += 0.37;
+        benchmark::DoNotOptimize(buffer.data());
+    }
+}
+BENCHMARK(BM_FormatDouble);
+
+static void BM_FormatDouble_ToString(benchmark::State &state)
+{
+    double value = 0.0;
+    for (auto _ : state)
+    {
+        std::string text = std::to_string(value);
+        value += 0.37;
+        benchmark::DoNotOptimize(text.data());
+    }
+}
+BENCHMARK(BM_FormatDouble_ToString);
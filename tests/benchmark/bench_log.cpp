@@ -0,0 +1,184 @@
+#include <benchmark/benchmark.h>
+#include "Logger.h"
+#include "EventJournal.h"
+#include "LatencyTracer.h"
+#include "Metrics.h"
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+using namespace Wallbox;
+
+/**
+ * @brief Caller-side cost of one log line
+ *
+ * BM_LogLegacy is a copy of the logging this replaced (Application::logMessage):
+ * localtime/put_time per line, an ostream write and a flush, here to
+ * /dev/null. BM_LogAsync formats the same line into the calling thread's
+ * ring; the writer thread does the time formatting and writev() to
+ * /dev/null. A ring that overflows drops the line (counter "dropped").
+ * BM_LogDisabled is a statement below the runtime level.
+ * BM_JournalRecord appends one binary event to a mapped EventJournal file.
+ * BM_MetricsCounter / BM_MetricsHistogram are one update of a shared
+ * metric; BM_MetricsRender is a scrape of about a hundred sample lines.
+ * BM_TraceSpan times one stage of a current trace (two clock reads, two
+ * histograms, one ring slot); BM_TraceSpanIdle is a span with no trace.
+ */
+namespace
+{
+    std::string legacyTimestamp()
+    {
+        auto now = std::chrono::system_clock::now();
+        auto time_t = std::chrono::system_clock::to_time_t(now);
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      now.time_since_epoch()) %
+                  1000;
+
+        std::stringstream ss;
+        ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
+        ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
+        return ss.str();
+    }
+} // namespace
+
+static void BM_LogLegacy(benchmark::State &state)
+{
+    std::ofstream file("/dev/null");
+    int pin = 17;
+    for (auto _ : state)
+    {
+        file << "[" << legacyTimestamp() << "] [INFO] Relay state: ON pin " << pin << std::endl;
+        file.flush();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogLegacy)->Threads(1)->Threads(4);
+
+static void BM_LogAsync(benchmark::State &state)
+{
+    static LogSinks sink = 0;
+    if (state.thread_index() == 0)
+    {
+        sink = Logger::instance().openFile("/dev/null");
+    }
+    uint64_t droppedBefore = Logger::instance().getStats().dropped;
+
+    int pin = 17;
+    for (auto _ : state)
+    {
+        LogLine(LogLevel::INFO, "Relay", sink) << "Relay state: ON pin " << pin;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0)
+    {
+        Logger::instance().closeFile(sink);
+        state.counters["dropped"] = static_cast<double>(Logger::instance().getStats().dropped - droppedBefore);
+    }
+}
+BENCHMARK(BM_LogAsync)->Threads(1)->Threads(4);
+
+static void BM_LogDisabled(benchmark::State &state)
+{
+    LogLevel previous = Logger::getLevel();
+    Logger::setLevel(LogLevel::WARN);
+    int pin = 17;
+    for (auto _ : state)
+    {
+        WALLBOX_LOG_INFO("Relay") << "Relay state: ON pin " << pin;
+    }
+    Logger::setLevel(previous);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogDisabled);
+
+static void BM_JournalRecord(benchmark::State &state)
+{
+    static const char PATH[] = "/tmp/wallbox_bench_journal.bin";
+    EventJournal &journal = EventJournal::instance();
+    if (state.thread_index() == 0)
+    {
+        journal.open(PATH, 256 * 1024);
+    }
+
+    uint32_t value = 0;
+    for (auto _ : state)
+    {
+        journal.record(JournalEvent::RELAY, value & 1, 1);
+        value++;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0)
+    {
+        journal.close();
+        std::remove(PATH);
+    }
+}
+BENCHMARK(BM_JournalRecord)->Threads(1)->Threads(4);
+
+static void BM_MetricsCounter(benchmark::State &state)
+{
+    static Counter &counter = MetricsRegistry::instance().counter("bench_counter_total", "Benchmark");
+    for (auto _ : state)
+    {
+        counter.inc();
+    }
+}
+BENCHMARK(BM_MetricsCounter)->Threads(1)->Threads(4);
+
+static void BM_MetricsHistogram(benchmark::State &state)
+{
+    static Histogram &histogram = MetricsRegistry::instance().histogram("bench_duration_seconds", "Benchmark");
+    uint64_t value = 0;
+    for (auto _ : state)
+    {
+        histogram.observe(value);
+        value = (value + 37000) % 2000000;
+    }
+}
+BENCHMARK(BM_MetricsHistogram)->Threads(1)->Threads(4);
+
+static void BM_MetricsRender(benchmark::State &state)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        MetricsRegistry::instance().histogram("bench_render_seconds", "Benchmark", {{"route", std::to_string(i)}});
+    }
+    for (int i = 0; i < 20; ++i)
+    {
+        MetricsRegistry::instance().counter("bench_render_total", "Benchmark", {{"route", std::to_string(i)}});
+    }
+    std::string out;
+    for (auto _ : state)
+    {
+        out.clear();
+        MetricsRegistry::instance().render(out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.counters["bytes"] = static_cast<double>(out.size());
+}
+BENCHMARK(BM_MetricsRender);
+
+static void BM_TraceSpan(benchmark::State &state)
+{
+    TraceScope trace(TraceOrigin::UDP, LatencyTracer::nowNs());
+    for (auto _ : state)
+    {
+        TraceSpan span(TraceStage::GPIO_WRITE);
+    }
+}
+BENCHMARK(BM_TraceSpan)->Threads(1)->Threads(4);
+
+static void BM_TraceSpanIdle(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        TraceSpan span(TraceStage::GPIO_WRITE);
+    }
+}
+BENCHMARK(BM_TraceSpanIdle);
@@ -0,0 +1,108 @@
+#include <benchmark/benchmark.h>
+#include "IsoStackCtrlProtocol.h"
+#include "INetworkCommunicator.h"
+#include <cstring>
+#include <string>
+
+using namespace Wallbox;
+using namespace Iso15118;
+
+/**
+ * @brief IsoStackCtrlProtocol message encode/decode
+ *
+ * The protocol structs go on the wire as they are laid out in memory, so
+ * "serialization" is filling a struct and copying its bytes:
+ *
+ * - CmdEncode: the controller's status command, as in
+ *   WallboxController::sendStatusToSimulator(), copied into a datagram buffer
+ * - StateEncode: the simulator's state message, as in the simulator's
+ *   send_state(), optionally converted with stIsoStackState::bigEndian()
+ * - StateDecode: a received state datagram copied back into the struct and
+ *   the fields processNetworkMessage() looks at
+ * - StateToString: enIsoChargingState_toString(), used for every logged change
+ */
+
+static void BM_IsoCmdEncode(benchmark::State &state)
+{
+    uint8_t datagram[sizeof(stSeIsoStackCmd)];
+    uint16_t demand = 0;
+    for (auto _ : state)
+    {
+        stSeIsoStackCmd cmd;
+        cmd.isoStackCmd.msgVersion = 0;
+        cmd.isoStackCmd.msgType = enIsoStackMsgType::SeCtrlCmd;
+        cmd.isoStackCmd.enable = 1;
+        cmd.isoStackCmd.currentDemand = demand;
+        cmd.seHardwareState.mainContactor = 1;
+        ByteSpan span = ByteSpan::of(cmd);
+        std::memcpy(datagram, span.data, span.size);
+        benchmark::DoNotOptimize(datagram);
+        demand = static_cast<uint16_t>((demand + 10) % 100);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(sizeof(stSeIsoStackCmd)));
+}
+BENCHMARK(BM_IsoCmdEncode);
+
+static void BM_IsoStateEncode(benchmark::State &state)
+{
+    const bool bigEndian = state.range(0) != 0;
+    uint8_t datagram[sizeof(stSeIsoStackState)];
+    for (auto _ : state)
+    {
+        stSeIsoStackState message{};
+        message.isoStackState.clear();
+        message.seHardwareCmd.clear();
+        message.isoStackState.msgType = enIsoStackMsgType::SeCtrlState;
+        message.isoStackState.state = enIsoChargingState::charging;
+        message.isoStackState.current = 160;
+        message.isoStackState.voltage = 2300;
+        message.seHardwareCmd.mainContactor = 1;
+        message.seHardwareCmd.sourceEnable = 1;
+        if (bigEndian)
+        {
+            message.isoStackState = message.isoStackState.bigEndian();
+        }
+        std::memcpy(datagram, &message, sizeof(message));
+        benchmark::DoNotOptimize(datagram);
+    }
+    state.SetLabel(bigEndian ? "big endian" : "host order");
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(sizeof(stSeIsoStackState)));
+}
+BENCHMARK(BM_IsoStateEncode)->Arg(0)->Arg(1);
+
+static void BM_IsoStateDecode(benchmark::State &state)
+{
+    stSeIsoStackState sent{};
+    sent.isoStackState.clear();
+    sent.seHardwareCmd.clear();
+    sent.isoStackState.state = enIsoChargingState::charging;
+    sent.seHardwareCmd.mainContactor = 1;
+    uint8_t datagram[sizeof(stSeIsoStackState)];
+    std::memcpy(datagram, &sent, sizeof(sent));
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(datagram);
+        stSeIsoStackState received;
+        std::memcpy(&received, datagram, sizeof(received));
+        bool contactor = received.seHardwareCmd.mainContactor != 0;
+        bool enable = received.seHardwareCmd.sourceEnable != 0;
+        benchmark::DoNotOptimize(contactor);
+        benchmark::DoNotOptimize(enable);
+        benchmark::DoNotOptimize(received.isoStackState.state);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(sizeof(stSeIsoStackState)));
+}
+BENCHMARK(BM_IsoStateDecode);
+
+static void BM_IsoStateToString(benchmark::State &state)
+{
+    int value = 0;
+    for (auto _ : state)
+    {
+        std::string name = enIsoChargingState_toString(static_cast<enIsoChargingState>(value));
+        benchmark::DoNotOptimize(name.data());
+        value = (value + 1) % 9;
+    }
+}
+BENCHMARK(BM_IsoStateToString);
@@ -0,0 +1,63 @@
+#include <benchmark/benchmark.h>
+#include "ChargingStateMachine.h"
+#include "Logger.h"
+#include <chrono>
+
+using namespace Wallbox;
+
+/**
+ * @brief Cost of a state transition as seen by the transitioning thread
+ *
+ * Each listener simulates slow work (~2 us of spinning, like a log line or
+ * a send). Synchronous listeners add their run time to every transition;
+ * asynchronous ones only add a ring push. Back-to-back transitions are
+ * far faster than the listeners, so most asynchronous events end up
+ * dropped (counter "dropped"); real time also includes the listener
+ * threads competing for CPU.
+ * Logging is raised to WARN for the run because transitionTo() logs.
+ */
+namespace
+{
+    void slowWork()
+    {
+        auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(2);
+        while (std::chrono::steady_clock::now() < until)
+        {
+        }
+    }
+
+    void runTransitions(benchmark::State &state, ListenerMode mode)
+    {
+        LogLevel level = Logger::getLevel();
+        Logger::setLevel(LogLevel::WARN);
+        {
+            ChargingStateMachine machine;
+            for (int64_t i = 0; i < state.range(0); ++i)
+            {
+                machine.addStateChangeListener([](ChargingState, ChargingState, const std::string &)
+                                               { slowWork(); },
+                                               mode, 1024);
+            }
+
+            for (auto _ : state)
+            {
+                machine.transitionTo(machine.isIdle() ? ChargingState::CONNECTED : ChargingState::IDLE, "bench");
+            }
+            state.counters["dropped"] = static_cast<double>(machine.getDispatchStats().dropped);
+        }
+        Logger::setLevel(level);
+        state.SetItemsProcessed(state.iterations());
+    }
+} // namespace
+
+static void BM_TransitionSyncListeners(benchmark::State &state)
+{
+    runTransitions(state, ListenerMode::SYNCHRONOUS);
+}
+BENCHMARK(BM_TransitionSyncListeners)->Arg(0)->Arg(1)->Arg(4)->Arg(8);
+
+static void BM_TransitionAsyncListeners(benchmark::State &state)
+{
+    runTransitions(state, ListenerMode::ASYNCHRONOUS);
+}
+BENCHMARK(BM_TransitionAsyncListeners)->Arg(1)->Arg(4)->Arg(8);
@@ -0,0 +1,505 @@
+#include <benchmark/benchmark.h>
+#include "UdpCommunicator.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <new>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace Wallbox;
+
+/**
+ * @brief UdpCommunicator receive path against the sleep-poll loop it replaced
+ *
+ * LegacyUdpReceiver is a verbatim copy of the previous receive loop
+ * (non-blocking recvfrom + 1 ms sleep), kept here only as a baseline.
+ * Datagrams are sent over loopback from the benchmark thread.
+ *
+ * - Latency: one datagram, wait until the callback has seen it
+ * - Flood: FLOOD_COUNT datagrams back to back; counters report how many
+ *   were delivered before the receiver caught up or the socket dropped them
+ * - Cpu: process CPU time while receiving one datagram every N ms
+ *   (0 = idle, 100 = simulator status rate)
+ * - RoundTripSpan: send and receive through the ByteSpan API, counting
+ *   heap allocations per message (the global new/delete forms are instrumented)
+ * - Send: per-datagram send cost; legacySend() is a copy of the old
+ *   UdpCommunicator::send() (inet_pton + sendto per packet)
+ */
+static std::atomic<long> g_allocations(0);
+
+// Every replaceable new/delete form (C++14 has no aligned ones) goes through
+// this pair. They are not inlined, so the compiler never pairs a free() with
+// an operator new at a call site (-Wmismatched-new-delete).
+__attribute__((noinline)) static void *countedAllocate(size_t size) noexcept
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+__attribute__((noinline)) static void countedFree(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void *operator new(size_t size)
+{
+    void *memory = countedAllocate(size);
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAllocate(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAllocate(size);
+}
+
+void operator delete(void *memory) noexcept
+{
+    countedFree(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+    countedFree(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+    countedFree(memory);
+}
+
+void operator delete[](void *memory, size_t) noexcept
+{
+    countedFree(memory);
+}
+
+void operator delete(void *memory, const std::nothrow_t &) noexcept
+{
+    countedFree(memory);
+}
+
+void operator delete[](void *memory, const std::nothrow_t &) noexcept
+{
+    countedFree(memory);
+}
+
+namespace
+{
+    constexpr int SEND_PORT = 47100;
+    constexpr size_t PAYLOAD_SIZE = 64; // Roughly one ISO-stack state message
+    constexpr int FLOOD_COUNT = 1000;
+
+    class LegacyUdpReceiver
+    {
+    public:
+        explicit LegacyUdpReceiver(int listenPort) : m_listenPort(listenPort), m_socketFd(-1), m_running(false) {}
+        ~LegacyUdpReceiver() { disconnect(); }
+
+        bool connect()
+        {
+            m_socketFd = socket(AF_INET, SOCK_DGRAM, 0);
+            int opt = 1;
+            setsockopt(m_socketFd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+            sockaddr_in listenAddr{};
+            listenAddr.sin_family = AF_INET;
+            listenAddr.sin_addr.s_addr = INADDR_ANY;
+            listenAddr.sin_port = htons(m_listenPort);
+            if (bind(m_socketFd, (struct sockaddr *)&listenAddr, sizeof(listenAddr)) < 0)
+            {
+                return false;
+            }
+            int flags = fcntl(m_socketFd, F_GETFL, 0);
+            fcntl(m_socketFd, F_SETFL, flags | O_NONBLOCK);
+            return true;
+        }
+
+        void startReceiving(INetworkCommunicator::MessageCallback callback)
+        {
+            m_messageCallback = callback;
+            m_running = true;
+            m_receiveThread = std::thread([this]()
+                                          { receiveLoop(); });
+        }
+
+        void disconnect()
+        {
+            m_running = false;
+            if (m_receiveThread.joinable())
+            {
+                m_receiveThread.join();
+            }
+            if (m_socketFd >= 0)
+            {
+                close(m_socketFd);
+                m_socketFd = -1;
+            }
+        }
+
+    private:
+        int m_listenPort;
+        int m_socketFd;
+        std::atomic<bool> m_running;
+        INetworkCommunicator::MessageCallback m_messageCallback;
+        std::thread m_receiveThread;
+
+        void receiveLoop()
+        {
+            std::vector<uint8_t> buffer(4096);
+
+            while (m_running)
+            {
+                sockaddr_in senderAddr{};
+                socklen_t senderLen = sizeof(senderAddr);
+
+                ssize_t received = recvfrom(m_socketFd, buffer.data(), buffer.size(), 0,
+                                            (struct sockaddr *)&senderAddr, &senderLen);
+
+                if (received > 0)
+                {
+                    std::vector<uint8_t> message(buffer.begin(), buffer.begin() + received);
+                    if (m_messageCallback)
+                    {
+                        m_messageCallback(message);
+                    }
+                }
+
+                // Small delay to prevent CPU spinning
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    };
+
+    // Receiver types share connect/startReceiving/disconnect; construct them uniformly
+    template <typename Receiver>
+    std::unique_ptr<Receiver> makeReceiver(int port);
+
+    template <>
+    std::unique_ptr<LegacyUdpReceiver> makeReceiver<LegacyUdpReceiver>(int port)
+    {
+        return std::unique_ptr<LegacyUdpReceiver>(new LegacyUdpReceiver(port));
+    }
+
+    template <>
+    std::unique_ptr<UdpCommunicator> makeReceiver<UdpCommunicator>(int port)
+    {
+        return std::unique_ptr<UdpCommunicator>(new UdpCommunicator(port, SEND_PORT, "127.0.0.1"));
+    }
+
+    /**
+     * @brief Loopback sender plus a received-datagram counter
+     */
+    template <typename Receiver>
+    class UdpFixture
+    {
+    public:
+        explicit UdpFixture(int port)
+            : m_receiver(makeReceiver<Receiver>(port)),
+              m_sender(socket(AF_INET, SOCK_DGRAM, 0)),
+              m_payload(PAYLOAD_SIZE, 0x5A),
+              m_received(0)
+        {
+            m_target.sin_family = AF_INET;
+            m_target.sin_port = htons(port);
+            m_target.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+            m_ok = m_receiver->connect();
+            if (m_ok)
+            {
+                m_receiver->startReceiving([this](const std::vector<uint8_t> &)
+                                           { m_received.fetch_add(1, std::memory_order_release); });
+            }
+        }
+
+        ~UdpFixture()
+        {
+            m_receiver->disconnect();
+            close(m_sender);
+        }
+
+        bool ok() const { return m_ok; }
+        long received() const { return m_received.load(std::memory_order_acquire); }
+
+        void send()
+        {
+            sendto(m_sender, m_payload.data(), m_payload.size(), 0,
+                   (struct sockaddr *)&m_target, sizeof(m_target));
+        }
+
+        bool waitFor(long count, std::chrono::milliseconds timeout)
+        {
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            while (received() < count)
+            {
+                if (std::chrono::steady_clock::now() > deadline)
+                {
+                    return false;
+                }
+                std::this_thread::yield();
+            }
+            return true;
+        }
+
+    private:
+        std::unique_ptr<Receiver> m_receiver;
+        int m_sender;
+        sockaddr_in m_target{};
+        std::vector<uint8_t> m_payload;
+        std::atomic<long> m_received;
+        bool m_ok;
+    };
+
+    bool legacySend(int socketFd, const std::string &sendAddress, int sendPort, const std::vector<uint8_t> &data)
+    {
+        sockaddr_in sendAddr{};
+        sendAddr.sin_family = AF_INET;
+        sendAddr.sin_port = htons(sendPort);
+
+        if (inet_pton(AF_INET, sendAddress.c_str(), &sendAddr.sin_addr) <= 0)
+        {
+            return false;
+        }
+
+        ssize_t sent = sendto(socketFd, data.data(), data.size(), 0,
+                              (struct sockaddr *)&sendAddr, sizeof(sendAddr));
+        return sent == static_cast<ssize_t>(data.size());
+    }
+
+    /**
+     * @brief Bound socket nobody reads; datagrams sent to it are dropped once its buffer fills
+     */
+    class UdpSink
+    {
+    public:
+        explicit UdpSink(int port) : m_fd(socket(AF_INET, SOCK_DGRAM, 0))
+        {
+            int opt = 1;
+            setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            addr.sin_port = htons(port);
+            bind(m_fd, (struct sockaddr *)&addr, sizeof(addr));
+        }
+        ~UdpSink() { close(m_fd); }
+
+    private:
+        int m_fd;
+    };
+
+    double processCpuSeconds()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        return ts.tv_sec + ts.tv_nsec / 1e9;
+    }
+} // namespace
+
+template <typename Receiver>
+static void BM_UdpLatency(benchmark::State &state)
+{
+    UdpFixture<Receiver> fixture(47001);
+    if (!fixture.ok())
+    {
+        state.SkipWithError("bind failed");
+        return;
+    }
+
+    long expected = 0;
+    for (auto _ : state)
+    {
+        fixture.send();
+        if (!fixture.waitFor(++expected, std::chrono::milliseconds(100)))
+        {
+            state.SkipWithError("datagram lost");
+            break;
+        }
+    }
+}
+BENCHMARK_TEMPLATE(BM_UdpLatency, LegacyUdpReceiver)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_UdpLatency, UdpCommunicator)->UseRealTime();
+
+template <typename Receiver>
+static void BM_UdpFlood(benchmark::State &state)
+{
+    UdpFixture<Receiver> fixture(47002);
+    if (!fixture.ok())
+    {
+        state.SkipWithError("bind failed");
+        return;
+    }
+
+    long sent = 0;
+    for (auto _ : state)
+    {
+        long before = fixture.received();
+        for (int i = 0; i < FLOOD_COUNT; ++i)
+        {
+            fixture.send();
+        }
+        sent += FLOOD_COUNT;
+
+        // Wait until the receiver stops making progress; whatever is missing was dropped
+        long last = -1;
+        while (fixture.received() != last && fixture.received() - before < FLOOD_COUNT)
+        {
+            last = fixture.received();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+
+    state.counters["delivered_pct"] = 100.0 * fixture.received() / sent;
+    state.SetItemsProcessed(fixture.received());
+}
+BENCHMARK_TEMPLATE(BM_UdpFlood, LegacyUdpReceiver)->Iterations(3)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_UdpFlood, UdpCommunicator)->Iterations(3)->UseRealTime();
+
+template <typename Receiver>
+static void BM_UdpCpu(benchmark::State &state)
+{
+    const int intervalMs = static_cast<int>(state.range(0));
+    const auto window = std::chrono::seconds(1);
+
+    UdpFixture<Receiver> fixture(47003);
+    if (!fixture.ok())
+    {
+        state.SkipWithError("bind failed");
+        return;
+    }
+
+    double cpu = 0;
+    for (auto _ : state)
+    {
+        double start = processCpuSeconds();
+        auto end = std::chrono::steady_clock::now() + window;
+        while (std::chrono::steady_clock::now() < end)
+        {
+            if (intervalMs > 0)
+            {
+                fixture.send();
+                std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+            }
+            else
+            {
+                std::this_thread::sleep_until(end);
+            }
+        }
+        cpu = processCpuSeconds() - start;
+    }
+
+    state.counters["cpu_pct"] = 100.0 * cpu / std::chrono::duration<double>(window).count();
+}
+BENCHMARK_TEMPLATE(BM_UdpCpu, LegacyUdpReceiver)->Arg(0)->Arg(100)->Iterations(1)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_UdpCpu, UdpCommunicator)->Arg(0)->Arg(100)->Iterations(1)->UseRealTime();
+
+static void BM_UdpRoundTripSpan(benchmark::State &state)
+{
+    // Two communicators facing each other: A sends to B, B's callback counts
+    UdpCommunicator sender(47005, 47004, "127.0.0.1");
+    UdpCommunicator receiver(47004, 47005, "127.0.0.1");
+    if (!sender.connect() || !receiver.connect())
+    {
+        state.SkipWithError("bind failed");
+        return;
+    }
+
+    std::atomic<long> received(0);
+    receiver.startReceiving(INetworkCommunicator::SpanCallback([&received](ByteSpan message)
+                                                               {
+        benchmark::DoNotOptimize(message.data);
+        received.fetch_add(1, std::memory_order_release); }));
+
+    uint8_t payload[PAYLOAD_SIZE] = {0x5A};
+    long expected = 0;
+    long allocationsBefore = g_allocations.load();
+    for (auto _ : state)
+    {
+        sender.send(ByteSpan(payload, sizeof(payload)));
+        ++expected;
+        while (received.load(std::memory_order_acquire) < expected)
+        {
+        }
+    }
+    long allocations = g_allocations.load() - allocationsBefore;
+
+    receiver.disconnect();
+    sender.disconnect();
+    state.counters["allocs_per_msg"] = static_cast<double>(allocations) / (expected ? expected : 1);
+}
+BENCHMARK(BM_UdpRoundTripSpan)->UseRealTime();
+
+constexpr int SINK_PORT = 47010;
+
+static void BM_UdpSend_Legacy(benchmark::State &state)
+{
+    UdpSink sink(SINK_PORT);
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    std::vector<uint8_t> payload(PAYLOAD_SIZE, 0x5A);
+    std::string address = "127.0.0.1";
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(legacySend(fd, address, SINK_PORT, payload));
+    }
+    close(fd);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UdpSend_Legacy);
+
+static void BM_UdpSend(benchmark::State &state)
+{
+    const bool connected = state.range(0) != 0;
+    UdpSink sink(SINK_PORT);
+    UdpCommunicator communicator(47011, SINK_PORT, "localhost", connected);
+    if (!communicator.connect())
+    {
+        state.SkipWithError("connect failed");
+        return;
+    }
+
+    uint8_t payload[PAYLOAD_SIZE] = {0x5A};
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(communicator.send(ByteSpan(payload, sizeof(payload))));
+    }
+    state.SetLabel(connected ? "connected" : "sendto");
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UdpSend)->Arg(0)->Arg(1);
+
+static void BM_UdpSendBatch(benchmark::State &state)
+{
+    const size_t batch = static_cast<size_t>(state.range(0));
+    UdpSink sink(SINK_PORT);
+    UdpCommunicator communicator(47012, SINK_PORT, "127.0.0.1", true);
+    if (!communicator.connect())
+    {
+        state.SkipWithError("connect failed");
+        return;
+    }
+
+    uint8_t payload[PAYLOAD_SIZE] = {0x5A};
+    std::vector<ByteSpan> messages(batch, ByteSpan(payload, sizeof(payload)));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(communicator.sendBatch(messages.data(), messages.size()));
+    }
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+BENCHMARK(BM_UdpSendBatch)->Arg(4)->Arg(16);
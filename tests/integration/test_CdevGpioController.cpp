@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include "CdevGpioController.h"
+#include <cstdlib>
+#include <string>
+
+using namespace Wallbox;
+
+/**
+ * @brief Tests for CdevGpioController
+ *
+ * The hardware tests need a simulated chip and are skipped otherwise:
+ *
+ *   modprobe gpio-mockup gpio_mockup_ranges=-1,8
+ *   WALLBOX_TEST_GPIOCHIP=/dev/gpiochipN ./test_CdevGpioController
+ *
+ * (gpio-sim works the same way once a bank with 8 lines is live.) Output
+ * levels are read back through the same line request, so the tests do
+ * not depend on the simulator's debugfs/sysfs pull interface.
+ */
+class CdevGpioControllerTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const char *chip = std::getenv("WALLBOX_TEST_GPIOCHIP");
+        if (chip == nullptr || *chip == '\0')
+        {
+            GTEST_SKIP() << "WALLBOX_TEST_GPIOCHIP not set";
+        }
+        chipPath = chip;
+    }
+
+    std::string chipPath;
+};
+
+// Test: A missing chip is reported instead of silently ignored
+TEST(CdevGpioControllerErrorTest, MissingChipFailsToInitialize)
+{
+    CdevGpioController gpio("/dev/wallbox-no-such-gpiochip");
+    EXPECT_FALSE(gpio.initialize());
+    EXPECT_FALSE(gpio.isInitialized());
+    EXPECT_FALSE(gpio.setPinMode(0, PinMode::OUTPUT));
+}
+
+// Test: Outputs keep their level when more lines join the request
+TEST_F(CdevGpioControllerTest, OutputsSurviveReRequest)
+{
+    CdevGpioController gpio(chipPath);
+    ASSERT_TRUE(gpio.initialize());
+
+    ASSERT_TRUE(gpio.setPinMode(0, PinMode::OUTPUT));
+    ASSERT_TRUE(gpio.digitalWrite(0, PinValue::HIGH));
+    ASSERT_TRUE(gpio.setPinMode(1, PinMode::OUTPUT));
+    ASSERT_TRUE(gpio.setPinMode(2, PinMode::INPUT));
+
+    EXPECT_EQ(gpio.digitalRead(0), PinValue::HIGH);
+    EXPECT_EQ(gpio.digitalRead(1), PinValue::LOW);
+}
+
+// Test: Watching and unwatching an input leaves driven outputs alone
+TEST_F(CdevGpioControllerTest, EdgeChangesKeepOutputs)
+{
+    CdevGpioController gpio(chipPath);
+    ASSERT_TRUE(gpio.initialize());
+    ASSERT_TRUE(gpio.setPinMode(0, PinMode::OUTPUT));
+    ASSERT_TRUE(gpio.setPinMode(1, PinMode::INPUT));
+    ASSERT_TRUE(gpio.digitalWrite(0, PinValue::HIGH));
+
+    ASSERT_TRUE(gpio.watchPin(1, PinEdge::BOTH, [](const PinEvent &) {}));
+    EXPECT_EQ(gpio.digitalRead(0), PinValue::HIGH);
+    gpio.unwatchPin(1);
+    EXPECT_EQ(gpio.digitalRead(0), PinValue::HIGH);
+    ASSERT_TRUE(gpio.setPinMode(1, PinMode::OUTPUT));
+    EXPECT_EQ(gpio.digitalRead(0), PinValue::HIGH);
+}
+
+// Test: writeMany sets several outputs at once and rejects inputs
+TEST_F(CdevGpioControllerTest, WriteManyUpdatesAllLines)
+{
+    CdevGpioController gpio(chipPath);
+    ASSERT_TRUE(gpio.initialize());
+    for (int pin = 0; pin < 3; ++pin)
+    {
+        ASSERT_TRUE(gpio.setPinMode(pin, PinMode::OUTPUT));
+    }
+    ASSERT_TRUE(gpio.setPinMode(3, PinMode::INPUT));
+
+    const PinWrite pattern[] = {{0, PinValue::HIGH}, {1, PinValue::LOW}, {2, PinValue::HIGH}};
+    ASSERT_TRUE(gpio.writeMany(pattern, 3));
+    EXPECT_EQ(gpio.digitalRead(0), PinValue::HIGH);
+    EXPECT_EQ(gpio.digitalRead(1), PinValue::LOW);
+    EXPECT_EQ(gpio.digitalRead(2), PinValue::HIGH);
+
+    const PinWrite withInput[] = {{0, PinValue::LOW}, {3, PinValue::LOW}};
+    EXPECT_FALSE(gpio.writeMany(withInput, 2));
+    EXPECT_EQ(gpio.digitalRead(0), PinValue::HIGH);
+}
+
+// Test: Pins outside the chip are refused
+TEST_F(CdevGpioControllerTest, RejectsPinsOutsideChip)
+{
+    CdevGpioController gpio(chipPath, 100);
+    ASSERT_TRUE(gpio.initialize());
+    EXPECT_FALSE(gpio.setPinMode(99, PinMode::OUTPUT));
+    EXPECT_FALSE(gpio.setPinMode(100 + 4096, PinMode::OUTPUT));
+    EXPECT_TRUE(gpio.setPinMode(100, PinMode::OUTPUT));
+}
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include "CpStateFilter.h"
+#include "CpWaveformAnalyzer.h"
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Wallbox;
+
+/**
+ * @brief Tests for CpStateFilter
+ *
+ * Besides the unit tests, every trace in tests/data is replayed through a
+ * filter with the default settings; the trace's "# expect:" line lists the
+ * states that must be reported, starting with the initial one.
+ */
+namespace
+{
+    constexpr uint64_t MS = 1000000ULL;
+
+    struct Trace
+    {
+        std::vector<std::string> expected;
+        std::vector<std::pair<uint64_t, int32_t>> samples; ///< (time ns, mV)
+    };
+
+    bool loadTrace(const std::string &name, Trace &trace)
+    {
+        std::ifstream file(std::string(WALLBOX_TEST_DATA_DIR) + "/" + name);
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (line.compare(0, 10, "# expect: ") == 0)
+            {
+                std::istringstream states(line.substr(10));
+                std::string state;
+                while (states >> state)
+                {
+                    trace.expected.push_back(state);
+                }
+            }
+            else if (!line.empty() && line[0] != '#')
+            {
+                uint64_t ms = 0;
+                int32_t mv = 0;
+                std::istringstream(line) >> ms >> mv;
+                trace.samples.emplace_back(ms * MS, mv);
+            }
+        }
+        return !trace.samples.empty();
+    }
+
+    std::string letter(CpState state)
+    {
+        return state == CpState::UNKNOWN ? "?" : std::string(1, static_cast<char>('A' + static_cast<int>(state)));
+    }
+} // namespace
+
+// Test: A single deviating sample never changes the state
+TEST(CpStateFilterTest, VotingRejectsIsolatedSamples)
+{
+    CpStateFilter filter(CpFilterConfig(3, 5, 0, 0));
+    filter.reset(CpState::STATE_A, 0);
+
+    EXPECT_FALSE(filter.addVoltage(9000, 10 * MS));
+    EXPECT_FALSE(filter.addVoltage(12000, 20 * MS));
+    EXPECT_FALSE(filter.addVoltage(9000, 30 * MS));
+    EXPECT_FALSE(filter.settled());
+    EXPECT_TRUE(filter.addVoltage(9000, 40 * MS));
+    EXPECT_EQ(filter.state(), CpState::STATE_B);
+    EXPECT_EQ(filter.changeTimestampNs(), 10 * MS);
+}
+
+// Test: Voltages just across a threshold stay in the current state
+TEST(CpStateFilterTest, HysteresisWidensCurrentBand)
+{
+    CpStateFilter filter(CpFilterConfig(1, 1, 500, 0));
+    filter.reset(CpState::STATE_B, 0);
+
+    EXPECT_FALSE(filter.addVoltage(7600, 10 * MS)); // C by threshold, within 500 mV of B
+    EXPECT_EQ(filter.state(), CpState::STATE_B);
+    EXPECT_TRUE(filter.addVoltage(7400, 20 * MS));
+    EXPECT_EQ(filter.state(), CpState::STATE_C);
+    EXPECT_FALSE(filter.addVoltage(8400, 30 * MS)); // now C's band is widened
+    EXPECT_EQ(filter.state(), CpState::STATE_C);
+}
+
+// Test: Changes wait for the dwell time, except to STATE_F
+TEST(CpStateFilterTest, DwellHoldsStatesExceptErrors)
+{
+    CpStateFilter filter(CpFilterConfig(1, 1, 0, 50));
+    filter.reset(CpState::STATE_A, 0);
+
+    EXPECT_FALSE(filter.addVoltage(9000, 20 * MS));
+    EXPECT_TRUE(filter.addVoltage(9000, 50 * MS));
+    EXPECT_EQ(filter.state(), CpState::STATE_B);
+
+    EXPECT_TRUE(filter.addVoltage(-12000, 60 * MS));
+    EXPECT_EQ(filter.state(), CpState::STATE_F);
+}
+
+// Test: Suppressed transitions are counted against the unfiltered reading
+TEST(CpStateFilterTest, CountsSuppressedTransitions)
+{
+    CpStateFilter filter(CpFilterConfig(2, 3, 0, 0));
+    filter.reset(CpState::STATE_A, 0);
+
+    filter.addVoltage(9000, 10 * MS);  // raw A -> B
+    filter.addVoltage(12000, 20 * MS); // raw B -> A
+    filter.addVoltage(9000, 30 * MS);  // raw A -> B, reported
+    filter.addVoltage(-5000, 40 * MS); // UNKNOWN: not a transition
+
+    const CpFilterStats &stats = filter.stats();
+    EXPECT_EQ(stats.samples, 4u);
+    EXPECT_EQ(stats.rawTransitions, 3u);
+    EXPECT_EQ(stats.transitions, 1u);
+    EXPECT_EQ(stats.suppressed(), 2u);
+}
+
+// Test: Invalid settings are clamped instead of disabling the filter
+TEST(CpStateFilterTest, ClampsConfiguration)
+{
+    CpStateFilter filter(CpFilterConfig(10, 100, 0, 0));
+    EXPECT_EQ(filter.config().window, CpStateFilter::MAX_WINDOW);
+    EXPECT_EQ(filter.config().votes, 10u);
+
+    CpStateFilter tiny(CpFilterConfig(0, 0, 0, 0));
+    EXPECT_EQ(tiny.config().window, 1u);
+    EXPECT_EQ(tiny.config().votes, 1u);
+}
+
+class CpStateFilterTraceTest : public ::testing::TestWithParam<const char *>
+{
+};
+
+// Test: Recorded noisy traces produce exactly the expected state sequence
+TEST_P(CpStateFilterTraceTest, ReportsExpectedStates)
+{
+    Trace trace;
+    ASSERT_TRUE(loadTrace(GetParam(), trace));
+
+    CpStateFilter filter;
+    filter.reset(CpWaveformAnalyzer::stateForVoltage(trace.samples[0].second), trace.samples[0].first);
+    std::vector<std::string> reported = {letter(filter.state())};
+    for (const auto &sample : trace.samples)
+    {
+        if (filter.addVoltage(sample.second, sample.first))
+        {
+            reported.push_back(letter(filter.state()));
+        }
+    }
+
+    EXPECT_EQ(reported, trace.expected);
+    RecordProperty("suppressed", static_cast<int>(filter.stats().suppressed()));
+}
+
+INSTANTIATE_TEST_SUITE_P(Traces, CpStateFilterTraceTest,
+                         ::testing::Values("cp_plugin_noisy.trace", "cp_glitch.trace", "cp_fault.trace"));
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include "EventJournal.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+using namespace Wallbox;
+
+/**
+ * @brief Tests for EventJournal
+ *
+ * The journal is a process-wide singleton; each test maps its own
+ * temporary file and closes it again.
+ */
+class EventJournalTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        char pattern[] = "/tmp/wallbox_journal_test_XXXXXX";
+        int fd = mkstemp(pattern);
+        ASSERT_GE(fd, 0);
+        close(fd);
+        path = pattern;
+    }
+
+    void TearDown() override
+    {
+        EventJournal::instance().close();
+        std::remove(path.c_str());
+    }
+
+    std::vector<JournalRecord> read()
+    {
+        std::vector<JournalRecord> records;
+        std::string error;
+        EXPECT_TRUE(EventJournal::readFile(path, records, error)) << error;
+        return records;
+    }
+
+    static size_t bytesFor(size_t records)
+    {
+        return sizeof(JournalHeader) + records * sizeof(JournalRecord);
+    }
+
+    std::string path;
+};
+
+// Test: Records come back in order with their arguments and data
+TEST_F(EventJournalTest, RecordsRoundTrip)
+{
+    EventJournal &journal = EventJournal::instance();
+    ASSERT_TRUE(journal.open(path, bytesFor(64)));
+    EXPECT_EQ(journal.capacity(), 64u);
+
+    std::string reason = "User requested";
+    journal.record(JournalEvent::STATE_TRANSITION, 1, 2, reason.data(), reason.size());
+    journal.record(JournalEvent::RELAY, 1, 1);
+    std::vector<uint8_t> datagram(100, 0xab);
+    journal.record(JournalEvent::UDP_RX, static_cast<uint32_t>(datagram.size()), 0, datagram.data(), datagram.size());
+    journal.close();
+    EXPECT_FALSE(journal.isOpen());
+
+    std::vector<JournalRecord> records = read();
+    ASSERT_EQ(records.size(), 3u);
+    EXPECT_EQ(records[0].sequence, 1u);
+    EXPECT_EQ(records[0].type, JournalEvent::STATE_TRANSITION);
+    EXPECT_EQ(records[0].arg0, 1u);
+    EXPECT_EQ(records[0].arg1, 2u);
+    EXPECT_EQ(std::string(reinterpret_cast<const char *>(records[0].data), records[0].length), reason);
+    EXPECT_EQ(records[1].type, JournalEvent::RELAY);
+    EXPECT_EQ(records[2].arg0, 100u);
+    EXPECT_EQ(records[2].length, JournalRecord::DATA_CAPACITY);
+    EXPECT_LE(records[0].timestampNs, records[2].timestampNs);
+}
+
+// Test: A full ring keeps the newest records; reopening continues the sequence
+TEST_F(EventJournalTest, WrapsAndContinuesAfterReopen)
+{
+    EventJournal &journal = EventJournal::instance();
+    ASSERT_TRUE(journal.open(path, bytesFor(16)));
+    for (uint32_t i = 0; i < 40; ++i)
+    {
+        journal.record(JournalEvent::CP_CHANGE, i, i + 1);
+    }
+    journal.close();
+
+    std::vector<JournalRecord> records = read();
+    ASSERT_EQ(records.size(), 16u);
+    EXPECT_EQ(records.front().sequence, 25u);
+    EXPECT_EQ(records.front().arg0, 24u);
+    EXPECT_EQ(records.back().sequence, 40u);
+
+    ASSERT_TRUE(journal.open(path, bytesFor(16)));
+    journal.record(JournalEvent::RELAY, 0, 1);
+    journal.close();
+    records = read();
+    ASSERT_EQ(records.size(), 16u);
+    EXPECT_EQ(records.back().sequence, 41u);
+    EXPECT_EQ(records.back().type, JournalEvent::RELAY);
+
+    // A different size starts over
+    ASSERT_TRUE(journal.open(path, bytesFor(32)));
+    journal.close();
+    EXPECT_TRUE(read().empty());
+}
+
+// Test: Concurrent writers get distinct sequences and nothing is lost
+TEST_F(EventJournalTest, ConcurrentWriters)
+{
+    constexpr int THREADS = 4;
+    constexpr int PER_THREAD = 200;
+    EventJournal &journal = EventJournal::instance();
+    ASSERT_TRUE(journal.open(path, bytesFor(THREADS * PER_THREAD)));
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t)
+    {
+        threads.emplace_back([&journal, t]()
+                             {
+            for (int i = 0; i < PER_THREAD; ++i)
+            {
+                journal.record(JournalEvent::UDP_TX, static_cast<uint32_t>(t), static_cast<uint32_t>(i));
+            } });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    journal.close();
+
+    std::vector<JournalRecord> records = read();
+    ASSERT_EQ(records.size(), static_cast<size_t>(THREADS * PER_THREAD));
+    std::vector<int> next(THREADS, 0);
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        EXPECT_EQ(records[i].sequence, i + 1);
+        ASSERT_LT(records[i].arg0, static_cast<uint32_t>(THREADS));
+        EXPECT_EQ(records[i].arg1, static_cast<uint32_t>(next[records[i].arg0]++));
+    }
+}
+
+// Test: Recording while closed does nothing; other files are rejected
+TEST_F(EventJournalTest, ClosedJournalAndForeignFiles)
+{
+    EventJournal::instance().record(JournalEvent::RELAY, 1, 1);
+
+    FILE *file = std::fopen(path.c_str(), "w");
+    ASSERT_NE(file, nullptr);
+    std::fputs("not a journal, just some text that is long enough for a header......", file);
+    std::fclose(file);
+
+    std::vector<JournalRecord> records;
+    std::string error;
+    EXPECT_FALSE(EventJournal::readFile(path, records, error));
+    EXPECT_FALSE(error.empty());
+}
@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+#include "EventLoop.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+using namespace Wallbox;
+
+/**
+ * @brief Tests for EventLoop
+ *
+ * Each test runs the loop on a background thread and stops it from the
+ * test thread, the way Application drives the controller loop.
+ */
+class EventLoopTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(loop.open());
+    }
+
+    void TearDown() override
+    {
+        loop.stop();
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+        loop.close();
+    }
+
+    void start()
+    {
+        thread = std::thread([this]()
+                             { loop.run(); });
+        while (!loop.isRunning())
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    template <typename Predicate>
+    bool waitFor(Predicate predicate, int timeoutMs = 2000)
+    {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (!predicate())
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    EventLoop loop;
+    std::thread thread;
+};
+
+// Test: Posted tasks run on the loop thread in posting order
+TEST_F(EventLoopTest, PostedTasksRunInOrderOnLoopThread)
+{
+    start();
+
+    std::vector<int> order;
+    std::atomic<int> done(0);
+    std::atomic<bool> onLoopThread(true);
+    for (int i = 0; i < 100; ++i)
+    {
+        loop.post([&, i]()
+                  {
+            order.push_back(i);
+            if (!loop.inLoopThread())
+            {
+                onLoopThread = false;
+            }
+            done++; });
+    }
+
+    ASSERT_TRUE(waitFor([&]()
+                        { return done.load() == 100; }));
+    EXPECT_TRUE(onLoopThread.load());
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(order[i], i);
+    }
+}
+
+// Test: A readable fd calls its handler; removed fds are no longer watched
+TEST_F(EventLoopTest, FdHandlerRunsWhenReadable)
+{
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+
+    std::atomic<int> bytes(0);
+    ASSERT_TRUE(loop.addFd(fds[0], EPOLLIN, [&](uint32_t)
+                           {
+        char buffer[16];
+        ssize_t count = read(fds[0], buffer, sizeof(buffer));
+        if (count > 0)
+        {
+            bytes += static_cast<int>(count);
+        } }));
+    start();
+
+    ASSERT_EQ(write(fds[1], "abc", 3), 3);
+    EXPECT_TRUE(waitFor([&]()
+                        { return bytes.load() == 3; }));
+
+    std::atomic<bool> removed(false);
+    loop.post([&]()
+              {
+        loop.removeFd(fds[0]);
+        removed = true; });
+    ASSERT_TRUE(waitFor([&]()
+                        { return removed.load(); }));
+    ASSERT_EQ(write(fds[1], "de", 2), 2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(bytes.load(), 3);
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+// Test: Periodic timers repeat, one-shot timers fire once, 0 disarms
+TEST_F(EventLoopTest, TimersFireAndDisarm)
+{
+    std::atomic<int> periodic(0);
+    std::atomic<int> oneShot(0);
+    int periodicTimer = loop.addTimer([&]()
+                                      { periodic++; });
+    int oneShotTimer = loop.addTimer([&]()
+                                     { oneShot++; });
+    ASSERT_GE(periodicTimer, 0);
+    ASSERT_GE(oneShotTimer, 0);
+    start();
+
+    ASSERT_TRUE(loop.armTimer(periodicTimer, 5));
+    ASSERT_TRUE(loop.armTimer(oneShotTimer, 5, false));
+    EXPECT_TRUE(waitFor([&]()
+                        { return periodic.load() >= 3; }));
+    EXPECT_EQ(oneShot.load(), 1);
+
+    ASSERT_TRUE(loop.armTimer(periodicTimer, 0));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    int stopped = periodic.load();
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    EXPECT_EQ(periodic.load(), stopped);
+}
+
+// Test: An idle loop does not wake up (no polling tick)
+TEST_F(EventLoopTest, IdleLoopDoesNotWakeUp)
+{
+    start();
+    uint64_t before = loop.wakeups();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_EQ(loop.wakeups(), before);
+}
+
+// Test: stop() ends run() and tasks posted before it still run
+TEST_F(EventLoopTest, StopRunsRemainingTasks)
+{
+    start();
+
+    std::atomic<bool> ran(false);
+    loop.post([&]()
+              { ran = true; });
+    loop.stop();
+    thread.join();
+
+    EXPECT_TRUE(ran.load());
+    EXPECT_FALSE(loop.isRunning());
+
+    // The loop can be run again after stop()
+    start();
+    EXPECT_TRUE(loop.isRunning());
+}
+
+// Test: Without a running loop, runPending() drains the queue on the caller's thread
+TEST_F(EventLoopTest, RunPendingDrainsStoppedLoop)
+{
+    std::atomic<bool> onLoopThread(false);
+    loop.post([&]()
+              { onLoopThread = loop.inLoopThread(); });
+    EXPECT_TRUE(loop.runPending());
+    EXPECT_TRUE(onLoopThread.load());
+    EXPECT_FALSE(loop.inLoopThread());
+
+    // While run() consumes tasks nobody else may
+    start();
+    EXPECT_FALSE(loop.runPending());
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include "GpioEdgeWatcher.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <poll.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace Wallbox;
+
+/**
+ * @brief Tests for GpioEdgeWatcher
+ *
+ * A pipe stands in for a GPIO event fd: writing a byte is an "edge".
+ */
+class GpioEdgeWatcherTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_EQ(pipe(fds), 0);
+    }
+
+    void TearDown() override
+    {
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    void signalEdge()
+    {
+        char byte = 1;
+        ASSERT_EQ(write(fds[1], &byte, 1), 1);
+    }
+
+    bool waitForCount(int expected)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        return cv.wait_for(lock, std::chrono::seconds(2), [&]
+                           { return count == expected; });
+    }
+
+    GpioEdgeWatcher::ReadyHandler countingHandler()
+    {
+        return [this]()
+        {
+            char byte;
+            ssize_t bytes = read(fds[0], &byte, 1);
+            (void)bytes;
+            std::lock_guard<std::mutex> lock(mutex);
+            ++count;
+            cv.notify_all();
+        };
+    }
+
+    int fds[2];
+    std::mutex mutex;
+    std::condition_variable cv;
+    int count = 0;
+};
+
+// Test: Each edge runs the handler once
+TEST_F(GpioEdgeWatcherTest, RunsHandlerOnEdge)
+{
+    GpioEdgeWatcher watcher;
+    ASSERT_TRUE(watcher.watch(7, fds[0], POLLIN, countingHandler()));
+    EXPECT_TRUE(watcher.isWatching(7));
+
+    signalEdge();
+    EXPECT_TRUE(waitForCount(1));
+    signalEdge();
+    EXPECT_TRUE(waitForCount(2));
+}
+
+// Test: After unwatch() returns, edges no longer reach the handler
+TEST_F(GpioEdgeWatcherTest, UnwatchStopsHandler)
+{
+    GpioEdgeWatcher watcher;
+    ASSERT_TRUE(watcher.watch(7, fds[0], POLLIN, countingHandler()));
+    watcher.unwatch(7);
+    EXPECT_FALSE(watcher.isWatching(7));
+
+    signalEdge();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(count, 0);
+}
+
+// Test: Re-registering a key replaces its handler
+TEST_F(GpioEdgeWatcherTest, WatchReplacesHandler)
+{
+    std::atomic<int> oldCalls(0);
+    GpioEdgeWatcher watcher;
+    ASSERT_TRUE(watcher.watch(7, fds[0], POLLIN, [&]()
+                              { ++oldCalls; }));
+    ASSERT_TRUE(watcher.watch(7, fds[0], POLLIN, countingHandler()));
+
+    signalEdge();
+    EXPECT_TRUE(waitForCount(1));
+    EXPECT_EQ(oldCalls.load(), 0);
+}
+
+// Test: Monotonic timestamps do not go backwards
+TEST(GpioEdgeWatcherClockTest, MonotonicClock)
+{
+    uint64_t first = GpioEdgeWatcher::monotonicNowNs();
+    uint64_t second = GpioEdgeWatcher::monotonicNowNs();
+    EXPECT_GT(first, 0u);
+    EXPECT_GE(second, first);
+}
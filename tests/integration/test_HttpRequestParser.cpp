@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include "HttpRequestParser.h"
+
+using namespace Wallbox;
+
+/**
+ * @brief Unit tests for HttpRequestParser
+ *
+ * Feeds requests in arbitrary fragments, the way they arrive from
+ * non-blocking reads, and checks framing, slices and limit errors.
+ */
+class HttpRequestParserTest : public ::testing::Test
+{
+protected:
+    // Grows the buffer one fragment at a time, as the server does
+    HttpRequestParser::Result feed(const std::string &data, size_t fragmentSize)
+    {
+        HttpRequestParser::Result result = HttpRequestParser::Result::Incomplete;
+        buffer.clear();
+        for (size_t offset = 0; offset < data.size(); offset += fragmentSize)
+        {
+            buffer.append(data, offset, fragmentSize);
+            result = parser.parse(&buffer[0], buffer.size(), request);
+            if (result != HttpRequestParser::Result::Incomplete)
+            {
+                break;
+            }
+        }
+        return result;
+    }
+
+    HttpRequestParser parser;
+    HttpRequest request;
+    std::string buffer;
+};
+
+// Test: Request line, headers and query parameters are sliced correctly
+TEST_F(HttpRequestParserTest, ParsesRequestLineHeadersAndQuery)
+{
+    ASSERT_EQ(feed("GET /api/status?verbose=1&raw HTTP/1.1\r\nHost: wallbox\r\nX-Trace:  abc \r\n\r\n", 1),
+              HttpRequestParser::Result::Complete);
+
+    EXPECT_EQ(request.method.str(), "GET");
+    EXPECT_EQ(request.path.str(), "/api/status");
+    EXPECT_EQ(request.query.str(), "verbose=1&raw");
+    EXPECT_EQ(request.getHeader("host").str(), "wallbox");
+    EXPECT_EQ(request.getHeader("X-TRACE").str(), "abc");
+    EXPECT_EQ(request.getParam("verbose").str(), "1");
+    EXPECT_EQ(request.paramCount, 2u);
+    EXPECT_TRUE(request.keepAlive);
+    EXPECT_EQ(parser.getConsumed(), buffer.size());
+}
+
+// Test: Content-Length body split over several reads is not truncated
+TEST_F(HttpRequestParserTest, ReadsContentLengthBodyAcrossFragments)
+{
+    std::string body(10000, 'x');
+    std::string data = "POST /echo HTTP/1.1\r\nContent-Length: 10000\r\n\r\n" + body;
+
+    ASSERT_EQ(feed(data, 1400), HttpRequestParser::Result::Complete);
+    EXPECT_EQ(request.body.size, body.size());
+    EXPECT_EQ(request.body.str(), body);
+}
+
+// Test: Chunked body is decoded in place into one contiguous slice
+TEST_F(HttpRequestParserTest, DecodesChunkedBody)
+{
+    std::string data = "POST /echo HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+                       "5\r\nhello\r\n6;ext=1\r\n world\r\n0\r\nX-Trailer: 1\r\n\r\n";
+
+    ASSERT_EQ(feed(data, 3), HttpRequestParser::Result::Complete);
+    EXPECT_EQ(request.body.str(), "hello world");
+    EXPECT_EQ(parser.getConsumed(), data.size());
+}
+
+// Test: Pipelined requests are consumed one at a time
+TEST_F(HttpRequestParserTest, StopsAtEndOfFirstPipelinedRequest)
+{
+    std::string first = "POST /a HTTP/1.1\r\nContent-Length: 2\r\n\r\nok";
+    std::string second = "GET /b HTTP/1.1\r\nConnection: close\r\n\r\n";
+    buffer = first + second;
+
+    ASSERT_EQ(parser.parse(&buffer[0], buffer.size(), request), HttpRequestParser::Result::Complete);
+    EXPECT_EQ(request.path.str(), "/a");
+    EXPECT_EQ(parser.getConsumed(), first.size());
+
+    buffer.erase(0, parser.getConsumed());
+    parser.reset();
+    ASSERT_EQ(parser.parse(&buffer[0], buffer.size(), request), HttpRequestParser::Result::Complete);
+    EXPECT_EQ(request.path.str(), "/b");
+    EXPECT_FALSE(request.keepAlive);
+}
+
+// Test: HTTP/1.0 is only persistent when asked for
+TEST_F(HttpRequestParserTest, Http10DefaultsToClose)
+{
+    ASSERT_EQ(feed("GET / HTTP/1.0\r\n\r\n", 64), HttpRequestParser::Result::Complete);
+    EXPECT_FALSE(request.keepAlive);
+
+    parser.reset();
+    ASSERT_EQ(feed("GET / HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n", 64), HttpRequestParser::Result::Complete);
+    EXPECT_TRUE(request.keepAlive);
+}
+
+// Test: Limits and malformed input map to the right status codes
+TEST_F(HttpRequestParserTest, ReportsErrorStatus)
+{
+    HttpParserLimits limits;
+    limits.maxHeaderBytes = 256;
+    limits.maxBodyBytes = 16;
+
+    parser = HttpRequestParser(limits);
+    EXPECT_EQ(feed("POST / HTTP/1.1\r\nContent-Length: 17\r\n\r\n", 64), HttpRequestParser::Result::Error);
+    EXPECT_EQ(parser.getErrorStatus(), 413);
+
+    parser = HttpRequestParser(limits);
+    EXPECT_EQ(feed("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n20\r\n", 64), HttpRequestParser::Result::Error);
+    EXPECT_EQ(parser.getErrorStatus(), 413);
+
+    parser = HttpRequestParser(limits);
+    EXPECT_EQ(feed("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nffffffffffffffffffffffff\r\n", 64),
+              HttpRequestParser::Result::Error);
+    EXPECT_EQ(parser.getErrorStatus(), 413);
+
+    parser = HttpRequestParser(limits);
+    EXPECT_EQ(feed("GET / HTTP/1.1\r\nX: " + std::string(300, 'a') + "\r\n\r\n", 64), HttpRequestParser::Result::Error);
+    EXPECT_EQ(parser.getErrorStatus(), 431);
+
+    parser = HttpRequestParser(limits);
+    EXPECT_EQ(feed("POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n", 64), HttpRequestParser::Result::Error);
+    EXPECT_EQ(parser.getErrorStatus(), 501);
+
+    parser = HttpRequestParser(limits);
+    EXPECT_EQ(feed("POST / HTTP/1.1\r\nContent-Length: 1\r\nTransfer-Encoding: chunked\r\n\r\n", 64),
+              HttpRequestParser::Result::Error);
+    EXPECT_EQ(parser.getErrorStatus(), 400);
+
+    parser = HttpRequestParser(limits);
+    EXPECT_EQ(feed("GET /\r\n\r\n", 64), HttpRequestParser::Result::Error);
+    EXPECT_EQ(parser.getErrorStatus(), 400);
+}
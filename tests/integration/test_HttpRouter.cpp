@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include "HttpApiServer.h"
+
+using namespace Wallbox;
+
+/**
+ * @brief Unit tests for HttpRouter
+ *
+ * Checks literal, parameter and wildcard matching, precedence and the
+ * NotFound / MethodNotAllowed distinction.
+ */
+class HttpRouterTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        add(HttpMethod::GET, "/api/status", "status");
+        add(HttpMethod::POST, "/api/connectors/{id}/start", "start");
+        add(HttpMethod::GET, "/api/connectors/{id}", "connector");
+        add(HttpMethod::GET, "/api/connectors/main", "main");
+        add(HttpMethod::GET, "/api/sessions/{session}/meter/{index}", "meter");
+        add(HttpMethod::GET, "/static/*", "static");
+    }
+
+    void add(HttpMethod method, const std::string &pattern, const std::string &name)
+    {
+        ASSERT_TRUE(router.add(method, pattern, [name](const HttpRequest &, HttpResponse &)
+                               { lastHandler = name; }));
+    }
+
+    // Keeps the path alive: captured parameters are slices into it
+    HttpRouter::MatchResult match(HttpMethod method, const std::string &requestPath)
+    {
+        path = requestPath;
+        request = HttpRequest();
+        lastHandler.clear();
+        const HttpHandler *handler = nullptr;
+        HttpRouter::MatchResult result =
+            router.match(method, StringRef(path.data(), path.size()), request, handler);
+        if (handler != nullptr)
+        {
+            HttpResponse response;
+            (*handler)(request, response);
+        }
+        return result;
+    }
+
+    HttpRouter router;
+    HttpRequest request;
+    std::string path;
+    static std::string lastHandler;
+};
+
+std::string HttpRouterTest::lastHandler;
+
+// Test: Literal routes match exactly
+TEST_F(HttpRouterTest, MatchesLiteralRoute)
+{
+    EXPECT_EQ(match(HttpMethod::GET, "/api/status"), HttpRouter::MatchResult::Found);
+    EXPECT_EQ(lastHandler, "status");
+    EXPECT_EQ(request.paramCount, 0u);
+}
+
+// Test: Path parameters are captured into request.params
+TEST_F(HttpRouterTest, CapturesPathParameters)
+{
+    EXPECT_EQ(match(HttpMethod::POST, "/api/connectors/2/start"), HttpRouter::MatchResult::Found);
+    EXPECT_EQ(lastHandler, "start");
+    EXPECT_EQ(request.getParam("id").str(), "2");
+
+    EXPECT_EQ(match(HttpMethod::GET, "/api/sessions/abc/meter/7"), HttpRouter::MatchResult::Found);
+    EXPECT_EQ(request.getParam("session").str(), "abc");
+    EXPECT_EQ(request.getParam("index").str(), "7");
+}
+
+// Test: Literal segments win over parameters at the same position
+TEST_F(HttpRouterTest, LiteralTakesPrecedenceOverParameter)
+{
+    EXPECT_EQ(match(HttpMethod::GET, "/api/connectors/main"), HttpRouter::MatchResult::Found);
+    EXPECT_EQ(lastHandler, "main");
+
+    EXPECT_EQ(match(HttpMethod::GET, "/api/connectors/3"), HttpRouter::MatchResult::Found);
+    EXPECT_EQ(lastHandler, "connector");
+}
+
+// Test: Wildcard captures the remainder of the path
+TEST_F(HttpRouterTest, WildcardCapturesRemainder)
+{
+    EXPECT_EQ(match(HttpMethod::GET, "/static/js/app.js"), HttpRouter::MatchResult::Found);
+    EXPECT_EQ(lastHandler, "static");
+    EXPECT_EQ(request.getParam("*").str(), "js/app.js");
+}
+
+// Test: A literal route without the method falls back to a parameter route that has it
+TEST_F(HttpRouterTest, BacktracksWhenLiteralLacksMethod)
+{
+    add(HttpMethod::GET, "/api/{id}", "item");
+    add(HttpMethod::POST, "/api/reset", "reset");
+
+    EXPECT_EQ(match(HttpMethod::GET, "/api/reset"), HttpRouter::MatchResult::Found);
+    EXPECT_EQ(lastHandler, "item");
+    EXPECT_EQ(request.getParam("id").str(), "reset");
+
+    EXPECT_EQ(match(HttpMethod::POST, "/api/reset"), HttpRouter::MatchResult::Found);
+    EXPECT_EQ(lastHandler, "reset");
+    EXPECT_EQ(request.paramCount, 0u);
+
+    EXPECT_EQ(match(HttpMethod::DELETE, "/api/reset"), HttpRouter::MatchResult::MethodNotAllowed);
+    EXPECT_EQ(request.paramCount, 0u);
+}
+
+// Test: Unknown paths and wrong methods are distinguished
+TEST_F(HttpRouterTest, ReportsNotFoundAndMethodNotAllowed)
+{
+    EXPECT_EQ(match(HttpMethod::GET, "/api/unknown"), HttpRouter::MatchResult::NotFound);
+    EXPECT_EQ(match(HttpMethod::GET, "/api/connectors/2/start"), HttpRouter::MatchResult::MethodNotAllowed);
+    EXPECT_EQ(request.paramCount, 0u);
+}
+
+// Test: Invalid patterns are rejected at registration
+TEST_F(HttpRouterTest, RejectsInvalidPatterns)
+{
+    HttpHandler handler = [](const HttpRequest &, HttpResponse &) {};
+    EXPECT_FALSE(router.add(HttpMethod::GET, "/files/*/meta", handler));
+    EXPECT_FALSE(router.add(HttpMethod::GET, "/api/connectors/{name}/stop", handler));
+}
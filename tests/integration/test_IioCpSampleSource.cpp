@@ -0,0 +1,249 @@
+#include <gtest/gtest.h>
+#include "IioCpSampleSource.h"
+#include "CpWaveformAnalyzer.h"
+#include "HardwareCpSignalReader.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace Wallbox;
+
+/**
+ * @brief Tests for the CP ADC pipeline (IIO source, waveform analysis, reader)
+ *
+ * No ADC is needed: the device path runs against a stub sysfs tree with a
+ * regular file as the character device, everything else against replay files.
+ */
+class IioCpSampleSourceTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        char pattern[] = "/tmp/wallbox_iio_XXXXXX";
+        const char *dir = mkdtemp(pattern);
+        ASSERT_NE(dir, nullptr);
+        root = dir;
+    }
+
+    void TearDown() override
+    {
+        std::string command = "rm -rf " + root;
+        std::system(command.c_str());
+    }
+
+    static void writeFile(const std::string &path, const std::string &content)
+    {
+        std::ofstream(path, std::ios::binary) << content;
+    }
+
+    static std::string readFile(const std::string &path)
+    {
+        std::string value;
+        std::ifstream file(path);
+        std::getline(file, value);
+        return value;
+    }
+
+    static void appendSamples(std::ofstream &file, const std::vector<int16_t> &samples)
+    {
+        file.write(reinterpret_cast<const char *>(samples.data()), samples.size() * sizeof(int16_t));
+    }
+
+    /**
+     * @brief One 1 kHz PWM period per 100 samples, CP millivolts
+     */
+    static std::vector<int16_t> pwmBlock(size_t count, int16_t highMv, int16_t lowMv, size_t dutyPercent)
+    {
+        std::vector<int16_t> samples(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            samples[i] = (i % 100) < dutyPercent ? highMv : lowMv;
+        }
+        return samples;
+    }
+
+    /**
+     * @brief Replay config that passes samples through as CP millivolts
+     */
+    IioCpConfig replayConfig(const std::string &file) const
+    {
+        IioCpConfig config;
+        config.replayFile = root + "/" + file;
+        config.frontEndOffsetMv = 0;
+        config.frontEndGainX1000 = 1000;
+        return config;
+    }
+
+    std::string root;
+};
+
+// Test: Scan element formats parse and print in sysfs notation
+TEST(IioScanFormatTest, ParsesSysfsNotation)
+{
+    IioScanFormat format;
+    ASSERT_TRUE(IioScanFormat::parse("le:u12/16>>4", format));
+    EXPECT_FALSE(format.bigEndian);
+    EXPECT_FALSE(format.isSigned);
+    EXPECT_EQ(format.realBits, 12u);
+    EXPECT_EQ(format.storageBits, 16u);
+    EXPECT_EQ(format.shift, 4u);
+    EXPECT_EQ(format.toString(), "le:u12/16>>4");
+
+    ASSERT_TRUE(IioScanFormat::parse("be:s24/32>>0", format));
+    EXPECT_TRUE(format.bigEndian);
+    EXPECT_TRUE(format.isSigned);
+
+    EXPECT_FALSE(IioScanFormat::parse("le:u12/8>>0", format));
+    EXPECT_FALSE(IioScanFormat::parse("le:u12/16>>8", format));
+    EXPECT_FALSE(IioScanFormat::parse("garbage", format));
+}
+
+// Test: Replay applies scale, front-end offset and gain
+TEST_F(IioCpSampleSourceTest, ReplayDecodesSamples)
+{
+    {
+        std::ofstream file(root + "/cp.iio", std::ios::binary);
+        file << "IIO le:s16/16>>0 2.0 1000\n";
+        appendSamples(file, {0, 1000, -1000});
+    }
+
+    IioCpConfig config = replayConfig("cp.iio");
+    config.frontEndOffsetMv = 500;
+    config.frontEndGainX1000 = 4000;
+    IioCpSampleSource source(config);
+    ASSERT_TRUE(source.open());
+    EXPECT_EQ(source.sampleRateHz(), 1000u);
+
+    int32_t samples[8];
+    ASSERT_EQ(source.readBlock(samples, 8, 0), 3);
+    EXPECT_EQ(samples[0], -2000);  // (0 - 500) * 4
+    EXPECT_EQ(samples[1], 6000);   // (2000 - 500) * 4
+    EXPECT_EQ(samples[2], -10000); // (-2000 - 500) * 4
+    EXPECT_EQ(source.readBlock(samples, 8, 0), -1);
+}
+
+// Test: Device mode configures the scan element and buffer through sysfs
+TEST_F(IioCpSampleSourceTest, DeviceModeConfiguresSysfs)
+{
+    const std::string device = root + "/sys/iio:device0";
+    mkdir((root + "/sys").c_str(), 0700);
+    mkdir(device.c_str(), 0700);
+    mkdir((device + "/scan_elements").c_str(), 0700);
+    mkdir((device + "/buffer").c_str(), 0700);
+    writeFile(device + "/scan_elements/in_voltage0_en", "0");
+    writeFile(device + "/scan_elements/in_voltage0_type", "le:u12/16>>4\n");
+    writeFile(device + "/in_voltage_scale", "0.5\n");
+    writeFile(device + "/sampling_frequency", "0");
+    writeFile(device + "/buffer/length", "0");
+    writeFile(device + "/buffer/enable", "0");
+    mkdir((root + "/dev").c_str(), 0700);
+    {
+        std::ofstream file(root + "/dev/iio:device0", std::ios::binary);
+        appendSamples(file, {static_cast<int16_t>(3300 << 4), static_cast<int16_t>(0x000F)});
+    }
+
+    IioCpConfig config;
+    config.sysfsRoot = root + "/sys";
+    config.devRoot = root + "/dev";
+    config.frontEndOffsetMv = 0;
+    config.frontEndGainX1000 = 1000;
+    IioCpSampleSource source(config);
+    ASSERT_TRUE(source.open());
+
+    EXPECT_EQ(readFile(device + "/scan_elements/in_voltage0_en"), "1");
+    EXPECT_EQ(readFile(device + "/sampling_frequency"), "20000");
+    EXPECT_EQ(readFile(device + "/buffer/enable"), "1");
+    EXPECT_EQ(source.sampleRateHz(), 20000u);
+
+    int32_t samples[4];
+    ASSERT_EQ(source.readBlock(samples, 4, 100), 2);
+    EXPECT_EQ(samples[0], 1650); // 3300 LSB * 0.5 mV
+    EXPECT_EQ(samples[1], 0);    // bits below the shift are not data
+
+    source.close();
+    EXPECT_EQ(readFile(device + "/buffer/enable"), "0");
+}
+
+// Test: Plateaus, duty cycle and state of synthetic CP blocks
+TEST(CpWaveformAnalyzerTest, MeasuresPwmAndDcBlocks)
+{
+    std::vector<int32_t> block(200);
+    for (size_t i = 0; i < block.size(); ++i)
+    {
+        block[i] = (i % 100) < 25 ? 6000 : -12000;
+    }
+    CpMeasurement pwm = CpWaveformAnalyzer::analyze(block.data(), block.size());
+    EXPECT_TRUE(pwm.oscillating);
+    EXPECT_EQ(pwm.highMv, 6000);
+    EXPECT_EQ(pwm.lowMv, -12000);
+    EXPECT_EQ(pwm.dutyPermille, 250);
+    EXPECT_EQ(CpWaveformAnalyzer::classify(pwm), CpState::STATE_C);
+    EXPECT_EQ(CpWaveformAnalyzer::maxCurrentMilliamps(pwm.dutyPermille), 15000u);
+
+    std::fill(block.begin(), block.end(), 11900);
+    block[7] = 12100;
+    CpMeasurement dc = CpWaveformAnalyzer::analyze(block.data(), block.size());
+    EXPECT_FALSE(dc.oscillating);
+    EXPECT_EQ(dc.dutyPermille, 1000);
+    EXPECT_EQ(CpWaveformAnalyzer::classify(dc), CpState::STATE_A);
+
+    // PWM whose negative half stays near 0 V: vehicle diode missing
+    for (size_t i = 0; i < block.size(); ++i)
+    {
+        block[i] = (i % 100) < 50 ? 9000 : 0;
+    }
+    EXPECT_EQ(CpWaveformAnalyzer::classify(CpWaveformAnalyzer::analyze(block.data(), block.size())), CpState::STATE_F);
+
+    EXPECT_EQ(CpWaveformAnalyzer::classify(CpWaveformAnalyzer::analyze(block.data(), 0)), CpState::UNKNOWN);
+}
+
+// Test: The reader follows a replayed A -> B -> C plug-in sequence
+TEST_F(IioCpSampleSourceTest, ReaderReportsReplayedStates)
+{
+    // 1 kHz sample rate: 64-sample blocks
+    {
+        std::ofstream file(root + "/plugin.iio", std::ios::binary);
+        file << "IIO le:s16/16>>0 1.0 1000\n";
+        for (int i = 0; i < 3; ++i)
+            appendSamples(file, pwmBlock(64, 12000, 12000, 100));
+        for (int i = 0; i < 3; ++i)
+            appendSamples(file, pwmBlock(100, 9000, -12000, 50));
+        for (int i = 0; i < 3; ++i)
+            appendSamples(file, pwmBlock(100, 6000, -12000, 50));
+    }
+
+    HardwareCpSignalReader reader(std::unique_ptr<ICpSampleSource>(new IioCpSampleSource(replayConfig("plugin.iio"))));
+    std::mutex mutex;
+    std::vector<std::pair<CpState, CpState>> changes;
+    std::vector<CpState> queried;
+    reader.onStateChange([&](CpState oldState, CpState newState)
+                         {
+        // Listeners may query the reader from the callback
+        CpState current = reader.readCpState();
+        std::lock_guard<std::mutex> lock(mutex);
+        changes.emplace_back(oldState, newState);
+        queried.push_back(current); });
+
+    ASSERT_TRUE(reader.initialize());
+    EXPECT_EQ(reader.readCpState(), CpState::STATE_A);
+
+    reader.startMonitoring();
+    for (int i = 0; i < 100 && reader.readCpState() != CpState::STATE_C; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    reader.shutdown();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(changes.size(), 2u);
+    EXPECT_EQ(changes[0], std::make_pair(CpState::STATE_A, CpState::STATE_B));
+    EXPECT_EQ(changes[1], std::make_pair(CpState::STATE_B, CpState::STATE_C));
+    EXPECT_EQ(queried.size(), 2u);
+}
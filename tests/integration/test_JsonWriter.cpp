@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "JsonWriter.h"
+#include <climits>
+
+using namespace Wallbox;
+
+/**
+ * @brief Unit tests for JsonWriter
+ */
+class JsonWriterTest : public ::testing::Test
+{
+protected:
+    std::string buffer;
+};
+
+// Test: Commas are placed correctly in nested objects and arrays
+TEST_F(JsonWriterTest, WritesNestedStructures)
+{
+    JsonWriter json(buffer);
+    json.beginObject()
+        .field("state", "IDLE")
+        .key("pins")
+        .beginArray()
+        .value(17)
+        .value(27)
+        .endArray()
+        .key("status")
+        .beginObject()
+        .field("relay", true)
+        .endObject()
+        .key("empty")
+        .beginArray()
+        .endArray()
+        .endObject();
+
+    EXPECT_EQ(buffer, "{\"state\":\"IDLE\",\"pins\":[17,27],\"status\":{\"relay\":true},\"empty\":[]}");
+}
+
+// Test: Strings are escaped
+TEST_F(JsonWriterTest, EscapesStrings)
+{
+    JsonWriter json(buffer);
+    json.beginObject().field("reason", std::string("say \"hi\"\\\n\t\x01")).endObject();
+
+    EXPECT_EQ(buffer, "{\"reason\":\"say \\\"hi\\\"\\\\\\n\\t\\u0001\"}");
+}
+
+// Test: Numbers are formatted without iostream
+TEST_F(JsonWriterTest, FormatsNumbers)
+{
+    JsonWriter json(buffer);
+    json.beginArray()
+        .value(0)
+        .value(-42)
+        .value(LLONG_MIN)
+        .value(ULLONG_MAX)
+        .value(229.5)
+        .value(-0.125)
+        .value(3.0)
+        .value(-0.0000001)
+        .value(1e13)
+        .endArray();
+
+    EXPECT_EQ(buffer, "[0,-42,-9223372036854775808,18446744073709551615,229.5,-0.125,3,0,10000000000000]");
+}
+
+// Test: NaN and infinity become null
+TEST_F(JsonWriterTest, NonFiniteIsNull)
+{
+    JsonWriter json(buffer);
+    json.beginArray().value(0.0 / 0.0).value(1.0 / 0.0).endArray();
+
+    EXPECT_EQ(buffer, "[null,null]");
+}
+
+// Test: Appends to existing content, so buffers can be reused
+TEST_F(JsonWriterTest, AppendsToBuffer)
+{
+    buffer = "data: ";
+    JsonWriter(buffer).beginObject().field("id", 1u).endObject();
+    EXPECT_EQ(buffer, "data: {\"id\":1}");
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include "LatencyTracer.h"
+#include "Metrics.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Wallbox;
+
+/**
+ * @brief Tests for LatencyTracer
+ *
+ * The tracer is process-wide; tests look only at the spans of the traces
+ * they started.
+ */
+class LatencyTracerTest : public ::testing::Test
+{
+protected:
+    static std::vector<TraceSpanRecord> spansOf(uint32_t traceId)
+    {
+        std::vector<TraceSpanRecord> spans;
+        LatencyTracer::instance().snapshot(spans);
+        std::vector<TraceSpanRecord> result;
+        for (const auto &span : spans)
+        {
+            if (span.traceId == traceId)
+            {
+                result.push_back(span);
+            }
+        }
+        return result;
+    }
+};
+
+// Test: Spans attach to the current trace and scopes restore the previous one
+TEST_F(LatencyTracerTest, SpansFollowTheCurrentTrace)
+{
+    EXPECT_FALSE(LatencyTracer::current().active());
+    {
+        TraceSpan ignored(TraceStage::PARSE); // No trace: not recorded
+    }
+
+    uint64_t originNs = LatencyTracer::nowNs();
+    uint32_t id;
+    {
+        TraceScope trace(TraceOrigin::UDP, originNs);
+        id = trace.context().id;
+        EXPECT_EQ(LatencyTracer::current().id, id);
+        {
+            TraceSpan parse(TraceStage::PARSE);
+        }
+        TraceSpan relay(TraceStage::RELAY);
+        relay.end();
+        relay.end(); // Second end does nothing
+    }
+    EXPECT_FALSE(LatencyTracer::current().active());
+
+    std::vector<TraceSpanRecord> spans = spansOf(id);
+    ASSERT_EQ(spans.size(), 2u);
+    EXPECT_EQ(spans[0].stage, TraceStage::PARSE);
+    EXPECT_EQ(spans[1].stage, TraceStage::RELAY);
+    EXPECT_EQ(spans[1].origin, TraceOrigin::UDP);
+    EXPECT_EQ(spans[1].originNs, originNs);
+    EXPECT_LE(spans[0].startNs, spans[0].endNs);
+    EXPECT_LE(spans[0].endNs, spans[1].startNs);
+}
+
+// Test: A trace carried to another thread keeps its id and origin
+TEST_F(LatencyTracerTest, ContextCrossesThreads)
+{
+    TraceContext carried;
+    {
+        TraceScope trace(TraceOrigin::CP_EDGE, LatencyTracer::nowNs());
+        carried = LatencyTracer::current();
+    }
+
+    std::thread worker([carried]()
+                       {
+        TraceScope scope(carried);
+        TraceSpan span(TraceStage::TRANSITION); });
+    worker.join();
+
+    std::vector<TraceSpanRecord> spans = spansOf(carried.id);
+    ASSERT_EQ(spans.size(), 1u);
+    EXPECT_EQ(spans[0].origin, TraceOrigin::CP_EDGE);
+    EXPECT_EQ(spans[0].stage, TraceStage::TRANSITION);
+}
+
+// Test: Stage histograms appear on /metrics; the Chrome dump filters idle traces
+TEST_F(LatencyTracerTest, HistogramsAndChromeTrace)
+{
+    uint32_t idle;
+    uint32_t busy;
+    {
+        TraceScope trace(TraceOrigin::UDP, LatencyTracer::nowNs());
+        idle = trace.context().id;
+        TraceSpan parse(TraceStage::PARSE);
+    }
+    {
+        TraceScope trace(TraceOrigin::UDP, LatencyTracer::nowNs());
+        busy = trace.context().id;
+        TraceSpan send(TraceStage::STATUS_SEND);
+    }
+
+    std::string metrics;
+    MetricsRegistry::instance().render(metrics);
+    EXPECT_NE(metrics.find("wallbox_trace_stage_seconds_bucket{stage=\"status_send\",le=\"1e-06\"}"), std::string::npos);
+    EXPECT_NE(metrics.find("wallbox_trace_since_origin_seconds_count{origin=\"udp\",stage=\"status_send\"}"), std::string::npos);
+    EXPECT_EQ(metrics.find("wallbox_trace_since_origin_seconds_count{origin=\"udp\",stage=\"parse\"}"), std::string::npos);
+
+    std::string json;
+    LatencyTracer::instance().writeChromeTrace(json);
+    EXPECT_EQ(json.compare(0, 44, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[{\"nam"), 0);
+    EXPECT_NE(json.find("\"trace\":" + std::to_string(busy) + ","), std::string::npos);
+    EXPECT_EQ(json.find("\"trace\":" + std::to_string(idle) + ","), std::string::npos);
+
+    json.clear();
+    LatencyTracer::instance().writeChromeTrace(json, true);
+    EXPECT_NE(json.find("\"trace\":" + std::to_string(idle) + ","), std::string::npos);
+}
+
+// Test: Log-linear bounds split every power of two
+TEST_F(LatencyTracerTest, LogLinearBounds)
+{
+    std::vector<uint64_t> bounds = Histogram::logLinearBoundsNs(1000, 8000, 4);
+    std::vector<uint64_t> expected = {1000, 1250, 1500, 1750, 2000, 2500, 3000, 3500, 4000,
+                                      5000, 6000, 7000, 8000};
+    EXPECT_EQ(bounds, expected);
+}
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include "Logger.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+using namespace Wallbox;
+
+/**
+ * @brief Tests for the asynchronous Logger
+ *
+ * Lines go to a temporary file sink only; the logger is a process-wide
+ * singleton, so each test restores the level it changes.
+ */
+class LoggerTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        char pattern[] = "/tmp/wallbox_logger_test_XXXXXX";
+        int fd = mkstemp(pattern);
+        ASSERT_GE(fd, 0);
+        close(fd);
+        path = pattern;
+        sink = Logger::instance().openFile(path);
+        ASSERT_NE(sink, 0);
+        previousLevel = Logger::getLevel();
+    }
+
+    void TearDown() override
+    {
+        Logger::setLevel(previousLevel);
+        Logger::instance().closeFile(sink);
+        std::remove(path.c_str());
+    }
+
+    std::vector<std::string> readLines()
+    {
+        Logger::instance().flush();
+        std::ifstream file(path);
+        std::vector<std::string> lines;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    std::string path;
+    LogSinks sink = 0;
+    LogLevel previousLevel = LogLevel::INFO;
+};
+
+// Test: A line carries time, level, tag and the formatted values
+TEST_F(LoggerTest, FormatsLine)
+{
+    LogLine(LogLevel::WARN, "Relay", sink) << "pin " << 17 << ' ' << -5 << ' ' << true << ' ' << 2.5 << ' ' << std::string("done");
+
+    std::vector<std::string> lines = readLines();
+    ASSERT_EQ(lines.size(), 1u);
+    // [YYYY-MM-DD HH:MM:SS.mmm] is 25 characters
+    ASSERT_GT(lines[0].size(), 26u);
+    EXPECT_EQ(lines[0][0], '[');
+    EXPECT_EQ(lines[0][24], ']');
+    EXPECT_EQ(lines[0].substr(26), "[WARN] [Relay] pin 17 -5 true 2.5 done");
+}
+
+// Test: Free-form level names become a tag at INFO; long text is cut
+TEST_F(LoggerTest, LegacyLevelNamesAndTruncation)
+{
+    LogLine("CMD", sink) << "Wallbox enabled";
+    LogLine("error", sink) << "broken";
+    LogLine("INFO", sink) << std::string(1000, 'x');
+
+    std::vector<std::string> lines = readLines();
+    ASSERT_EQ(lines.size(), 3u);
+    EXPECT_EQ(lines[0].substr(26), "[INFO] [CMD] Wallbox enabled");
+    EXPECT_EQ(lines[1].substr(26), "[ERROR] broken");
+    std::string cut = lines[2].substr(26 + 7);
+    EXPECT_EQ(cut.size(), LogRecord::TEXT_CAPACITY);
+    EXPECT_EQ(cut.substr(cut.size() - 3), "...");
+}
+
+// Test: Disabled statements do not evaluate their arguments
+TEST_F(LoggerTest, DisabledLevelsSkipArguments)
+{
+    int evaluated = 0;
+    auto expensive = [&evaluated]()
+    {
+        evaluated++;
+        return "value";
+    };
+
+    Logger::setLevel(LogLevel::WARN);
+    WALLBOX_LOG_INFO("Test") << expensive();
+    EXPECT_EQ(evaluated, 0);
+
+    WALLBOX_LOG_WARN("Test") << expensive();
+    EXPECT_EQ(evaluated, 1);
+
+#if WALLBOX_LOG_MIN_LEVEL > 0
+    // Compiled out regardless of the runtime level
+    Logger::setLevel(LogLevel::TRACE);
+    WALLBOX_LOG_TRACE("Test") << expensive();
+    EXPECT_EQ(evaluated, 1);
+#endif
+}
+
+// Test: Lines from several threads all arrive, each thread's in order
+TEST_F(LoggerTest, ThreadsKeepTheirOrder)
+{
+    constexpr int THREADS = 4;
+    constexpr int PER_THREAD = 100; // Below the ring capacity: nothing may drop
+    uint64_t droppedBefore = Logger::instance().getStats().dropped;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t)
+    {
+        threads.emplace_back([this, t]()
+                             {
+            for (int i = 0; i < PER_THREAD; ++i)
+            {
+                LogLine(LogLevel::INFO, "T", sink) << t << ' ' << i;
+            } });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    std::vector<std::string> lines = readLines();
+    ASSERT_EQ(lines.size(), static_cast<size_t>(THREADS * PER_THREAD));
+    EXPECT_EQ(Logger::instance().getStats().dropped, droppedBefore);
+
+    std::vector<int> next(THREADS, 0);
+    for (const auto &line : lines)
+    {
+        std::istringstream text(line.substr(line.find("[T] ") + 4));
+        int thread = -1;
+        int index = -1;
+        text >> thread >> index;
+        ASSERT_GE(thread, 0);
+        ASSERT_LT(thread, THREADS);
+        EXPECT_EQ(index, next[thread]);
+        next[thread] = index + 1;
+    }
+}
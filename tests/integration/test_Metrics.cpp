@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "Metrics.h"
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Wallbox;
+
+/**
+ * @brief Tests for MetricsRegistry
+ *
+ * The registry is process-wide; every test uses its own metric names.
+ */
+class MetricsTest : public ::testing::Test
+{
+protected:
+    static std::string render()
+    {
+        std::string out;
+        MetricsRegistry::instance().render(out);
+        return out;
+    }
+
+    static bool contains(const std::string &text, const std::string &line)
+    {
+        return text.find(line) != std::string::npos;
+    }
+};
+
+// Test: Series of one family share their HELP and TYPE lines
+TEST_F(MetricsTest, CountersAndGaugesRender)
+{
+    MetricsRegistry &registry = MetricsRegistry::instance();
+    Counter &get = registry.counter("test_requests_total", "Requests", {{"method", "GET"}});
+    Counter &post = registry.counter("test_requests_total", "Requests", {{"method", "POST"}});
+    Gauge &gauge = registry.gauge("test_level", "Level");
+    get.inc();
+    get.inc(2);
+    post.inc();
+    gauge.set(7);
+    gauge.add(-10);
+
+    EXPECT_EQ(&get, &registry.counter("test_requests_total", "Requests", {{"method", "GET"}}));
+
+    std::string text = render();
+    EXPECT_TRUE(contains(text, "# HELP test_requests_total Requests\n# TYPE test_requests_total counter\n"
+                               "test_requests_total{method=\"GET\"} 3\n"
+                               "test_requests_total{method=\"POST\"} 1\n"));
+    EXPECT_TRUE(contains(text, "# TYPE test_level gauge\ntest_level -3\n"));
+}
+
+// Test: Histogram buckets are cumulative and exported in seconds
+TEST_F(MetricsTest, HistogramBuckets)
+{
+    Histogram &histogram = MetricsRegistry::instance().histogram(
+        "test_duration_seconds", "Duration", {{"route", "/a"}}, {1000000, 10000000});
+    histogram.observe(500000);   // 0.5 ms
+    histogram.observe(1000000);  // exactly on a bound
+    histogram.observe(5000000);  // 5 ms
+    histogram.observe(20000000); // above all bounds
+
+    std::string text = render();
+    EXPECT_TRUE(contains(text, "# TYPE test_duration_seconds histogram\n"
+                               "test_duration_seconds_bucket{route=\"/a\",le=\"0.001\"} 2\n"
+                               "test_duration_seconds_bucket{route=\"/a\",le=\"0.01\"} 3\n"
+                               "test_duration_seconds_bucket{route=\"/a\",le=\"+Inf\"} 4\n"
+                               "test_duration_seconds_sum{route=\"/a\"} 0.0265\n"
+                               "test_duration_seconds_count{route=\"/a\"} 4\n"));
+}
+
+// Test: Label values are escaped; a name cannot change its type
+TEST_F(MetricsTest, EscapingAndTypeMismatch)
+{
+    MetricsRegistry &registry = MetricsRegistry::instance();
+    registry.counter("test_escaped_total", "Escaped", {{"path", "a\"b\\c\nd"}}).inc();
+    EXPECT_TRUE(contains(render(), "test_escaped_total{path=\"a\\\"b\\\\c\\nd\"} 1\n"));
+
+    EXPECT_THROW(registry.gauge("test_escaped_total", "Escaped"), std::invalid_argument);
+}
+
+// Test: Concurrent increments and scrapes lose nothing
+TEST_F(MetricsTest, ConcurrentIncrements)
+{
+    constexpr int THREADS = 4;
+    constexpr int PER_THREAD = 10000;
+    Counter &counter = MetricsRegistry::instance().counter("test_concurrent_total", "Concurrent");
+    Histogram &histogram = MetricsRegistry::instance().histogram("test_concurrent_seconds", "Concurrent");
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t)
+    {
+        threads.emplace_back([&counter, &histogram]()
+                             {
+            for (int i = 0; i < PER_THREAD; ++i)
+            {
+                counter.inc();
+                histogram.observe(static_cast<uint64_t>(i) * 1000);
+            } });
+    }
+    for (int i = 0; i < 20; ++i)
+    {
+        render();
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(counter.value(), static_cast<uint64_t>(THREADS * PER_THREAD));
+    EXPECT_EQ(histogram.count(), static_cast<uint64_t>(THREADS * PER_THREAD));
+    EXPECT_TRUE(contains(render(), "test_concurrent_seconds_count 40000\n"));
+}
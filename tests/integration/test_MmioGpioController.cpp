@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include "MmioGpioController.h"
+#include <sys/mman.h>
+
+using namespace Wallbox;
+
+/**
+ * @brief Unit tests for MmioGpioController against a fake register file
+ *
+ * The register block is an anonymous mapping, so the tests check exactly
+ * which bits the controller touches without any GPIO hardware.
+ */
+class MmioGpioControllerTest : public ::testing::Test
+{
+protected:
+    static constexpr size_t MAP_SIZE = 4096;
+    static constexpr int DIR = 0;
+    static constexpr int OUT = 1;
+    static constexpr int IN = 2;
+    static constexpr int SET = 3;
+    static constexpr int CLEAR = 4;
+
+    void SetUp() override
+    {
+        void *mapping = mmap(nullptr, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        ASSERT_NE(mapping, MAP_FAILED);
+        registers = static_cast<volatile uint32_t *>(mapping);
+
+        // Bank of 8 pins at global numbers 100-107, bits 4-11, Amlogic-style direction
+        layout.physicalBase = 0;
+        layout.blockOffset = 0;
+        layout.mapSize = MAP_SIZE;
+        layout.banks = {{100, 8, 4, DIR, true, OUT, IN, -1, -1}};
+    }
+
+    void TearDown() override
+    {
+        munmap(const_cast<uint32_t *>(registers), MAP_SIZE);
+    }
+
+    GpioRegisterLayout layout;
+    volatile uint32_t *registers = nullptr;
+};
+
+// Test: Direction and output bits are updated without touching neighbours
+TEST_F(MmioGpioControllerTest, ReadModifyWriteKeepsOtherBits)
+{
+    registers[DIR] = 0xFFFFFFFF; // everything input after reset
+    registers[OUT] = 0x80000001;
+
+    MmioGpioController gpio(layout, registers);
+    ASSERT_TRUE(gpio.initialize());
+    ASSERT_TRUE(gpio.setPinMode(102, PinMode::OUTPUT));
+    EXPECT_EQ(registers[DIR], 0xFFFFFFFFu & ~(1u << 6));
+
+    ASSERT_TRUE(gpio.digitalWrite(102, PinValue::HIGH));
+    EXPECT_EQ(registers[OUT], 0x80000001u | (1u << 6));
+    ASSERT_TRUE(gpio.digitalWrite(102, PinValue::LOW));
+    EXPECT_EQ(registers[OUT], 0x80000001u);
+
+    ASSERT_TRUE(gpio.setPinMode(102, PinMode::INPUT));
+    EXPECT_EQ(registers[DIR], 0xFFFFFFFFu);
+}
+
+// Test: Reads come from the input register
+TEST_F(MmioGpioControllerTest, ReadsInputRegister)
+{
+    MmioGpioController gpio(layout, registers);
+    registers[IN] = 1u << 11;
+    EXPECT_EQ(gpio.digitalRead(107), PinValue::HIGH);
+    EXPECT_EQ(gpio.digitalRead(106), PinValue::LOW);
+}
+
+// Test: Banks with set/clear registers are written with single stores
+TEST_F(MmioGpioControllerTest, UsesSetClearRegisters)
+{
+    layout.banks[0].setReg = SET;
+    layout.banks[0].clearReg = CLEAR;
+    registers[OUT] = 0x1234;
+
+    MmioGpioController gpio(layout, registers);
+    ASSERT_TRUE(gpio.digitalWrite(100, PinValue::HIGH));
+    EXPECT_EQ(registers[SET], 1u << 4);
+    ASSERT_TRUE(gpio.digitalWrite(101, PinValue::LOW));
+    EXPECT_EQ(registers[CLEAR], 1u << 5);
+    EXPECT_EQ(registers[OUT], 0x1234u);
+}
+
+// Test: writeMany applies a whole pattern and reports unknown pins
+TEST_F(MmioGpioControllerTest, WriteManyAppliesPattern)
+{
+    MmioGpioController gpio(layout, registers);
+    registers[OUT] = 1u << 5;
+
+    const PinWrite pattern[] = {{100, PinValue::HIGH}, {101, PinValue::LOW}, {107, PinValue::HIGH}};
+    ASSERT_TRUE(gpio.writeMany(pattern, 3));
+    EXPECT_EQ(registers[OUT], (1u << 4) | (1u << 11));
+
+    const PinWrite withUnknown[] = {{100, PinValue::LOW}, {200, PinValue::HIGH}};
+    EXPECT_FALSE(gpio.writeMany(withUnknown, 2));
+    EXPECT_EQ(registers[OUT], 1u << 11);
+}
+
+// Test: Pins outside the layout are rejected
+TEST_F(MmioGpioControllerTest, RejectsUnknownPins)
+{
+    MmioGpioController gpio(layout, registers);
+    EXPECT_FALSE(gpio.setPinMode(99, PinMode::OUTPUT));
+    EXPECT_FALSE(gpio.digitalWrite(108, PinValue::HIGH));
+    EXPECT_EQ(registers[OUT], 0u);
+}
+
+// Test: The Banana Pi M5 pins used by the default configuration map to GPIOX
+TEST(GpioRegisterLayoutTest, AmlogicG12MapsHeaderPins)
+{
+    GpioRegisterLayout layout = GpioRegisterLayout::amlogicG12(512);
+    int relayPin = 586; // GPIOX_9, physical pin 21
+    bool found = false;
+    for (const auto &bank : layout.banks)
+    {
+        if (relayPin >= bank.firstPin && relayPin < bank.firstPin + bank.pinCount)
+        {
+            EXPECT_EQ(relayPin - bank.firstPin, 9);
+            EXPECT_EQ(bank.outputReg, 0x07);
+            found = true;
+        }
+    }
+    EXPECT_TRUE(found);
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "MpscQueue.h"
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Wallbox;
+
+/**
+ * @brief Tests for MpscQueue
+ */
+
+// Test: Single producer gets FIFO order, empty queue pops nothing
+TEST(MpscQueueTest, FifoOrder)
+{
+    MpscQueue<int> queue;
+    int value = -1;
+    EXPECT_TRUE(queue.empty());
+    EXPECT_FALSE(queue.pop(value));
+
+    for (int i = 0; i < 10; ++i)
+    {
+        queue.push(i);
+    }
+    EXPECT_FALSE(queue.empty());
+    for (int i = 0; i < 10; ++i)
+    {
+        ASSERT_TRUE(queue.pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.pop(value));
+}
+
+// Test: Concurrent producers lose nothing and keep their own order
+TEST(MpscQueueTest, ConcurrentProducersKeepPerProducerOrder)
+{
+    constexpr int PRODUCERS = 4;
+    constexpr int PER_PRODUCER = 20000;
+    MpscQueue<std::pair<int, int>> queue;
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; ++p)
+    {
+        producers.emplace_back([&queue, p]()
+                               {
+            for (int i = 0; i < PER_PRODUCER; ++i)
+            {
+                queue.push(std::make_pair(p, i));
+            } });
+    }
+
+    std::vector<int> next(PRODUCERS, 0);
+    int received = 0;
+    std::pair<int, int> item;
+    while (received < PRODUCERS * PER_PRODUCER)
+    {
+        if (!queue.pop(item))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(item.second, next[item.first]);
+        next[item.first]++;
+        received++;
+    }
+
+    for (auto &producer : producers)
+    {
+        producer.join();
+    }
+    EXPECT_TRUE(queue.empty());
+}
+
+// Test: Elements left in the queue are destroyed with it
+TEST(MpscQueueTest, DestroysRemainingElements)
+{
+    auto tracked = std::make_shared<int>(1);
+    {
+        MpscQueue<std::shared_ptr<int>> queue;
+        queue.push(tracked);
+        queue.push(tracked);
+        EXPECT_EQ(tracked.use_count(), 3);
+    }
+    EXPECT_EQ(tracked.use_count(), 1);
+}
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include "ChargingStateMachine.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace Wallbox;
+
+/**
+ * @brief Tests for ChargingStateMachine listener dispatch
+ *
+ * Transitions alternate IDLE <-> CONNECTED, which is always valid.
+ */
+namespace
+{
+    void toggle(ChargingStateMachine &machine, int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            machine.transitionTo(machine.isIdle() ? ChargingState::CONNECTED : ChargingState::IDLE, "test");
+        }
+    }
+
+    template <typename Predicate>
+    bool waitFor(Predicate predicate)
+    {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (!predicate())
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+} // namespace
+
+// Test: Synchronous listeners run inside the transition and can be removed
+TEST(StateChangeDispatchTest, SynchronousListenersAddRemove)
+{
+    ChargingStateMachine machine;
+    int first = 0;
+    int second = 0;
+    ListenerId firstId = machine.addStateChangeListener([&](ChargingState, ChargingState, const std::string &)
+                                                        { first++; });
+    machine.addStateChangeListener([&](ChargingState oldState, ChargingState newState, const std::string &reason)
+                                   {
+        EXPECT_EQ(oldState, ChargingState::IDLE);
+        EXPECT_EQ(newState, ChargingState::CONNECTED);
+        EXPECT_EQ(reason, "test");
+        second++; });
+
+    toggle(machine, 1);
+    EXPECT_EQ(first, 1);
+    EXPECT_EQ(second, 1);
+    EXPECT_EQ(machine.getListenerStats(firstId).delivered, 1u);
+
+    EXPECT_TRUE(machine.removeStateChangeListener(firstId));
+    EXPECT_FALSE(machine.removeStateChangeListener(firstId));
+    machine.clearStateChangeListeners();
+    toggle(machine, 1);
+    EXPECT_EQ(first, 1);
+    EXPECT_EQ(second, 1);
+}
+
+// Test: A listener registered during dispatch starts with the next transition
+TEST(StateChangeDispatchTest, AddDuringDispatchSeesNextTransition)
+{
+    ChargingStateMachine machine;
+    int late = 0;
+    bool added = false;
+    machine.addStateChangeListener([&](ChargingState, ChargingState, const std::string &)
+                                   {
+        if (!added)
+        {
+            added = true;
+            machine.addStateChangeListener([&](ChargingState, ChargingState, const std::string &)
+                                           { late++; });
+        } });
+
+    toggle(machine, 1);
+    EXPECT_EQ(late, 0);
+    toggle(machine, 2);
+    EXPECT_EQ(late, 2);
+}
+
+// Test: Asynchronous listeners get all events in order on their own thread
+TEST(StateChangeDispatchTest, AsynchronousListenerKeepsOrder)
+{
+    ChargingStateMachine machine;
+    std::mutex mutex;
+    std::vector<ChargingState> seen;
+    std::thread::id caller = std::this_thread::get_id();
+    std::atomic<bool> otherThread(true);
+    ListenerId id = machine.addStateChangeListener([&](ChargingState, ChargingState newState, const std::string &)
+                                                   {
+        if (std::this_thread::get_id() == caller)
+        {
+            otherThread = false;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        seen.push_back(newState); },
+                                                   ListenerMode::ASYNCHRONOUS, 128);
+
+    toggle(machine, 100);
+    ASSERT_TRUE(waitFor([&]()
+                        { return machine.getListenerStats(id).delivered == 100; }));
+    EXPECT_TRUE(otherThread.load());
+    EXPECT_EQ(machine.getListenerStats(id).dropped, 0u);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < seen.size(); ++i)
+    {
+        EXPECT_EQ(seen[i], i % 2 == 0 ? ChargingState::CONNECTED : ChargingState::IDLE);
+    }
+}
+
+// Test: A stalled asynchronous listener neither blocks transitions nor loses count of drops
+TEST(StateChangeDispatchTest, StalledListenerDropsInsteadOfBlocking)
+{
+    ChargingStateMachine machine;
+    std::mutex mutex;
+    std::condition_variable released;
+    bool release = false;
+    ListenerId id = machine.addStateChangeListener([&](ChargingState, ChargingState, const std::string &)
+                                                   {
+        std::unique_lock<std::mutex> lock(mutex);
+        released.wait(lock, [&]()
+                      { return release; }); },
+                                                   ListenerMode::ASYNCHRONOUS, 4);
+
+    auto start = std::chrono::steady_clock::now();
+    toggle(machine, 20);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        release = true;
+    }
+    released.notify_all();
+
+    ASSERT_TRUE(waitFor([&]()
+                        {
+        ListenerStats stats = machine.getListenerStats(id);
+        return stats.delivered + stats.dropped == 20; }));
+    ListenerStats stats = machine.getListenerStats(id);
+    EXPECT_GE(stats.dropped, 15u); // At most one in the callback plus a full ring of 4
+    EXPECT_EQ(stats.highWater, 4u);
+    EXPECT_EQ(machine.getDispatchStats().dropped, stats.dropped);
+}
@@ -9,13 +9,49 @@ function App() {
   const [error, setError] = useState(null);
   const [connected, setConnected] = useState(false);
 
-  // Load status on mount and every 2 seconds
+  // Load status on mount, then follow pushed events; poll every 2 seconds
+  // only while the event stream is unavailable
   useEffect(() => {
     logger.info('React app started');
     loadStatus();
-    const interval = setInterval(loadStatus, 2000);
+
+    let interval = null;
+    const startPolling = () => {
+      if (!interval) {
+        interval = setInterval(loadStatus, 2000);
+      }
+    };
+    const stopPolling = () => {
+      if (interval) {
+        clearInterval(interval);
+        interval = null;
+      }
+    };
+
+    const unsubscribe = wallboxAPI.subscribeStatus(
+      (data) => {
+        setStatus(data);
+        setConnected(true);
+        setError(null);
+      },
+      (streamConnected) => {
+        if (streamConnected) {
+          stopPolling();
+          loadStatus(); // Catch up on anything missed while disconnected
+        } else {
+          startPolling();
+        }
+      }
+    );
+    if (!unsubscribe) {
+      startPolling();
+    }
+
     return () => {
-      clearInterval(interval);
+      stopPolling();
+      if (unsubscribe) {
+        unsubscribe();
+      }
       logger.info('React app unmounted');
     };
   }, []);
@@ -88,6 +88,38 @@ class WallboxAPI {
     }
   }
 
+  /**
+   * Subscribe to pushed status changes (Server-Sent Events on /api/events).
+   * EventSource reconnects by itself and resumes with Last-Event-ID.
+   * Returns an unsubscribe function, or null if the browser lacks EventSource.
+   */
+  subscribeStatus(onStatus, onConnectionChange) {
+    if (typeof window === 'undefined' || !window.EventSource) {
+      return null;
+    }
+
+    logger.info('API: Subscribing to status events');
+    const source = new EventSource(`${API_BASE_URL}/api/events`);
+    const handleEvent = (event) => {
+      try {
+        const payload = JSON.parse(event.data);
+        logger.debug(`API: Event ${event.type}`, payload);
+        onStatus(payload.status);
+      } catch (error) {
+        logger.error('API: Invalid event data', error.message);
+      }
+    };
+
+    ['state', 'relay', 'cp'].forEach((type) => source.addEventListener(type, handleEvent));
+    source.onopen = () => onConnectionChange(true);
+    source.onerror = () => onConnectionChange(false);
+
+    return () => {
+      logger.info('API: Closing status events');
+      source.close();
+    };
+  }
+
   async healthCheck() {
     try {
       logger.debug('API: Health check');